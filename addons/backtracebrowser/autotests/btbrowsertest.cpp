@@ -6,6 +6,7 @@
  */
 
 #include "btbrowsertest.h"
+#include "btindex.h"
 #include "btparser.h"
 
 #include <QFileInfo>
@@ -81,4 +82,38 @@ void KateBtBrowserTest::testParser()
     QVERIFY(info.empty());
 }
 
+void KateBtBrowserTest::testIndex()
+{
+    BtIndexBuilder builder;
+    const quint32 src = builder.addDirectory(BtIndex::NoParent, QStringLiteral("/home/dev/src"), 1);
+    const quint32 kernel = builder.addDirectory(src, QStringLiteral("kernel"), 2);
+    const quint32 gui = builder.addDirectory(src, QStringLiteral("gui"), 3);
+    const quint32 guiKernel = builder.addDirectory(gui, QStringLiteral("kernel"), 4);
+    builder.addFile(kernel, QStringLiteral("qapplication.cpp"));
+    builder.addFile(guiKernel, QStringLiteral("qapplication.cpp"));
+    builder.addFile(gui, QStringLiteral("qwidget.cpp"));
+    builder.addFile(src, QStringLiteral("main.cpp"));
+
+    const std::shared_ptr<const BtIndex> index = BtIndex::fromData(builder.build({QStringLiteral("*.cpp")}));
+    QVERIFY(index);
+    QCOMPARE(index->fileCount(), 4);
+    QCOMPARE(index->directoryCount(), 4);
+    QCOMPARE(index->filter(), QStringList{QStringLiteral("*.cpp")});
+    QCOMPARE(index->directoryPath(guiKernel), QStringLiteral("/home/dev/src/gui/kernel"));
+    QCOMPARE(index->directoryMTime(gui), qint64(3));
+
+    // the longest matching suffix wins
+    QCOMPARE(index->lookup(QStringLiteral("gui/kernel/qapplication.cpp")), QStringLiteral("/home/dev/src/gui/kernel/qapplication.cpp"));
+    QCOMPARE(index->lookup(QStringLiteral("src/kernel/qapplication.cpp")), QStringLiteral("/home/dev/src/kernel/qapplication.cpp"));
+    QCOMPARE(index->lookup(QStringLiteral("qwidget.cpp")), QStringLiteral("/home/dev/src/gui/qwidget.cpp"));
+    QCOMPARE(index->lookup(QStringLiteral("dev/src/main.cpp")), QStringLiteral("/home/dev/src/main.cpp"));
+    QVERIFY(index->lookup(QStringLiteral("kernel/qobject.cpp")).isEmpty());
+
+    // garbage is rejected
+    QVERIFY(!BtIndex::fromData(QByteArray("KBTI")));
+    QByteArray data = builder.build({});
+    data[data.size() - 1] = char(0x7f);
+    QVERIFY(!BtIndex::fromData(data));
+}
+
 // kate: space-indent on; indent-width 4; replace-tabs on;
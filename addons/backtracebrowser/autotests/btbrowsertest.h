@@ -20,6 +20,7 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void testParser();
+    void testIndex();
 };
 
 #endif
@@ -6,29 +6,30 @@
 
 #include "btdatabase.h"
 
-#include <QDataStream>
 #include <QDebug>
-#include <QDir>
-#include <QFile>
 
 void KateBtDatabase::loadFromFile(const QString &url)
 {
-    QFile file(url);
-    if (file.open(QIODevice::ReadOnly)) {
-        QMutexLocker locker(&mutex);
-        QDataStream ds(&file);
-        ds >> db;
-    }
-    //     qDebug() << "Number of entries in the backtrace database" << url << ":" << db.size();
+    // the file is mapped, not parsed; databases of older versions are simply ignored and rebuilt
+    std::shared_ptr<const BtIndex> index = BtIndex::fromFile(url);
+    QMutexLocker locker(&mutex);
+    db = index;
+    modified = false;
+    //     qDebug() << "Number of entries in the backtrace database" << url << ":" << (db ? db->fileCount() : 0);
 }
 
 void KateBtDatabase::saveToFile(const QString &url) const
 {
-    QFile file(url);
-    if (file.open(QIODevice::WriteOnly)) {
+    std::shared_ptr<const BtIndex> index;
+    {
         QMutexLocker locker(&mutex);
-        QDataStream ds(&file);
-        ds << db;
+        if (!modified) {
+            return;
+        }
+        index = db;
+    }
+    if (index) {
+        index->saveToFile(url);
     }
     //     qDebug() << "Saved backtrace database to" << url;
 }
@@ -36,45 +37,27 @@ void KateBtDatabase::saveToFile(const QString &url) const
 QString KateBtDatabase::value(const QString &key)
 {
     // key is either of the form "foo/bar.txt" or only "bar.txt"
-    QString file = key;
-    QStringList sl = key.split(QLatin1Char('/'));
-    if (sl.size() > 1) {
-        file = sl[1];
-    }
+    const std::shared_ptr<const BtIndex> index = this->index();
+    return index ? index->lookup(key) : QString();
+}
 
+std::shared_ptr<const BtIndex> KateBtDatabase::index() const
+{
     QMutexLocker locker(&mutex);
-    if (db.contains(file)) {
-        const QStringList &sl = db.value(file);
-        for (int i = 0; i < sl.size(); ++i) {
-            if (sl[i].indexOf(key) != -1) {
-                return sl[i];
-            }
-        }
-        // try to use the first one
-        if (!sl.empty()) {
-            return sl[0];
-        }
-    }
-
-    return QString();
+    return db;
 }
 
-void KateBtDatabase::add(const QString &folder, const QStringList &files)
+void KateBtDatabase::setIndex(const std::shared_ptr<const BtIndex> &index)
 {
     QMutexLocker locker(&mutex);
-    for (const QString &file : files) {
-        QStringList &sl = db[file];
-        QString entry = QDir::fromNativeSeparators(folder + QLatin1Char('/') + file);
-        if (!sl.contains(entry)) {
-            sl << entry;
-        }
-    }
+    db = index;
+    modified = true;
 }
 
 int KateBtDatabase::size() const
 {
-    QMutexLocker locker(&mutex);
-    return db.size();
+    const std::shared_ptr<const BtIndex> index = this->index();
+    return index ? index->fileCount() : 0;
 }
 
 // kate: space-indent on; indent-width 4; replace-tabs on;
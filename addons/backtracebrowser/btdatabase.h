@@ -7,10 +7,12 @@
 #ifndef BTDATABASE_H
 #define BTDATABASE_H
 
-#include <QHash>
+#include "btindex.h"
+
 #include <QMutex>
 #include <QString>
-#include <QStringList>
+
+#include <memory>
 
 class KateBtDatabase
 {
@@ -27,13 +29,18 @@ public:
 
     QString value(const QString &key);
 
-    void add(const QString &folder, const QStringList &files);
+    /// the current index, may be nullptr; it is immutable and stays valid as long as it is referenced
+    std::shared_ptr<const BtIndex> index() const;
+    /// replace the index, e.g. after the indexer is done
+    void setIndex(const std::shared_ptr<const BtIndex> &index);
 
     int size() const;
 
 private:
     mutable QMutex mutex;
-    QHash<QString, QStringList> db;
+    std::shared_ptr<const BtIndex> db;
+    // the mapped file does not need to be written back
+    bool modified = false;
 };
 
 #endif // BTDATABASE_H
@@ -6,9 +6,224 @@
 
 #include "btfileindexer.h"
 #include "btdatabase.h"
+#include "btindex.h"
 
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
+
+namespace
+{
+QString joinPath(const QString &parent, const QString &name)
+{
+    if (parent.endsWith(QLatin1Char('/'))) {
+        return parent + name;
+    }
+    return parent + QLatin1Char('/') + name;
+}
+
+/**
+ * The file filter, "*.ext" patterns are checked as plain suffixes.
+ * Each scan task has its own copy.
+ */
+class FileMatcher
+{
+public:
+    explicit FileMatcher(const QStringList &filter)
+    {
+        for (const QString &pattern : filter) {
+            const QString suffix = pattern.mid(1);
+            if (pattern.startsWith(QLatin1Char('*')) && !suffix.contains(QLatin1Char('*')) && !suffix.contains(QLatin1Char('?')) && !suffix.contains(QLatin1Char('['))) {
+                suffixes.append(suffix);
+            } else {
+                wildcards.append(QRegularExpression(wildcardPattern(pattern)));
+            }
+        }
+    }
+
+    bool matches(const QString &fileName)
+    {
+        for (const QString &suffix : qAsConst(suffixes)) {
+            if (fileName.endsWith(suffix)) {
+                return true;
+            }
+        }
+        for (const QRegularExpression &wildcard : qAsConst(wildcards)) {
+            if (wildcard.match(fileName).hasMatch()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    /**
+     * A regular expression matching whole file names like the wildcard
+     * @p pattern, with "*", "?" and "[...]".
+     */
+    static QString wildcardPattern(const QString &pattern)
+    {
+        QString rx = QStringLiteral("\\A(?:");
+        for (int i = 0; i < pattern.size(); ++i) {
+            const QChar c = pattern.at(i);
+            if (c == QLatin1Char('*')) {
+                rx += QLatin1String(".*");
+            } else if (c == QLatin1Char('?')) {
+                rx += QLatin1Char('.');
+            } else if (c == QLatin1Char('[') && pattern.indexOf(QLatin1Char(']'), i + 2) > i) {
+                // a set of characters, taken over as it is
+                const int end = pattern.indexOf(QLatin1Char(']'), i + 2);
+                rx += pattern.midRef(i, end - i + 1);
+                i = end;
+            } else {
+                rx += QRegularExpression::escape(QString(c));
+            }
+        }
+        rx += QLatin1String(")\\z");
+        return rx;
+    }
+
+private:
+    QStringList suffixes;
+    QVector<QRegularExpression> wildcards;
+};
+
+/**
+ * State shared by all tasks of one indexer run.
+ * Directories are appended to the list before their children, so it can
+ * be fed to BtIndexBuilder in order.
+ */
+struct Scan {
+    struct Directory {
+        int parent = -1;
+        QString name;
+        QString path;
+        qint64 mtime = 0;
+        QStringList files;
+        bool valid = false;
+    };
+
+    Scan(const std::atomic<bool> &cancelled, const QStringList &filter)
+        : cancelled(cancelled)
+        , filter(filter)
+    {
+    }
+
+    const std::atomic<bool> &cancelled;
+    const QStringList filter;
+    QThreadPool pool;
+
+    // the previous index, indexed by its directory ids
+    QHash<QString, int> oldDirectories;
+    QVector<qint64> oldMTimes;
+    QVector<QStringList> oldFiles;
+    QVector<QStringList> oldSubdirs;
+
+    QMutex mutex;
+    QVector<Directory> directories;
+    QSet<QString> visited;
+    int reused = 0;
+
+    void schedule(int parent, const QString &name, const QString &path);
+};
+
+class ScanTask : public QRunnable
+{
+public:
+    ScanTask(Scan &scan, int directory)
+        : scan(scan)
+        , directory(directory)
+        , matcher(scan.filter)
+    {
+    }
+
+    void run() override
+    {
+        if (scan.cancelled) {
+            return;
+        }
+
+        QString path;
+        {
+            QMutexLocker locker(&scan.mutex);
+            path = scan.directories[directory].path;
+        }
+
+        const QFileInfo info(path);
+        if (!info.isDir()) {
+            return;
+        }
+        const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+
+        // nothing was added, removed or renamed in an unchanged folder
+        QStringList files;
+        QStringList subdirs;
+        const int old = scan.oldDirectories.value(path, -1);
+        const bool unchanged = old >= 0 && scan.oldMTimes[old] == mtime;
+        if (unchanged) {
+            files = scan.oldFiles[old];
+            subdirs = scan.oldSubdirs[old];
+        } else {
+            QDirIterator it(path, QDir::Files | QDir::Dirs | QDir::NoSymLinks | QDir::Readable | QDir::NoDotAndDotDot);
+            while (it.hasNext() && !scan.cancelled) {
+                it.next();
+                const QFileInfo entry = it.fileInfo();
+                const QString name = entry.fileName();
+                if (entry.isDir()) {
+                    subdirs.append(name);
+                } else if (matcher.matches(name)) {
+                    files.append(name);
+                }
+            }
+        }
+
+        QMutexLocker locker(&scan.mutex);
+        Scan::Directory &d = scan.directories[directory];
+        d.mtime = mtime;
+        d.files = files;
+        d.valid = true;
+        if (unchanged) {
+            ++scan.reused;
+        }
+        for (const QString &subdir : qAsConst(subdirs)) {
+            scan.schedule(directory, subdir, joinPath(path, subdir));
+        }
+    }
+
+private:
+    Scan &scan;
+    const int directory;
+    FileMatcher matcher;
+};
+
+// called with the mutex locked
+void Scan::schedule(int parent, const QString &name, const QString &path)
+{
+    // search folders may overlap
+    if (visited.contains(path)) {
+        return;
+    }
+    visited.insert(path);
+
+    Directory directory;
+    directory.parent = parent;
+    directory.name = name;
+    directory.path = path;
+    directories.append(directory);
+
+    pool.start(new ScanTask(*this, directories.size() - 1));
+}
+}
 
 BtFileIndexer::BtFileIndexer(KateBtDatabase *database)
     : cancelAsap(false)
@@ -44,37 +259,80 @@ void BtFileIndexer::run()
     }
 
     cancelAsap = false;
-    for (int i = 0; i < searchPaths.size(); ++i) {
-        if (cancelAsap) {
-            break;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Scan scan(cancelAsap, filter);
+    scan.pool.setMaxThreadCount(QThread::idealThreadCount());
+
+    // the previous index can only be reused if it holds the same kind of files
+    const std::shared_ptr<const BtIndex> old = db->index();
+    if (old && old->filter() == filter) {
+        const int count = old->directoryCount();
+        QVector<QString> paths(count);
+        scan.oldMTimes.resize(count);
+        scan.oldFiles.resize(count);
+        scan.oldSubdirs.resize(count);
+        for (int i = 0; i < count; ++i) {
+            const quint32 parent = old->directoryParent(i);
+            if (parent == BtIndex::NoParent) {
+                paths[i] = old->directoryName(i);
+            } else if (parent < quint32(i) && !paths[parent].isEmpty()) {
+                paths[i] = joinPath(paths[parent], old->directoryName(i));
+                scan.oldSubdirs[parent].append(old->directoryName(i));
+            } else {
+                continue;
+            }
+            scan.oldDirectories.insert(paths[i], i);
+            scan.oldMTimes[i] = old->directoryMTime(i);
+        }
+        for (int i = 0; i < old->fileCount(); ++i) {
+            scan.oldFiles[old->fileDirectory(i)].append(old->fileName(i));
         }
-        indexFiles(searchPaths[i]);
     }
-    qDebug() << QStringLiteral("Backtrace file database contains %1 files").arg(db->size());
-}
 
-void BtFileIndexer::cancel()
-{
-    cancelAsap = true;
-}
+    {
+        QMutexLocker locker(&scan.mutex);
+        for (const QString &searchPath : qAsConst(searchPaths)) {
+            const QString path = QDir::cleanPath(QDir::fromNativeSeparators(searchPath));
+            if (!path.isEmpty()) {
+                scan.schedule(-1, path, path);
+            }
+        }
+    }
 
-void BtFileIndexer::indexFiles(const QString &url)
-{
-    QDir dir(url);
-    if (!dir.exists()) {
+    scan.pool.waitForDone();
+
+    if (cancelAsap) {
         return;
     }
 
-    QStringList files = dir.entryList(filter, QDir::Files | QDir::NoSymLinks | QDir::Readable | QDir::NoDotAndDotDot | QDir::CaseSensitive);
-    db->add(url, files);
-
-    QStringList subdirs = dir.entryList(QDir::Dirs | QDir::NoSymLinks | QDir::Readable | QDir::NoDotAndDotDot | QDir::CaseSensitive);
-    for (int i = 0; i < subdirs.size(); ++i) {
-        if (cancelAsap) {
-            break;
+    BtIndexBuilder builder;
+    QVector<quint32> ids(scan.directories.size(), BtIndex::NoParent);
+    for (int i = 0; i < scan.directories.size(); ++i) {
+        const Scan::Directory &d = scan.directories[i];
+        if (!d.valid || (d.parent >= 0 && ids[d.parent] == BtIndex::NoParent)) {
+            continue;
+        }
+        ids[i] = builder.addDirectory(d.parent >= 0 ? ids[d.parent] : BtIndex::NoParent, d.name, d.mtime);
+        for (const QString &file : d.files) {
+            builder.addFile(ids[i], file);
         }
-        indexFiles(url + QLatin1Char('/') + subdirs[i]);
     }
+
+    db->setIndex(BtIndex::fromData(builder.build(filter)));
+
+    qDebug() << QStringLiteral("Backtrace file database contains %1 files, %2 of %3 folders unchanged, indexed in %4 ms")
+                    .arg(db->size())
+                    .arg(scan.reused)
+                    .arg(scan.directories.size())
+                    .arg(timer.elapsed());
+}
+
+void BtFileIndexer::cancel()
+{
+    cancelAsap = true;
 }
 
 // kate: space-indent on; indent-width 4; replace-tabs on;
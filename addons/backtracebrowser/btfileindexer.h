@@ -11,8 +11,17 @@
 #include <QStringList>
 #include <QThread>
 
+#include <atomic>
+
 class KateBtDatabase;
 
+/**
+ * Builds a new BtIndex of the search folders and hands it to the database.
+ *
+ * Folders are scanned in parallel on a thread pool. A folder whose
+ * modification time did not change since the last run is not listed again,
+ * its entries are taken over from the previous index.
+ */
 class BtFileIndexer : public QThread
 {
     Q_OBJECT
@@ -27,10 +36,9 @@ public:
 
 protected:
     void run() override;
-    void indexFiles(const QString &url);
 
 private:
-    bool cancelAsap;
+    std::atomic<bool> cancelAsap;
     QStringList searchPaths;
     QStringList filter;
 
@@ -0,0 +1,453 @@
+/* This file is part of the KDE project
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#include "btindex.h"
+
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+const quint32 Magic = 0x4954424b; // "KBTI"
+const quint32 Version = 1;
+
+// magic, version, filter size, string count, strings size, directory count, file count, reserved
+const int HeaderSize = 8 * 4;
+const int DirectorySize = 16;
+const int FileSize = 8;
+
+quint32 readU32(const uchar *p)
+{
+    return qFromLittleEndian<quint32>(p);
+}
+
+qint64 padded(qint64 size, int alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+int compareBytes(const char *a, int aSize, const char *b, int bSize)
+{
+    const int result = std::memcmp(a, b, std::min(aSize, bSize));
+    if (result != 0) {
+        return result;
+    }
+    return aSize - bSize;
+}
+
+void appendU32(QByteArray &data, quint32 value)
+{
+    uchar buffer[4];
+    qToLittleEndian(value, buffer);
+    data.append(reinterpret_cast<const char *>(buffer), 4);
+}
+
+void appendI64(QByteArray &data, qint64 value)
+{
+    uchar buffer[8];
+    qToLittleEndian(value, buffer);
+    data.append(reinterpret_cast<const char *>(buffer), 8);
+}
+
+void pad(QByteArray &data, int alignment)
+{
+    data.append(int(padded(data.size(), alignment) - data.size()), '\0');
+}
+
+QString joinPath(const QString &parent, const QString &name)
+{
+    if (parent.endsWith(QLatin1Char('/'))) {
+        return parent + name;
+    }
+    return parent + QLatin1Char('/') + name;
+}
+}
+
+std::shared_ptr<const BtIndex> BtIndex::fromData(const QByteArray &data)
+{
+    std::shared_ptr<BtIndex> index(new BtIndex);
+    index->m_data = data;
+    index->m_base = reinterpret_cast<const uchar *>(index->m_data.constData());
+    index->m_size = index->m_data.size();
+    if (!index->init()) {
+        return nullptr;
+    }
+    return index;
+}
+
+std::shared_ptr<const BtIndex> BtIndex::fromFile(const QString &fileName)
+{
+    std::shared_ptr<BtIndex> index(new BtIndex);
+    index->m_file.reset(new QFile(fileName));
+    if (!index->m_file->open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+
+    index->m_size = index->m_file->size();
+    index->m_base = index->m_file->map(0, index->m_size);
+    if (!index->m_base) {
+        // no mapping possible, e.g. on some network file systems
+        index->m_data = index->m_file->readAll();
+        index->m_file.reset();
+        index->m_base = reinterpret_cast<const uchar *>(index->m_data.constData());
+        index->m_size = index->m_data.size();
+    }
+
+    if (!index->init()) {
+        return nullptr;
+    }
+    return index;
+}
+
+BtIndex::~BtIndex()
+{
+    if (m_file && m_base) {
+        m_file->unmap(const_cast<uchar *>(m_base));
+    }
+}
+
+bool BtIndex::init()
+{
+    if (m_size < HeaderSize || readU32(m_base) != Magic || readU32(m_base + 4) != Version) {
+        return false;
+    }
+
+    m_filterSize = readU32(m_base + 8);
+    m_stringCount = readU32(m_base + 12);
+    m_stringsSize = readU32(m_base + 16);
+    m_directoryCount = readU32(m_base + 20);
+    m_fileCount = readU32(m_base + 24);
+
+    qint64 offset = HeaderSize;
+    m_filter = m_base + offset;
+    offset = padded(offset + m_filterSize, 4);
+    m_stringOffsets = m_base + offset;
+    offset += (qint64(m_stringCount) + 1) * 4;
+    m_strings = m_base + offset;
+    offset = padded(offset + m_stringsSize, 8);
+    m_directories = m_base + offset;
+    offset += qint64(m_directoryCount) * DirectorySize;
+    m_files = m_base + offset;
+    offset += qint64(m_fileCount) * FileSize;
+
+    if (offset > m_size) {
+        return false;
+    }
+
+    // check everything that is used without bounds checks later on
+    quint32 previous = 0;
+    for (quint32 i = 0; i <= m_stringCount; ++i) {
+        const quint32 stringOffset = readU32(m_stringOffsets + 4 * i);
+        if (stringOffset < previous || stringOffset > m_stringsSize) {
+            return false;
+        }
+        previous = stringOffset;
+    }
+    for (quint32 i = 0; i < m_directoryCount; ++i) {
+        const uchar *directory = m_directories + DirectorySize * i;
+        const quint32 parent = readU32(directory);
+        if ((parent != NoParent && parent >= m_directoryCount) || readU32(directory + 4) >= m_stringCount) {
+            return false;
+        }
+    }
+    for (quint32 i = 0; i < m_fileCount; ++i) {
+        const uchar *file = m_files + FileSize * i;
+        if (readU32(file) >= m_stringCount || readU32(file + 4) >= m_directoryCount) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool BtIndex::saveToFile(const QString &fileName) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(m_base), m_size);
+    return file.commit();
+}
+
+QStringList BtIndex::filter() const
+{
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+    return QString::fromUtf8(reinterpret_cast<const char *>(m_filter), m_filterSize).split(QLatin1Char('\n'), QString::SkipEmptyParts);
+#else
+    return QString::fromUtf8(reinterpret_cast<const char *>(m_filter), m_filterSize).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+#endif
+}
+
+int BtIndex::directoryCount() const
+{
+    return m_directoryCount;
+}
+
+quint32 BtIndex::directoryParent(int directory) const
+{
+    return readU32(m_directories + DirectorySize * directory);
+}
+
+QString BtIndex::directoryName(int directory) const
+{
+    return QString::fromUtf8(stringUtf8(readU32(m_directories + DirectorySize * directory + 4)));
+}
+
+qint64 BtIndex::directoryMTime(int directory) const
+{
+    return qFromLittleEndian<qint64>(m_directories + DirectorySize * directory + 8);
+}
+
+QString BtIndex::directoryPath(int directory) const
+{
+    QStringList names;
+    // the chain is bounded, a damaged file must not make us loop forever
+    for (quint32 i = 0; i < m_directoryCount && quint32(directory) != NoParent; ++i) {
+        names.prepend(directoryName(directory));
+        directory = directoryParent(directory);
+    }
+
+    QString path;
+    for (const QString &name : qAsConst(names)) {
+        path = path.isEmpty() ? name : joinPath(path, name);
+    }
+    return path;
+}
+
+int BtIndex::fileCount() const
+{
+    return m_fileCount;
+}
+
+QString BtIndex::fileName(int file) const
+{
+    return QString::fromUtf8(stringUtf8(fileNameId(file)));
+}
+
+int BtIndex::fileDirectory(int file) const
+{
+    return readU32(m_files + FileSize * file + 4);
+}
+
+quint32 BtIndex::fileNameId(int file) const
+{
+    return readU32(m_files + FileSize * file);
+}
+
+quint32 BtIndex::stringCount() const
+{
+    return m_stringCount;
+}
+
+QByteArray BtIndex::stringUtf8(quint32 id) const
+{
+    const quint32 begin = readU32(m_stringOffsets + 4 * id);
+    const quint32 end = readU32(m_stringOffsets + 4 * (id + 1));
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(m_strings + begin), end - begin);
+}
+
+quint32 BtIndex::findString(const QByteArray &utf8) const
+{
+    quint32 lo = 0;
+    quint32 hi = m_stringCount;
+    while (lo < hi) {
+        const quint32 mid = lo + (hi - lo) / 2;
+        const QByteArray candidate = stringUtf8(mid);
+        const int result = compareBytes(candidate.constData(), candidate.size(), utf8.constData(), utf8.size());
+        if (result == 0) {
+            return mid;
+        }
+        if (result < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NoParent;
+}
+
+QString BtIndex::lookup(const QString &key) const
+{
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+    const QStringList parts = key.split(QLatin1Char('/'), QString::SkipEmptyParts);
+#else
+    const QStringList parts = key.split(QLatin1Char('/'), Qt::SkipEmptyParts);
+#endif
+    if (parts.isEmpty()) {
+        return QString();
+    }
+
+    const quint32 name = findString(parts.last().toUtf8());
+    if (name == NoParent) {
+        return QString();
+    }
+
+    // the ids of the folders in the key, NoParent for names no folder has
+    QVector<quint32> parentIds;
+    parentIds.reserve(parts.size() - 1);
+    for (int i = 0; i < parts.size() - 1; ++i) {
+        parentIds.append(findString(parts[i].toUtf8()));
+    }
+
+    // first file with that name
+    quint32 lo = 0;
+    quint32 hi = m_fileCount;
+    while (lo < hi) {
+        const quint32 mid = lo + (hi - lo) / 2;
+        if (fileNameId(mid) < name) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    int best = -1;
+    int bestScore = -1;
+    for (quint32 file = lo; file < m_fileCount && fileNameId(file) == name; ++file) {
+        // count the trailing folders of the key found in the path of the candidate
+        int score = 0;
+        int part = parentIds.size() - 1;
+        quint32 directory = fileDirectory(file);
+        for (quint32 steps = 0; part >= 0 && directory != NoParent && steps < m_directoryCount; ++steps) {
+            const uchar *entry = m_directories + DirectorySize * directory;
+            if (readU32(entry) == NoParent) {
+                // a search folder, its name is a whole path
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+                const QStringList rootParts = directoryName(directory).split(QLatin1Char('/'), QString::SkipEmptyParts);
+#else
+                const QStringList rootParts = directoryName(directory).split(QLatin1Char('/'), Qt::SkipEmptyParts);
+#endif
+                for (int i = rootParts.size() - 1; i >= 0 && part >= 0 && rootParts[i] == parts[part]; --i, --part) {
+                    ++score;
+                }
+                break;
+            }
+            if (readU32(entry + 4) != parentIds[part]) {
+                break;
+            }
+            ++score;
+            --part;
+            directory = readU32(entry);
+        }
+
+        if (score > bestScore) {
+            best = file;
+            bestScore = score;
+            if (score == parentIds.size()) {
+                break;
+            }
+        }
+    }
+
+    if (best < 0) {
+        return QString();
+    }
+    return joinPath(directoryPath(fileDirectory(best)), fileName(best));
+}
+
+quint32 BtIndexBuilder::intern(const QString &string)
+{
+    auto it = m_stringIds.constFind(string);
+    if (it != m_stringIds.constEnd()) {
+        return it.value();
+    }
+    const quint32 id = m_strings.size();
+    m_strings.append(string);
+    m_stringIds.insert(string, id);
+    return id;
+}
+
+quint32 BtIndexBuilder::addDirectory(quint32 parent, const QString &name, qint64 mtime)
+{
+    m_directories.append({parent, intern(name), mtime});
+    return m_directories.size() - 1;
+}
+
+void BtIndexBuilder::addFile(quint32 directory, const QString &name)
+{
+    m_files.append({intern(name), directory});
+}
+
+QByteArray BtIndexBuilder::build(const QStringList &filter) const
+{
+    // sort the strings, so they can be found by binary search
+    QVector<QByteArray> utf8;
+    utf8.reserve(m_strings.size());
+    for (const QString &string : m_strings) {
+        utf8.append(string.toUtf8());
+    }
+
+    QVector<quint32> order(m_strings.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&utf8](quint32 a, quint32 b) {
+        return compareBytes(utf8[a].constData(), utf8[a].size(), utf8[b].constData(), utf8[b].size()) < 0;
+    });
+
+    QVector<quint32> newId(m_strings.size());
+    for (int i = 0; i < order.size(); ++i) {
+        newId[order[i]] = i;
+    }
+
+    QVector<File> files = m_files;
+    for (File &file : files) {
+        file.name = newId[file.name];
+    }
+    std::sort(files.begin(), files.end(), [](const File &a, const File &b) {
+        return a.name < b.name || (a.name == b.name && a.directory < b.directory);
+    });
+
+    const QByteArray filterData = filter.join(QLatin1Char('\n')).toUtf8();
+    quint32 stringsSize = 0;
+    for (const QByteArray &string : qAsConst(utf8)) {
+        stringsSize += string.size();
+    }
+
+    QByteArray data;
+    data.reserve(int(HeaderSize + filterData.size() + 4 * (order.size() + 1) + stringsSize + DirectorySize * m_directories.size() + FileSize * files.size() + 16));
+
+    appendU32(data, Magic);
+    appendU32(data, Version);
+    appendU32(data, filterData.size());
+    appendU32(data, order.size());
+    appendU32(data, stringsSize);
+    appendU32(data, m_directories.size());
+    appendU32(data, files.size());
+    appendU32(data, 0);
+
+    data.append(filterData);
+    pad(data, 4);
+
+    quint32 offset = 0;
+    appendU32(data, offset);
+    for (quint32 id : qAsConst(order)) {
+        offset += utf8[id].size();
+        appendU32(data, offset);
+    }
+    for (quint32 id : qAsConst(order)) {
+        data.append(utf8[id]);
+    }
+    pad(data, 8);
+
+    for (const Directory &directory : m_directories) {
+        appendU32(data, directory.parent);
+        appendU32(data, newId[directory.name]);
+        appendI64(data, directory.mtime);
+    }
+
+    for (const File &file : qAsConst(files)) {
+        appendU32(data, file.name);
+        appendU32(data, file.directory);
+    }
+
+    return data;
+}
+
+// kate: space-indent on; indent-width 4; replace-tabs on;
@@ -0,0 +1,132 @@
+/* This file is part of the KDE project
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#ifndef BTINDEX_H
+#define BTINDEX_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <memory>
+
+/**
+ * Read only index of the source files found in the search folders.
+ *
+ * The index is one flat buffer that is used in place, either read from
+ * disk through a memory mapping or fresh from BtIndexBuilder:
+ *  - a header with magic, version and section sizes
+ *  - the file filter the index was built with
+ *  - all path components, interned, sorted and stored as UTF-8
+ *  - the directories as (parent, name, mtime), search folders have no
+ *    parent and their whole path as name
+ *  - the files as (name, directory), sorted by name
+ *
+ * Looking up a file name is a binary search in the string table and
+ * another one in the files; candidates are then ranked by the number of
+ * trailing path components they share with the key.
+ */
+class BtIndex
+{
+public:
+    static constexpr quint32 NoParent = 0xffffffff;
+
+    /// @return nullptr if @p data is not a valid index
+    static std::shared_ptr<const BtIndex> fromData(const QByteArray &data);
+    /// map the index stored in @p fileName
+    static std::shared_ptr<const BtIndex> fromFile(const QString &fileName);
+
+    ~BtIndex();
+
+    bool saveToFile(const QString &fileName) const;
+
+    QStringList filter() const;
+
+    int directoryCount() const;
+    quint32 directoryParent(int directory) const;
+    QString directoryName(int directory) const;
+    qint64 directoryMTime(int directory) const;
+    QString directoryPath(int directory) const;
+
+    int fileCount() const;
+    QString fileName(int file) const;
+    int fileDirectory(int file) const;
+
+    /**
+     * Find the file best matching @p key, which is a file name optionally
+     * preceded by some of its parent folders, e.g. "kernel/qobject.cpp".
+     * @return the absolute path, or an empty string if no file has that name
+     */
+    QString lookup(const QString &key) const;
+
+private:
+    BtIndex() = default;
+    bool init();
+
+    quint32 stringCount() const;
+    QByteArray stringUtf8(quint32 id) const;
+    /// @return the id of @p utf8, or NoParent if it is not in the index
+    quint32 findString(const QByteArray &utf8) const;
+    quint32 fileNameId(int file) const;
+
+private:
+    // keeps the mapped memory alive, unless the index came from a buffer
+    std::unique_ptr<QFile> m_file;
+    QByteArray m_data;
+
+    const uchar *m_base = nullptr;
+    qint64 m_size = 0;
+
+    // section pointers into m_base
+    const uchar *m_filter = nullptr;
+    quint32 m_filterSize = 0;
+    const uchar *m_stringOffsets = nullptr;
+    const uchar *m_strings = nullptr;
+    quint32 m_stringCount = 0;
+    quint32 m_stringsSize = 0;
+    const uchar *m_directories = nullptr;
+    quint32 m_directoryCount = 0;
+    const uchar *m_files = nullptr;
+    quint32 m_fileCount = 0;
+};
+
+/**
+ * Collects directories and files and serializes them into a BtIndex.
+ */
+class BtIndexBuilder
+{
+public:
+    /// @p parent is NoParent for a search folder, @p name then holds its whole path
+    quint32 addDirectory(quint32 parent, const QString &name, qint64 mtime);
+    void addFile(quint32 directory, const QString &name);
+
+    QByteArray build(const QStringList &filter) const;
+
+private:
+    quint32 intern(const QString &string);
+
+    struct Directory {
+        quint32 parent;
+        quint32 name;
+        qint64 mtime;
+    };
+    struct File {
+        quint32 name;
+        quint32 directory;
+    };
+
+    QHash<QString, quint32> m_stringIds;
+    QVector<QString> m_strings;
+    QVector<Directory> m_directories;
+    QVector<File> m_files;
+};
+
+#endif // BTINDEX_H
+
+// kate: space-indent on; indent-width 4; replace-tabs on;
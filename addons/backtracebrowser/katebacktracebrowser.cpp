@@ -40,6 +40,9 @@ KateBtBrowserPlugin::KateBtBrowserPlugin(QObject *parent, const QList<QVariant>
     , indexer(&db)
 {
     s_self = this;
+    connect(&indexer, &QThread::finished, this, [this]() {
+        emit newStatus(i18np("Indexed one file", "Indexed %1 files", db.size()));
+    });
     db.loadFromFile(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/katebtbrowser/backtracedatabase.db"));
 }
 
@@ -110,4 +110,57 @@ void ExternalToolTest::testRunTac()
     QCOMPARE(runner.outputData(), QStringLiteral("c\nb\na\n"));
 }
 
+void ExternalToolTest::testStreamedOutput()
+{
+    // Skip, if 'tac' is not installed
+    if (QStandardPaths::findExecutable(QStringLiteral("tac")).isEmpty()) {
+        QSKIP("'tac' not found - skipping test");
+    }
+
+    std::unique_ptr<KateExternalTool> tool(new KateExternalTool());
+    tool->name = QStringLiteral("tac");
+    tool->executable = QStringLiteral("tac");
+    tool->input = QStringLiteral("a\nb\nc\n");
+    tool->saveMode = KateExternalTool::SaveMode::None;
+
+    KateToolRunner runner(std::move(tool), nullptr);
+    QString streamed;
+    connect(&runner, &KateToolRunner::outputReceived, this, [&streamed](KateToolRunner *, const QString &data) {
+        streamed += data;
+    });
+    runner.run();
+    runner.waitForFinished();
+
+    // the pieces add up to the whole output
+    QCOMPARE(streamed, runner.outputData());
+    QCOMPARE(runner.metrics().outputSize, qint64(6));
+    QVERIFY(runner.metrics().wallTime >= 0);
+}
+
+void ExternalToolTest::testStreamedError()
+{
+    // Skip, if 'sh' is not installed
+    if (QStandardPaths::findExecutable(QStringLiteral("sh")).isEmpty()) {
+        QSKIP("'sh' not found - skipping test");
+    }
+
+    std::unique_ptr<KateExternalTool> tool(new KateExternalTool());
+    tool->name = QStringLiteral("sh");
+    tool->executable = QStringLiteral("sh");
+    tool->arguments = QStringLiteral("-c 'echo error >&2'");
+    tool->saveMode = KateExternalTool::SaveMode::None;
+
+    KateToolRunner runner(std::move(tool), nullptr);
+    QString streamed;
+    connect(&runner, &KateToolRunner::errorReceived, this, [&streamed](KateToolRunner *, const QString &data) {
+        streamed += data;
+    });
+    runner.run();
+    runner.waitForFinished();
+
+    QCOMPARE(streamed, QStringLiteral("error\n"));
+    QCOMPARE(runner.errorData(), streamed);
+    QVERIFY(runner.outputData().isEmpty());
+}
+
 // kate: space-indent on; indent-width 4; replace-tabs on;
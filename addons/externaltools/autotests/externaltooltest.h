@@ -22,6 +22,8 @@ private Q_SLOTS:
     void testLoadSave();
     void testRunListDirectory();
     void testRunTac();
+    void testStreamedOutput();
+    void testStreamedError();
 };
 
 #endif
@@ -24,6 +24,7 @@
 #include <KAuthorized>
 #include <KConfig>
 #include <KConfigGroup>
+#include <KFormat>
 #include <KPluginFactory>
 #include <KXMLGUIFactory>
 
@@ -60,6 +61,8 @@ KateExternalToolsPlugin::KateExternalToolsPlugin(QObject *parent, const QList<QV
 
 KateExternalToolsPlugin::~KateExternalToolsPlugin()
 {
+    qDeleteAll(m_queuedRunners);
+    qDeleteAll(m_runningRunners);
     clearTools();
 }
 
@@ -87,6 +90,7 @@ void KateExternalToolsPlugin::reload()
     KConfigGroup config(&_config, "Global");
     const int toolCount = config.readEntry("tools", 0);
     const bool firstStart = config.readEntry("firststart", true);
+    m_concurrentRuns = qMax(1, config.readEntry("concurrent runs", 1));
 
     if (!firstStart || toolCount > 0) {
         // read user config
@@ -168,10 +172,17 @@ void KateExternalToolsPlugin::runTool(const KateExternalTool &tool, KTextEditor:
     // copy tool
     std::unique_ptr<KateExternalTool> copy(new KateExternalTool(tool));
 
-    // clear previous toolview data
+    // clear previous toolview data, unless other tools still use it
     auto pluginView = viewForMainWindow(mw);
-    pluginView->clearToolView();
-    pluginView->addToolStatus(i18n("Running external tool: %1", copy->name));
+    if (!hasToolsInMainWindow(mw)) {
+        pluginView->clearToolView();
+    }
+    const bool runNow = m_runningRunners.size() < m_concurrentRuns;
+    if (runNow) {
+        pluginView->addToolStatus(i18n("Running external tool: %1", copy->name));
+    } else {
+        pluginView->addToolStatus(i18n("Queued external tool: %1", copy->name));
+    }
     pluginView->addToolStatus(i18n("- Executable: %1", copy->executable));
     pluginView->addToolStatus(i18n("- Arguments : %1", copy->arguments));
     pluginView->addToolStatus(i18n("- Input     : %1", copy->input));
@@ -190,7 +201,75 @@ void KateExternalToolsPlugin::runTool(const KateExternalTool &tool, KTextEditor:
 
     // use QueuedConnection, since handleToolFinished deletes the runner
     connect(runner, &KateToolRunner::toolFinished, this, &KateExternalToolsPlugin::handleToolFinished, Qt::QueuedConnection);
-    runner->run();
+    connect(runner, &KateToolRunner::outputReceived, this, &KateExternalToolsPlugin::handleToolOutput);
+    connect(runner, &KateToolRunner::errorReceived, this, &KateExternalToolsPlugin::handleToolError);
+    if (runNow) {
+        m_runningRunners.push_back(runner);
+        runner->run();
+    } else {
+        m_queuedRunners.push_back(runner);
+    }
+}
+
+int KateExternalToolsPlugin::concurrentRuns() const
+{
+    return m_concurrentRuns;
+}
+
+void KateExternalToolsPlugin::startQueuedTools()
+{
+    while (!m_queuedRunners.isEmpty() && m_runningRunners.size() < m_concurrentRuns) {
+        auto runner = m_queuedRunners.takeFirst();
+        m_runningRunners.push_back(runner);
+
+        if (auto view = runner->view()) {
+            if (KateExternalToolsPluginView *pluginView = viewForMainWindow(view->mainWindow())) {
+                pluginView->addToolStatus(i18n("Running external tool: %1", runner->tool()->name));
+            }
+        }
+        runner->run();
+    }
+}
+
+bool KateExternalToolsPlugin::hasToolsInMainWindow(KTextEditor::MainWindow *mainWindow) const
+{
+    for (const auto &runners : {m_queuedRunners, m_runningRunners}) {
+        for (auto runner : runners) {
+            if (runner->view() && runner->view()->mainWindow() == mainWindow) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void KateExternalToolsPlugin::handleToolOutput(KateToolRunner *runner, const QString &data)
+{
+    // the other output modes need the whole output, see handleToolFinished
+    auto view = runner->view();
+    if (!view || runner->tool()->outputMode != KateExternalTool::OutputMode::DisplayInPane) {
+        return;
+    }
+
+    if (KateExternalToolsPluginView *pluginView = viewForMainWindow(view->mainWindow())) {
+        pluginView->appendOutputData(data);
+    }
+}
+
+void KateExternalToolsPlugin::handleToolError(KateToolRunner *runner, const QString &data)
+{
+    auto view = runner->view();
+    if (!view) {
+        return;
+    }
+
+    if (KateExternalToolsPluginView *pluginView = viewForMainWindow(view->mainWindow())) {
+        // the first piece, the data is collected already
+        if (runner->errorData().size() == data.size()) {
+            pluginView->addToolStatus(i18n("Data written to stderr by %1:", runner->tool()->name));
+        }
+        pluginView->appendToolStatus(data);
+    }
 }
 
 void KateExternalToolsPlugin::handleToolFinished(KateToolRunner *runner, int exitCode, bool crashed)
@@ -246,15 +325,12 @@ void KateExternalToolsPlugin::handleToolFinished(KateToolRunner *runner, int exi
 
     KateExternalToolsPluginView *pluginView = runner->view() ? viewForMainWindow(runner->view()->mainWindow()) : nullptr;
     if (pluginView) {
-        bool hasOutputInPane = false;
-        if (runner->tool()->outputMode == KateExternalTool::OutputMode::DisplayInPane) {
-            pluginView->setOutputData(runner->outputData());
-            hasOutputInPane = !runner->outputData().isEmpty();
-        }
+        // the output was shown while the tool was running
+        const bool hasOutputInPane = runner->tool()->outputMode == KateExternalTool::OutputMode::DisplayInPane && !runner->outputData().isEmpty();
 
-        if (!runner->errorData().isEmpty()) {
-            pluginView->addToolStatus(i18n("Data written to stderr:"));
-            pluginView->addToolStatus(runner->errorData());
+        // the data written to stderr was shown while the tool was running
+        if (!runner->errorData().isEmpty() && !runner->errorData().endsWith(QLatin1Char('\n'))) {
+            pluginView->addToolStatus(QString());
         }
 
         // empty line
@@ -264,7 +340,14 @@ void KateExternalToolsPlugin::handleToolFinished(KateToolRunner *runner, int exi
         if (crashed) {
             pluginView->addToolStatus(i18n("Warning: External tool crashed."));
         }
-        pluginView->addToolStatus(i18n("Finished with exit code: %1", exitCode));
+        pluginView->addToolStatus(i18n("Finished %1 with exit code: %2", runner->tool()->name, exitCode));
+
+        const auto &metrics = runner->metrics();
+        KFormat format;
+        pluginView->addToolStatus(i18n("Wall time: %1, CPU time: %2, output: %3",
+                                       format.formatDuration(metrics.wallTime),
+                                       metrics.cpuTime >= 0 ? format.formatDuration(metrics.cpuTime) : i18nc("CPU time", "unknown"),
+                                       format.formatByteSize(metrics.outputSize)));
 
         if (crashed || exitCode != 0) {
             pluginView->showToolView(ToolViewFocus::StatusTab);
@@ -273,7 +356,10 @@ void KateExternalToolsPlugin::handleToolFinished(KateToolRunner *runner, int exi
         }
     }
 
+    m_runningRunners.removeOne(runner);
     delete runner;
+
+    startQueuedTools();
 }
 
 int KateExternalToolsPlugin::configPages() const
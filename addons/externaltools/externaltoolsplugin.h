@@ -79,9 +79,15 @@ public:
 
     /**
      * Executes the tool based on the view as current document.
+     * If concurrentRuns() tools are running already, it waits for one of them.
      */
     void runTool(const KateExternalTool &tool, KTextEditor::View *view);
 
+    /**
+     * Returns the number of tools that run at once, the others are queued.
+     */
+    int concurrentRuns() const;
+
 Q_SIGNALS:
     /**
      * This signal is emitted whenever the external tools change.
@@ -113,11 +119,36 @@ private:
     QStringList m_commands;
     KateExternalToolsCommand *m_command = nullptr;
 
+    // runners waiting for their turn, and the running ones
+    QVector<KateToolRunner *> m_queuedRunners;
+    QVector<KateToolRunner *> m_runningRunners;
+    int m_concurrentRuns = 1;
+
+    /**
+     * Starts the queued tools, as long as less than concurrentRuns() run.
+     */
+    void startQueuedTools();
+
+    /**
+     * Whether tools run or wait in @p mainWindow, they share its tool view.
+     */
+    bool hasToolsInMainWindow(KTextEditor::MainWindow *mainWindow) const;
+
 private Q_SLOTS:
     /**
      * Called whenever an external tool is done.
      */
     void handleToolFinished(KateToolRunner *runner, int exitCode, bool crashed);
+
+    /**
+     * Called for each piece of output of an external tool.
+     */
+    void handleToolOutput(KateToolRunner *runner, const QString &data);
+
+    /**
+     * Called for each piece an external tool writes to stderr.
+     */
+    void handleToolError(KateToolRunner *runner, const QString &data);
 };
 
 #endif
@@ -263,6 +263,10 @@ KateExternalToolsConfigWidget::KateExternalToolsConfigWidget(QWidget *parent, Ka
         m_changed = true;
         Q_EMIT changed();
     });
+    connect(sbConcurrentRuns, QOverload<int>::of(&QSpinBox::valueChanged), [this]() {
+        m_changed = true;
+        Q_EMIT changed();
+    });
 }
 
 KateExternalToolsConfigWidget::~KateExternalToolsConfigWidget()
@@ -305,6 +309,7 @@ void KateExternalToolsConfigWidget::reset()
         category->appendRow(item);
     }
     lbTools->expandAll();
+    sbConcurrentRuns->setValue(m_plugin->concurrentRuns());
     m_changed = false;
 }
 
@@ -330,6 +335,7 @@ void KateExternalToolsConfigWidget::apply()
     // write tool configuration to disk
     m_config->group("Global").writeEntry("firststart", false);
     m_config->group("Global").writeEntry("tools", static_cast<int>(tools.size()));
+    m_config->group("Global").writeEntry("concurrent runs", sbConcurrentRuns->value());
     for (size_t i = 0; i < tools.size(); i++) {
         const QString section = QStringLiteral("Tool ") + QString::number(i);
         KConfigGroup cg(m_config, section);
@@ -25,6 +25,8 @@
 
 #include <QFontDatabase>
 #include <QKeyEvent>
+#include <QPlainTextDocumentLayout>
+#include <QScrollBar>
 #include <QTextDocument>
 #include <QToolButton>
 
@@ -135,6 +137,13 @@ KateExternalToolsPluginView::KateExternalToolsPluginView(KTextEditor::MainWindow
 {
     m_plugin->registerPluginView(this);
 
+    // shown in a QPlainTextEdit, which only lays out the visible lines
+    m_outputDoc->setDocumentLayout(new QPlainTextDocumentLayout(m_outputDoc));
+
+    m_outputTimer.setSingleShot(true);
+    m_outputTimer.setInterval(100);
+    connect(&m_outputTimer, &QTimer::timeout, this, &KateExternalToolsPluginView::flushOutputData);
+
     KXMLGUIClient::setComponentName(QLatin1String("externaltools"), i18n("External Tools"));
     setXMLFile(QLatin1String("ui.rc"));
 
@@ -219,6 +228,8 @@ void KateExternalToolsPluginView::showToolView(ToolViewFocus tab)
 
 void KateExternalToolsPluginView::clearToolView()
 {
+    m_outputTimer.stop();
+    m_pendingOutput.clear();
     m_outputDoc->clear();
     m_statusDoc->clear();
 }
@@ -231,13 +242,41 @@ void KateExternalToolsPluginView::addToolStatus(const QString &message)
     cursor.insertText(QStringLiteral("\n"));
 }
 
-void KateExternalToolsPluginView::setOutputData(const QString &data)
+void KateExternalToolsPluginView::appendToolStatus(const QString &data)
 {
-    QTextCursor cursor(m_outputDoc);
+    QTextCursor cursor(m_statusDoc);
     cursor.movePosition(QTextCursor::End);
     cursor.insertText(data);
 }
 
+void KateExternalToolsPluginView::appendOutputData(const QString &data)
+{
+    if (m_outputDoc->isEmpty() && m_pendingOutput.isEmpty()) {
+        showToolView(ToolViewFocus::OutputTab);
+    }
+
+    m_pendingOutput += data;
+    if (!m_outputTimer.isActive()) {
+        m_outputTimer.start();
+    }
+}
+
+void KateExternalToolsPluginView::flushOutputData()
+{
+    // keep following the output, unless scrolled up
+    QScrollBar *scrollBar = m_ui ? m_ui->teOutput->verticalScrollBar() : nullptr;
+    const bool atEnd = scrollBar && scrollBar->value() == scrollBar->maximum();
+
+    QTextCursor cursor(m_outputDoc);
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(m_pendingOutput);
+    m_pendingOutput.clear();
+
+    if (atEnd) {
+        scrollBar->setValue(scrollBar->maximum());
+    }
+}
+
 void KateExternalToolsPluginView::deleteToolView()
 {
     if (m_toolView) {
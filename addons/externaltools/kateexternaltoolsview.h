@@ -20,6 +20,8 @@ class View;
 #include <KMacroExpander>
 #include <KXMLGUIClient>
 
+#include <QTimer>
+
 class QTextDocument;
 
 class KActionCollection;
@@ -120,9 +122,15 @@ public Q_SLOTS:
     void addToolStatus(const QString &message);
 
     /**
-     * Sets the output data to data;
+     * Appends @p data to the status as it is, without a line break.
+     */
+    void appendToolStatus(const QString &data);
+
+    /**
+     * Appends @p data to the output. Pieces arriving in quick succession
+     * are added at once, and the output tab is shown.
      */
-    void setOutputData(const QString &data);
+    void appendOutputData(const QString &data);
 
     /**
      * Deletes the tool view, if existing.
@@ -142,6 +150,12 @@ private:
     Ui::ToolView *m_ui = nullptr;
     QTextDocument *m_outputDoc = nullptr;
     QTextDocument *m_statusDoc = nullptr;
+
+    //! Output not yet added to m_outputDoc
+    QString m_pendingOutput;
+    QTimer m_outputTimer;
+
+    void flushOutputData();
 };
 
 #endif // KTEXTEDITOR_EXTERNALTOOLS_H
@@ -13,18 +13,49 @@
 #include <KShell>
 #include <KTextEditor/View>
 #include <QFileInfo>
+#include <QVector>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+/**
+ * CPU time used by all child processes that were waited for, in ms.
+ * Also counts the children of the tool, e.g. of a shell script, but as
+ * well any other tool that finishes meanwhile, see s_activeRunners, and
+ * other child processes of the application.
+ */
+static qint64 childrenCpuTime()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_CHILDREN, &usage) == 0) {
+        return qint64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+    }
+#endif
+    return -1;
+}
+
+/**
+ * The runners with a running process. The difference of childrenCpuTime()
+ * belongs to one run only if no other run overlapped it.
+ */
+static QVector<KateToolRunner *> s_activeRunners;
 
 KateToolRunner::KateToolRunner(std::unique_ptr<KateExternalTool> tool, KTextEditor::View *view, QObject *parent)
     : QObject(parent)
     , m_view(view)
     , m_tool(std::move(tool))
     , m_process(new QProcess())
+    , m_stdoutDecoder(QTextCodec::codecForLocale()->makeDecoder())
+    , m_stderrDecoder(QTextCodec::codecForLocale()->makeDecoder())
 {
     m_process->setProcessChannelMode(QProcess::SeparateChannels);
 }
 
 KateToolRunner::~KateToolRunner()
 {
+    s_activeRunners.removeOne(this);
 }
 
 KTextEditor::View *KateToolRunner::view() const
@@ -50,10 +81,36 @@ void KateToolRunner::run()
         }
     }
 
-    QObject::connect(m_process.get(), &QProcess::readyReadStandardOutput, [this]() { m_stdout += m_process->readAllStandardOutput(); });
-    QObject::connect(m_process.get(), &QProcess::readyReadStandardError, [this]() { m_stderr += m_process->readAllStandardError(); });
-    QObject::connect(
-        m_process.get(), static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), [this](int exitCode, QProcess::ExitStatus exitStatus) { Q_EMIT toolFinished(this, exitCode, exitStatus == QProcess::CrashExit); });
+    // hand out the data as it comes, the decoders keep characters split between reads
+    QObject::connect(m_process.get(), &QProcess::readyReadStandardOutput, [this]() {
+        const QByteArray block = m_process->readAllStandardOutput();
+        m_metrics.outputSize += block.size();
+        const QString data = m_stdoutDecoder->toUnicode(block);
+        m_stdout += data;
+        Q_EMIT outputReceived(this, data);
+    });
+    QObject::connect(m_process.get(), &QProcess::readyReadStandardError, [this]() {
+        const QByteArray block = m_process->readAllStandardError();
+        m_metrics.outputSize += block.size();
+        const QString data = m_stderrDecoder->toUnicode(block);
+        m_stderr += data;
+        Q_EMIT errorReceived(this, data);
+    });
+    QObject::connect(m_process.get(), static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), [this](int exitCode, QProcess::ExitStatus exitStatus) {
+        // the process was waited for already
+        m_metrics.wallTime = m_clock.elapsed();
+        s_activeRunners.removeOne(this);
+        const qint64 cpuTime = childrenCpuTime();
+        m_metrics.cpuTime = (cpuTime >= 0 && m_cpuTimeAtStart >= 0 && !m_overlapped) ? cpuTime - m_cpuTimeAtStart : -1;
+        Q_EMIT toolFinished(this, exitCode, exitStatus == QProcess::CrashExit);
+    });
+
+    // there is no finished() if the tool could not be started
+    QObject::connect(m_process.get(), &QProcess::errorOccurred, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            s_activeRunners.removeOne(this);
+        }
+    });
 
     // Write stdin to process, if applicable, then close write channel
     QObject::connect(m_process.get(), &QProcess::started, [this]() {
@@ -64,6 +121,13 @@ void KateToolRunner::run()
     });
 
     const QStringList args = KShell::splitArgs(m_tool->arguments);
+    m_clock.start();
+    m_cpuTimeAtStart = childrenCpuTime();
+    m_overlapped = !s_activeRunners.isEmpty();
+    for (KateToolRunner *runner : qAsConst(s_activeRunners)) {
+        runner->m_overlapped = true;
+    }
+    s_activeRunners.push_back(this);
     m_process->start(m_tool->executable, args);
 }
 
@@ -74,12 +138,17 @@ void KateToolRunner::waitForFinished()
 
 QString KateToolRunner::outputData() const
 {
-    return QString::fromLocal8Bit(m_stdout);
+    return m_stdout;
 }
 
 QString KateToolRunner::errorData() const
 {
-    return QString::fromLocal8Bit(m_stderr);
+    return m_stderr;
+}
+
+const KateToolRunner::Metrics &KateToolRunner::metrics() const
+{
+    return m_metrics;
 }
 
 // kate: space-indent on; indent-width 4; replace-tabs on;
@@ -8,11 +8,12 @@
 #ifndef KTEXTEDITOR_EXTERNALTOOLRUNNER_H
 #define KTEXTEDITOR_EXTERNALTOOLRUNNER_H
 
-#include <QByteArray>
+#include <QElapsedTimer>
 #include <QObject>
 #include <QPointer>
 #include <QProcess>
 #include <QString>
+#include <QTextCodec>
 
 #include <memory>
 
@@ -31,6 +32,18 @@ class KateToolRunner : public QObject
     Q_OBJECT
 
 public:
+    /**
+     * Resources used by a run, known once the tool is finished.
+     */
+    struct Metrics {
+        //! Milliseconds from start to exit
+        qint64 wallTime = 0;
+        //! Milliseconds of user and system CPU time, -1 if unknown, e.g. when another tool ran at the same time
+        qint64 cpuTime = -1;
+        //! Bytes written to stdout and stderr
+        qint64 outputSize = 0;
+    };
+
     /**
      * Constructor that will run @p tool in the run() method.
      * The @p view can later be retrieved again with view() to process the data when the tool is finished.
@@ -74,7 +87,22 @@ public:
      */
     QString errorData() const;
 
+    /**
+     * Returns the resources used by the tool, valid once it is finished.
+     */
+    const Metrics &metrics() const;
+
 Q_SIGNALS:
+    /**
+     * This signal is emitted for each piece of @p data the tool writes to stdout.
+     */
+    void outputReceived(KateToolRunner *runner, const QString &data);
+
+    /**
+     * This signal is emitted for each piece of @p data the tool writes to stderr.
+     */
+    void errorReceived(KateToolRunner *runner, const QString &data);
+
     /**
      * This signal is emitted when the tool is finished.
      */
@@ -91,10 +119,19 @@ private:
     std::unique_ptr<QProcess> m_process;
 
     //! Collect stdout
-    QByteArray m_stdout;
+    QString m_stdout;
+    std::unique_ptr<QTextDecoder> m_stdoutDecoder;
 
     //! Collect stderr
-    QByteArray m_stderr;
+    QString m_stderr;
+    std::unique_ptr<QTextDecoder> m_stderrDecoder;
+
+    //! Measure the run
+    QElapsedTimer m_clock;
+    qint64 m_cpuTimeAtStart = -1;
+    //! Another run was active meanwhile, so the CPU time is unknown
+    bool m_overlapped = false;
+    Metrics m_metrics;
 };
 
 #endif // KTEXTEDITOR_EXTERNALTOOLRUNNER_H
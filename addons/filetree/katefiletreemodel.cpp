@@ -16,6 +16,7 @@
 
 #include <KColorScheme>
 #include <KColorUtils>
+#include <KFormat>
 #include <KIconUtils>
 #include <KLocalizedString>
 
@@ -543,6 +544,23 @@ QVariant KateFileTreeModel::data(const QModelIndex &index, int role) const
             tooltip = i18nc("%1 is the full path", "<p><b>%1</b></p><p>The document has been modified by another application.</p>", item->path());
         }
 
+        // Kate estimates the memory of its documents, other hosts don't offer it
+        qint64 memory = -1;
+        QObject *app = KTextEditor::Editor::instance()->application()->parent();
+        if (item->doc() && app && app->metaObject()->indexOfMethod("documentMemoryUsage(KTextEditor::Document*)") >= 0) {
+            QMetaObject::invokeMethod(app,
+                                      "documentMemoryUsage",
+                                      Qt::DirectConnection,
+                                      Q_RETURN_ARG(qint64, memory),
+                                      Q_ARG(KTextEditor::Document *, item->doc()));
+        }
+        if (memory >= 0) {
+            if (!tooltip.startsWith(QLatin1String("<p>"))) {
+                tooltip = QStringLiteral("<p>%1</p>").arg(tooltip.toHtmlEscaped());
+            }
+            tooltip += i18nc("%1 is the estimated memory use of the document", "<p>Memory: %1</p>", KFormat().formatByteSize(memory));
+        }
+
         return tooltip;
     }
 
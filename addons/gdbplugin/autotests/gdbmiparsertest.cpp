@@ -0,0 +1,100 @@
+/* This file is part of the KDE project
+ *
+ *  SPDX-FileCopyrightText: 2021 Kate Developers
+ *
+ *  SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "gdbmiparsertest.h"
+#include "gdbmiparser.h"
+
+#include <QJsonArray>
+#include <QtTest>
+
+QTEST_MAIN(GdbMiParserTest)
+
+void GdbMiParserTest::testResultRecord()
+{
+    GdbMi::Record record;
+    QVERIFY(GdbMiParser::parseLine(
+        "12^done,stack=[frame={level=\"0\",addr=\"0x0000555555555131\",func=\"main\",file=\"test.c\",fullname=\"/tmp/test.c\",line=\"5\"},"
+        "frame={level=\"1\",addr=\"0x00007ffff7de70b3\",func=\"__libc_start_main\",from=\"/lib/libc.so.6\"}]",
+        record));
+
+    QCOMPARE(record.category, GdbMi::Record::Result);
+    QCOMPARE(record.token, 12);
+    QCOMPARE(record.resultClass, QStringLiteral("done"));
+
+    const QJsonArray stack = record.results.value(QStringLiteral("stack")).toArray();
+    QCOMPARE(stack.size(), 2);
+    QCOMPARE(stack.at(0).toObject().value(QStringLiteral("fullname")).toString(), QStringLiteral("/tmp/test.c"));
+    QCOMPARE(stack.at(0).toObject().value(QStringLiteral("line")).toString(), QStringLiteral("5"));
+    QCOMPARE(stack.at(1).toObject().value(QStringLiteral("from")).toString(), QStringLiteral("/lib/libc.so.6"));
+
+    QVERIFY(GdbMiParser::parseLine("^error,msg=\"No symbol \\\"foo\\\" in current context.\"", record));
+    QCOMPARE(record.token, -1);
+    QCOMPARE(record.resultClass, QStringLiteral("error"));
+    QCOMPARE(record.results.value(QStringLiteral("msg")).toString(), QStringLiteral("No symbol \"foo\" in current context."));
+
+    QVERIFY(GdbMiParser::parseLine("3^done,variables=[]", record));
+    QVERIFY(record.results.value(QStringLiteral("variables")).toArray().isEmpty());
+}
+
+void GdbMiParserTest::testAsyncRecord()
+{
+    GdbMi::Record record;
+    QVERIFY(GdbMiParser::parseLine("*stopped,reason=\"end-stepping-range\",frame={func=\"main\",args=[],line=\"7\"},thread-id=\"1\"", record));
+    QCOMPARE(record.category, GdbMi::Record::Exec);
+    QCOMPARE(record.resultClass, QStringLiteral("stopped"));
+    QCOMPARE(record.results.value(QStringLiteral("frame")).toObject().value(QStringLiteral("line")).toString(), QStringLiteral("7"));
+    QCOMPARE(record.results.value(QStringLiteral("thread-id")).toString(), QStringLiteral("1"));
+
+    // old GDBs append the locations of multi-location breakpoints as bare tuples
+    QVERIFY(GdbMiParser::parseLine("=breakpoint-created,bkpt={number=\"2\",addr=\"<MULTIPLE>\"},{number=\"2.1\",line=\"3\"}", record));
+    QCOMPARE(record.category, GdbMi::Record::Notify);
+    QCOMPARE(record.results.value(QStringLiteral("bkpt")).toObject().value(QStringLiteral("number")).toString(), QStringLiteral("2"));
+}
+
+void GdbMiParserTest::testStreamRecord()
+{
+    GdbMi::Record record;
+    QVERIFY(GdbMiParser::parseLine("~\"$1 = \\\"\\303\\244\\\"\\n\"", record));
+    QCOMPARE(record.category, GdbMi::Record::Console);
+    QCOMPARE(record.text, QStringLiteral("$1 = \"\u00e4\"\n"));
+
+    QVERIFY(GdbMiParser::parseLine("(gdb) ", record));
+    QCOMPARE(record.category, GdbMi::Record::Prompt);
+}
+
+void GdbMiParserTest::testPartialInput()
+{
+    GdbMiParser parser;
+    QVERIFY(parser.parse("~\"Hello").isEmpty());
+    QVERIFY(parser.parse(" World\\n\"").isEmpty());
+
+    const QVector<GdbMi::Record> records = parser.parse("\r\n(gdb) \n1^done\n2^run");
+    QCOMPARE(records.size(), 3);
+    QCOMPARE(records.at(0).text, QStringLiteral("Hello World\n"));
+    QCOMPARE(records.at(1).category, GdbMi::Record::Prompt);
+    QCOMPARE(records.at(2).token, 1);
+
+    const QVector<GdbMi::Record> rest = parser.parse("ning\n");
+    QCOMPARE(rest.size(), 1);
+    QCOMPARE(rest.at(0).resultClass, QStringLiteral("running"));
+}
+
+void GdbMiParserTest::testInvalidLine()
+{
+    GdbMi::Record record;
+    QVERIFY(!GdbMiParser::parseLine("Hello from the inferior", record));
+    QCOMPARE(record.category, GdbMi::Record::Unknown);
+    QCOMPARE(record.text, QStringLiteral("Hello from the inferior"));
+
+    QVERIFY(!GdbMiParser::parseLine("^done,value={a=\"1\"", record));
+    QCOMPARE(record.category, GdbMi::Record::Unknown);
+}
+
+void GdbMiParserTest::testQuote()
+{
+    QCOMPARE(GdbMi::quote(QStringLiteral("print \"a\\b\"")), QStringLiteral("\"print \\\"a\\\\b\\\"\""));
+}
@@ -0,0 +1,28 @@
+/* This file is part of the KDE project
+ *
+ *  SPDX-FileCopyrightText: 2021 Kate Developers
+ *
+ *  SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef GDBMI_PARSER_TEST_H
+#define GDBMI_PARSER_TEST_H
+
+#include <QObject>
+
+class GdbMiParserTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testResultRecord();
+    void testAsyncRecord();
+    void testStreamRecord();
+    void testPartialInput();
+    void testInvalidLine();
+    void testQuote();
+};
+
+#endif
+
+// kate: space-indent on; indent-width 4; replace-tabs on;
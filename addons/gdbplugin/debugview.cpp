@@ -11,8 +11,10 @@
 
 #include "debugview.h"
 
+#include <QDir>
 #include <QFile>
-#include <QRegularExpression>
+#include <QFileInfo>
+#include <QJsonArray>
 #include <QTimer>
 
 #include <KLocalizedString>
@@ -22,13 +24,22 @@
 #include <signal.h>
 #include <stdlib.h>
 
-static const QString PromptStr = QStringLiteral("(prompt)");
+static QString consoleCommand(const QString &cmd)
+{
+    return QStringLiteral("-interpreter-exec console %1").arg(GdbMi::quote(cmd));
+}
+
+static int intValue(const QJsonObject &tuple, const QString &key, int defaultValue = -1)
+{
+    bool ok = false;
+    const int value = tuple.value(key).toString().toInt(&ok);
+    return ok ? value : defaultValue;
+}
 
 DebugView::DebugView(QObject *parent)
     : QObject(parent)
     , m_debugProcess(nullptr)
     , m_state(none)
-    , m_subState(normal)
     , m_debugLocationChanged(true)
     , m_queryLocals(false)
 {
@@ -54,9 +65,11 @@ void DebugView::runDebugger(const GDBTargetConf &conf, const QStringList &ioFifo
     }
 
     if (m_state == none) {
-        m_outBuffer.clear();
+        m_parser.reset();
         m_errBuffer.clear();
-        m_errorList.clear();
+        m_pendingCommands.clear();
+        m_queuedChildren.clear();
+        m_sequentialToken = -1;
 
         // create a process to control GDB
         m_debugProcess.setWorkingDirectory(m_targetConf.workDir);
@@ -69,11 +82,16 @@ void DebugView::runDebugger(const GDBTargetConf &conf, const QStringList &ioFifo
 
         connect(&m_debugProcess, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &DebugView::slotDebugFinished);
 
-        m_debugProcess.start(m_targetConf.gdbCmd, QStringList());
+        m_debugProcess.start(m_targetConf.gdbCmd, QStringList{QStringLiteral("--interpreter=mi")});
 
-        m_nextCommands << QStringLiteral("set pagination off");
+        m_nextCommands << QStringLiteral("(Q)-gdb-set pagination off");
+        // containers get children that can be listed in pages
+        m_nextCommands << QStringLiteral("(Q)-enable-pretty-printing");
         m_state = ready;
+        m_waitingForPrompt = true;
     } else {
+        // the locals view gets cleared for the new run
+        deleteVariables();
         // On startup the gdb prompt will trigger the "nextCommands",
         // here we have to trigger it manually.
         QTimer::singleShot(0, this, &DebugView::issueNextCommand);
@@ -82,7 +100,7 @@ void DebugView::runDebugger(const GDBTargetConf &conf, const QStringList &ioFifo
     m_nextCommands << QStringLiteral("set args %1 %2").arg(m_targetConf.arguments).arg(m_ioPipeString);
     m_nextCommands << QStringLiteral("set inferior-tty /dev/null");
     m_nextCommands << m_targetConf.customInit;
-    m_nextCommands << QStringLiteral("(Q) info breakpoints");
+    m_nextCommands << QStringLiteral("(Q)-break-list");
 }
 
 bool DebugView::debuggerRunning() const
@@ -125,20 +143,9 @@ void DebugView::slotError()
 
 void DebugView::slotReadDebugStdOut()
 {
-    m_outBuffer += QString::fromLocal8Bit(m_debugProcess.readAllStandardOutput().data());
-    int end = 0;
-    // handle one line at a time
-    do {
-        end = m_outBuffer.indexOf(QLatin1Char('\n'));
-        if (end < 0)
-            break;
-        processLine(m_outBuffer.mid(0, end));
-        m_outBuffer.remove(0, end + 1);
-    } while (1);
-
-    if (m_outBuffer == QLatin1String("(gdb) ") || m_outBuffer == QLatin1String(">")) {
-        m_outBuffer.clear();
-        processLine(PromptStr);
+    const QVector<GdbMi::Record> records = m_parser.parse(m_debugProcess.readAllStandardOutput());
+    for (const auto &record : records) {
+        processRecord(record);
     }
 }
 
@@ -146,16 +153,14 @@ void DebugView::slotReadDebugStdErr()
 {
     m_errBuffer += QString::fromLocal8Bit(m_debugProcess.readAllStandardError().data());
     int end = 0;
-    // add whole lines at a time to the error list
+    // add whole lines at a time to the output
     do {
         end = m_errBuffer.indexOf(QLatin1Char('\n'));
         if (end < 0)
             break;
-        m_errorList << m_errBuffer.mid(0, end);
+        emit outputError(m_errBuffer.left(end + 1));
         m_errBuffer.remove(0, end + 1);
     } while (1);
-
-    processErrors();
 }
 
 void DebugView::slotDebugFinished(int /*exitCode*/, QProcess::ExitStatus status)
@@ -165,6 +170,14 @@ void DebugView::slotDebugFinished(int /*exitCode*/, QProcess::ExitStatus status)
     }
 
     m_state = none;
+    m_inferiorRunning = false;
+    m_inferiorAlive = false;
+    m_sequentialToken = -1;
+    m_pendingCommands.clear();
+    m_rootVariables.clear();
+    m_variablesFrame.clear();
+    m_currentFrame.clear();
+    m_currentThread = -1;
     emit readyForInput(false);
 
     // remove all old breakpoints
@@ -174,6 +187,7 @@ void DebugView::slotDebugFinished(int /*exitCode*/, QProcess::ExitStatus status)
         emit breakPointCleared(bPoint.file, bPoint.line - 1);
     }
 
+    emit variablesCleared();
     emit gdbEnded();
 }
 
@@ -211,6 +225,7 @@ void DebugView::slotKill()
     if (m_state != ready) {
         slotInterrupt();
         m_state = ready;
+        m_sequentialToken = -1;
     }
     issueCommand(QStringLiteral("kill"));
 }
@@ -222,7 +237,7 @@ void DebugView::slotReRun()
     m_nextCommands << QStringLiteral("set args %1 %2").arg(m_targetConf.arguments).arg(m_ioPipeString);
     m_nextCommands << QStringLiteral("set inferior-tty /dev/null");
     m_nextCommands << m_targetConf.customInit;
-    m_nextCommands << QStringLiteral("(Q) info breakpoints");
+    m_nextCommands << QStringLiteral("(Q)-break-list");
 
     m_nextCommands << QStringLiteral("tbreak main");
     m_nextCommands << QStringLiteral("run");
@@ -250,229 +265,436 @@ void DebugView::slotContinue()
     issueCommand(QStringLiteral("continue"));
 }
 
-static const QRegularExpression breakpointList(QStringLiteral("\\ANum\\s+Type\\s+Disp\\s+Enb\\s+Address\\s+What.*\\z"));
-static const QRegularExpression breakpointListed(QStringLiteral("\\A(\\d)\\s+breakpoint\\s+keep\\sy\\s+0x[\\da-f]+\\sin\\s.+\\sat\\s([^:]+):(\\d+).*\\z"));
-static const QRegularExpression stackFrameAny(QStringLiteral("\\A#(\\d+)\\s(.*)\\z"));
-static const QRegularExpression stackFrameFile(QStringLiteral("\\A#(\\d+)\\s+(?:0x[\\da-f]+\\s*in\\s)*(\\S+)(\\s\\(.*\\)) at ([^:]+):(\\d+).*\\z"));
-static const QRegularExpression changeFile(QStringLiteral("\\A(?:(?:Temporary\\sbreakpoint|Breakpoint)\\s*\\d+,\\s*|0x[\\da-f]+\\s*in\\s*)?[^\\s]+\\s*\\([^)]*\\)\\s*at\\s*([^:]+):(\\d+).*\\z"));
-static const QRegularExpression changeLine(QStringLiteral("\\A(\\d+)\\s+.*\\z"));
-static const QRegularExpression breakPointReg(QStringLiteral("\\ABreakpoint\\s+(\\d+)\\s+at\\s+0x[\\da-f]+:\\s+file\\s+([^\\,]+)\\,\\s+line\\s+(\\d+).*\\z"));
-static const QRegularExpression breakPointMultiReg(QStringLiteral("\\ABreakpoint\\s+(\\d+)\\s+at\\s+0x[\\da-f]+:\\s+([^\\,]+):(\\d+).*\\z"));
-static const QRegularExpression breakPointDel(QStringLiteral("\\ADeleted\\s+breakpoint.*\\z"));
-static const QRegularExpression exitProgram(QStringLiteral("\\A(?:Program|.*Inferior.*)\\s+exited.*\\z"));
-static const QRegularExpression threadLine(QStringLiteral("\\A\\**\\s+(\\d+)\\s+Thread.*\\z"));
+int DebugView::sendCommand(const QString &command, const PendingCommand &pending)
+{
+    const int token = m_nextToken++;
+    m_pendingCommands.insert(token, pending);
+    m_debugProcess.write(QByteArray::number(token) + command.toLocal8Bit() + '\n');
+    return token;
+}
+
+int DebugView::sendQuery(const QString &command, Query query, const QString &argument)
+{
+    PendingCommand pending;
+    pending.query = query;
+    pending.argument = argument;
+    return sendCommand(command, pending);
+}
 
-void DebugView::processLine(QString line)
+bool DebugView::queriesPending() const
 {
-    if (line.isEmpty())
-        return;
+    for (const auto &pending : m_pendingCommands) {
+        if (!pending.sequential) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DebugView::checkReady()
+{
+    if (m_state == executingCmd && m_sequentialToken < 0 && !m_inferiorRunning) {
+        m_state = ready;
+        // Give stderr a possibility to get noticed since stderr and stdout are not in sync
+        QTimer::singleShot(0, this, &DebugView::issueNextCommand);
+    }
+}
 
-    static QRegularExpressionMatch match;
-    switch (m_state) {
-    case none:
-    case ready:
-        if (PromptStr == line) {
+void DebugView::processRecord(const GdbMi::Record &record)
+{
+    switch (record.category) {
+    case GdbMi::Record::Prompt:
+        if (m_waitingForPrompt && m_state == ready) {
             // we get here after initialization
+            m_waitingForPrompt = false;
             QTimer::singleShot(0, this, &DebugView::issueNextCommand);
         }
         break;
+    case GdbMi::Record::Result:
+        processResult(record);
+        break;
+    case GdbMi::Record::Exec:
+        if (record.resultClass == QLatin1String("running")) {
+            m_inferiorRunning = true;
+        } else if (record.resultClass == QLatin1String("stopped")) {
+            processStopped(record.results);
+        }
+        break;
+    case GdbMi::Record::Notify:
+        processNotify(record);
+        break;
+    case GdbMi::Record::Console:
+        if (!m_lastCommand.startsWith(QLatin1String("(Q)"))) {
+            emit outputText(record.text);
+        }
+        break;
+    case GdbMi::Record::Target:
+        emit outputText(record.text);
+        break;
+    case GdbMi::Record::Log:
+        if (!m_lastCommand.startsWith(QLatin1String("(Q)"))) {
+            m_lastLogText = record.text.trimmed();
+            emit outputError(record.text);
+        }
+        break;
+    case GdbMi::Record::Unknown:
+        // not MI, e.g. output of the inferior on our tty
+        emit outputText(record.text + QLatin1Char('\n'));
+        break;
+    case GdbMi::Record::Status:
+        break;
+    }
+}
 
-    case executingCmd:
-        if (breakpointList.match(line).hasMatch()) {
-            m_state = listingBreakpoints;
-            emit clearBreakpointMarks();
-            m_breakPointList.clear();
-        } else if (line.contains(QLatin1String("No breakpoints or watchpoints."))) {
+void DebugView::processResult(const GdbMi::Record &record)
+{
+    const auto it = m_pendingCommands.find(record.token);
+    if (it == m_pendingCommands.end()) {
+        return;
+    }
+    const PendingCommand pending = it.value();
+    m_pendingCommands.erase(it);
+
+    if (record.resultClass == QLatin1String("running")) {
+        m_inferiorRunning = true;
+    } else if (record.resultClass == QLatin1String("error")) {
+        processError(pending, record.results.value(QStringLiteral("msg")).toString());
+    } else {
+        switch (pending.query) {
+        case Query::None:
+            break;
+        case Query::BreakList: {
             emit clearBreakpointMarks();
             m_breakPointList.clear();
-        } else if ((match = stackFrameAny.match(line)).hasMatch()) {
-            if (m_lastCommand.contains(QLatin1String("info stack"))) {
-                emit stackFrameInfo(match.captured(1), match.captured(2));
-            } else {
-                m_subState = (m_subState == normal) ? stackFrameSeen : stackTraceSeen;
-
-                m_newFrameLevel = match.captured(1).toInt();
-
-                if ((match = stackFrameFile.match(line)).hasMatch()) {
-                    m_newFrameFile = match.captured(4);
-                }
+            const QJsonArray body = record.results.value(QStringLiteral("BreakpointTable")).toObject().value(QStringLiteral("body")).toArray();
+            for (const auto &bkpt : body) {
+                insertBreakpoint(bkpt.toObject());
             }
-        } else if ((match = changeFile.match(line)).hasMatch()) {
-            m_currentFile = match.captured(1).trimmed();
-            int lineNum = match.captured(2).toInt();
-
-            if (!m_nextCommands.contains(QLatin1String("continue"))) {
-                // GDB uses 1 based line numbers, kate uses 0 based...
-                emit debugLocationChanged(resolveFileName(m_currentFile), lineNum - 1);
+            break;
+        }
+        case Query::StackFrames: {
+            const QJsonArray stack = record.results.value(QStringLiteral("stack")).toArray();
+            for (const auto &value : stack) {
+                const QJsonObject frame = value.toObject();
+                QString info = frame.value(QStringLiteral("func")).toString(QStringLiteral("??")) + QStringLiteral(" ()");
+                if (frame.contains(QStringLiteral("addr")) && frame.value(QStringLiteral("level")).toString() != QLatin1String("0")) {
+                    info = QStringLiteral("%1 in %2").arg(frame.value(QStringLiteral("addr")).toString(), info);
+                }
+                if (frame.contains(QStringLiteral("file"))) {
+                    info += QStringLiteral(" at %1:%2").arg(frame.value(QStringLiteral("file")).toString(), frame.value(QStringLiteral("line")).toString());
+                } else if (frame.contains(QStringLiteral("from"))) {
+                    info += QStringLiteral(" from %1").arg(frame.value(QStringLiteral("from")).toString());
+                }
+                emit stackFrameInfo(frame.value(QStringLiteral("level")).toString(), info);
             }
-            m_debugLocationChanged = true;
-        } else if ((match = changeLine.match(line)).hasMatch()) {
-            int lineNum = match.captured(1).toInt();
-
-            if (m_subState == stackFrameSeen) {
-                m_currentFile = m_newFrameFile;
+            emit stackFrameInfo(QString(), QString());
+            emit stackFrameChanged(m_currentFrameLevel);
+            break;
+        }
+        case Query::ThreadInfo: {
+            const int current = intValue(record.results, QStringLiteral("current-thread-id"));
+            if (current > 0) {
+                m_currentThread = current;
             }
-            if (!m_nextCommands.contains(QLatin1String("continue"))) {
-                // GDB uses 1 based line numbers, kate uses 0 based...
-                emit debugLocationChanged(resolveFileName(m_currentFile), lineNum - 1);
+            emit threadInfo(-1, false);
+            const QJsonArray threads = record.results.value(QStringLiteral("threads")).toArray();
+            for (const auto &thread : threads) {
+                const int id = intValue(thread.toObject(), QStringLiteral("id"));
+                emit threadInfo(id, id == m_currentThread);
             }
-            m_debugLocationChanged = true;
-        } else if ((match = breakPointReg.match(line)).hasMatch()) {
-            BreakPoint breakPoint;
-            breakPoint.number = match.captured(1).toInt();
-            breakPoint.file = resolveFileName(match.captured(2));
-            breakPoint.line = match.captured(3).toInt();
-            m_breakPointList << breakPoint;
-            emit breakPointSet(breakPoint.file, breakPoint.line - 1);
-        } else if ((match = breakPointMultiReg.match(line)).hasMatch()) {
-            BreakPoint breakPoint;
-            breakPoint.number = match.captured(1).toInt();
-            breakPoint.file = resolveFileName(match.captured(2));
-            breakPoint.line = match.captured(3).toInt();
-            m_breakPointList << breakPoint;
-            emit breakPointSet(breakPoint.file, breakPoint.line - 1);
-        } else if (breakPointDel.match(line).hasMatch()) {
-            line.remove(QStringLiteral("Deleted breakpoint"));
-            line.remove(QLatin1Char('s')); // in case of multiple breakpoints
-#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
-            QStringList numbers = line.split(QLatin1Char(' '), QString::SkipEmptyParts);
-#else
-            QStringList numbers = line.split(QLatin1Char(' '), Qt::SkipEmptyParts);
-#endif
-            for (int i = 0; i < numbers.size(); i++) {
-                for (int j = 0; j < m_breakPointList.size(); j++) {
-                    if (numbers[i].toInt() == m_breakPointList[j].number) {
-                        emit breakPointCleared(m_breakPointList[j].file, m_breakPointList[j].line - 1);
-                        m_breakPointList.removeAt(j);
-                        break;
-                    }
-                }
+            break;
+        }
+        case Query::FrameInfo:
+            processFrameInfo(record.results);
+            // a new thread gets the full update, a new frame only needs the locals
+            if (m_queryLocals && !m_debugLocationChanged) {
+                queryLocals();
             }
-        } else if (exitProgram.match(line).hasMatch() || line.contains(QLatin1String("The program no longer exists")) || line.contains(QLatin1String("Kill the program being debugged"))) {
-            // if there are still commands to execute remove them to remove unneeded output
-            // except  if the "kill was for "re-run"
-            if ((!m_nextCommands.empty()) && !m_nextCommands[0].contains(QLatin1String("file"))) {
-                m_nextCommands.clear();
+            break;
+        case Query::VariableNames:
+            processVariableNames(record.results);
+            break;
+        case Query::VariableCreate: {
+            const QString name = record.results.value(QStringLiteral("name")).toString();
+            if (pending.generation != m_variablesGeneration) {
+                // the frame changed while the command was in flight
+                sendQuery(QStringLiteral("-var-delete %1").arg(name), Query::VariableDelete);
+                break;
             }
-            m_debugLocationChanged = false; // do not insert (Q) commands
-            emit programEnded();
-        } else if (PromptStr == line) {
-            if (m_subState == stackFrameSeen) {
-                emit stackFrameChanged(m_newFrameLevel);
+            m_rootVariables.insert(pending.argument, name);
+            emit variableCreated(name,
+                                 QString(),
+                                 pending.argument,
+                                 record.results.value(QStringLiteral("value")).toString(),
+                                 record.results.value(QStringLiteral("type")).toString(),
+                                 intValue(record.results, QStringLiteral("numchild"), 0),
+                                 intValue(record.results, QStringLiteral("has_more"), 0) > 0);
+            break;
+        }
+        case Query::VariableUpdate:
+            processVariableUpdate(record.results);
+            break;
+        case Query::VariableChildren: {
+            const QJsonArray children = record.results.value(QStringLiteral("children")).toArray();
+            for (const auto &value : children) {
+                const QJsonObject child = value.toObject();
+                emit variableCreated(child.value(QStringLiteral("name")).toString(),
+                                     pending.argument,
+                                     child.value(QStringLiteral("exp")).toString(),
+                                     child.value(QStringLiteral("value")).toString(),
+                                     child.value(QStringLiteral("type")).toString(),
+                                     intValue(child, QStringLiteral("numchild"), 0),
+                                     intValue(child, QStringLiteral("has_more"), 0) > 0);
             }
-            m_state = ready;
-
-            // Give the error a possibility get noticed since stderr and stdout are not in sync
-            QTimer::singleShot(0, this, &DebugView::issueNextCommand);
+            emit childrenListed(pending.argument, intValue(record.results, QStringLiteral("has_more"), 0) > 0);
+            break;
         }
-        break;
-
-    case listingBreakpoints:;
-        if ((match = breakpointListed.match(line)).hasMatch()) {
-            BreakPoint breakPoint;
-            breakPoint.number = match.captured(1).toInt();
-            breakPoint.file = resolveFileName(match.captured(2));
-            breakPoint.line = match.captured(3).toInt();
-            m_breakPointList << breakPoint;
-            emit breakPointSet(breakPoint.file, breakPoint.line - 1);
-        } else if (PromptStr == line) {
-            m_state = ready;
-            QTimer::singleShot(0, this, &DebugView::issueNextCommand);
+        case Query::VariableDelete:
+            break;
         }
-        break;
-    case infoArgs:
-        if (PromptStr == line) {
-            m_state = ready;
-            QTimer::singleShot(0, this, &DebugView::issueNextCommand);
-        } else {
-            emit infoLocal(line);
+    }
+
+    if (pending.sequential) {
+        m_sequentialToken = -1;
+        checkReady();
+    } else if (m_state == ready && !queriesPending()) {
+        QTimer::singleShot(0, this, &DebugView::issueNextCommand);
+    }
+}
+
+void DebugView::processStopped(const QJsonObject &results)
+{
+    m_inferiorRunning = false;
+
+    const QString reason = results.value(QStringLiteral("reason")).toString();
+    if (reason.startsWith(QLatin1String("exited"))) {
+        inferiorExited();
+    } else {
+        const QJsonObject frame = results.value(QStringLiteral("frame")).toObject();
+        const int thread = intValue(results, QStringLiteral("thread-id"));
+        if (thread > 0) {
+            m_currentThread = thread;
         }
-        break;
-    case printThis:
-        if (PromptStr == line) {
-            m_state = ready;
-            QTimer::singleShot(0, this, &DebugView::issueNextCommand);
-        } else {
-            emit infoLocal(line);
+        m_currentFrameLevel = 0;
+        m_currentFrame = QStringLiteral("%1:%2:0").arg(m_currentThread).arg(frame.value(QStringLiteral("func")).toString());
+
+        const int lineNum = intValue(frame, QStringLiteral("line"));
+        if (lineNum > 0 && !m_nextCommands.contains(QLatin1String("continue"))) {
+            // GDB uses 1 based line numbers, kate uses 0 based...
+            emit debugLocationChanged(frameUrl(frame), lineNum - 1);
         }
-        break;
-    case infoLocals:
-        if (PromptStr == line) {
-            m_state = ready;
-            emit infoLocal(QString());
-            QTimer::singleShot(0, this, &DebugView::issueNextCommand);
-        } else {
-            emit infoLocal(line);
+        m_debugLocationChanged = true;
+    }
+
+    checkReady();
+}
+
+void DebugView::processNotify(const GdbMi::Record &record)
+{
+    const QString &what = record.resultClass;
+    if (what == QLatin1String("breakpoint-created") || what == QLatin1String("breakpoint-modified")) {
+        const QJsonObject bkpt = record.results.value(QStringLiteral("bkpt")).toObject();
+        removeBreakpoint(intValue(bkpt, QStringLiteral("number")));
+        insertBreakpoint(bkpt);
+    } else if (what == QLatin1String("breakpoint-deleted")) {
+        removeBreakpoint(intValue(record.results, QStringLiteral("id")));
+    } else if (what == QLatin1String("thread-group-started")) {
+        m_inferiorAlive = true;
+    } else if (what == QLatin1String("thread-group-exited")) {
+        inferiorExited();
+    } else if (what == QLatin1String("thread-selected")) {
+        // selection changed by a console command like "thread 2" or "up"
+        const int thread = intValue(record.results, QStringLiteral("id"));
+        if (thread > 0) {
+            m_currentThread = thread;
         }
-        break;
-    case infoStack:
-        if (PromptStr == line) {
-            m_state = ready;
-            emit stackFrameInfo(QString(), QString());
-            QTimer::singleShot(0, this, &DebugView::issueNextCommand);
-        } else if ((match = stackFrameAny.match(line)).hasMatch()) {
-            emit stackFrameInfo(match.captured(1), match.captured(2));
+        if (record.results.contains(QStringLiteral("frame"))) {
+            processFrameInfo(record.results);
         }
-        break;
-    case infoThreads:
-        if (PromptStr == line) {
-            m_state = ready;
-            QTimer::singleShot(0, this, &DebugView::issueNextCommand);
-        } else if ((match = threadLine.match(line)).hasMatch()) {
-            emit threadInfo(match.captured(1).toInt(), (line[0] == QLatin1Char('*')));
+        m_debugLocationChanged = true;
+    }
+}
+
+void DebugView::processError(const PendingCommand &pending, const QString &error)
+{
+    if (!pending.sequential) {
+        if (pending.query == Query::VariableCreate && pending.generation == m_variablesGeneration) {
+            m_rootVariables.remove(pending.argument);
+        } else if (pending.query == Query::VariableChildren) {
+            emit childrenListed(pending.argument, false);
         }
-        break;
+        // failing queries, e.g. for variables going out of scope, are not interesting
+        return;
     }
-    outputTextMaybe(line);
-}
-
-void DebugView::processErrors()
-{
-    QString error;
-    while (!m_errorList.empty()) {
-        error = m_errorList.takeFirst();
-        // qDebug() << error;
-        if (error == QLatin1String("The program is not being run.")) {
-            if (m_lastCommand == QLatin1String("continue")) {
-                m_nextCommands.clear();
-                m_nextCommands << QStringLiteral("tbreak main");
-                m_nextCommands << QStringLiteral("run");
-                m_nextCommands << QStringLiteral("p setvbuf(stdout, 0, %1, 1024)").arg(_IOLBF);
-                m_nextCommands << QStringLiteral("continue");
-                QTimer::singleShot(0, this, &DebugView::issueNextCommand);
-            } else if ((m_lastCommand == QLatin1String("step")) || (m_lastCommand == QLatin1String("next")) || (m_lastCommand == QLatin1String("finish"))) {
-                m_nextCommands.clear();
-                m_nextCommands << QStringLiteral("tbreak main");
-                m_nextCommands << QStringLiteral("run");
-                m_nextCommands << QStringLiteral("p setvbuf(stdout, 0, %1, 1024)").arg(_IOLBF);
-                QTimer::singleShot(0, this, &DebugView::issueNextCommand);
-            } else if ((m_lastCommand == QLatin1String("kill"))) {
-                if (!m_nextCommands.empty()) {
-                    if (!m_nextCommands[0].contains(QLatin1String("file"))) {
-                        m_nextCommands.clear();
-                        m_nextCommands << QStringLiteral("quit");
-                    }
-                    // else continue with "ReRun"
-                } else {
+
+    if (error == QLatin1String("The program is not being run.")) {
+        if (m_lastCommand == QLatin1String("continue")) {
+            m_nextCommands.clear();
+            m_nextCommands << QStringLiteral("tbreak main");
+            m_nextCommands << QStringLiteral("run");
+            m_nextCommands << QStringLiteral("p setvbuf(stdout, 0, %1, 1024)").arg(_IOLBF);
+            m_nextCommands << QStringLiteral("continue");
+        } else if ((m_lastCommand == QLatin1String("step")) || (m_lastCommand == QLatin1String("next")) || (m_lastCommand == QLatin1String("finish"))) {
+            m_nextCommands.clear();
+            m_nextCommands << QStringLiteral("tbreak main");
+            m_nextCommands << QStringLiteral("run");
+            m_nextCommands << QStringLiteral("p setvbuf(stdout, 0, %1, 1024)").arg(_IOLBF);
+        } else if ((m_lastCommand == QLatin1String("kill"))) {
+            if (!m_nextCommands.empty()) {
+                if (!m_nextCommands[0].contains(QLatin1String("file"))) {
+                    m_nextCommands.clear();
                     m_nextCommands << QStringLiteral("quit");
                 }
-                m_state = ready;
-                QTimer::singleShot(0, this, &DebugView::issueNextCommand);
+                // else continue with "ReRun"
+            } else {
+                m_nextCommands << QStringLiteral("quit");
             }
-            // else do nothing
-        } else if (error.contains(QLatin1String("No line ")) || error.contains(QLatin1String("No source file named"))) {
-            // setting a breakpoint failed. Do not continue.
-            m_nextCommands.clear();
-            emit readyForInput(true);
-        } else if (error.contains(QLatin1String("No stack"))) {
-            m_nextCommands.clear();
-            emit programEnded();
         }
+        // else do nothing
+    } else if (error.contains(QLatin1String("No line ")) || error.contains(QLatin1String("No source file named"))) {
+        // setting a breakpoint failed. Do not continue.
+        m_nextCommands.clear();
+    } else if (error.contains(QLatin1String("No stack"))) {
+        m_nextCommands.clear();
+        emit programEnded();
+    }
 
-        if ((m_lastCommand == QLatin1String("(Q)print *this")) && error.contains(QLatin1String("No symbol \"this\" in current context."))) {
+    // console commands already reported the error on the log stream
+    if (m_lastCommand.startsWith(QLatin1String("(Q)")) || (!pending.miCommand && error.trimmed() == m_lastLogText)) {
+        return;
+    }
+    emit outputError(error + QLatin1Char('\n'));
+}
+
+void DebugView::processFrameInfo(const QJsonObject &results)
+{
+    const QJsonObject frame = results.value(QStringLiteral("frame")).toObject();
+    const int thread = intValue(results, QStringLiteral("new-thread-id"));
+    if (thread > 0) {
+        m_currentThread = thread;
+    }
+
+    m_currentFrameLevel = intValue(frame, QStringLiteral("level"), 0);
+    m_currentFrame = QStringLiteral("%1:%2:%3").arg(m_currentThread).arg(frame.value(QStringLiteral("func")).toString()).arg(m_currentFrameLevel);
+    emit stackFrameChanged(m_currentFrameLevel);
+
+    const int lineNum = intValue(frame, QStringLiteral("line"));
+    if (lineNum > 0) {
+        emit debugLocationChanged(frameUrl(frame), lineNum - 1);
+    }
+}
+
+void DebugView::processVariableNames(const QJsonObject &results)
+{
+    QStringList names;
+    const QJsonArray variables = results.value(QStringLiteral("variables")).toArray();
+    for (const auto &variable : variables) {
+        const QString name = variable.toObject().value(QStringLiteral("name")).toString();
+        if (!names.contains(name)) {
+            names << name;
+        }
+    }
+
+    // drop the variables that went out of scope
+    for (auto it = m_rootVariables.begin(); it != m_rootVariables.end();) {
+        if (names.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        if (!it.value().isEmpty()) {
+            sendQuery(QStringLiteral("-var-delete %1").arg(it.value()), Query::VariableDelete);
+            emit variableRemoved(it.value());
+        }
+        it = m_rootVariables.erase(it);
+    }
+
+    // only the new ones need to be created, the rest is kept up to date by -var-update
+    for (const QString &name : qAsConst(names)) {
+        if (!m_rootVariables.contains(name)) {
+            // remember the pending creation so that overlapping updates do not create it twice
+            m_rootVariables.insert(name, QString());
+            PendingCommand pending;
+            pending.query = Query::VariableCreate;
+            pending.argument = name;
+            pending.generation = m_variablesGeneration;
+            sendCommand(QStringLiteral("-var-create - * %1").arg(GdbMi::quote(name)), pending);
+        }
+    }
+}
+
+void DebugView::processVariableUpdate(const QJsonObject &results)
+{
+    const QJsonArray changes = results.value(QStringLiteral("changelist")).toArray();
+    for (const auto &value : changes) {
+        const QJsonObject change = value.toObject();
+        const QString name = change.value(QStringLiteral("name")).toString();
+        const QString expression = m_rootVariables.key(name);
+
+        if (change.value(QStringLiteral("in_scope")).toString() != QLatin1String("true")) {
+            if (!expression.isEmpty()) {
+                sendQuery(QStringLiteral("-var-delete %1").arg(name), Query::VariableDelete);
+                m_rootVariables.remove(expression);
+                emit variableRemoved(name);
+            }
             continue;
         }
-        emit outputError(error + QLatin1Char('\n'));
+
+        int childCount = intValue(change, QStringLiteral("new_num_children"));
+        if (childCount < 0 && change.value(QStringLiteral("type_changed")).toString() == QLatin1String("true")) {
+            childCount = 0;
+        }
+        emit variableChanged(name, change.value(QStringLiteral("value")).toString(), childCount, intValue(change, QStringLiteral("has_more"), 0) > 0);
+    }
+}
+
+void DebugView::inferiorExited()
+{
+    if (!m_inferiorAlive) {
+        return;
+    }
+    m_inferiorAlive = false;
+
+    // if there are still commands to execute remove them to remove unneeded output
+    // except  if the "kill was for "re-run"
+    if ((!m_nextCommands.empty()) && !m_nextCommands[0].contains(QLatin1String("file"))) {
+        m_nextCommands.clear();
+    }
+    m_debugLocationChanged = false; // do not query the stack and locals
+    deleteVariables();
+    emit programEnded();
+}
+
+void DebugView::insertBreakpoint(const QJsonObject &bkpt)
+{
+    QJsonObject location = bkpt;
+    if (!location.contains(QStringLiteral("line"))) {
+        // pending or multi-location breakpoint, use the first resolved location
+        const QJsonArray locations = bkpt.value(QStringLiteral("locations")).toArray();
+        if (locations.isEmpty()) {
+            return;
+        }
+        location = locations.first().toObject();
+    }
+
+    BreakPoint breakPoint;
+    breakPoint.number = intValue(bkpt, QStringLiteral("number"));
+    breakPoint.line = intValue(location, QStringLiteral("line"));
+    if (breakPoint.number < 0 || breakPoint.line < 0) {
+        return;
+    }
+    breakPoint.file = frameUrl(location);
+    m_breakPointList << breakPoint;
+    emit breakPointSet(breakPoint.file, breakPoint.line - 1);
+}
+
+void DebugView::removeBreakpoint(int number)
+{
+    for (int i = 0; i < m_breakPointList.size(); i++) {
+        if (m_breakPointList[i].number == number) {
+            emit breakPointCleared(m_breakPointList[i].file, m_breakPointList[i].line - 1);
+            m_breakPointList.removeAt(i);
+            return;
+        }
     }
 }
 
@@ -481,28 +703,28 @@ void DebugView::issueCommand(QString const &cmd)
     if (m_state == ready) {
         emit readyForInput(false);
         m_state = executingCmd;
-        if (cmd == QLatin1String("(Q)info locals")) {
-            m_state = infoLocals;
-        } else if (cmd == QLatin1String("(Q)info args")) {
-            m_state = infoArgs;
-        } else if (cmd == QLatin1String("(Q)print *this")) {
-            m_state = printThis;
-        } else if (cmd == QLatin1String("(Q)info stack")) {
-            m_state = infoStack;
-        } else if (cmd == QLatin1String("(Q)info thread")) {
-            emit threadInfo(-1, false);
-            m_state = infoThreads;
-        }
-        m_subState = normal;
         m_lastCommand = cmd;
+        m_lastLogText.clear();
 
-        if (cmd.startsWith(QLatin1String("(Q)"))) {
-            m_debugProcess.write(qPrintable(cmd.mid(3)));
+        QString command = cmd;
+        if (command.startsWith(QLatin1String("(Q)"))) {
+            command.remove(0, 3);
         } else {
             emit outputText(QStringLiteral("(gdb) ") + cmd + QLatin1Char('\n'));
-            m_debugProcess.write(qPrintable(cmd));
         }
-        m_debugProcess.write("\n");
+
+        PendingCommand pending;
+        pending.sequential = true;
+        if (command.startsWith(QLatin1String("-break-list"))) {
+            pending.query = Query::BreakList;
+        } else if (command.startsWith(QLatin1String("-stack-info-frame")) || command.startsWith(QLatin1String("-thread-select"))) {
+            pending.query = Query::FrameInfo;
+        }
+        if (!command.startsWith(QLatin1Char('-'))) {
+            pending.miCommand = false;
+            command = consoleCommand(command);
+        }
+        m_sequentialToken = sendCommand(command, pending);
     }
 }
 
@@ -513,26 +735,106 @@ void DebugView::issueNextCommand()
             QString cmd = m_nextCommands.takeFirst();
             // qDebug() << "Next command" << cmd;
             issueCommand(cmd);
-        } else {
-            // FIXME "thread" needs a better generic solution
-            if (m_debugLocationChanged || m_lastCommand.startsWith(QLatin1String("thread"))) {
-                m_debugLocationChanged = false;
-                if (m_queryLocals && !m_lastCommand.startsWith(QLatin1String("(Q)"))) {
-                    m_nextCommands << QStringLiteral("(Q)info stack");
-                    m_nextCommands << QStringLiteral("(Q)frame");
-                    m_nextCommands << QStringLiteral("(Q)info args");
-                    m_nextCommands << QStringLiteral("(Q)print *this");
-                    m_nextCommands << QStringLiteral("(Q)info locals");
-                    m_nextCommands << QStringLiteral("(Q)info thread");
-                    issueNextCommand();
-                    return;
-                }
+            return;
+        }
+        if (m_debugLocationChanged) {
+            m_debugLocationChanged = false;
+            if (m_queryLocals) {
+                queryState();
             }
+        }
+        QVector<ChildrenRequest> queuedChildren;
+        queuedChildren.swap(m_queuedChildren);
+        for (const auto &request : qAsConst(queuedChildren)) {
+            listChildren(request);
+        }
+        if (!queriesPending()) {
             emit readyForInput(true);
         }
     }
 }
 
+void DebugView::selectFrame(int level)
+{
+    if (m_state == ready) {
+        m_nextCommands << QStringLiteral("(Q)-stack-info-frame");
+        issueCommand(QStringLiteral("(Q)-stack-select-frame %1").arg(level));
+    }
+}
+
+void DebugView::selectThread(int thread)
+{
+    if (m_state == ready && thread > 0 && thread != m_currentThread) {
+        m_debugLocationChanged = true;
+        issueCommand(QStringLiteral("(Q)-thread-select %1").arg(thread));
+    }
+}
+
+void DebugView::queryState()
+{
+    // all of these are in flight at the same time
+    sendQuery(QStringLiteral("-stack-list-frames"), Query::StackFrames);
+    sendQuery(QStringLiteral("-thread-info"), Query::ThreadInfo);
+    queryLocals();
+}
+
+void DebugView::queryLocals()
+{
+    if (m_variablesFrame != m_currentFrame) {
+        // variable objects are bound to the frame they were created in
+        deleteVariables();
+        m_variablesFrame = m_currentFrame;
+    }
+    if (!m_rootVariables.isEmpty()) {
+        // only reports the variables that changed since the last stop
+        sendQuery(QStringLiteral("-var-update --all-values *"), Query::VariableUpdate);
+    }
+    sendQuery(QStringLiteral("-stack-list-variables --no-values"), Query::VariableNames);
+}
+
+void DebugView::deleteVariables()
+{
+    for (const QString &variable : qAsConst(m_rootVariables)) {
+        if (!variable.isEmpty()) {
+            sendQuery(QStringLiteral("-var-delete %1").arg(variable), Query::VariableDelete);
+        }
+    }
+    m_rootVariables.clear();
+    m_queuedChildren.clear();
+    m_variablesGeneration++;
+    m_variablesFrame.clear();
+    emit variablesCleared();
+}
+
+void DebugView::slotListChildren(const QString &variable, int from, int to)
+{
+    const ChildrenRequest request{variable, from, to};
+    if (m_state == ready && m_nextCommands.empty()) {
+        listChildren(request);
+    } else if (m_state != none) {
+        // the variable keeps its children count, they are listed when GDB is ready
+        m_queuedChildren.append(request);
+    }
+}
+
+void DebugView::listChildren(const ChildrenRequest &request)
+{
+    // only the requested range is transferred, which keeps huge arrays and containers cheap
+    sendQuery(QStringLiteral("-var-list-children --all-values %1 %2 %3").arg(request.variable).arg(request.from).arg(request.to),
+              Query::VariableChildren,
+              request.variable);
+}
+
+QUrl DebugView::frameUrl(const QJsonObject &frame)
+{
+    // prefer the absolute path GDB resolved itself
+    const QString fullName = frame.value(QStringLiteral("fullname")).toString();
+    if (!fullName.isEmpty() && QFileInfo::exists(fullName)) {
+        return QUrl::fromLocalFile(fullName);
+    }
+    return resolveFileName(frame.value(QStringLiteral("file")).toString());
+}
+
 QUrl DebugView::resolveFileName(const QString &fileName)
 {
     QFileInfo fInfo = QFileInfo(fileName);
@@ -570,24 +872,11 @@ QUrl DebugView::resolveFileName(const QString &fileName)
     return QUrl::fromUserInput(fileName);
 }
 
-void DebugView::outputTextMaybe(const QString &text)
-{
-    if (!m_lastCommand.startsWith(QLatin1String("(Q)")) && !text.contains(PromptStr)) {
-        emit outputText(text + QLatin1Char('\n'));
-    }
-}
-
 void DebugView::slotQueryLocals(bool query)
 {
     m_queryLocals = query;
     if (query && (m_state == ready) && (m_nextCommands.empty())) {
-        m_nextCommands << QStringLiteral("(Q)info stack");
-        m_nextCommands << QStringLiteral("(Q)frame");
-        m_nextCommands << QStringLiteral("(Q)info args");
-        m_nextCommands << QStringLiteral("(Q)print *this");
-        m_nextCommands << QStringLiteral("(Q)info locals");
-        m_nextCommands << QStringLiteral("(Q)info thread");
-        issueNextCommand();
+        queryState();
     }
 }
 
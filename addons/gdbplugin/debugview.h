@@ -14,10 +14,14 @@
 
 #include <QObject>
 
+#include <QHash>
+#include <QJsonObject>
 #include <QProcess>
 #include <QUrl>
+#include <QVector>
 
 #include "configview.h"
+#include "gdbmiparser.h"
 
 class DebugView : public QObject
 {
@@ -35,8 +39,12 @@ public:
     void movePC(QUrl const &url, int line);
     void runToCursor(QUrl const &url, int line);
 
+    // Commands not starting with "-" are passed to the GDB console interpreter
     void issueCommand(QString const &cmd);
 
+    void selectFrame(int level);
+    void selectThread(int thread);
+
     QString targetName() const;
     void setFileSearchPaths(const QStringList &paths);
 
@@ -50,6 +58,7 @@ public Q_SLOTS:
     void slotReRun();
 
     void slotQueryLocals(bool display);
+    void slotListChildren(const QString &variable, int from, int to);
 
 private Q_SLOTS:
     void slotError();
@@ -67,7 +76,15 @@ Q_SIGNALS:
     void stackFrameChanged(int level);
     void threadInfo(int number, bool active);
 
-    void infoLocal(QString const &line);
+    // Variable objects of the current frame. An empty parent denotes a local.
+    // Pretty printed variables report hasMore instead of a child count.
+    void variableCreated(const QString &variable, const QString &parent, const QString &expression, const QString &value, const QString &type, int childCount, bool hasMore);
+    // childCount is -1 if the number of children did not change
+    void variableChanged(const QString &variable, const QString &value, int childCount, bool hasMore);
+    void variableRemoved(const QString &variable);
+    void variablesCleared();
+    // a page requested with slotListChildren() is complete
+    void childrenListed(const QString &variable, bool hasMore);
 
     void outputText(const QString &text);
     void outputError(const QString &text);
@@ -77,9 +94,28 @@ Q_SIGNALS:
     void sourceFileNotFound(const QString &fileName);
 
 private:
-    enum State { none, ready, executingCmd, listingBreakpoints, infoStack, infoArgs, printThis, infoLocals, infoThreads };
+    enum State { none, ready, executingCmd };
+
+    // what to do with the result record of a command
+    enum class Query { None, BreakList, StackFrames, ThreadInfo, FrameInfo, VariableNames, VariableCreate, VariableUpdate, VariableChildren, VariableDelete };
+
+    struct PendingCommand {
+        Query query = Query::None;
+        // sequential commands are issued one at a time from m_nextCommands,
+        // all others are queries that may be in flight concurrently
+        bool sequential = false;
+        // false if the command came from the console interpreter
+        bool miCommand = true;
+        QString argument;
+        // value of m_variablesGeneration when a variable object was requested
+        int generation = 0;
+    };
 
-    enum SubState { normal, stackFrameSeen, stackTraceSeen };
+    struct ChildrenRequest {
+        QString variable;
+        int from;
+        int to;
+    };
 
     struct BreakPoint {
         int number;
@@ -88,29 +124,64 @@ private:
     };
 
 private:
-    void processLine(QString output);
-    void processErrors();
-    void outputTextMaybe(const QString &text);
+    int sendCommand(const QString &command, const PendingCommand &pending);
+    int sendQuery(const QString &command, Query query, const QString &argument = QString());
+    bool queriesPending() const;
+    void checkReady();
+
+    void processRecord(const GdbMi::Record &record);
+    void processResult(const GdbMi::Record &record);
+    void processStopped(const QJsonObject &results);
+    void processNotify(const GdbMi::Record &record);
+    void processError(const PendingCommand &pending, const QString &error);
+    void processFrameInfo(const QJsonObject &results);
+    void processVariableNames(const QJsonObject &results);
+    void processVariableUpdate(const QJsonObject &results);
+
+    void inferiorExited();
+    void insertBreakpoint(const QJsonObject &bkpt);
+    void removeBreakpoint(int number);
+
+    void queryState();
+    void queryLocals();
+    void deleteVariables();
+    void listChildren(const ChildrenRequest &request);
+
+    QUrl frameUrl(const QJsonObject &frame);
     QUrl resolveFileName(const QString &fileName);
 
 private:
     QProcess m_debugProcess;
+    GdbMiParser m_parser;
     GDBTargetConf m_targetConf;
     QString m_ioPipeString;
 
     State m_state;
-    SubState m_subState;
+    bool m_waitingForPrompt = false;
+    bool m_inferiorRunning = false;
+    bool m_inferiorAlive = false;
+
+    int m_nextToken = 1;
+    int m_sequentialToken = -1;
+    QHash<int, PendingCommand> m_pendingCommands;
+
+    int m_currentThread = -1;
+    int m_currentFrameLevel = 0;
+    // identifies the frame the variable objects belong to
+    QString m_currentFrame;
+    QString m_variablesFrame;
+    // local name -> root variable object, empty while its creation is pending
+    QHash<QString, QString> m_rootVariables;
+    int m_variablesGeneration = 0;
+    // children requested while GDB was busy, listed once it is ready
+    QVector<ChildrenRequest> m_queuedChildren;
 
-    QString m_currentFile;
-    QString m_newFrameFile;
-    int m_newFrameLevel = 0;
     QStringList m_nextCommands;
     QString m_lastCommand;
+    QString m_lastLogText;
     bool m_debugLocationChanged;
     QList<BreakPoint> m_breakPointList;
-    QString m_outBuffer;
     QString m_errBuffer;
-    QStringList m_errorList;
     bool m_queryLocals;
 };
 
@@ -0,0 +1,344 @@
+//
+// Description: Incremental parser for the GDB/MI output syntax
+//
+// SPDX-FileCopyrightText: 2021 Kate Developers
+//
+//  SPDX-License-Identifier: LGPL-2.0-only
+
+#include "gdbmiparser.h"
+
+#include <QJsonArray>
+
+namespace
+{
+/**
+ * Character level scanner over one MI line. All parse functions leave the
+ * position behind the consumed input and return false on a syntax error.
+ */
+class Tokenizer
+{
+public:
+    explicit Tokenizer(const QByteArray &line)
+        : m_pos(line.constData())
+        , m_end(line.constData() + line.size())
+    {
+    }
+
+    bool atEnd() const
+    {
+        return m_pos >= m_end;
+    }
+
+    char peek() const
+    {
+        return atEnd() ? '\0' : *m_pos;
+    }
+
+    bool consume(char c)
+    {
+        if (peek() != c) {
+            return false;
+        }
+        ++m_pos;
+        return true;
+    }
+
+    int token()
+    {
+        if (!isDigit(peek())) {
+            return -1;
+        }
+        int token = 0;
+        while (isDigit(peek())) {
+            token = token * 10 + (*m_pos - '0');
+            ++m_pos;
+        }
+        return token;
+    }
+
+    QString identifier()
+    {
+        const char *start = m_pos;
+        while (!atEnd() && (isDigit(*m_pos) || isLetter(*m_pos) || *m_pos == '-' || *m_pos == '_')) {
+            ++m_pos;
+        }
+        return QString::fromLatin1(start, int(m_pos - start));
+    }
+
+    bool cString(QString &out)
+    {
+        if (!consume('"')) {
+            return false;
+        }
+        QByteArray bytes;
+        while (!atEnd()) {
+            char c = *m_pos++;
+            if (c == '"') {
+                out = QString::fromUtf8(bytes);
+                return true;
+            }
+            if (c != '\\' || atEnd()) {
+                bytes.append(c);
+                continue;
+            }
+            c = *m_pos++;
+            switch (c) {
+            case 'n':
+                bytes.append('\n');
+                break;
+            case 't':
+                bytes.append('\t');
+                break;
+            case 'r':
+                bytes.append('\r');
+                break;
+            case 'f':
+                bytes.append('\f');
+                break;
+            case 'v':
+                bytes.append('\v');
+                break;
+            case 'a':
+                bytes.append('\a');
+                break;
+            case 'b':
+                bytes.append('\b');
+                break;
+            case 'e':
+                bytes.append('\033');
+                break;
+            default:
+                if (c >= '0' && c <= '7') {
+                    // octal escape, GDB uses these for all non ASCII bytes
+                    int value = c - '0';
+                    for (int i = 0; i < 2 && !atEnd() && *m_pos >= '0' && *m_pos <= '7'; ++i) {
+                        value = value * 8 + (*m_pos++ - '0');
+                    }
+                    bytes.append(char(value));
+                } else {
+                    bytes.append(c);
+                }
+                break;
+            }
+        }
+        return false;
+    }
+
+    bool value(QJsonValue &out)
+    {
+        switch (peek()) {
+        case '"': {
+            QString str;
+            if (!cString(str)) {
+                return false;
+            }
+            out = str;
+            return true;
+        }
+        case '{': {
+            QJsonObject tuple;
+            if (!this->tuple(tuple)) {
+                return false;
+            }
+            out = tuple;
+            return true;
+        }
+        case '[': {
+            QJsonArray list;
+            if (!this->list(list)) {
+                return false;
+            }
+            out = list;
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    bool result(QString &name, QJsonValue &out)
+    {
+        name = identifier();
+        return !name.isEmpty() && consume('=') && value(out);
+    }
+
+    bool tuple(QJsonObject &out)
+    {
+        if (!consume('{')) {
+            return false;
+        }
+        if (consume('}')) {
+            return true;
+        }
+        do {
+            QString name;
+            QJsonValue val;
+            if (!result(name, val)) {
+                return false;
+            }
+            out.insert(name, val);
+        } while (consume(','));
+        return consume('}');
+    }
+
+    bool list(QJsonArray &out)
+    {
+        if (!consume('[')) {
+            return false;
+        }
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            QJsonValue val;
+            const char c = peek();
+            if (c == '"' || c == '{' || c == '[') {
+                if (!value(val)) {
+                    return false;
+                }
+            } else {
+                // a list of results, e.g. stack=[frame={...},frame={...}]
+                QString name;
+                if (!result(name, val)) {
+                    return false;
+                }
+            }
+            out.append(val);
+        } while (consume(','));
+        return consume(']');
+    }
+
+private:
+    static bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    static bool isLetter(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    const char *m_pos;
+    const char *m_end;
+};
+}
+
+QString GdbMi::quote(const QString &arg)
+{
+    QString quoted;
+    quoted.reserve(arg.size() + 2);
+    quoted += QLatin1Char('"');
+    for (const QChar c : arg) {
+        if (c == QLatin1Char('"') || c == QLatin1Char('\\')) {
+            quoted += QLatin1Char('\\');
+            quoted += c;
+        } else if (c == QLatin1Char('\n')) {
+            quoted += QLatin1String("\\n");
+        } else {
+            quoted += c;
+        }
+    }
+    quoted += QLatin1Char('"');
+    return quoted;
+}
+
+QVector<GdbMi::Record> GdbMiParser::parse(const QByteArray &data)
+{
+    m_buffer.append(data);
+
+    QVector<GdbMi::Record> records;
+    int start = 0;
+    int end;
+    while ((end = m_buffer.indexOf('\n', start)) >= 0) {
+        int lineEnd = end;
+        if (lineEnd > start && m_buffer.at(lineEnd - 1) == '\r') {
+            --lineEnd;
+        }
+        if (lineEnd > start) {
+            GdbMi::Record record;
+            parseLine(QByteArray::fromRawData(m_buffer.constData() + start, lineEnd - start), record);
+            records.append(record);
+        }
+        start = end + 1;
+    }
+    m_buffer.remove(0, start);
+    return records;
+}
+
+void GdbMiParser::reset()
+{
+    m_buffer.clear();
+}
+
+bool GdbMiParser::parseLine(const QByteArray &line, GdbMi::Record &record)
+{
+    record = GdbMi::Record();
+
+    if (line.startsWith("(gdb)")) {
+        record.category = GdbMi::Record::Prompt;
+        return true;
+    }
+
+    Tokenizer tok(line);
+    record.token = tok.token();
+
+    const char prefix = tok.peek();
+    switch (prefix) {
+    case '^':
+        record.category = GdbMi::Record::Result;
+        break;
+    case '*':
+        record.category = GdbMi::Record::Exec;
+        break;
+    case '+':
+        record.category = GdbMi::Record::Status;
+        break;
+    case '=':
+        record.category = GdbMi::Record::Notify;
+        break;
+    case '~':
+        record.category = GdbMi::Record::Console;
+        break;
+    case '@':
+        record.category = GdbMi::Record::Target;
+        break;
+    case '&':
+        record.category = GdbMi::Record::Log;
+        break;
+    default:
+        break;
+    }
+
+    bool ok = false;
+    if (record.category >= GdbMi::Record::Console && record.category <= GdbMi::Record::Log) {
+        tok.consume(prefix);
+        ok = tok.cString(record.text);
+    } else if (record.category != GdbMi::Record::Unknown) {
+        tok.consume(prefix);
+        record.resultClass = tok.identifier();
+        ok = !record.resultClass.isEmpty();
+        while (ok && tok.consume(',')) {
+            if (tok.peek() == '{') {
+                // older GDBs list the locations of a multi-location
+                // breakpoint as bare tuples behind bkpt={...}; skip them
+                QJsonValue ignored;
+                ok = tok.value(ignored);
+                continue;
+            }
+            QString name;
+            QJsonValue val;
+            ok = tok.result(name, val);
+            if (ok) {
+                record.results.insert(name, val);
+            }
+        }
+        ok = ok && tok.atEnd();
+    }
+
+    if (!ok) {
+        record = GdbMi::Record();
+        record.text = QString::fromLocal8Bit(line);
+    }
+    return ok;
+}
@@ -0,0 +1,82 @@
+//
+// Description: Incremental parser for the GDB/MI output syntax
+//
+// SPDX-FileCopyrightText: 2021 Kate Developers
+//
+//  SPDX-License-Identifier: LGPL-2.0-only
+
+#ifndef GDBMIPARSER_H
+#define GDBMIPARSER_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+namespace GdbMi
+{
+/**
+ * One complete output record as emitted by "gdb --interpreter=mi".
+ * See "GDB/MI Output Syntax" in the GDB manual.
+ */
+struct Record {
+    enum Category {
+        Prompt, // (gdb)
+        Result, // ^done, ^running, ^error, ...
+        Exec, // *stopped, *running
+        Status, // +download
+        Notify, // =breakpoint-created, =thread-selected, ...
+        Console, // ~"..."
+        Target, // @"..."
+        Log, // &"..."
+        Unknown // anything not in MI syntax, e.g. inferior output
+    };
+
+    Category category = Unknown;
+    // the command token the record answers, -1 if none was given
+    int token = -1;
+    // the result or async class, e.g. "done" or "stopped"
+    QString resultClass;
+    // the results following the class; lists are stored as arrays, the
+    // names of results inside of lists are dropped
+    QJsonObject results;
+    // decoded text of stream records, raw line for unknown records
+    QString text;
+};
+
+/**
+ * Quote @p arg as a MI c-string, suitable as command parameter.
+ */
+QString quote(const QString &arg);
+}
+
+/**
+ * Splits the byte stream read from GDB into lines and tokenizes every
+ * complete line into a GdbMi::Record. Partial lines are kept until the
+ * rest arrives, so the parser can be fed directly from readyRead().
+ */
+class GdbMiParser
+{
+public:
+    /**
+     * Append @p data to the internal buffer and parse all complete lines.
+     * @return the records found in the completed lines, in order
+     */
+    QVector<GdbMi::Record> parse(const QByteArray &data);
+
+    /**
+     * Forget any buffered partial line.
+     */
+    void reset();
+
+    /**
+     * Tokenize one line (without the line break) into @p record.
+     * @return false if the line is not valid MI output; @p record is then of category Unknown
+     */
+    static bool parseLine(const QByteArray &line, GdbMi::Record &record);
+
+private:
+    QByteArray m_buffer;
+};
+
+#endif
@@ -0,0 +1,318 @@
+//
+// Description: Model of the variable objects of the current frame
+//
+// SPDX-FileCopyrightText: 2021 Kate Developers
+//
+//  SPDX-License-Identifier: LGPL-2.0-only
+
+#include "localsmodel.h"
+
+#include <KLocalizedString>
+
+#include <QFont>
+
+int LocalsModel::Node::row() const
+{
+    if (!parent) {
+        return 0;
+    }
+    for (size_t i = 0; i < parent->children.size(); ++i) {
+        if (parent->children[i].get() == this) {
+            return int(i);
+        }
+    }
+    return 0;
+}
+
+int LocalsModel::Node::listedChildren() const
+{
+    const int count = int(children.size());
+    return (count > 0 && children.back()->isMore) ? count - 1 : count;
+}
+
+bool LocalsModel::Node::moreAvailable() const
+{
+    return hasMore || listedChildren() < childCount;
+}
+
+LocalsModel::LocalsModel(QObject *parent)
+    : QAbstractItemModel(parent)
+{
+}
+
+LocalsModel::~LocalsModel()
+{
+}
+
+LocalsModel::Node *LocalsModel::node(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return const_cast<Node *>(&m_root);
+    }
+    return static_cast<Node *>(index.internalPointer());
+}
+
+QModelIndex LocalsModel::indexOf(Node *node, int column) const
+{
+    if (node == &m_root) {
+        return QModelIndex();
+    }
+    return createIndex(node->row(), column, node);
+}
+
+QModelIndex LocalsModel::index(int row, int column, const QModelIndex &parent) const
+{
+    Node *parentNode = node(parent);
+    if (row < 0 || row >= int(parentNode->children.size()) || column < 0 || column >= ColumnCount) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, parentNode->children[row].get());
+}
+
+QModelIndex LocalsModel::parent(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return QModelIndex();
+    }
+    return indexOf(node(index)->parent);
+}
+
+int LocalsModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0) {
+        return 0;
+    }
+    return int(node(parent)->children.size());
+}
+
+int LocalsModel::columnCount(const QModelIndex &) const
+{
+    return ColumnCount;
+}
+
+bool LocalsModel::hasChildren(const QModelIndex &parent) const
+{
+    if (parent.column() > 0) {
+        return false;
+    }
+    const Node *n = node(parent);
+    return !n->children.empty() || n->childCount > 0 || n->hasMore;
+}
+
+QVariant LocalsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    const Node *n = node(index);
+
+    if (n->isMore) {
+        if (index.column() == SymbolColumn && role == Qt::DisplayRole) {
+            if (n->parent->hasMore) {
+                return i18n("More…");
+            }
+            return i18np("One more element…", "%1 more elements…", n->parent->childCount - n->parent->listedChildren());
+        }
+        if (role == Qt::FontRole) {
+            QFont font;
+            font.setItalic(true);
+            return font;
+        }
+        return QVariant();
+    }
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return index.column() == SymbolColumn ? n->expression : n->value;
+    case Qt::ToolTipRole:
+        if (index.column() == SymbolColumn) {
+            return QStringLiteral("<qt>%1 <i>%2</i></qt>").arg(n->expression.toHtmlEscaped(), n->type.toHtmlEscaped());
+        }
+        return QStringLiteral("<qt>%1</qt>").arg(n->value.toHtmlEscaped());
+    default:
+        return QVariant();
+    }
+}
+
+QVariant LocalsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    return section == SymbolColumn ? i18n("Symbol") : i18n("Value");
+}
+
+bool LocalsModel::canFetchMore(const QModelIndex &parent) const
+{
+    // the first page is fetched on expansion, the following ones through the "more" item
+    const Node *n = node(parent);
+    return n != &m_root && !n->isMore && !n->fetching && n->children.empty() && n->moreAvailable();
+}
+
+void LocalsModel::fetchMore(const QModelIndex &parent)
+{
+    if (canFetchMore(parent)) {
+        fetchPage(node(parent));
+    }
+}
+
+bool LocalsModel::isMoreItem(const QModelIndex &index) const
+{
+    return index.isValid() && node(index)->isMore;
+}
+
+void LocalsModel::fetchNextPage(const QModelIndex &parent)
+{
+    if (parent.isValid()) {
+        fetchPage(node(parent));
+    }
+}
+
+void LocalsModel::fetchPage(Node *n)
+{
+    if (n->fetching || !n->moreAvailable()) {
+        return;
+    }
+    n->fetching = true;
+
+    const int from = n->listedChildren();
+    if (from < int(n->children.size())) {
+        // drop the "more" item while the page is on its way
+        beginRemoveRows(indexOf(n), from, from);
+        n->children.pop_back();
+        endRemoveRows();
+    }
+    n->requestedChildren = from + ChildPageSize;
+    emit childrenRequested(n->variable, from, n->requestedChildren);
+}
+
+void LocalsModel::updateMoreItem(Node *n)
+{
+    const bool hasMoreItem = !n->children.empty() && n->children.back()->isMore;
+    const bool needsMoreItem = !n->fetching && n->listedChildren() > 0 && n->moreAvailable();
+    if (hasMoreItem == needsMoreItem) {
+        if (hasMoreItem) {
+            const QModelIndex more = index(int(n->children.size()) - 1, SymbolColumn, indexOf(n));
+            emit dataChanged(more, more);
+        }
+        return;
+    }
+
+    const int row = int(n->children.size()) - (hasMoreItem ? 1 : 0);
+    if (needsMoreItem) {
+        beginInsertRows(indexOf(n), row, row);
+        std::unique_ptr<Node> more(new Node);
+        more->parent = n;
+        more->isMore = true;
+        n->children.push_back(std::move(more));
+        endInsertRows();
+    } else {
+        beginRemoveRows(indexOf(n), row, row);
+        n->children.pop_back();
+        endRemoveRows();
+    }
+}
+
+void LocalsModel::clear()
+{
+    beginResetModel();
+    m_root.children.clear();
+    m_nodes.clear();
+    endResetModel();
+}
+
+void LocalsModel::addVariable(const QString &variable, const QString &parent, const QString &expression, const QString &value, const QString &type, int childCount, bool hasMore)
+{
+    Node *parentNode = parent.isEmpty() ? &m_root : m_nodes.value(parent);
+    if (!parentNode || m_nodes.contains(variable)) {
+        // the parent was removed in the meantime
+        return;
+    }
+
+    const int row = parentNode->listedChildren();
+    beginInsertRows(indexOf(parentNode), row, row);
+    std::unique_ptr<Node> n(new Node);
+    n->parent = parentNode;
+    n->variable = variable;
+    n->expression = expression;
+    n->value = value;
+    n->type = type;
+    n->childCount = childCount;
+    n->hasMore = hasMore;
+    m_nodes.insert(variable, n.get());
+    parentNode->children.insert(parentNode->children.begin() + row, std::move(n));
+    endInsertRows();
+}
+
+void LocalsModel::changeVariable(const QString &variable, const QString &value, int childCount, bool hasMore)
+{
+    Node *n = m_nodes.value(variable);
+    if (!n) {
+        return;
+    }
+
+    n->value = value;
+    const QModelIndex valueIndex = indexOf(n, ValueColumn);
+    emit dataChanged(valueIndex, valueIndex);
+
+    if (childCount >= 0) {
+        // the old children are gone, list the new ones on the next expansion
+        removeChildren(n);
+        n->childCount = childCount;
+        n->fetching = false;
+    }
+    if (n->hasMore != hasMore) {
+        n->hasMore = hasMore;
+        updateMoreItem(n);
+    }
+}
+
+void LocalsModel::removeVariable(const QString &variable)
+{
+    Node *n = m_nodes.value(variable);
+    if (!n) {
+        return;
+    }
+    Node *parentNode = n->parent;
+    const int row = n->row();
+    beginRemoveRows(indexOf(parentNode), row, row);
+    forget(n);
+    parentNode->children.erase(parentNode->children.begin() + row);
+    endRemoveRows();
+}
+
+void LocalsModel::childrenListed(const QString &variable, bool hasMore)
+{
+    Node *n = m_nodes.value(variable);
+    if (!n) {
+        return;
+    }
+    n->fetching = false;
+    n->hasMore = hasMore;
+    if (!hasMore && n->listedChildren() < qMin(n->requestedChildren, n->childCount)) {
+        // GDB returned less than it announced, do not ask again
+        n->childCount = n->listedChildren();
+    }
+    updateMoreItem(n);
+}
+
+void LocalsModel::removeChildren(Node *n)
+{
+    if (n->children.empty()) {
+        return;
+    }
+    beginRemoveRows(indexOf(n), 0, int(n->children.size()) - 1);
+    for (const auto &child : n->children) {
+        forget(child.get());
+    }
+    n->children.clear();
+    endRemoveRows();
+}
+
+void LocalsModel::forget(Node *n)
+{
+    m_nodes.remove(n->variable);
+    for (const auto &child : n->children) {
+        forget(child.get());
+    }
+}
@@ -0,0 +1,97 @@
+//
+// Description: Model of the variable objects of the current frame
+//
+// SPDX-FileCopyrightText: 2021 Kate Developers
+//
+//  SPDX-License-Identifier: LGPL-2.0-only
+
+#ifndef LOCALSMODEL_H
+#define LOCALSMODEL_H
+
+#include <QAbstractItemModel>
+#include <QHash>
+
+#include <memory>
+#include <vector>
+
+/**
+ * Tree of GDB variable objects. Only the locals themselves are known up
+ * front, children are requested page by page when a node gets expanded or
+ * its trailing "more" item is activated.
+ */
+class LocalsModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    enum Column { SymbolColumn = 0, ValueColumn, ColumnCount };
+
+    // maximum number of children listed per request
+    static const int ChildPageSize = 100;
+
+    explicit LocalsModel(QObject *parent = nullptr);
+    ~LocalsModel() override;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    /**
+     * @return true if @p index is the placeholder that requests the next page of its parent
+     */
+    bool isMoreItem(const QModelIndex &index) const;
+
+    /**
+     * Request the next page of children of @p parent.
+     */
+    void fetchNextPage(const QModelIndex &parent);
+
+public Q_SLOTS:
+    void clear();
+    void addVariable(const QString &variable, const QString &parent, const QString &expression, const QString &value, const QString &type, int childCount, bool hasMore);
+    void changeVariable(const QString &variable, const QString &value, int childCount, bool hasMore);
+    void removeVariable(const QString &variable);
+    void childrenListed(const QString &variable, bool hasMore);
+
+Q_SIGNALS:
+    void childrenRequested(const QString &variable, int from, int to);
+
+private:
+    struct Node {
+        Node *parent = nullptr;
+        QString variable;
+        QString expression;
+        QString value;
+        QString type;
+        // number of children GDB reported, dynamic (pretty printed) variables report hasMore instead
+        int childCount = 0;
+        bool hasMore = false;
+        bool fetching = false;
+        // end of the range of the last request
+        int requestedChildren = 0;
+        bool isMore = false;
+        std::vector<std::unique_ptr<Node>> children;
+
+        int row() const;
+        int listedChildren() const;
+        bool moreAvailable() const;
+    };
+
+    Node *node(const QModelIndex &index) const;
+    QModelIndex indexOf(Node *node, int column = 0) const;
+    void fetchPage(Node *node);
+    void removeChildren(Node *node);
+    void updateMoreItem(Node *node);
+    void forget(Node *node);
+
+    Node m_root;
+    QHash<QString, Node *> m_nodes;
+};
+
+#endif
@@ -8,21 +8,21 @@
 #ifndef LOCALSVIEW_H
 #define LOCALSVIEW_H
 
-#include <QTreeWidget>
-#include <QTreeWidgetItem>
+#include <QTreeView>
 
-class LocalsView : public QTreeWidget
+class LocalsModel;
+
+class LocalsView : public QTreeView
 {
     Q_OBJECT
 public:
     LocalsView(QWidget *parent = nullptr);
     ~LocalsView() override;
 
+    LocalsModel *localsModel() const;
+
 public Q_SLOTS:
-    // An empty value string ends the locals
-    void addLocal(const QString &vString);
-    void addStruct(QTreeWidgetItem *parent, const QString &vString);
-    void addArray(QTreeWidgetItem *parent, const QString &vString);
+    void clear();
 
 Q_SIGNALS:
     void localsVisible(bool visible);
@@ -32,10 +32,9 @@ protected:
     void hideEvent(QHideEvent *event) override;
 
 private:
-    void createWrappedItem(QTreeWidgetItem *parent, const QString &name, const QString &value);
-    void createWrappedItem(QTreeWidget *parent, const QString &name, const QString &value);
-    bool m_allAdded = true;
-    QString m_local;
+    void slotClicked(const QModelIndex &index);
+
+    LocalsModel *m_model;
 };
 
 #endif
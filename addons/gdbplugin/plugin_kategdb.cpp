@@ -8,6 +8,7 @@
 //  SPDX-License-Identifier: LGPL-2.0-only
 
 #include "plugin_kategdb.h"
+#include "localsmodel.h"
 
 #include <QFile>
 #include <QFileInfo>
@@ -168,7 +169,15 @@ KatePluginGDBView::KatePluginGDBView(KTextEditor::Plugin *plugin, KTextEditor::M
 
     connect(m_debugView, &DebugView::stackFrameChanged, this, &KatePluginGDBView::stackFrameChanged);
 
-    connect(m_debugView, &DebugView::infoLocal, m_localsView, &LocalsView::addLocal);
+    connect(m_debugView, &DebugView::variableCreated, m_localsView->localsModel(), &LocalsModel::addVariable);
+
+    connect(m_debugView, &DebugView::variableChanged, m_localsView->localsModel(), &LocalsModel::changeVariable);
+
+    connect(m_debugView, &DebugView::variableRemoved, m_localsView->localsModel(), &LocalsModel::removeVariable);
+
+    connect(m_debugView, &DebugView::variablesCleared, m_localsView->localsModel(), &LocalsModel::clear);
+
+    connect(m_debugView, &DebugView::childrenListed, m_localsView->localsModel(), &LocalsModel::childrenListed);
 
     connect(m_debugView, &DebugView::threadInfo, this, &KatePluginGDBView::insertThread);
 
@@ -177,6 +186,7 @@ KatePluginGDBView::KatePluginGDBView(KTextEditor::Plugin *plugin, KTextEditor::M
     });
 
     connect(m_localsView, &LocalsView::localsVisible, m_debugView, &DebugView::slotQueryLocals);
+    connect(m_localsView->localsModel(), &LocalsModel::childrenRequested, m_debugView, &DebugView::slotListChildren);
 
     connect(m_configView, &ConfigView::configChanged, this, [this]() {
         GDBTargetConf config = m_configView->currentTarget();
@@ -559,7 +569,7 @@ void KatePluginGDBView::insertStackFrame(QString const &level, QString const &in
 
 void KatePluginGDBView::stackFrameSelected()
 {
-    m_debugView->issueCommand(QStringLiteral("(Q)f %1").arg(m_stackTree->currentIndex().row()));
+    m_debugView->selectFrame(m_stackTree->currentIndex().row());
 }
 
 void KatePluginGDBView::stackFrameChanged(int level)
@@ -592,7 +602,7 @@ void KatePluginGDBView::insertThread(int number, bool active)
 
 void KatePluginGDBView::threadSelected(int thread)
 {
-    m_debugView->issueCommand(QStringLiteral("thread %1").arg(m_threadCombo->itemData(thread).toInt()));
+    m_debugView->selectThread(m_threadCombo->itemData(thread).toInt());
 }
 
 QString KatePluginGDBView::currentWord()
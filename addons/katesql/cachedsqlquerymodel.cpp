@@ -6,95 +6,134 @@ SPDX-License-Identifier: LGPL-2.0-only
 
 #include "cachedsqlquerymodel.h"
 
-#include <QDebug>
+#include <algorithm>
 
-CachedSqlQueryModel::CachedSqlQueryModel(QObject *parent, int cacheCapacity)
-    : QSqlQueryModel(parent)
-    , cache(cacheCapacity)
+CachedSqlQueryModel::CachedSqlQueryModel(QObject *parent)
+    : QAbstractTableModel(parent)
 {
 }
 
+int CachedSqlQueryModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return m_blockEnds.isEmpty() ? 0 : m_blockEnds.last();
+}
+
+int CachedSqlQueryModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return m_columns.size();
+}
+
 QVariant CachedSqlQueryModel::data(const QModelIndex &item, int role) const
 {
     if (!item.isValid())
         return QVariant();
 
-    if (role == Qt::EditRole)
-        return QSqlQueryModel::data(item, role);
-
-    if (role != Qt::DisplayRole)
+    if (role != Qt::DisplayRole && role != Qt::EditRole)
         return QVariant();
 
-    const int row = item.row();
+    return value(item.row(), item.column());
+}
+
+QVariant CachedSqlQueryModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
+        return m_columns.value(section);
 
-    return record(row).value(item.column());
+    return QAbstractTableModel::headerData(section, orientation, role);
 }
 
-QSqlRecord CachedSqlQueryModel::record(int row) const
+bool CachedSqlQueryModel::canFetchMore(const QModelIndex &parent) const
 {
-    // if cache capacity is set to 0, don't use cache
-    if (cacheCapacity() == 0)
-        return QSqlQueryModel::record(row);
-
-    const int lookAhead = cacheCapacity() / 5;
-    const int halfLookAhead = lookAhead / 2;
-
-    if (row > cache.lastIndex()) {
-        if (row - cache.lastIndex() > lookAhead)
-            cacheRecords(row - halfLookAhead, qMin(rowCount(), row + halfLookAhead));
-        else {
-            int until = qMin(rowCount(), cache.lastIndex() + lookAhead);
-
-            while (cache.lastIndex() < until)
-                cache.append(QSqlQueryModel::record(cache.lastIndex() + 1));
-        }
-    } else if (row < cache.firstIndex()) {
-        if (cache.firstIndex() - row > lookAhead)
-            cacheRecords(qMax(0, row - halfLookAhead), row + halfLookAhead);
-        else {
-            int until = qMax(0, cache.firstIndex() - lookAhead);
-
-            while (cache.firstIndex() > until)
-                cache.prepend(QSqlQueryModel::record(cache.firstIndex() - 1));
-        }
-    }
-
-    return cache.at(row);
+    if (parent.isValid())
+        return false;
+
+    return m_moreRowsAvailable && !m_fetchingRows;
 }
 
-void CachedSqlQueryModel::clear()
+void CachedSqlQueryModel::fetchMore(const QModelIndex &parent)
 {
-    clearCache();
+    if (!canFetchMore(parent))
+        return;
 
-    QSqlQueryModel::clear();
+    m_fetchingRows = true;
+
+    emit moreRowsRequested();
 }
 
-void CachedSqlQueryModel::cacheRecords(int from, int to) const
+QVariant CachedSqlQueryModel::value(int row, int column) const
 {
-    qDebug() << "caching records from" << from << "to" << to;
+    if (row < 0 || row >= rowCount())
+        return QVariant();
 
-    for (int i = from; i <= to; ++i)
-        cache.insert(i, QSqlQueryModel::record(i));
+    const int block = blockOf(row);
+    const int firstRow = (block > 0) ? m_blockEnds.at(block - 1) : 0;
+
+    return m_blocks.at(block).value(row - firstRow, column);
 }
 
-void CachedSqlQueryModel::clearCache()
+int CachedSqlQueryModel::blockOf(int row) const
 {
-    cache.clear();
+    const int firstRow = (m_lastBlock > 0) ? m_blockEnds.at(m_lastBlock - 1) : 0;
+
+    if (m_lastBlock < m_blockEnds.size() && row >= firstRow && row < m_blockEnds.at(m_lastBlock))
+        return m_lastBlock;
+
+    m_lastBlock = int(std::upper_bound(m_blockEnds.cbegin(), m_blockEnds.cend(), row) - m_blockEnds.cbegin());
+
+    return m_lastBlock;
 }
 
-int CachedSqlQueryModel::cacheCapacity() const
+void CachedSqlQueryModel::clear()
 {
-    return cache.capacity();
+    beginResetModel();
+
+    m_columns.clear();
+    m_blocks.clear();
+    m_blockEnds.clear();
+    m_lastBlock = 0;
+    m_moreRowsAvailable = false;
+    m_fetchingRows = false;
+
+    endResetModel();
 }
 
-void CachedSqlQueryModel::setCacheCapacity(int capacity)
+void CachedSqlQueryModel::setColumns(const QStringList &columns)
 {
-    qDebug() << "cache capacity set to" << capacity;
+    beginResetModel();
+
+    m_columns = columns;
+    m_blocks.clear();
+    m_blockEnds.clear();
+    m_lastBlock = 0;
+    m_moreRowsAvailable = false;
+    m_fetchingRows = false;
+
+    endResetModel();
+}
+
+void CachedSqlQueryModel::appendRows(const SqlResultBlock &rows)
+{
+    if (rows.isEmpty())
+        return;
+
+    const int count = rowCount();
+
+    beginInsertRows(QModelIndex(), count, count + rows.rowCount() - 1);
+
+    m_blocks.append(rows);
+    m_blockEnds.append(count + rows.rowCount());
 
-    cache.setCapacity(capacity);
+    endInsertRows();
 }
 
-void CachedSqlQueryModel::queryChange()
+void CachedSqlQueryModel::setMoreRowsAvailable(bool available)
 {
-    clearCache();
+    m_moreRowsAvailable = available;
+    m_fetchingRows = false;
 }
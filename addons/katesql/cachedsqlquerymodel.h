@@ -7,33 +7,56 @@ SPDX-License-Identifier: LGPL-2.0-only
 #ifndef CACHEDSQLQUERYMODEL_H
 #define CACHEDSQLQUERYMODEL_H
 
-#include <QContiguousCache>
-#include <QSqlQueryModel>
-#include <QSqlRecord>
+#include "sqlresultblock.h"
 
-class CachedSqlQueryModel : public QSqlQueryModel
+#include <QAbstractTableModel>
+#include <QStringList>
+
+/// keeps the rows of a result set as they are streamed in by a SQLQueryWorker,
+/// in the columnar blocks the worker produced them in. Rows beyond the first
+/// window are only requested when a view scrolls to them, see moreRowsRequested().
+class CachedSqlQueryModel : public QAbstractTableModel
 {
     Q_OBJECT
 public:
-    explicit CachedSqlQueryModel(QObject *parent = nullptr, int cacheCapacity = 1000);
+    explicit CachedSqlQueryModel(QObject *parent = nullptr);
 
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &item, int role = Qt::DisplayRole) const override;
-    QSqlRecord record(int row) const;
-    void clear() override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
 
-    int cacheCapacity() const;
+    QVariant value(int row, int column) const;
 
 public Q_SLOTS:
-    void clearCache();
-    void setCacheCapacity(int);
+    virtual void clear();
+    /// start a new result set, drops all rows
+    void setColumns(const QStringList &columns);
+    void appendRows(const SqlResultBlock &rows);
+    /// the result set has rows that were not fetched yet, answers moreRowsRequested()
+    void setMoreRowsAvailable(bool available);
 
-protected:
-    void queryChange() override;
+Q_SIGNALS:
+    /// a view needs the next window of rows
+    void moreRowsRequested();
 
 private:
-    void cacheRecords(int from, int to) const;
+    /// index into m_blocks of the block holding @p row
+    int blockOf(int row) const;
 
-    mutable QContiguousCache<QSqlRecord> cache;
+private:
+    QStringList m_columns;
+    QVector<SqlResultBlock> m_blocks;
+    // m_blockEnds[i] is the number of rows in the blocks up to and including i
+    QVector<int> m_blockEnds;
+    // views read row after row, start the search where the last one ended
+    mutable int m_lastBlock = 0;
+
+    bool m_moreRowsAvailable = false;
+    bool m_fetchingRows = false;
 };
 
 #endif // CACHEDSQLQUERYMODEL_H
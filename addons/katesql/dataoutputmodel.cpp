@@ -21,7 +21,7 @@ inline bool isNumeric(const QVariant::Type type)
 }
 
 DataOutputModel::DataOutputModel(QObject *parent)
-    : CachedSqlQueryModel(parent, 1000)
+    : CachedSqlQueryModel(parent)
 {
     m_useSystemLocale = false;
 
@@ -40,15 +40,6 @@ DataOutputModel::~DataOutputModel()
     qDeleteAll(m_styles);
 }
 
-void DataOutputModel::clear()
-{
-    beginResetModel();
-
-    CachedSqlQueryModel::clear();
-
-    endResetModel();
-}
-
 void DataOutputModel::readConfig()
 {
     KConfigGroup config(KSharedConfig::openConfig(), "KateSQLPlugin");
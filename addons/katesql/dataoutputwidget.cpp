@@ -26,23 +26,32 @@
 #include <QElapsedTimer>
 #include <QFile>
 #include <QHeaderView>
+#include <QLabel>
 #include <QLayout>
+#include <QLocale>
 #include <QSize>
-#include <QSqlError>
-#include <QSqlQuery>
 #include <QStyle>
 #include <QTextStream>
 #include <QTime>
 #include <QTimer>
 
+#include <algorithm>
+#include <vector>
+
 DataOutputWidget::DataOutputWidget(QWidget *parent)
     : QWidget(parent)
     , m_model(new DataOutputModel(this))
     , m_view(new DataOutputView(this))
+    , m_statusTimer(new QTimer(this))
+    , m_running(false)
     , m_isEmpty(true)
 {
     m_view->setModel(m_model);
 
+    // keep the elapsed time moving while the server has not sent anything yet
+    m_statusTimer->setInterval(250);
+    connect(m_statusTimer, &QTimer::timeout, this, &DataOutputWidget::updateStatus);
+
     QHBoxLayout *layout = new QHBoxLayout(this);
     m_dataLayout = new QVBoxLayout();
 
@@ -59,6 +68,13 @@ DataOutputWidget::DataOutputWidget(QWidget *parent)
 
     QAction *action;
 
+    m_cancelAction = new QAction(QIcon::fromTheme(QStringLiteral("process-stop")), i18nc("@action:intoolbar", "Stop query"), this);
+    m_cancelAction->setEnabled(false);
+    toolbar->addAction(m_cancelAction);
+    connect(m_cancelAction, &QAction::triggered, this, &DataOutputWidget::cancelRequested);
+
+    toolbar->addSeparator();
+
     action = new QAction(QIcon::fromTheme(QStringLiteral("distribute-horizontal-x")), i18nc("@action:intoolbar", "Resize columns to contents"), this);
     toolbar->addAction(action);
     connect(action, &QAction::triggered, this, &DataOutputWidget::resizeColumnsToContents);
@@ -87,7 +103,11 @@ DataOutputWidget::DataOutputWidget(QWidget *parent)
     toolbar->addAction(toggleAction);
     connect(toggleAction, &QAction::triggered, this, &DataOutputWidget::slotToggleLocale);
 
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
     m_dataLayout->addWidget(m_view);
+    m_dataLayout->addWidget(m_statusLabel);
 
     layout->addWidget(toolbar);
     layout->addLayout(m_dataLayout);
@@ -100,33 +120,160 @@ DataOutputWidget::~DataOutputWidget()
 {
 }
 
-void DataOutputWidget::showQueryResultSets(QSqlQuery &query)
+void DataOutputWidget::beginQuery()
+{
+    clearResults();
+
+    m_exportedRows = -1;
+    m_resultComplete = false;
+    m_running = true;
+    m_cancelAction->setEnabled(true);
+
+    m_queryTime.start();
+    m_statusTimer->start();
+
+    updateStatus();
+}
+
+void DataOutputWidget::showColumns(const QStringList &columns)
 {
     /// TODO: loop resultsets if > 1
-    /// NOTE from Qt Documentation:
-    /// When one of the statements is a non-select statement a count of affected rows
-    /// may be available instead of a result set.
+    m_model->setColumns(columns);
+
+    m_isEmpty = false;
+
+    raise();
+}
+
+void DataOutputWidget::appendRows(const SqlResultBlock &rows)
+{
+    const bool first = (m_model->rowCount() == 0);
+
+    m_model->appendRows(rows);
+
+    // size the columns after the first rows, later batches must not make the view jump
+    if (first)
+        QTimer::singleShot(0, this, &DataOutputWidget::resizeColumnsToContents);
+
+    updateStatus();
+}
 
-    if (!query.isSelect() || query.lastError().isValid())
+void DataOutputWidget::endQuery(bool completed)
+{
+    if (!m_running)
         return;
 
-    m_model->setQuery(query);
+    if (m_exportedRows < 0)
+        m_resultComplete = completed;
 
-    m_isEmpty = false;
+    m_running = false;
+    m_cancelAction->setEnabled(false);
+    m_statusTimer->stop();
 
-    QTimer::singleShot(0, this, &DataOutputWidget::resizeColumnsToContents);
+    // an export that did not finish has nothing more to deliver
+    resetExport();
 
-    raise();
+    updateStatus();
+}
+
+void DataOutputWidget::beginExport()
+{
+    m_export = m_requestedExport;
+    m_requestedExport = NoExport;
+    m_exportText.clear();
+    m_exportedRows = 0;
+
+    m_running = true;
+    m_cancelAction->setEnabled(true);
+
+    m_queryTime.start();
+    m_statusTimer->start();
+
+    updateStatus();
+}
+
+void DataOutputWidget::appendExportChunk(const QString &chunk, int rows)
+{
+    if (m_export == NoExport)
+        return;
+
+    // each chunk goes into the document as it arrives, the cursor of the view follows it
+    if (m_export == ExportToDocument && m_exportView)
+        m_exportView->insertText(chunk);
+    else if (m_export == ExportToClipboard)
+        m_exportText += chunk;
+
+    m_exportedRows = rows;
+
+    updateStatus();
+}
+
+void DataOutputWidget::finishExport()
+{
+    if (m_export == ExportToDocument && m_exportView) {
+        m_exportView->setFocus();
+    } else if (m_export == ExportToClipboard) {
+        QApplication::clipboard()->setText(m_exportText);
+    }
+
+    resetExport();
+
+    // the export consumed the result set, exports of the shown rows are left
+    m_resultComplete = false;
+}
+
+void DataOutputWidget::resetExport()
+{
+    m_export = NoExport;
+    m_exportView.clear();
+    m_exportText.clear();
+}
+
+void DataOutputWidget::updateStatus()
+{
+    if (!m_queryTime.isValid()) {
+        m_statusLabel->clear();
+        return;
+    }
+
+    const qint64 msecs = m_queryTime.elapsed();
+    const bool exporting = (m_exportedRows >= 0);
+    const int rows = exporting ? m_exportedRows : m_model->rowCount();
+
+    const QString seconds = QLocale().toString(msecs / 1000.0, 'f', 2);
+    const QString rowsPerSecond = QLocale().toString(msecs > 0 ? qRound64(rows * 1000.0 / msecs) : 0);
+
+    const QString status = exporting ? i18ncp("@info", "%1 row exported in %2 s (%3 rows/s)", "%1 rows exported in %2 s (%3 rows/s)", rows, seconds, rowsPerSecond)
+                                     : i18ncp("@info", "%1 row in %2 s (%3 rows/s)", "%1 rows in %2 s (%3 rows/s)", rows, seconds, rowsPerSecond);
+
+    if (!m_running)
+        m_statusLabel->setText(status);
+    else if (exporting)
+        m_statusLabel->setText(i18nc("@info", "Exporting… %1", status));
+    else
+        m_statusLabel->setText(i18nc("@info", "Running query… %1", status));
 }
 
 void DataOutputWidget::clearResults()
 {
-    // avoid crash when calling QSqlQueryModel::clear() after removing connection from the QSqlDatabase list
+    // rows of a running query would keep coming in
+    if (m_running)
+        emit cancelRequested();
+
+    if (!m_running) {
+        m_queryTime.invalidate();
+        m_statusLabel->clear();
+    }
+
+    m_resultComplete = false;
+
     if (m_isEmpty)
         return;
 
     m_model->clear();
 
+    emit resultsCleared();
+
     m_isEmpty = true;
 
     /// HACK needed to refresh headers. please correct if there's a better way
@@ -168,9 +315,6 @@ void DataOutputWidget::slotCopySelected()
     if (m_model->rowCount() <= 0)
         return;
 
-    while (m_model->canFetchMore())
-        m_model->fetchMore();
-
     if (!m_view->selectionModel()->hasSelection())
         m_view->selectAll();
 
@@ -188,8 +332,8 @@ void DataOutputWidget::slotExport()
     if (m_model->rowCount() <= 0)
         return;
 
-    while (m_model->canFetchMore())
-        m_model->fetchMore();
+    // export the rows of an incomplete result set as they are shown
+    const bool wholeResult = !m_running && m_resultComplete && isWholeResultSelected();
 
     if (!m_view->selectionModel()->hasSelection())
         m_view->selectAll();
@@ -203,23 +347,41 @@ void DataOutputWidget::slotExport()
     bool outputInClipboard = wizard.field(QStringLiteral("outClipboard")).toBool();
     bool outputInFile = wizard.field(QStringLiteral("outFile")).toBool();
 
-    bool exportColumnNames = wizard.field(QStringLiteral("exportColumnNames")).toBool();
-    bool exportLineNumbers = wizard.field(QStringLiteral("exportLineNumbers")).toBool();
+    SqlExportOptions options;
 
-    Options opt = NoOptions;
-
-    if (exportColumnNames)
-        opt |= ExportColumnNames;
-    if (exportLineNumbers)
-        opt |= ExportLineNumbers;
+    options.columnNames = wizard.field(QStringLiteral("exportColumnNames")).toBool();
+    options.lineNumbers = wizard.field(QStringLiteral("exportLineNumbers")).toBool();
 
     bool quoteStrings = wizard.field(QStringLiteral("checkQuoteStrings")).toBool();
     bool quoteNumbers = wizard.field(QStringLiteral("checkQuoteNumbers")).toBool();
 
-    QChar stringsQuoteChar = (quoteStrings) ? wizard.field(QStringLiteral("quoteStringsChar")).toString().at(0) : QLatin1Char('\0');
-    QChar numbersQuoteChar = (quoteNumbers) ? wizard.field(QStringLiteral("quoteNumbersChar")).toString().at(0) : QLatin1Char('\0');
+    options.stringsQuoteChar = (quoteStrings) ? wizard.field(QStringLiteral("quoteStringsChar")).toString().at(0) : QLatin1Char('\0');
+    options.numbersQuoteChar = (quoteNumbers) ? wizard.field(QStringLiteral("quoteNumbersChar")).toString().at(0) : QLatin1Char('\0');
+
+    options.fieldDelimiter = wizard.field(QStringLiteral("fieldDelimiter")).toString();
+
+    if (wholeResult) {
+        // the worker writes the fetched rows and the rest of the result set in chunks,
+        // instead of converting the whole result set to text at once
+        if (outputInDocument) {
+            KTextEditor::MainWindow *mw = KTextEditor::Editor::instance()->application()->activeMainWindow();
 
-    QString fieldDelimiter = wizard.field(QStringLiteral("fieldDelimiter")).toString();
+            m_exportView = mw->activeView();
+
+            if (!m_exportView)
+                return;
+
+            m_requestedExport = ExportToDocument;
+        } else if (outputInClipboard) {
+            m_requestedExport = ExportToClipboard;
+        } else if (outputInFile) {
+            options.fileName = wizard.field(QStringLiteral("outFileUrl")).toString();
+            m_requestedExport = ExportToFile;
+        }
+
+        emit exportRequested(options);
+        return;
+    }
 
     if (outputInDocument) {
         KTextEditor::MainWindow *mw = KTextEditor::Editor::instance()->application()->activeMainWindow();
@@ -231,7 +393,7 @@ void DataOutputWidget::slotExport()
         QString text;
         QTextStream stream(&text);
 
-        exportData(stream, stringsQuoteChar, numbersQuoteChar, fieldDelimiter, opt);
+        exportData(stream, options);
 
         kv->insertText(text);
         kv->setFocus();
@@ -239,7 +401,7 @@ void DataOutputWidget::slotExport()
         QString text;
         QTextStream stream(&text);
 
-        exportData(stream, stringsQuoteChar, numbersQuoteChar, fieldDelimiter, opt);
+        exportData(stream, options);
 
         QApplication::clipboard()->setText(text);
     } else if (outputInFile) {
@@ -248,7 +410,7 @@ void DataOutputWidget::slotExport()
         if (data.open(QFile::WriteOnly | QFile::Truncate)) {
             QTextStream stream(&data);
 
-            exportData(stream, stringsQuoteChar, numbersQuoteChar, fieldDelimiter, opt);
+            exportData(stream, options);
 
             stream.flush();
         } else {
@@ -257,87 +419,75 @@ void DataOutputWidget::slotExport()
     }
 }
 
-void DataOutputWidget::exportData(QTextStream &stream, const QChar stringsQuoteChar, const QChar numbersQuoteChar, const QString &fieldDelimiter, const Options opt)
+bool DataOutputWidget::isWholeResultSelected() const
+{
+    const QItemSelection selection = m_view->selectionModel()->selection();
+
+    if (selection.isEmpty())
+        return true;
+
+    if (selection.size() != 1)
+        return false;
+
+    const QItemSelectionRange &range = selection.first();
+
+    return range.top() == 0 && range.left() == 0 && range.bottom() == m_model->rowCount() - 1 && range.right() == m_model->columnCount() - 1;
+}
+
+void DataOutputWidget::exportData(QTextStream &stream, const SqlExportOptions &options)
 {
     QItemSelectionModel *selectionModel = m_view->selectionModel();
 
     if (!selectionModel->hasSelection())
         return;
 
-    QString fixedFieldDelimiter = fieldDelimiter;
-
-    /// FIXME: ugly workaround...
-    fixedFieldDelimiter.replace(QLatin1String("\\t"), QLatin1String("\t"));
-    fixedFieldDelimiter.replace(QLatin1String("\\r"), QLatin1String("\r"));
-    fixedFieldDelimiter.replace(QLatin1String("\\n"), QLatin1String("\n"));
-
     QElapsedTimer t;
     t.start();
 
-    QSet<int> columns;
-    QSet<int> rows;
-    QHash<QPair<int, int>, QString> snapshot;
-
-    const QModelIndexList selectedIndexes = selectionModel->selectedIndexes();
+    const QItemSelection selection = selectionModel->selection();
 
-    snapshot.reserve(selectedIndexes.count());
+    // rows and columns touched by the selection, cells outside of it are left empty
+    std::vector<bool> rows(m_model->rowCount());
+    std::vector<bool> columns(m_model->columnCount());
 
-    for (const QModelIndex &index : selectedIndexes) {
-        const QVariant data = index.data(Qt::UserRole);
-
-        const int col = index.column();
-        const int row = index.row();
+    for (const QItemSelectionRange &range : selection) {
+        std::fill(rows.begin() + range.top(), rows.begin() + range.bottom() + 1, true);
+        std::fill(columns.begin() + range.left(), columns.begin() + range.right() + 1, true);
+    }
 
-        if (!columns.contains(col))
-            columns.insert(col);
-        if (!rows.contains(row))
-            rows.insert(row);
+    SqlExportWriter writer(stream, options);
 
-        if (data.type() < 7) // is numeric or boolean
-        {
-            if (numbersQuoteChar != QLatin1Char('\0'))
-                snapshot[qMakePair(row, col)] = numbersQuoteChar + data.toString() + numbersQuoteChar;
-            else
-                snapshot[qMakePair(row, col)] = data.toString();
-        } else {
-            if (stringsQuoteChar != QLatin1Char('\0'))
-                snapshot[qMakePair(row, col)] = stringsQuoteChar + data.toString() + stringsQuoteChar;
-            else
-                snapshot[qMakePair(row, col)] = data.toString();
-        }
+    QStringList columnNames;
+    for (int col = 0; col < int(columns.size()); ++col) {
+        if (columns[col])
+            columnNames << m_model->headerData(col, Qt::Horizontal).toString();
     }
 
-    if (opt.testFlag(ExportColumnNames)) {
-        if (opt.testFlag(ExportLineNumbers))
-            stream << fixedFieldDelimiter;
+    writer.writeHeader(columnNames);
 
-        QSetIterator<int> j(columns);
-        while (j.hasNext()) {
-            const QVariant data = m_model->headerData(j.next(), Qt::Horizontal);
+    const bool singleRange = (selection.size() == 1);
 
-            if (stringsQuoteChar != QLatin1Char('\0'))
-                stream << stringsQuoteChar + data.toString() + stringsQuoteChar;
-            else
-                stream << data.toString();
+    for (int row = 0; row < int(rows.size()); ++row) {
+        if (!rows[row])
+            continue;
 
-            if (j.hasNext())
-                stream << fixedFieldDelimiter;
-        }
-        stream << "\n";
-    }
+        writer.beginRow(row + 1);
 
-    for (const int row : qAsConst(rows)) {
-        if (opt.testFlag(ExportLineNumbers))
-            stream << row + 1 << fixedFieldDelimiter;
+        for (int col = 0; col < int(columns.size()); ++col) {
+            if (!columns[col])
+                continue;
 
-        QSetIterator<int> j(columns);
-        while (j.hasNext()) {
-            stream << snapshot.value(qMakePair(row, j.next()));
+            const QModelIndex index = m_model->index(row, col);
 
-            if (j.hasNext())
-                stream << fixedFieldDelimiter;
+            if (!singleRange && !selection.contains(index)) {
+                writer.writeEmptyField();
+                continue;
+            }
+
+            writer.writeField(index.data(Qt::UserRole).toString(), SqlExportWriter::isNumeric(m_model->value(row, col)));
         }
-        stream << "\n";
+
+        writer.endRow();
     }
 
     qDebug() << "Export in" << t.elapsed() << "msecs";
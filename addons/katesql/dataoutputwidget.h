@@ -7,12 +7,24 @@
 #ifndef DATAOUTPUTWIDGET_H
 #define DATAOUTPUTWIDGET_H
 
+class QAction;
+class QLabel;
 class QTextStream;
+class QTimer;
 class QVBoxLayout;
-class QSqlQuery;
 class DataOutputModel;
 class DataOutputView;
 
+namespace KTextEditor
+{
+class View;
+}
+
+#include "sqlexport.h"
+#include "sqlresultblock.h"
+
+#include <QElapsedTimer>
+#include <QPointer>
 #include <QWidget>
 
 class DataOutputWidget : public QWidget
@@ -20,14 +32,11 @@ class DataOutputWidget : public QWidget
     Q_OBJECT
 
 public:
-    enum Option { NoOptions = 0x0, ExportColumnNames = 0x1, ExportLineNumbers = 0x2 };
-
-    Q_DECLARE_FLAGS(Options, Option)
-
     DataOutputWidget(QWidget *parent);
     ~DataOutputWidget() override;
 
-    void exportData(QTextStream &stream, const QChar stringsQuoteChar = QLatin1Char('\0'), const QChar numbersQuoteChar = QLatin1Char('\0'), const QString &fieldDelimiter = QStringLiteral("\t"), const Options opt = NoOptions);
+    /// write the selected cells of the view
+    void exportData(QTextStream &stream, const SqlExportOptions &options = SqlExportOptions());
 
     DataOutputModel *model() const
     {
@@ -39,7 +48,19 @@ public:
     }
 
 public Q_SLOTS:
-    void showQueryResultSets(QSqlQuery &query);
+    /// a query is running, results follow through showColumns() and appendRows()
+    void beginQuery();
+    void showColumns(const QStringList &columns);
+    void appendRows(const SqlResultBlock &rows);
+    /// @p completed is false if the query failed or was cancelled
+    void endQuery(bool completed);
+
+    /// an export requested with exportRequested() is running
+    void beginExport();
+    void appendExportChunk(const QString &chunk, int rows);
+    /// the export completed, deliver the text to its target
+    void finishExport();
+
     void resizeColumnsToContents();
     void resizeRowsToContents();
     void clearResults();
@@ -48,8 +69,40 @@ public Q_SLOTS:
     void slotCopySelected();
     void slotExport();
 
+Q_SIGNALS:
+    void cancelRequested();
+    /// the shown rows were dropped, the rest of their result set is not needed anymore
+    void resultsCleared();
+    /// the whole result set is to be exported, the rest of it straight from the database
+    void exportRequested(const SqlExportOptions &options);
+
+private Q_SLOTS:
+    void updateStatus();
+
+private:
+    enum ExportTarget { NoExport, ExportToDocument, ExportToClipboard, ExportToFile };
+
+    bool isWholeResultSelected() const;
+    void resetExport();
+
 private:
     QVBoxLayout *m_dataLayout;
+    QLabel *m_statusLabel;
+    QAction *m_cancelAction;
+
+    QElapsedTimer m_queryTime;
+    QTimer *m_statusTimer;
+    bool m_running;
+    // all rows of the result set arrived
+    bool m_resultComplete = false;
+
+    ExportTarget m_requestedExport = NoExport;
+    ExportTarget m_export = NoExport;
+    QPointer<KTextEditor::View> m_exportView;
+    // the clipboard takes the text as a whole
+    QString m_exportText;
+    // rows written by the last export, -1 if the last action was a query
+    int m_exportedRows = -1;
 
     /// TODO: manage multiple views for query with multiple resultsets
     DataOutputModel *m_model;
@@ -58,6 +111,4 @@ private:
     bool m_isEmpty;
 };
 
-Q_DECLARE_OPERATORS_FOR_FLAGS(DataOutputWidget::Options)
-
 #endif // DATAOUTPUTWIDGET_H
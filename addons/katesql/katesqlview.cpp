@@ -33,7 +33,6 @@
 
 #include <QApplication>
 #include <QMenu>
-#include <QSqlQuery>
 #include <QString>
 #include <QVBoxLayout>
 #include <QWidgetAction>
@@ -73,7 +72,18 @@ KateSQLView::KateSQLView(KTextEditor::Plugin *plugin, KTextEditor::MainWindow *m
     connect(m_connectionsGroup, &QActionGroup::triggered, this, &KateSQLView::slotConnectionSelectedFromMenu);
     connect(m_manager, &SQLManager::error, this, &KateSQLView::slotError);
     connect(m_manager, &SQLManager::success, this, &KateSQLView::slotSuccess);
-    connect(m_manager, &SQLManager::queryActivated, this, &KateSQLView::slotQueryActivated);
+    connect(m_manager, &SQLManager::queryStarted, this, &KateSQLView::slotQueryStarted);
+    connect(m_manager, &SQLManager::queryColumnsReady, this, &KateSQLView::slotQueryColumnsReady);
+    connect(m_manager, &SQLManager::queryRowsReady, m_outputWidget->dataOutputWidget(), &DataOutputWidget::appendRows);
+    connect(m_manager, &SQLManager::moreRowsAvailable, m_outputWidget->dataOutputWidget()->model(), &DataOutputModel::setMoreRowsAvailable);
+    connect(m_outputWidget->dataOutputWidget()->model(), &DataOutputModel::moreRowsRequested, m_manager, &SQLManager::fetchMoreRows);
+    connect(m_manager, &SQLManager::queryStopped, this, &KateSQLView::slotQueryStopped);
+    connect(m_manager, &SQLManager::exportStarted, this, &KateSQLView::slotExportStarted);
+    connect(m_manager, &SQLManager::exportChunkReady, m_outputWidget->dataOutputWidget(), &DataOutputWidget::appendExportChunk);
+    connect(m_manager, &SQLManager::exportFinished, m_outputWidget->dataOutputWidget(), &DataOutputWidget::finishExport);
+    connect(m_outputWidget->dataOutputWidget(), &DataOutputWidget::cancelRequested, m_manager, &SQLManager::cancelQuery);
+    connect(m_outputWidget->dataOutputWidget(), &DataOutputWidget::resultsCleared, m_manager, &SQLManager::closeResult);
+    connect(m_outputWidget->dataOutputWidget(), &DataOutputWidget::exportRequested, m_manager, &SQLManager::exportResult);
     connect(m_manager, &SQLManager::connectionCreated, this, &KateSQLView::slotConnectionCreated);
     connect(m_manager, &SQLManager::connectionAboutToBeClosed, this, &KateSQLView::slotConnectionAboutToBeClosed);
     connect(m_connectionsComboBox, QOverload<const QString &>::of(&QComboBox::currentIndexChanged), this, &KateSQLView::slotConnectionChanged);
@@ -127,12 +137,11 @@ void KateSQLView::setupActions()
     collection->setDefaultShortcut(action, QKeySequence(Qt::CTRL | Qt::Key_E));
     connect(action, &QAction::triggered, this, &KateSQLView::slotRunQuery);
 
-    /// TODO: stop sql query
-    //   action = collection->addAction("sql_stop");
-    //   action->setText( i18n("Stop query") );
-    //   action->setIcon( KIcon("process-stop") );
-    //   action->setShortcut( QKeySequence(Qt::ALT | Qt::Key_F5) );
-    //   connect( action , SIGNAL(triggered()) , this , SLOT(stopQuery()));
+    m_stopQueryAction = collection->addAction(QStringLiteral("query_stop"));
+    m_stopQueryAction->setText(i18nc("@action:inmenu", "Stop query"));
+    m_stopQueryAction->setIcon(QIcon::fromTheme(QStringLiteral("process-stop")));
+    m_stopQueryAction->setEnabled(false);
+    connect(m_stopQueryAction, &QAction::triggered, m_manager, &SQLManager::cancelQuery);
 }
 
 void KateSQLView::slotSQLMenuAboutToShow()
@@ -278,8 +287,6 @@ void KateSQLView::slotConnectionReconnect()
 
 void KateSQLView::slotConnectionAboutToBeClosed(const QString &name)
 {
-    /// must delete the QSqlQuery object inside the model before closing connection
-
     if (name == m_currentResultsetConnection)
         m_outputWidget->dataOutputWidget()->clearResults();
 }
@@ -320,19 +327,42 @@ void KateSQLView::slotError(const QString &message)
 void KateSQLView::slotSuccess(const QString &message)
 {
     m_outputWidget->textOutputWidget()->showSuccessMessage(message);
+
+    if (m_resultSetShown)
+        return;
+
     m_outputWidget->setCurrentWidget(m_outputWidget->textOutputWidget());
     m_mainWindow->showToolView(m_outputToolView);
 }
 
-void KateSQLView::slotQueryActivated(QSqlQuery &query, const QString &connection)
+void KateSQLView::slotQueryStarted(const QString &connection)
 {
-    if (query.isSelect()) {
-        m_currentResultsetConnection = connection;
+    m_currentResultsetConnection = connection;
+    m_resultSetShown = false;
 
-        m_outputWidget->dataOutputWidget()->showQueryResultSets(query);
-        m_outputWidget->setCurrentWidget(m_outputWidget->dataOutputWidget());
-        m_mainWindow->showToolView(m_outputToolView);
-    }
+    m_stopQueryAction->setEnabled(true);
+    m_outputWidget->dataOutputWidget()->beginQuery();
+}
+
+void KateSQLView::slotQueryColumnsReady(const QStringList &columns)
+{
+    m_resultSetShown = true;
+
+    m_outputWidget->dataOutputWidget()->showColumns(columns);
+    m_outputWidget->setCurrentWidget(m_outputWidget->dataOutputWidget());
+    m_mainWindow->showToolView(m_outputToolView);
+}
+
+void KateSQLView::slotExportStarted()
+{
+    m_stopQueryAction->setEnabled(true);
+    m_outputWidget->dataOutputWidget()->beginExport();
+}
+
+void KateSQLView::slotQueryStopped(bool completed)
+{
+    m_stopQueryAction->setEnabled(false);
+    m_outputWidget->dataOutputWidget()->endQuery(completed);
 }
 
 void KateSQLView::slotConnectionCreated(const QString &name)
@@ -26,7 +26,7 @@ class SQLManager;
 class KConfigBase;
 class KComboBox;
 
-class QSqlQuery;
+class QAction;
 class QActionGroup;
 
 #include <KXMLGUIClient>
@@ -58,7 +58,10 @@ public Q_SLOTS:
     void slotRunQuery();
     void slotError(const QString &message);
     void slotSuccess(const QString &message);
-    void slotQueryActivated(QSqlQuery &query, const QString &connection);
+    void slotQueryStarted(const QString &connection);
+    void slotQueryColumnsReady(const QStringList &columns);
+    void slotExportStarted();
+    void slotQueryStopped(bool completed);
     void slotConnectionCreated(const QString &name);
     void slotGlobalSettingsChanged();
     void slotSQLMenuAboutToShow();
@@ -72,6 +75,7 @@ private:
     QWidget *m_outputToolView;
     QWidget *m_schemaBrowserToolView;
     QActionGroup *m_connectionsGroup;
+    QAction *m_stopQueryAction;
 
     KateSQLOutputWidget *m_outputWidget;
 
@@ -82,6 +86,8 @@ private:
     SQLManager *m_manager;
 
     QString m_currentResultsetConnection;
+    // the running query produced a result set, which stays in front when it completes
+    bool m_resultSetShown = false;
 
     KTextEditor::MainWindow *m_mainWindow;
 };
@@ -0,0 +1,79 @@
+/*
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#include "sqlexport.h"
+
+#include <QTextStream>
+
+SqlExportWriter::SqlExportWriter(QTextStream &stream, const SqlExportOptions &options)
+    : m_stream(stream)
+    , m_options(options)
+    , m_fieldDelimiter(options.fieldDelimiter)
+{
+    /// FIXME: ugly workaround...
+    m_fieldDelimiter.replace(QLatin1String("\\t"), QLatin1String("\t"));
+    m_fieldDelimiter.replace(QLatin1String("\\r"), QLatin1String("\r"));
+    m_fieldDelimiter.replace(QLatin1String("\\n"), QLatin1String("\n"));
+}
+
+void SqlExportWriter::writeHeader(const QStringList &columns)
+{
+    if (!m_options.columnNames)
+        return;
+
+    if (m_options.lineNumbers)
+        m_stream << m_fieldDelimiter;
+
+    m_firstField = true;
+
+    for (const QString &column : columns)
+        writeField(column, false);
+
+    endRow();
+}
+
+void SqlExportWriter::beginRow(int number)
+{
+    if (m_options.lineNumbers)
+        m_stream << number << m_fieldDelimiter;
+
+    m_firstField = true;
+}
+
+void SqlExportWriter::writeField(const QString &text, bool numeric)
+{
+    writeDelimiter();
+
+    const QChar quoteChar = numeric ? m_options.numbersQuoteChar : m_options.stringsQuoteChar;
+
+    if (quoteChar != QLatin1Char('\0'))
+        m_stream << quoteChar << text << quoteChar;
+    else
+        m_stream << text;
+}
+
+void SqlExportWriter::writeEmptyField()
+{
+    writeDelimiter();
+}
+
+void SqlExportWriter::endRow()
+{
+    m_stream << "\n";
+}
+
+bool SqlExportWriter::isNumeric(const QVariant &value)
+{
+    return value.type() < 7;
+}
+
+void SqlExportWriter::writeDelimiter()
+{
+    if (!m_firstField)
+        m_stream << m_fieldDelimiter;
+
+    m_firstField = false;
+}
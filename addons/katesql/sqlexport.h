@@ -0,0 +1,56 @@
+/*
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#ifndef SQLEXPORT_H
+#define SQLEXPORT_H
+
+class QTextStream;
+
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+struct SqlExportOptions {
+    QChar stringsQuoteChar = QLatin1Char('\0');
+    QChar numbersQuoteChar = QLatin1Char('\0');
+    QString fieldDelimiter = QStringLiteral("\t");
+    bool columnNames = false;
+    bool lineNumbers = false;
+    /// if set, the rows are written to this file, otherwise they are handed out as text
+    QString fileName;
+};
+
+Q_DECLARE_METATYPE(SqlExportOptions)
+
+/// writes rows as delimiter separated text, one field after the other
+class SqlExportWriter
+{
+public:
+    SqlExportWriter(QTextStream &stream, const SqlExportOptions &options);
+
+    void writeHeader(const QStringList &columns);
+
+    /// @p number is the line number written in front of the row, if requested
+    void beginRow(int number);
+    void writeField(const QString &text, bool numeric);
+    void writeEmptyField();
+    void endRow();
+
+    /// numbers and booleans use the numbers quote char
+    static bool isNumeric(const QVariant &value);
+
+private:
+    void writeDelimiter();
+
+private:
+    QTextStream &m_stream;
+    const SqlExportOptions m_options;
+    QString m_fieldDelimiter;
+    bool m_firstField = true;
+};
+
+#endif // SQLEXPORT_H
@@ -12,9 +12,10 @@
 #include <KLocalizedString>
 
 #include <QDebug>
+#include <QLocale>
 #include <QSqlDatabase>
-#include <QSqlDriver>
 #include <QSqlError>
+#include <QThread>
 
 using KWallet::Wallet;
 
@@ -22,10 +23,21 @@ SQLManager::SQLManager(QObject *parent)
     : QObject(parent)
     , m_model(new ConnectionModel(this))
 {
+    qRegisterMetaType<SqlResultBlock>();
+    qRegisterMetaType<SqlExportOptions>();
 }
 
 SQLManager::~SQLManager()
 {
+    const auto workers = m_workers;
+    for (SQLQueryWorker *worker : workers)
+        retireWorker(worker);
+
+    // the worker threads are our children, wait until the last query returned
+    const auto threads = findChildren<QThread *>(QString(), Qt::FindDirectChildrenOnly);
+    for (QThread *thread : threads)
+        thread->wait();
+
     for (int i = 0; i < m_model->rowCount(); i++) {
         QString connection = m_model->data(m_model->index(i), Qt::DisplayRole).toString();
         QSqlDatabase::removeDatabase(connection);
@@ -37,6 +49,8 @@ SQLManager::~SQLManager()
 
 void SQLManager::createConnection(const Connection &conn)
 {
+    removeWorker(conn.name);
+
     if (QSqlDatabase::contains(conn.name)) {
         qDebug() << "connection" << conn.name << "already exist";
         QSqlDatabase::removeDatabase(conn.name);
@@ -146,6 +160,8 @@ void SQLManager::reopenConnection(const QString &name)
 {
     emit connectionAboutToBeClosed(name);
 
+    removeWorker(name);
+
     QSqlDatabase db = QSqlDatabase::database(name);
 
     db.close();
@@ -225,6 +241,11 @@ void SQLManager::removeConnection(const QString &name)
 {
     emit connectionAboutToBeClosed(name);
 
+    removeWorker(name);
+
+    if (name == m_resultConnection)
+        m_resultConnection.clear();
+
     m_model->removeConnection(name);
 
     QSqlDatabase::removeDatabase(name);
@@ -298,47 +319,240 @@ void SQLManager::runQuery(const QString &text, const QString &connection)
     if (text.isEmpty())
         return;
 
+    // only one result set is shown at a time
+    cancelQuery();
+    closeResult();
+
+    m_resultConnection.clear();
+
     if (!isValidAndOpen(connection))
         return;
 
-    QSqlDatabase db = QSqlDatabase::database(connection);
-    QSqlQuery query(db);
+    m_activeWorker = queryWorker(connection);
+    m_activeConnection = connection;
 
-    if (!query.prepare(text)) {
-        QSqlError err = query.lastError();
+    emit queryStarted(connection);
 
-        if (err.type() == QSqlError::ConnectionError)
-            m_model->setStatus(connection, Connection::OFFLINE);
+    QMetaObject::invokeMethod(m_activeWorker, "runQuery", Qt::QueuedConnection, Q_ARG(QString, text));
+}
+
+void SQLManager::exportResult(const SqlExportOptions &options)
+{
+    cancelQuery();
 
-        emit error(err.text());
+    // the statement is not run again, its side effects would repeat and its rows could differ
+    if (!m_resultWorker) {
+        emit error(i18nc("@info", "The result set is not available anymore"));
         return;
     }
 
-    if (!query.exec()) {
-        QSqlError err = query.lastError();
+    m_activeWorker = m_resultWorker;
+    m_activeConnection = m_resultConnection;
 
-        if (err.type() == QSqlError::ConnectionError)
-            m_model->setStatus(connection, Connection::OFFLINE);
+    emit exportStarted();
 
-        emit error(err.text());
+    // queued after a window that is still being fetched, which is part of the export then
+    QMetaObject::invokeMethod(m_activeWorker, "exportResult", Qt::QueuedConnection, Q_ARG(SqlExportOptions, options));
+}
+
+void SQLManager::fetchMoreRows()
+{
+    // not while the worker exports
+    if (!m_resultWorker || !m_moreRows || m_fetchingRows || m_activeWorker)
+        return;
+
+    m_fetchingRows = true;
+
+    QMetaObject::invokeMethod(m_resultWorker, "fetchRows", Qt::QueuedConnection);
+}
+
+void SQLManager::closeResult()
+{
+    if (!m_resultWorker)
+        return;
+
+    if (m_fetchingRows) {
+        // the rows in flight must not reach the next result set
+        removeWorker(m_resultConnection);
         return;
     }
 
-    QString message;
+    QMetaObject::invokeMethod(m_resultWorker, "closeResult", Qt::QueuedConnection);
+
+    m_resultWorker = nullptr;
+    m_moreRows = false;
+}
+
+void SQLManager::cancelQuery()
+{
+    if (!m_activeWorker)
+        return;
 
-    /// TODO: improve messages
-    if (query.isSelect()) {
-        if (!query.driver()->hasFeature(QSqlDriver::QuerySize))
-            message = i18nc("@info", "Query completed successfully");
-        else {
-            int nRowsSelected = query.size();
-            message = i18ncp("@info", "%1 record selected", "%1 records selected", nRowsSelected);
+    // the driver can't interrupt a running statement, abandon the whole
+    // thread instead and let the next query open a fresh connection
+    removeWorker(m_activeConnection);
+}
+
+SQLQueryWorker *SQLManager::queryWorker(const QString &connection)
+{
+    SQLQueryWorker *worker = m_workers.value(connection);
+
+    if (worker)
+        return worker;
+
+    // copy the settings of the opened connection, including a password read from the wallet
+    const QSqlDatabase db = QSqlDatabase::database(connection, false);
+
+    Connection conn;
+    conn.name = connection;
+    conn.driver = db.driverName();
+    conn.hostname = db.hostName();
+    conn.username = db.userName();
+    conn.password = db.password();
+    conn.database = db.databaseName();
+    conn.options = db.connectOptions();
+    conn.port = db.port();
+    conn.status = Connection::ONLINE;
+
+    worker = new SQLQueryWorker(conn, QStringLiteral("%1-katesql-worker-%2").arg(connection).arg(++m_workerCount));
+
+    QThread *thread = new QThread(this);
+    worker->moveToThread(thread);
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+
+    connect(worker, &SQLQueryWorker::columnsReady, this, &SQLManager::queryColumnsReady);
+    connect(worker, &SQLQueryWorker::rowsReady, this, &SQLManager::queryRowsReady);
+    connect(worker, &SQLQueryWorker::exportChunkReady, this, &SQLManager::exportChunkReady);
+
+    connect(worker, &SQLQueryWorker::exportFinished, this, [this, worker](int rows, qint64 msecs) {
+        if (worker != m_activeWorker)
+            return;
+
+        const QString seconds = QLocale().toString(msecs / 1000.0, 'f', 2);
+        const QString message = i18ncp("@info", "%1 record exported in %2 s", "%1 records exported in %2 s", rows, seconds);
+
+        // the export consumed the result set
+        if (worker == m_resultWorker) {
+            m_resultWorker = nullptr;
+            m_moreRows = false;
+            emit moreRowsAvailable(false);
         }
-    } else {
-        int nRowsAffected = query.numRowsAffected();
-        message = i18ncp("@info", "%1 row affected", "%1 rows affected", nRowsAffected);
+
+        emit exportFinished();
+        finishQuery(true);
+        emit success(message);
+    });
+
+    connect(worker, &SQLQueryWorker::queryFinished, this, [this, worker](bool isSelect, int rows, qint64 msecs, bool hasMore) {
+        if (worker != m_activeWorker)
+            return;
+
+        const QString seconds = QLocale().toString(msecs / 1000.0, 'f', 2);
+        QString message;
+
+        /// TODO: improve messages
+        if (isSelect) {
+            if (hasMore)
+                message = i18ncp("@info", "First %1 record selected in %2 s", "First %1 records selected in %2 s", rows, seconds);
+            else
+                message = i18ncp("@info", "%1 record selected in %2 s", "%1 records selected in %2 s", rows, seconds);
+
+            // the worker keeps the result set, the next rows are read when the view scrolls to them
+            m_resultWorker = worker;
+            m_resultConnection = m_activeConnection;
+            m_moreRows = hasMore;
+
+            emit moreRowsAvailable(hasMore);
+        } else {
+            message = i18ncp("@info", "%1 row affected in %2 s", "%1 rows affected in %2 s", rows, seconds);
+        }
+
+        finishQuery(true);
+        emit success(message);
+    });
+
+    connect(worker, &SQLQueryWorker::rowsFetched, this, [this, worker](int, bool hasMore) {
+        if (worker != m_resultWorker)
+            return;
+
+        m_fetchingRows = false;
+        m_moreRows = hasMore;
+
+        emit moreRowsAvailable(hasMore);
+    });
+
+    connect(worker, &SQLQueryWorker::queryFailed, this, [this, worker](const QString &message, bool connectionError) {
+        if (worker == m_resultWorker && m_fetchingRows) {
+            // the rows shown so far stay
+            if (connectionError)
+                m_model->setStatus(m_resultConnection, Connection::OFFLINE);
+
+            m_fetchingRows = false;
+            m_moreRows = false;
+            m_resultWorker = nullptr;
+
+            emit moreRowsAvailable(false);
+            emit error(message);
+            return;
+        }
+
+        if (worker != m_activeWorker)
+            return;
+
+        if (connectionError)
+            m_model->setStatus(m_activeConnection, Connection::OFFLINE);
+
+        finishQuery(false);
+        emit error(message);
+    });
+
+    thread->start();
+
+    m_workers.insert(connection, worker);
+
+    return worker;
+}
+
+void SQLManager::retireWorker(SQLQueryWorker *worker)
+{
+    worker->cancel();
+
+    // queued batches of the old query must not reach the output anymore
+    disconnect(worker, nullptr, this, nullptr);
+
+    // the thread stops as soon as the current statement returns
+    QThread *thread = worker->thread();
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    thread->quit();
+}
+
+void SQLManager::removeWorker(const QString &connection)
+{
+    SQLQueryWorker *worker = m_workers.take(connection);
+
+    if (!worker)
+        return;
+
+    const bool active = (worker == m_activeWorker);
+
+    retireWorker(worker);
+
+    if (worker == m_resultWorker) {
+        m_resultWorker = nullptr;
+        m_moreRows = false;
+        m_fetchingRows = false;
+
+        emit moreRowsAvailable(false);
     }
 
-    emit success(message);
-    emit queryActivated(query, connection);
+    if (active)
+        finishQuery(false);
+}
+
+void SQLManager::finishQuery(bool completed)
+{
+    m_activeWorker = nullptr;
+    m_activeConnection.clear();
+
+    emit queryStopped(completed);
 }
@@ -9,10 +9,13 @@
 
 class ConnectionModel;
 class KConfigGroup;
+class SQLQueryWorker;
 
 #include "connection.h"
+#include "sqlqueryworker.h"
 #include <KWallet>
-#include <QSqlQuery>
+#include <QHash>
+#include <QSqlError>
 
 class SQLManager : public QObject
 {
@@ -37,6 +40,13 @@ public Q_SLOTS:
     void loadConnections(KConfigGroup *connectionsGroup);
     void saveConnections(KConfigGroup *connectionsGroup);
     void runQuery(const QString &text, const QString &connection);
+    /// export all rows of the shown result set, the fetched ones and the rest of it
+    void exportResult(const SqlExportOptions &options);
+    void cancelQuery();
+    /// read the next window of rows of the shown result set
+    void fetchMoreRows();
+    /// the shown result set is not needed anymore, release its cursor
+    void closeResult();
 
 protected:
     void saveConnection(KConfigGroup *connectionsGroup, const Connection &conn);
@@ -46,14 +56,44 @@ Q_SIGNALS:
     void connectionRemoved(const QString &name);
     void connectionAboutToBeClosed(const QString &name);
 
-    void queryActivated(QSqlQuery &query, const QString &connection);
+    /// a query was handed to the worker of @p connection
+    void queryStarted(const QString &connection);
+    /// the running query produced a result set
+    void queryColumnsReady(const QStringList &columns);
+    void queryRowsReady(const SqlResultBlock &rows);
+    /// the shown result set has rows that fetchMoreRows() can read
+    void moreRowsAvailable(bool available);
+
+    void exportStarted();
+    /// @p chunk is empty if the export goes to a file
+    void exportChunkReady(const QString &chunk, int rows);
+    void exportFinished();
+    /// the running query or export is done; @p completed is false on errors and cancellation
+    void queryStopped(bool completed);
 
     void error(const QString &message);
     void success(const QString &message);
 
+private:
+    SQLQueryWorker *queryWorker(const QString &connection);
+    void retireWorker(SQLQueryWorker *worker);
+    void removeWorker(const QString &connection);
+    void finishQuery(bool completed);
+
 private:
     ConnectionModel *m_model;
     KWallet::Wallet *m_wallet = nullptr;
+
+    /// one worker thread per connection, created on first use
+    QHash<QString, SQLQueryWorker *> m_workers;
+    SQLQueryWorker *m_activeWorker = nullptr;
+    QString m_activeConnection;
+    // the worker keeping the shown result set, for fetching more rows and exporting it
+    SQLQueryWorker *m_resultWorker = nullptr;
+    QString m_resultConnection;
+    bool m_moreRows = false;
+    bool m_fetchingRows = false;
+    int m_workerCount = 0;
 };
 
 #endif // SQLMANAGER_H
@@ -0,0 +1,341 @@
+/*
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#include "sqlqueryworker.h"
+
+#include <KLocalizedString>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QTextStream>
+
+SQLQueryWorker::SQLQueryWorker(const Connection &conn, const QString &databaseName)
+    : m_connection(conn)
+    , m_databaseName(databaseName)
+    , m_cancelled(false)
+{
+}
+
+SQLQueryWorker::~SQLQueryWorker()
+{
+    // runs in the worker thread, which owns the connection
+    closeResult();
+
+    if (!QSqlDatabase::contains(m_databaseName))
+        return;
+
+    {
+        QSqlDatabase db = QSqlDatabase::database(m_databaseName, false);
+        db.close();
+    }
+
+    QSqlDatabase::removeDatabase(m_databaseName);
+}
+
+void SQLQueryWorker::cancel()
+{
+    m_cancelled = true;
+}
+
+bool SQLQueryWorker::cancelled() const
+{
+    return m_cancelled;
+}
+
+bool SQLQueryWorker::openDatabase(QSqlDatabase &db)
+{
+    // the connection is created lazily, so it belongs to this thread
+    if (!QSqlDatabase::contains(m_databaseName)) {
+        QSqlDatabase newDb = QSqlDatabase::addDatabase(m_connection.driver, m_databaseName);
+
+        newDb.setHostName(m_connection.hostname);
+        newDb.setUserName(m_connection.username);
+        newDb.setPassword(m_connection.password);
+        newDb.setDatabaseName(m_connection.database);
+        newDb.setConnectOptions(m_connection.options);
+
+        if (m_connection.port > 0)
+            newDb.setPort(m_connection.port);
+    }
+
+    db = QSqlDatabase::database(m_databaseName, false);
+
+    if (!db.isOpen() && !db.open()) {
+        if (!cancelled())
+            emit queryFailed(db.lastError().text(), true);
+        return false;
+    }
+
+    return true;
+}
+
+bool SQLQueryWorker::execute(QSqlQuery &query, const QString &text)
+{
+    // rows are handed out as they come, there is no need to scroll back
+    query.setForwardOnly(true);
+
+    if (!query.prepare(text) || !query.exec()) {
+        if (!cancelled()) {
+            const QSqlError err = query.lastError();
+            emit queryFailed(err.text(), err.type() == QSqlError::ConnectionError);
+        }
+        return false;
+    }
+
+    return !cancelled();
+}
+
+void SQLQueryWorker::runQuery(const QString &text)
+{
+    if (cancelled())
+        return;
+
+    // one result set at a time
+    closeResult();
+    m_fetchedRows = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QSqlDatabase db;
+
+    if (!openDatabase(db))
+        return;
+
+    std::unique_ptr<QSqlQuery> query(new QSqlQuery(db));
+
+    if (!execute(*query, text))
+        return;
+
+    if (!query->isSelect()) {
+        emit queryFinished(false, query->numRowsAffected(), timer.elapsed(), false);
+        return;
+    }
+
+    const QSqlRecord record = query->record();
+    const int columnCount = record.count();
+
+    QStringList columns;
+    columns.reserve(columnCount);
+    for (int i = 0; i < columnCount; ++i)
+        columns << record.fieldName(i);
+
+    emit columnsReady(columns);
+
+    m_result = std::move(query);
+    m_resultColumns = columns;
+
+    bool hasMore = false;
+
+    if (!readRows(hasMore))
+        return;
+
+    emit queryFinished(true, m_fetchedRows, timer.elapsed(), hasMore);
+}
+
+void SQLQueryWorker::fetchRows()
+{
+    if (cancelled())
+        return;
+
+    bool hasMore = false;
+
+    if (m_result && !readRows(hasMore))
+        return;
+
+    emit rowsFetched(m_fetchedRows, hasMore);
+}
+
+void SQLQueryWorker::closeResult()
+{
+    m_result.reset();
+    m_resultColumns.clear();
+    m_resultBlocks.clear();
+    m_rowPending = false;
+}
+
+bool SQLQueryWorker::nextRow()
+{
+    if (m_rowPending) {
+        m_rowPending = false;
+        return true;
+    }
+
+    return m_result->next();
+}
+
+bool SQLQueryWorker::readRows(bool &hasMore)
+{
+    const int columnCount = m_resultColumns.size();
+    SqlResultBlock block(columnCount);
+    int rows = 0;
+
+    hasMore = false;
+
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+
+    while (nextRow()) {
+        if (cancelled())
+            return false;
+
+        if (rows == FetchRows) {
+            // keep the row for the next window, so the end of the result set is known
+            m_rowPending = true;
+            hasMore = true;
+            break;
+        }
+
+        block.appendRow(*m_result);
+        ++rows;
+
+        if (block.rowCount() >= MaxBatchRows || batchTimer.elapsed() >= MaxBatchMsecs) {
+            block.squeeze();
+            m_resultBlocks.append(block);
+            emit rowsReady(block);
+            block = SqlResultBlock(columnCount);
+            batchTimer.restart();
+        }
+    }
+
+    if (cancelled())
+        return false;
+
+    if (!block.isEmpty()) {
+        block.squeeze();
+        m_resultBlocks.append(block);
+        emit rowsReady(block);
+    }
+
+    m_fetchedRows += rows;
+
+    if (hasMore)
+        return true;
+
+    // next() fails silently, e.g. if the connection drops in the middle of a result set
+    const QSqlError err = m_result->lastError();
+
+    if (err.isValid()) {
+        closeResult();
+        emit queryFailed(err.text(), err.type() == QSqlError::ConnectionError);
+        return false;
+    }
+
+    // all rows are in the blocks now
+    m_result.reset();
+
+    return true;
+}
+
+void SQLQueryWorker::exportResult(const SqlExportOptions &options)
+{
+    if (cancelled())
+        return;
+
+    if (m_resultColumns.isEmpty()) {
+        emit queryFailed(i18nc("@info", "The result set is not available anymore"), false);
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file;
+    QString chunk;
+    QTextStream stream;
+
+    if (!options.fileName.isEmpty()) {
+        file.setFileName(options.fileName);
+
+        if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+            emit queryFailed(xi18nc("@info", "Unable to open file <filename>%1</filename>", options.fileName), false);
+            return;
+        }
+
+        stream.setDevice(&file);
+    } else {
+        stream.setString(&chunk);
+    }
+
+    const int columnCount = m_resultColumns.size();
+
+    SqlExportWriter writer(stream, options);
+    writer.writeHeader(m_resultColumns);
+
+    int rows = 0;
+
+    auto flush = [&]() {
+        stream.flush();
+        emit exportChunkReady(chunk, rows);
+        chunk.clear();
+    };
+
+    auto writeField = [&](const QVariant &value) {
+        writer.writeField(value.toString(), SqlExportWriter::isNumeric(value));
+    };
+
+    auto endRow = [&]() {
+        writer.endRow();
+
+        if (rows % ExportChunkRows == 0)
+            flush();
+    };
+
+    // the rows the model shows, exactly as they were fetched
+    for (const SqlResultBlock &block : qAsConst(m_resultBlocks)) {
+        for (int row = 0; row < block.rowCount(); ++row) {
+            if (cancelled()) {
+                file.remove();
+                return;
+            }
+
+            writer.beginRow(++rows);
+            for (int i = 0; i < columnCount; ++i)
+                writeField(block.value(row, i));
+            endRow();
+        }
+    }
+
+    // the rest of the result set goes straight from the cursor to the output
+    while (m_result && nextRow()) {
+        if (cancelled()) {
+            file.remove();
+            return;
+        }
+
+        writer.beginRow(++rows);
+        for (int i = 0; i < columnCount; ++i)
+            writeField(m_result->value(i));
+        endRow();
+    }
+
+    if (cancelled()) {
+        file.remove();
+        return;
+    }
+
+    flush();
+
+    const QSqlError err = m_result ? m_result->lastError() : QSqlError();
+
+    closeResult();
+
+    if (err.isValid()) {
+        emit queryFailed(err.text(), err.type() == QSqlError::ConnectionError);
+        return;
+    }
+
+    if (file.isOpen() && file.error() != QFile::NoError) {
+        emit queryFailed(file.errorString(), false);
+        return;
+    }
+
+    emit exportFinished(rows, timer.elapsed());
+}
@@ -0,0 +1,102 @@
+/*
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#ifndef SQLQUERYWORKER_H
+#define SQLQUERYWORKER_H
+
+#include "connection.h"
+#include "sqlexport.h"
+#include "sqlresultblock.h"
+
+#include <QObject>
+#include <QStringList>
+
+#include <atomic>
+#include <memory>
+
+class QSqlDatabase;
+class QSqlQuery;
+
+/// Executes queries on a private database connection. The worker is meant to
+/// live in a thread of its own, so a slow query never blocks the editor.
+/// Rows are emitted in batches while they are fetched from the server, a
+/// window of FetchRows rows at a time: the cursor of a select stays open
+/// until fetchRows() asks for the next window or closeResult() drops it.
+/// The worker keeps the blocks it emitted, which the model shares, so the
+/// result set can be exported without running its statement again.
+class SQLQueryWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// @p databaseName must be unique, the worker registers its copy of @p conn under it
+    SQLQueryWorker(const Connection &conn, const QString &databaseName);
+    ~SQLQueryWorker() override;
+
+    /// Thread safe. The running query stops at the next fetched row and the
+    /// worker does not report anything anymore; it must not be reused.
+    void cancel();
+
+    /// rows fetched at once, the next ones are only read when they are asked for
+    static constexpr int FetchRows = 1000;
+    /// upper bound of rows per block
+    static constexpr int MaxBatchRows = 1000;
+    /// a partial block is emitted after this time, so slow result sets show up gradually
+    static constexpr int MaxBatchMsecs = 100;
+    /// rows written per exported chunk
+    static constexpr int ExportChunkRows = 10000;
+
+public Q_SLOTS:
+    void runQuery(const QString &text);
+    /// read the next window of the open result set
+    void fetchRows();
+    /// drop the open result set, if any
+    void closeResult();
+    /// Write the whole result set: the rows fetched so far, then the rest of
+    /// the open cursor, of which no more than a chunk is in memory. The
+    /// result set is consumed, it is closed afterwards.
+    void exportResult(const SqlExportOptions &options);
+
+Q_SIGNALS:
+    /// a result set starts
+    void columnsReady(const QStringList &columns);
+    void rowsReady(const SqlResultBlock &rows);
+    /// @p rows is the number of fetched rows for a select, the number of affected rows otherwise;
+    /// @p hasMore is true if the result set has rows beyond the first window
+    void queryFinished(bool isSelect, int rows, qint64 msecs, bool hasMore);
+    /// a window requested with fetchRows() was read, @p rows is the number of rows fetched so far
+    void rowsFetched(int rows, bool hasMore);
+
+    /// @p chunk is empty when exporting to a file, @p rows is the number of rows written so far
+    void exportChunkReady(const QString &chunk, int rows);
+    void exportFinished(int rows, qint64 msecs);
+
+    void queryFailed(const QString &message, bool connectionError);
+
+private:
+    bool cancelled() const;
+    /// create and open the private connection if needed
+    bool openDatabase(QSqlDatabase &db);
+    bool execute(QSqlQuery &query, const QString &text);
+    /// emit the next window of the open result set, false on errors and cancellation
+    bool readRows(bool &hasMore);
+    bool nextRow();
+
+private:
+    Connection m_connection;
+    QString m_databaseName;
+    std::atomic<bool> m_cancelled;
+
+    // the select whose rows are handed out window by window
+    std::unique_ptr<QSqlQuery> m_result;
+    QStringList m_resultColumns;
+    QVector<SqlResultBlock> m_resultBlocks;
+    int m_fetchedRows = 0;
+    // the cursor is on a row that was not read yet
+    bool m_rowPending = false;
+};
+
+#endif // SQLQUERYWORKER_H
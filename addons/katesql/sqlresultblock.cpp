@@ -0,0 +1,175 @@
+/*
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#include "sqlresultblock.h"
+
+#include <QSqlQuery>
+
+#include <algorithm>
+#include <limits>
+
+SqlResultBlock::SqlResultBlock(int columnCount)
+    : m_columns(columnCount)
+{
+}
+
+void SqlResultBlock::appendRow(const QSqlQuery &query)
+{
+    for (int i = 0; i < m_columns.size(); ++i)
+        append(m_columns[i], query.value(i));
+
+    ++m_rowCount;
+}
+
+void SqlResultBlock::appendRow(const QVector<QVariant> &values)
+{
+    for (int i = 0; i < m_columns.size(); ++i)
+        append(m_columns[i], values.value(i));
+
+    ++m_rowCount;
+}
+
+QVariant SqlResultBlock::value(int row, int column) const
+{
+    if (row < 0 || row >= m_rowCount || column < 0 || column >= m_columns.size())
+        return QVariant();
+
+    const Column &c = m_columns.at(column);
+
+    if (std::binary_search(c.nulls.cbegin(), c.nulls.cend(), row))
+        return QVariant(c.type);
+
+    return storedValue(c, row);
+}
+
+void SqlResultBlock::squeeze()
+{
+    for (Column &c : m_columns) {
+        c.nulls.squeeze();
+        c.integers.squeeze();
+        c.reals.squeeze();
+        c.text.squeeze();
+        c.textEnds.squeeze();
+        c.generic.squeeze();
+    }
+}
+
+SqlResultBlock::Column::Storage SqlResultBlock::storageFor(const QVariant &value)
+{
+    switch (value.type()) {
+    case QVariant::Bool:
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+        return Column::Integer;
+    case QVariant::ULongLong:
+        return (value.toULongLong() <= quint64(std::numeric_limits<qint64>::max())) ? Column::Integer : Column::Generic;
+    case QVariant::Double:
+        return Column::Real;
+    case QVariant::String:
+        return Column::Text;
+    default:
+        return Column::Generic;
+    }
+}
+
+void SqlResultBlock::append(Column &column, const QVariant &value)
+{
+    if (column.type == QVariant::Invalid && value.type() != QVariant::Invalid) {
+        // the first typed value decides the storage, NULLs before it get default entries
+        column.type = value.type();
+        column.storage = storageFor(value);
+
+        for (int row = 0; row < m_rowCount; ++row)
+            appendDefault(column);
+    }
+
+    if (value.isNull()) {
+        column.nulls.append(m_rowCount);
+        appendDefault(column);
+        return;
+    }
+
+    if (column.storage != Column::Generic && (value.type() != column.type || storageFor(value) != column.storage))
+        makeGeneric(column);
+
+    switch (column.storage) {
+    case Column::Undecided:
+        break;
+    case Column::Integer:
+        column.integers.append(value.toLongLong());
+        break;
+    case Column::Real:
+        column.reals.append(value.toDouble());
+        break;
+    case Column::Text:
+        column.text += value.toString();
+        column.textEnds.append(column.text.size());
+        break;
+    case Column::Generic:
+        column.generic.append(value);
+        break;
+    }
+}
+
+void SqlResultBlock::appendDefault(Column &column)
+{
+    switch (column.storage) {
+    case Column::Undecided:
+        break;
+    case Column::Integer:
+        column.integers.append(0);
+        break;
+    case Column::Real:
+        column.reals.append(0.0);
+        break;
+    case Column::Text:
+        column.textEnds.append(column.text.size());
+        break;
+    case Column::Generic:
+        column.generic.append(QVariant(column.type));
+        break;
+    }
+}
+
+void SqlResultBlock::makeGeneric(Column &column)
+{
+    QVector<QVariant> generic;
+    generic.reserve(m_rowCount + 1);
+
+    for (int row = 0; row < m_rowCount; ++row)
+        generic.append(storedValue(column, row));
+
+    column.integers.clear();
+    column.reals.clear();
+    column.text.clear();
+    column.textEnds.clear();
+    column.generic = generic;
+    column.storage = Column::Generic;
+}
+
+QVariant SqlResultBlock::storedValue(const Column &column, int row) const
+{
+    switch (column.storage) {
+    case Column::Undecided:
+        return QVariant();
+    case Column::Integer: {
+        QVariant value(column.integers.at(row));
+        value.convert(column.type);
+        return value;
+    }
+    case Column::Real:
+        return QVariant(column.reals.at(row));
+    case Column::Text: {
+        const int start = (row > 0) ? column.textEnds.at(row - 1) : 0;
+        return QVariant(column.text.mid(start, column.textEnds.at(row) - start));
+    }
+    case Column::Generic:
+        return column.generic.at(row);
+    }
+
+    return QVariant();
+}
@@ -0,0 +1,83 @@
+/*
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#ifndef SQLRESULTBLOCK_H
+#define SQLRESULTBLOCK_H
+
+class QSqlQuery;
+
+#include <QMetaType>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+/// A block of consecutive rows of a result set, stored column by column.
+/// Every column keeps its values in the most compact storage that fits its
+/// type: integers and booleans as qint64, floating point numbers as double,
+/// strings packed into one buffer. Columns mixing types fall back to
+/// QVariant. Blocks are implicitly shared and cheap to pass between threads.
+class SqlResultBlock
+{
+public:
+    explicit SqlResultBlock(int columnCount = 0);
+
+    int rowCount() const
+    {
+        return m_rowCount;
+    }
+    int columnCount() const
+    {
+        return m_columns.size();
+    }
+    bool isEmpty() const
+    {
+        return m_rowCount == 0;
+    }
+
+    /// append the row @p query is positioned on
+    void appendRow(const QSqlQuery &query);
+    /// @p values must have columnCount() entries
+    void appendRow(const QVector<QVariant> &values);
+
+    /// a null value keeps the type of its column, as QSqlQuery::value() does
+    QVariant value(int row, int column) const;
+
+    /// release the spare capacity of a completed block
+    void squeeze();
+
+private:
+    struct Column {
+        enum Storage { Undecided, Integer, Real, Text, Generic };
+
+        Storage storage = Undecided;
+        QVariant::Type type = QVariant::Invalid;
+
+        // rows holding NULL, in ascending order; the storage holds a default value for them
+        QVector<int> nulls;
+
+        QVector<qint64> integers;
+        QVector<double> reals;
+        // all strings of the column back to back, textEnds[row] is the end of the string of row
+        QString text;
+        QVector<int> textEnds;
+        QVector<QVariant> generic;
+    };
+
+    void append(Column &column, const QVariant &value);
+    QVariant storedValue(const Column &column, int row) const;
+    void appendDefault(Column &column);
+    void makeGeneric(Column &column);
+
+    static Column::Storage storageFor(const QVariant &value);
+
+private:
+    QVector<Column> m_columns;
+    int m_rowCount = 0;
+};
+
+Q_DECLARE_METATYPE(SqlResultBlock)
+
+#endif // SQLRESULTBLOCK_H
@@ -25,6 +25,8 @@
 
 #include <QApplication>
 #include <QCheckBox>
+#include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QGroupBox>
 #include <QIcon>
@@ -33,6 +35,7 @@
 #include <QPushButton>
 #include <QShowEvent>
 #include <QStyle>
+#include <QTemporaryFile>
 #include <QVBoxLayout>
 
 #include <KAboutData>
@@ -153,6 +156,12 @@ KateConsole::KateConsole(KateKonsolePlugin *plugin, KTextEditor::MainWindow *mw,
     actionCollection()->setDefaultShortcut(a, QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_F4));
     connect(a, &QAction::triggered, this, &KateConsole::slotToggleFocus);
 
+    m_syncTimer.setSingleShot(true);
+    m_syncTimer.setInterval(200);
+    connect(&m_syncTimer, &QTimer::timeout, this, [this]() {
+        slotSync();
+    });
+
     m_mw->guiFactory()->addClient(this);
 
     readConfig();
@@ -163,6 +172,9 @@ KateConsole::~KateConsole()
     m_mw->guiFactory()->removeClient(this);
     if (m_part)
         disconnect(m_part, &KParts::ReadOnlyPart::destroyed, this, &KateConsole::slotDestroyed);
+
+    for (const QString &fileName : qAsConst(m_pipeFiles))
+        QFile::remove(fileName);
 }
 
 void KateConsole::loadConsoleIfNeeded()
@@ -206,6 +218,7 @@ void KateConsole::slotDestroyed()
 {
     m_part = nullptr;
     m_currentPath.clear();
+    m_unsyncedUrl.clear();
     setFocusProxy(nullptr);
 
     // hide the dockwidget
@@ -239,11 +252,16 @@ void KateConsole::cd(const QString &path)
         return;
 
     m_currentPath = path;
+    m_unsyncedUrl.clear();
     QString command = QLatin1String(" cd ") + KShell::quoteArg(m_currentPath) + QLatin1Char('\n');
 
     // special handling for some interpreters
     TerminalInterface *t = qobject_cast<TerminalInterface *>(m_part);
     if (t) {
+        // nothing to do if the shell is already there, e.g. after a manual cd
+        if (QFileInfo(t->currentWorkingDirectory()) == QFileInfo(path))
+            return;
+
         // ghci doesn't allow \space dir names, does allow spaces in dir names
         // irb can take spaces or \space but doesn't allow " 'path' "
         if (t->foregroundProcessName() == QLatin1String("irb")) {
@@ -273,6 +291,46 @@ void KateConsole::sendInput(const QString &text)
     t->sendInput(text);
 }
 
+bool KateConsole::sendInputThroughFile(const QString &text)
+{
+    loadConsoleIfNeeded();
+
+    TerminalInterface *t = qobject_cast<TerminalInterface *>(m_part);
+    if (!t)
+        return false;
+
+    // the file is read by the shell itself, so only do this for shells we know
+    const QString shell = t->foregroundProcessName();
+    QString sourceCommand;
+    if (shell == QLatin1String("bash") || shell == QLatin1String("zsh") || shell == QLatin1String("fish"))
+        sourceCommand = QStringLiteral("source");
+    else if (shell == QLatin1String("sh") || shell == QLatin1String("dash") || shell == QLatin1String("ksh") || shell == QLatin1String("mksh"))
+        sourceCommand = QStringLiteral(".");
+    else
+        return false;
+
+    // only readable by us, the shell removes it once read
+    QTemporaryFile file(QDir::tempPath() + QLatin1String("/kate-pipe-XXXXXX"));
+    file.setAutoRemove(false);
+    if (!file.open())
+        return false;
+
+    const QByteArray data = text.toUtf8();
+    if (file.write(data) != data.size() || !file.flush()) {
+        file.remove();
+        return false;
+    }
+    file.close();
+    m_pipeFiles.append(file.fileName());
+
+    const QString fileName = KShell::quoteArg(file.fileName());
+
+    // Send prior Ctrl-E, Ctrl-U to ensure the line is empty
+    t->sendInput(QStringLiteral("\x05\x15"));
+    t->sendInput(QLatin1Char(' ') + sourceCommand + QLatin1Char(' ') + fileName + QLatin1String("; rm -f ") + fileName + QLatin1Char('\n'));
+    return true;
+}
+
 void KateConsole::slotPipeToConsole()
 {
     if (KMessageBox::warningContinueCancel(m_mw->window(),
@@ -288,10 +346,15 @@ void KateConsole::slotPipeToConsole()
     if (!v)
         return;
 
-    if (v->selection())
-        sendInput(v->selectionText());
-    else
-        sendInput(v->document()->text());
+    const QString text = v->selection() ? v->selectionText() : v->document()->text();
+
+    // typing larger texts takes ages, let the shell read them from a file
+    if (text.size() > 4096 && KConfigGroup(KSharedConfig::openConfig(), "Konsole").readEntry("PipeThroughFile", true)) {
+        if (sendInputThroughFile(text))
+            return;
+    }
+
+    sendInput(text);
 }
 
 void KateConsole::slotSync(KTextEditor::View *)
@@ -301,15 +364,23 @@ void KateConsole::slotSync(KTextEditor::View *)
         if (u.isValid() && u.isLocalFile()) {
             QFileInfo fi(u.toLocalFile());
             cd(fi.absolutePath());
-        } else if (!u.isEmpty()) {
+        } else if (!u.isEmpty() && u != m_unsyncedUrl) {
+            m_unsyncedUrl = u;
             sendInput(QStringLiteral("### ") + i18n("Sorry, cannot cd into '%1'", u.toLocalFile()) + QLatin1Char('\n'));
         }
     }
 }
 
+void KateConsole::slotDelayedSync()
+{
+    m_syncTimer.start();
+}
+
 void KateConsole::slotManualSync()
 {
+    m_syncTimer.stop();
     m_currentPath.clear();
+    m_unsyncedUrl.clear();
     slotSync();
     if (!m_part || !m_part->widget()->isVisible())
         m_mw->showToolView(parentWidget());
@@ -412,9 +483,10 @@ void KateConsole::slotToggleFocus()
 
 void KateConsole::readConfig()
 {
-    disconnect(m_mw, &KTextEditor::MainWindow::viewChanged, this, &KateConsole::slotSync);
+    disconnect(m_mw, &KTextEditor::MainWindow::viewChanged, this, &KateConsole::slotDelayedSync);
+    m_syncTimer.stop();
     if (KConfigGroup(KSharedConfig::openConfig(), "Konsole").readEntry("AutoSyncronize", true)) {
-        connect(m_mw, &KTextEditor::MainWindow::viewChanged, this, &KateConsole::slotSync);
+        connect(m_mw, &KTextEditor::MainWindow::viewChanged, this, &KateConsole::slotDelayedSync);
     }
 
     if (KConfigGroup(KSharedConfig::openConfig(), "Konsole").readEntry("SetEditor", false))
@@ -434,6 +506,10 @@ KateKonsoleConfigPage::KateKonsoleConfigPage(QWidget *parent, KateKonsolePlugin
     cbAutoSyncronize = new QCheckBox(i18n("&Automatically synchronize the terminal with the current document when possible"), this);
     lo->addWidget(cbAutoSyncronize);
 
+    cbPipeThroughFile = new QCheckBox(i18n("&Let the shell read larger texts piped to the terminal from a temporary file"), this);
+    cbPipeThroughFile->setWhatsThis(i18n("Typing a large text into the terminal is slow. If the terminal runs a known shell, it sources a temporary file holding the text instead."));
+    lo->addWidget(cbPipeThroughFile);
+
     QVBoxLayout *vboxRun = new QVBoxLayout;
     QGroupBox *groupRun = new QGroupBox(i18n("Run in terminal"), this);
     // Remove extension
@@ -474,6 +550,7 @@ KateKonsoleConfigPage::KateKonsoleConfigPage(QWidget *parent, KateKonsolePlugin
     connect(cbRemoveExtension, &QCheckBox::stateChanged, this, &KTextEditor::ConfigPage::changed);
     connect(lePrefix, &QLineEdit::textChanged, this, &KateKonsoleConfigPage::changed);
     connect(cbSetEditor, &QCheckBox::stateChanged, this, &KateKonsoleConfigPage::changed);
+    connect(cbPipeThroughFile, &QCheckBox::stateChanged, this, &KateKonsoleConfigPage::changed);
 }
 
 void KateKonsoleConfigPage::slotEnableRunWarning()
@@ -503,6 +580,7 @@ void KateKonsoleConfigPage::apply()
     config.writeEntry("RemoveExtension", cbRemoveExtension->isChecked());
     config.writeEntry("RunPrefix", lePrefix->text());
     config.writeEntry("SetEditor", cbSetEditor->isChecked());
+    config.writeEntry("PipeThroughFile", cbPipeThroughFile->isChecked());
     config.sync();
     mPlugin->readConfig();
 }
@@ -514,6 +592,7 @@ void KateKonsoleConfigPage::reset()
     cbRemoveExtension->setChecked(config.readEntry("RemoveExtension", false));
     lePrefix->setText(config.readEntry("RunPrefix", ""));
     cbSetEditor->setChecked(config.readEntry("SetEditor", false));
+    cbPipeThroughFile->setChecked(config.readEntry("PipeThroughFile", true));
 }
 
 #include "kateconsole.moc"
@@ -16,6 +16,8 @@
 
 #include <QKeyEvent>
 #include <QList>
+#include <QTimer>
+#include <QUrl>
 
 #include <KXMLGUIClient>
 
@@ -117,6 +119,15 @@ public:
      */
     void sendInput(const QString &text);
 
+    /**
+     * let the shell in the console read @p text from a private temporary
+     * file, instead of typing it, this is a lot faster for larger texts
+     * @param text commands for console
+     * @return false if the foreground process is no known shell or the file
+     *         could not be written, nothing was sent then
+     */
+    bool sendInputThroughFile(const QString &text);
+
     KTextEditor::MainWindow *mainWindow()
     {
         return m_mw;
@@ -133,6 +144,12 @@ public Q_SLOTS:
      */
     void slotSync(KTextEditor::View *view = nullptr);
 
+    /**
+     * synchronize the konsole a bit later, switching quickly between views
+     * then only leads to one cd
+     */
+    void slotDelayedSync();
+
     /**
      * When syncing is done by the user, also show the terminal if it is hidden
      */
@@ -195,6 +212,22 @@ private:
 
     KateKonsolePlugin *m_plugin;
     QString m_currentPath;
+
+    /**
+     * url we last told we cannot cd into, to not repeat it for every switch
+     */
+    QUrl m_unsyncedUrl;
+
+    /**
+     * delays the automatic synchronization, see slotDelayedSync()
+     */
+    QTimer m_syncTimer;
+
+    /**
+     * temporary files piped to the console, the shell removes them once
+     * read, whatever is left is removed with the console
+     */
+    QStringList m_pipeFiles;
 };
 
 class KateKonsoleConfigPage : public KTextEditor::ConfigPage
@@ -221,6 +254,7 @@ private:
     class QCheckBox *cbRemoveExtension;
     class QLineEdit *lePrefix;
     class QCheckBox *cbSetEditor;
+    class QCheckBox *cbPipeThroughFile;
     KateKonsolePlugin *mPlugin;
 
 private Q_SLOTS:
@@ -20,6 +20,7 @@
 #include <KXMLGUIFactory>
 #include <QAction>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 
 K_PLUGIN_FACTORY_WITH_JSON(KateOpenHeaderFactory, "kateopenheaderplugin.json", registerPlugin<PluginKateOpenHeader>();)
@@ -47,10 +48,12 @@ PluginViewKateOpenHeader::~PluginViewKateOpenHeader()
 PluginKateOpenHeader::PluginKateOpenHeader(QObject *parent, const QList<QVariant> &)
     : KTextEditor::Plugin(parent)
 {
+    connect(KTextEditor::Editor::instance()->application(), &KTextEditor::Application::documentWillBeDeleted, this, &PluginKateOpenHeader::slotDocumentWillBeDeleted);
 }
 
 PluginKateOpenHeader::~PluginKateOpenHeader()
 {
+    statRemote(nullptr, QVector<QUrl>());
 }
 
 QObject *PluginKateOpenHeader::createView(KTextEditor::MainWindow *mainWindow)
@@ -72,6 +75,17 @@ void PluginKateOpenHeader::slotOpenHeader()
     if ((!url.isValid()) || (url.isEmpty()))
         return;
 
+    // found before, unless the document was saved under another name or the counterpart is gone meanwhile
+    const auto it = m_counterparts.constFind(kv->document());
+    if (it != m_counterparts.constEnd()) {
+        const QUrl counterpart = it->url;
+        if (it->source == url && (!counterpart.isLocalFile() || QFile::exists(counterpart.toLocalFile()))) {
+            open(kv->document(), counterpart);
+            return;
+        }
+        m_counterparts.remove(kv->document());
+    }
+
     qDebug() << "Trying to open opposite of " << url.toString();
     qDebug() << "Trying to open opposite of toLocalFile:" << url.toLocalFile();
     qDebug() << "Trying to open opposite of path:" << url.path();
@@ -106,13 +120,13 @@ bool PluginKateOpenHeader::tryOpenInternal(const QUrl &url, const QStringList &e
         setFileName(&newURL, basename + QStringLiteral(".") + extension);
         KTextEditor::Document *doc = application->findUrl(newURL);
         if (doc) {
-            application->activeMainWindow()->openUrl(newURL);
+            open(application->findUrl(url), newURL);
             return true;
         }
         setFileName(&newURL, basename + QStringLiteral(".") + extension.toUpper());
         doc = application->findUrl(newURL);
         if (doc) {
-            application->activeMainWindow()->openUrl(newURL);
+            open(application->findUrl(url), newURL);
             return true;
         }
     }
@@ -126,35 +140,195 @@ void PluginKateOpenHeader::tryOpen(const QUrl &url, const QStringList &extension
         return;
 
     qDebug() << "Trying to open " << url.toString() << " with extensions " << extensions.join(QLatin1Char(' '));
+    KTextEditor::Document *document = application->findUrl(url);
+    const QVector<QUrl> urls = candidates(url, extensions);
+
+    if (!url.isLocalFile()) {
+        // checking one after the other would block for seconds on slow remote file systems
+        statRemote(document, urls);
+        return;
+    }
+
+    for (const QUrl &candidate : urls) {
+        if (QFile::exists(candidate.toLocalFile())) {
+            open(document, candidate);
+            return;
+        }
+    }
+
+    // not next to it, e.g. include/foo/bar.h <-> src/bar.cpp
+    const QUrl counterpart = findInProjects(url, extensions);
+    if (counterpart.isValid()) {
+        open(document, counterpart);
+    }
+}
+
+void PluginKateOpenHeader::open(KTextEditor::Document *document, const QUrl &url)
+{
+    KTextEditor::MainWindow *mainWindow = KTextEditor::Editor::instance()->application()->activeMainWindow();
+    if (!mainWindow)
+        return;
+
+    KTextEditor::View *view = mainWindow->openUrl(url);
+    if (!document)
+        return;
+
+    m_counterparts.insert(document, {document->url(), url});
+    if (view && view->document() != document) {
+        m_counterparts.insert(view->document(), {view->document()->url(), document->url()});
+    }
+}
+
+QVector<QUrl> PluginKateOpenHeader::candidates(const QUrl &url, const QStringList &extensions)
+{
+    QVector<QUrl> urls;
     QString basename = QFileInfo(url.path()).baseName();
     QUrl newURL(url);
 
     for (const auto &extension : extensions) {
         setFileName(&newURL, basename + QStringLiteral(".") + extension);
-        if (fileExists(newURL)) {
-            application->activeMainWindow()->openUrl(newURL);
-            return;
+        if (!urls.contains(newURL)) {
+            urls.append(newURL);
         }
         setFileName(&newURL, basename + QStringLiteral(".") + extension.toUpper());
-        if (fileExists(newURL)) {
-            application->activeMainWindow()->openUrl(newURL);
-            return;
+        if (!urls.contains(newURL)) {
+            urls.append(newURL);
+        }
+    }
+    return urls;
+}
+
+QUrl PluginKateOpenHeader::findInProjects(const QUrl &url, const QStringList &extensions)
+{
+    updateIndex();
+
+    const QString fileName = url.toLocalFile();
+    const auto it = m_index.constFind(QFileInfo(fileName).baseName());
+    if (it == m_index.constEnd()) {
+        return QUrl();
+    }
+
+    QStringList lowerExtensions;
+    for (const auto &extension : extensions) {
+        lowerExtensions.append(extension.toLower());
+    }
+
+    // prefer the file sharing the longest part of the path, then the extension listed first
+    QString best;
+    int bestCommon = -1;
+    int bestExtension = -1;
+    for (const QString &file : it.value()) {
+        const int extension = lowerExtensions.indexOf(QFileInfo(file).suffix().toLower());
+        if (extension == -1 || file == fileName) {
+            continue;
+        }
+
+        int common = 0;
+        while (common < file.size() && common < fileName.size() && file.at(common) == fileName.at(common)) {
+            ++common;
+        }
+
+        if (common > bestCommon || (common == bestCommon && extension < bestExtension)) {
+            best = file;
+            bestCommon = common;
+            bestExtension = extension;
         }
     }
+
+    return best.isEmpty() ? QUrl() : QUrl::fromLocalFile(best);
 }
 
-bool PluginKateOpenHeader::fileExists(const QUrl &url)
+void PluginKateOpenHeader::updateIndex()
 {
-    if (url.isLocalFile()) {
-        return QFile::exists(url.toLocalFile());
+    KTextEditor::MainWindow *mainWindow = KTextEditor::Editor::instance()->application()->activeMainWindow();
+    QObject *projectView = mainWindow ? mainWindow->pluginView(QStringLiteral("kateprojectplugin")) : nullptr;
+    const QStringList files = projectView ? projectView->property("allProjectsFiles").toStringList() : QStringList();
+
+    // reloaded projects are only noticed by their number of files
+    if (projectView == m_indexedProjectView && files.size() == m_indexedFiles) {
+        return;
+    }
+
+    if (projectView && projectView != m_indexedProjectView) {
+        connect(projectView, SIGNAL(projectMapChanged()), this, SLOT(slotProjectChanged()), Qt::UniqueConnection);
+    }
+    m_indexedProjectView = projectView;
+    m_indexedFiles = files.size();
+
+    // a closer counterpart might have been added
+    m_counterparts.clear();
+
+    m_index.clear();
+    for (const QString &file : files) {
+        // same as QFileInfo::baseName(), without the overhead
+        const int slash = file.lastIndexOf(QLatin1Char('/'));
+        const int dot = file.indexOf(QLatin1Char('.'), slash + 1);
+        m_index[file.mid(slash + 1, dot == -1 ? -1 : dot - slash - 1)].append(file);
+    }
+}
+
+void PluginKateOpenHeader::slotProjectChanged()
+{
+    m_indexedFiles = -1;
+}
+
+void PluginKateOpenHeader::slotDocumentWillBeDeleted(KTextEditor::Document *document)
+{
+    m_counterparts.remove(document);
+}
+
+void PluginKateOpenHeader::statRemote(KTextEditor::Document *document, const QVector<QUrl> &candidates)
+{
+    // a new lookup replaces the running one
+    for (int i = 0; i < m_remoteLookup.jobs.size(); ++i) {
+        if (m_remoteLookup.states.at(i) == RemoteLookup::Pending && m_remoteLookup.jobs.at(i)) {
+            m_remoteLookup.jobs.at(i)->kill();
+        }
+    }
+    m_remoteLookup = RemoteLookup();
+
+    if (candidates.isEmpty()) {
+        return;
+    }
+
+    m_remoteLookup.document = document;
+    m_remoteLookup.candidates = candidates;
+    m_remoteLookup.states.fill(RemoteLookup::Pending, candidates.size());
+
+    QWidget *window = KTextEditor::Editor::instance()->application()->activeMainWindow()->window();
+    for (const QUrl &candidate : candidates) {
+        KIO::StatJob *job = KIO::stat(candidate, KIO::HideProgressInfo);
+        KJobWidgets::setWindow(job, window);
+        job->setSide(KIO::StatJob::DestinationSide /*SourceSide*/);
+        connect(job, &KJob::result, this, &PluginKateOpenHeader::slotStatResult);
+        m_remoteLookup.jobs.append(job);
+    }
+}
+
+void PluginKateOpenHeader::slotStatResult(KJob *job)
+{
+    const int index = m_remoteLookup.jobs.indexOf(job);
+    if (index == -1) {
+        return;
+    }
+    m_remoteLookup.states[index] = job->error() ? RemoteLookup::Missing : RemoteLookup::Exists;
+
+    // the first candidate that exists wins, as if they were checked one after the other
+    for (int i = 0; i < m_remoteLookup.candidates.size(); ++i) {
+        if (m_remoteLookup.states.at(i) == RemoteLookup::Pending) {
+            return;
+        }
+        if (m_remoteLookup.states.at(i) == RemoteLookup::Exists) {
+            const QUrl url = m_remoteLookup.candidates.at(i);
+            KTextEditor::Document *document = m_remoteLookup.document;
+            statRemote(nullptr, QVector<QUrl>());
+            open(document, url);
+            return;
+        }
     }
 
-    KIO::JobFlags flags = KIO::DefaultFlags;
-    KIO::StatJob *job = KIO::stat(url, flags);
-    KJobWidgets::setWindow(job, KTextEditor::Editor::instance()->application()->activeMainWindow()->window());
-    job->setSide(KIO::StatJob::DestinationSide /*SourceSide*/);
-    job->exec();
-    return !job->error();
+    // there is none
+    m_remoteLookup = RemoteLookup();
 }
 
 void PluginKateOpenHeader::setFileName(QUrl *url, const QString &_txt)
@@ -208,6 +382,7 @@ bool PluginViewKateOpenHeader::help(KTextEditor::View *view, const QString &cmd,
         "its corresponding C/C++ file or vice versa.</p>"
         "<p>For example, if you are editing myclass.cpp, <tt>toggle-header</tt> will change "
         "to myclass.h if this file is available.</p>"
+        "<p>If there is no such file in the same folder, the files of the open projects are searched.</p>"
         "<p>Pairs of the following filename suffixes will work:<br />"
         " Header files: h, H, hh, hpp<br />"
         " Source files: c, cpp, cc, cp, cxx</p>");
@@ -11,11 +11,21 @@
 #include <KPluginFactory>
 #include <KTextEditor/Command>
 #include <KXMLGUIClient>
+#include <QHash>
 #include <QObject>
+#include <QPointer>
 #include <QUrl>
+#include <QVector>
 #include <ktexteditor/mainwindow.h>
 #include <ktexteditor/plugin.h>
 
+class KJob;
+
+namespace KTextEditor
+{
+class Document;
+}
+
 class PluginKateOpenHeader : public KTextEditor::Plugin
 {
     Q_OBJECT
@@ -31,9 +41,59 @@ public Q_SLOTS:
     void tryOpen(const QUrl &url, const QStringList &extensions);
     bool tryOpenInternal(const QUrl &url, const QStringList &extensions);
 
+private Q_SLOTS:
+    /**
+     * The files of the projects may have changed, index them again on the next lookup.
+     */
+    void slotProjectChanged();
+    void slotDocumentWillBeDeleted(KTextEditor::Document *document);
+
 private:
-    bool fileExists(const QUrl &url);
+    /**
+     * Open @p url as the counterpart of @p document and remember it, both ways.
+     */
+    void open(KTextEditor::Document *document, const QUrl &url);
+
+    /**
+     * Candidates in the same directory as @p url, in the order to try them.
+     */
+    QVector<QUrl> candidates(const QUrl &url, const QStringList &extensions);
+
+    /**
+     * The project file with the basename of @p url and one of @p extensions,
+     * the one closest to @p url if there are several.
+     */
+    QUrl findInProjects(const QUrl &url, const QStringList &extensions);
+    void updateIndex();
+
+    /**
+     * Check the remote @p candidates in parallel, the first one that exists is opened.
+     */
+    void statRemote(KTextEditor::Document *document, const QVector<QUrl> &candidates);
+    void slotStatResult(KJob *job);
     void setFileName(QUrl *url, const QString &_txt);
+
+    // counterpart found for a document, while the document keeps its url
+    struct Counterpart {
+        QUrl source;
+        QUrl url;
+    };
+    QHash<KTextEditor::Document *, Counterpart> m_counterparts;
+
+    // basename -> files of all projects, see updateIndex()
+    QHash<QString, QStringList> m_index;
+    QPointer<QObject> m_indexedProjectView;
+    int m_indexedFiles = -1;
+
+    // the running remote lookup, see statRemote()
+    struct RemoteLookup {
+        enum State { Pending, Exists, Missing };
+        QPointer<KTextEditor::Document> document;
+        QVector<QUrl> candidates;
+        QVector<State> states;
+        QVector<QPointer<KJob>> jobs;
+    };
+    RemoteLookup m_remoteLookup;
 };
 
 class PluginViewKateOpenHeader : public KTextEditor::Command, public KXMLGUIClient
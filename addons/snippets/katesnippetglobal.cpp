@@ -101,6 +101,9 @@ void KateSnippetGlobal::createSnippet(KTextEditor::View *view)
         match->setFileTypes(QStringList() << mode);
     }
 
+    // the new snippet goes after the existing ones
+    match->load();
+
     EditSnippet dlg(match, nullptr, view);
     dlg.setSnippetText(view->selectionText());
     int status = dlg.exec();
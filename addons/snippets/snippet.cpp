@@ -39,6 +39,8 @@ QString Snippet::snippet() const
 void Snippet::setSnippet(const QString &snippet)
 {
     m_snippet = snippet;
+    // not part of the item data, still let the completion know
+    emitDataChanged();
 }
 
 void Snippet::registerActionForView(QWidget *view)
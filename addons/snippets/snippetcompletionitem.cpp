@@ -79,6 +79,11 @@ QVariant SnippetCompletionItem::data(const QModelIndex &index, int role, const K
 
 void SnippetCompletionItem::execute(KTextEditor::View *view, const KTextEditor::Range &word)
 {
+    // the repository was removed while the completion was shown
+    if (!m_repo) {
+        return;
+    }
+
     // insert snippet content
     view->insertTemplate(view->cursorPosition(), m_snippet, m_repo->script());
     view->document()->removeText(word);
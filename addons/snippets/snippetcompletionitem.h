@@ -12,6 +12,7 @@
 
 /// TODO: push this into kdevplatform/language/codecompletion so language plugins can reuse it's functionality
 
+#include <QPointer>
 #include <QString>
 #include <QVariant>
 
@@ -32,6 +33,14 @@ public:
     SnippetCompletionItem(Snippet *snippet, SnippetRepository *repo);
     ~SnippetCompletionItem();
 
+    /**
+     * The name to complete, prefixed with the completion namespace of the repository.
+     */
+    const QString &name() const
+    {
+        return m_name;
+    }
+
     void execute(KTextEditor::View *view, const KTextEditor::Range &word);
     QVariant data(const QModelIndex &index, int role, const KTextEditor::CodeCompletionModel *model) const;
 
@@ -39,7 +48,7 @@ private:
     // we copy since the snippet itself can be deleted at any time
     QString m_name;
     QString m_snippet;
-    SnippetRepository *m_repo;
+    QPointer<SnippetRepository> m_repo;
 };
 
 #endif // SNIPPETCOMPLETIONITEM_H
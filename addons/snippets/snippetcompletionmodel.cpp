@@ -23,12 +23,33 @@ SnippetCompletionModel::SnippetCompletionModel()
     : KTextEditor::CodeCompletionModel(nullptr)
 {
     setHasGroups(false);
+
+    // keep the catalog until a repository changes
+    SnippetStore *store = SnippetStore::self();
+    connect(store, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft) {
+        // the check state of a repository or anything of a snippet
+        invalidate(topLeft.parent().isValid() ? topLeft.parent() : topLeft);
+    });
+    connect(store, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &parent) {
+        invalidate(parent);
+    });
+    connect(store, &QAbstractItemModel::rowsAboutToBeRemoved, this, [this](const QModelIndex &parent, int first, int last) {
+        if (parent.isValid()) {
+            invalidate(parent);
+            return;
+        }
+        // forget the removed repositories before they are deleted
+        for (int i = first; i <= last; ++i) {
+            invalidate(SnippetStore::self()->index(i, 0));
+        }
+    });
+    connect(store, &QAbstractItemModel::rowsMoved, this, &SnippetCompletionModel::invalidateAll);
+    connect(store, &QAbstractItemModel::layoutChanged, this, &SnippetCompletionModel::invalidateAll);
+    connect(store, &QAbstractItemModel::modelReset, this, &SnippetCompletionModel::invalidateAll);
 }
 
 SnippetCompletionModel::~SnippetCompletionModel()
 {
-    qDeleteAll(m_snippets);
-    m_snippets.clear();
 }
 
 QVariant SnippetCompletionModel::data(const QModelIndex &idx, int role) const
@@ -75,10 +96,22 @@ void SnippetCompletionModel::initData(KTextEditor::View *view)
         mode = view->document()->highlightingMode();
     }
 
+    // all snippets of the mode, KTextEditor filters them while typing
+    const QVector<Item> &items = catalog(mode);
+
     beginResetModel();
+    m_snippets = items;
+    endResetModel();
+}
 
-    qDeleteAll(m_snippets);
-    m_snippets.clear();
+const QVector<SnippetCompletionModel::Item> &SnippetCompletionModel::catalog(const QString &mode)
+{
+    auto it = m_catalogs.find(mode);
+    if (it != m_catalogs.end()) {
+        return *it;
+    }
+
+    QVector<Item> items;
     SnippetStore *store = SnippetStore::self();
     for (int i = 0; i < store->rowCount(); i++) {
         if (store->item(i, 0)->checkState() != Qt::Checked) {
@@ -86,15 +119,46 @@ void SnippetCompletionModel::initData(KTextEditor::View *view)
         }
         SnippetRepository *repo = dynamic_cast<SnippetRepository *>(store->item(i, 0));
         if (repo && (repo->fileTypes().isEmpty() || repo->fileTypes().contains(mode))) {
-            for (int j = 0; j < repo->rowCount(); ++j) {
-                if (Snippet *snippet = dynamic_cast<Snippet *>(repo->child(j))) {
-                    m_snippets << new SnippetCompletionItem(snippet, repo);
-                }
-            }
+            items << repositoryItems(repo);
         }
     }
 
-    endResetModel();
+    return *m_catalogs.insert(mode, items);
+}
+
+const QVector<SnippetCompletionModel::Item> &SnippetCompletionModel::repositoryItems(SnippetRepository *repo)
+{
+    auto it = m_repositoryItems.find(repo);
+    if (it != m_repositoryItems.end()) {
+        return *it;
+    }
+
+    // the first use for this mode
+    repo->load();
+
+    QVector<Item> items;
+    items.reserve(repo->rowCount());
+    for (int j = 0; j < repo->rowCount(); ++j) {
+        if (Snippet *snippet = dynamic_cast<Snippet *>(repo->child(j))) {
+            items.append(std::make_shared<SnippetCompletionItem>(snippet, repo));
+        }
+    }
+    return *m_repositoryItems.insert(repo, items);
+}
+
+void SnippetCompletionModel::invalidate(const QModelIndex &parent)
+{
+    // a new repository has no items yet, only the catalogs change
+    if (parent.isValid()) {
+        m_repositoryItems.remove(dynamic_cast<SnippetRepository *>(SnippetStore::self()->itemFromIndex(parent)));
+    }
+    m_catalogs.clear();
+}
+
+void SnippetCompletionModel::invalidateAll()
+{
+    m_repositoryItems.clear();
+    m_catalogs.clear();
 }
 
 QModelIndex SnippetCompletionModel::parent(const QModelIndex &index) const
@@ -13,7 +13,11 @@
 #include <ktexteditor/codecompletionmodel.h>
 #include <ktexteditor/codecompletionmodelcontrollerinterface.h>
 
+#include <QHash>
 #include <QPointer>
+#include <QVector>
+
+#include <memory>
 
 namespace KTextEditor
 {
@@ -21,6 +25,7 @@ class View;
 }
 
 class SnippetCompletionItem;
+class SnippetRepository;
 
 class SnippetCompletionModel : public KTextEditor::CodeCompletionModel, public KTextEditor::CodeCompletionModelControllerInterface
 {
@@ -43,7 +48,24 @@ public:
 
 private:
     void initData(KTextEditor::View *view);
-    QList<SnippetCompletionItem *> m_snippets;
+
+    using Item = std::shared_ptr<SnippetCompletionItem>;
+
+    /**
+     * The completion items of all checked repositories for one mode.
+     */
+    const QVector<Item> &catalog(const QString &mode);
+    const QVector<Item> &repositoryItems(SnippetRepository *repo);
+
+    // @p parent is the repository of the changed rows, invalid for top level rows
+    void invalidate(const QModelIndex &parent);
+    void invalidateAll();
+
+    QHash<QString, QVector<Item>> m_catalogs;
+    QHash<SnippetRepository *, QVector<Item>> m_repositoryItems;
+
+    // the items of the current completion, these are shared with the catalog
+    QVector<Item> m_snippets;
 };
 
 #endif
@@ -13,9 +13,14 @@
 #include "snippet.h"
 
 #include <QAction>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
 #include <QFile>
 #include <QFileInfo>
+#include <QSaveFile>
 #include <QTimer>
+#include <QXmlStreamReader>
 
 #include <QDomDocument>
 #include <QDomElement>
@@ -41,6 +46,10 @@ function year() { return new Date().getFullYear(); }\n\
 function upper(x) { return x.toUpperCase(); }\n\
 function lower(x) { return x.toLowerCase(); }\n");
 
+// binary copy of a repository file, valid as long as the file has the same mtime and size
+static const quint32 CacheMagic = 0x31434e53; // "SNC1"
+static const quint32 CacheVersion = 1;
+
 SnippetRepository::SnippetRepository(const QString &file)
     : QStandardItem(i18n("<empty repository>"))
     , m_file(file)
@@ -52,8 +61,10 @@ SnippetRepository::SnippetRepository(const QString &file)
     setCheckState(activated ? Qt::Checked : Qt::Unchecked);
 
     if (QFile::exists(file)) {
-        // Tell the new repository to load it's snippets
-        QTimer::singleShot(0, this, &SnippetRepository::slotParseFile);
+        // Tell the new repository to load it's name and filetypes, the snippets come on first use
+        QTimer::singleShot(0, this, &SnippetRepository::slotParseHeader);
+    } else {
+        m_loaded = true;
     }
 
     qDebug() << "created new snippet repo" << file << this;
@@ -120,6 +131,8 @@ void SnippetRepository::setFileTypes(const QStringList &filetypes)
     } else {
         m_filetypes = filetypes;
     }
+    // not part of the item data, still let the completion know
+    emitDataChanged();
 }
 
 QString SnippetRepository::license() const
@@ -140,6 +153,7 @@ QString SnippetRepository::completionNamespace() const
 void SnippetRepository::setCompletionNamespace(const QString &completionNamespace)
 {
     m_namespace = completionNamespace;
+    emitDataChanged();
 }
 
 QString SnippetRepository::script() const
@@ -155,6 +169,7 @@ void SnippetRepository::setScript(const QString &script)
 void SnippetRepository::remove()
 {
     QFile::remove(m_file);
+    QFile::remove(cacheFile());
     setCheckState(Qt::Unchecked);
     model()->invisibleRootItem()->removeRow(row());
 }
@@ -171,6 +186,9 @@ static void addAndCreateElement(QDomDocument &doc, QDomElement &item, const QStr
 void SnippetRepository::save()
 {
     qDebug() << "*** called";
+    // else the snippets not loaded yet would be lost
+    load();
+
     /// based on the code from snippets_tng/lib/completionmodel.cpp
     ///@copyright 2009 Joseph Wenninger <jowenn@kde.org>
     /*
@@ -239,6 +257,7 @@ void SnippetRepository::save()
     outfile.write(doc.toByteArray());
     outfile.close();
     m_file = outname;
+    writeCache();
 
     // save shortcuts
     KConfigGroup config = SnippetStore::self()->getConfig().group(QLatin1String("repository ") + m_file);
@@ -260,7 +279,76 @@ void SnippetRepository::save()
     config.sync();
 }
 
-void SnippetRepository::slotParseFile()
+bool SnippetRepository::isLoaded() const
+{
+    return m_loaded;
+}
+
+void SnippetRepository::load()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+
+    QList<QPair<QString, QString>> snippets;
+    if (!readCache(&snippets)) {
+        if (!parseFile(&snippets)) {
+            return;
+        }
+        writeCache(snippets);
+    }
+
+    // load shortcuts
+    KConfigGroup config = SnippetStore::self()->getConfig().group(QLatin1String("repository ") + m_file);
+
+    QList<QStandardItem *> items;
+    for (const auto &match : qAsConst(snippets)) {
+        // require at least a non-empty name and snippet
+        if (match.first.isEmpty() || match.second.isEmpty()) {
+            continue;
+        }
+        Snippet *snippet = new Snippet;
+        snippet->setText(match.first);
+        snippet->setSnippet(match.second);
+
+        const QStringList shortcuts = config.readEntry(QLatin1String("shortcut ") + snippet->text(), QStringList());
+        QList<QKeySequence> sequences;
+        for (const QString &shortcut : shortcuts) {
+            sequences << QKeySequence::fromString(shortcut);
+        }
+
+        snippet->action()->setShortcuts(sequences);
+
+        items << snippet;
+    }
+
+    // one insertion, the views register the snippet actions for each one
+    if (!items.isEmpty()) {
+        appendRows(items);
+    }
+}
+
+void SnippetRepository::slotParseHeader()
+{
+    if (!readCache(nullptr) && !parseFile(nullptr)) {
+        // nothing to load later
+        m_loaded = true;
+        return;
+    }
+
+    // the snippet actions must exist for their shortcuts to work
+    const KConfigGroup config = SnippetStore::self()->getConfig().group(QLatin1String("repository ") + m_file);
+    const QStringList keys = config.keyList();
+    for (const QString &key : keys) {
+        if (key.startsWith(QLatin1String("shortcut ")) && !config.readEntry(key, QStringList()).isEmpty()) {
+            load();
+            break;
+        }
+    }
+}
+
+bool SnippetRepository::parseFile(QList<QPair<QString, QString>> *snippets)
 {
     /// based on the code from snippets_tng/lib/completionmodel.cpp
     ///@copyright 2009 Joseph Wenninger <jowenn@kde.org>
@@ -269,83 +357,151 @@ void SnippetRepository::slotParseFile()
 
     if (!f.open(QIODevice::ReadOnly)) {
         KMessageBox::error(QApplication::activeWindow(), i18n("Cannot open snippet repository %1.", m_file));
-        return;
+        return false;
     }
 
-    QDomDocument doc;
-    QString errorMsg;
-    int line, col;
-    bool success = doc.setContent(&f, &errorMsg, &line, &col);
-    f.close();
-
-    if (!success) {
-        KMessageBox::error(QApplication::activeWindow(), i18n("<qt>The error <b>%4</b><br /> has been detected in the file %1 at %2/%3</qt>", m_file, line, col, i18nc("QXml", errorMsg.toUtf8().data())));
-        return;
-    }
+    QXmlStreamReader xml(&f);
 
     // parse root item
-    const QDomElement &docElement = doc.documentElement();
-    if (docElement.tagName() != QLatin1String("snippets")) {
-        KMessageBox::error(QApplication::activeWindow(), i18n("Invalid XML snippet file: %1", m_file));
-        return;
-    }
-    setLicense(docElement.attribute(QStringLiteral("license")));
-    setAuthors(docElement.attribute(QStringLiteral("authors")));
+    if (!xml.readNextStartElement() || xml.name() != QLatin1String("snippets")) {
+        if (!xml.hasError()) {
+            KMessageBox::error(QApplication::activeWindow(), i18n("Invalid XML snippet file: %1", m_file));
+            return false;
+        }
+    } else {
+        const QXmlStreamAttributes attributes = xml.attributes();
+        setLicense(attributes.value(QLatin1String("license")).toString());
+        setAuthors(attributes.value(QLatin1String("authors")).toString());
 #if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
-    setFileTypes(docElement.attribute(QStringLiteral("filetypes")).split(QLatin1Char(';'), QString::SkipEmptyParts));
+        setFileTypes(attributes.value(QLatin1String("filetypes")).toString().split(QLatin1Char(';'), QString::SkipEmptyParts));
 #else
-    setFileTypes(docElement.attribute(QStringLiteral("filetypes")).split(QLatin1Char(';'), Qt::SkipEmptyParts));
+        setFileTypes(attributes.value(QLatin1String("filetypes")).toString().split(QLatin1Char(';'), Qt::SkipEmptyParts));
 #endif
-    setText(docElement.attribute(QStringLiteral("name")));
-    setCompletionNamespace(docElement.attribute(QStringLiteral("namespace")));
-
-    // load shortcuts
-    KConfigGroup config = SnippetStore::self()->getConfig().group(QLatin1String("repository ") + m_file);
+        setText(attributes.value(QLatin1String("name")).toString());
+        setCompletionNamespace(attributes.value(QLatin1String("namespace")).toString());
 
-    // parse children, i.e. <item>'s
-    const QDomNodeList &nodes = docElement.childNodes();
-    for (int i = 0; i < nodes.size(); ++i) {
-        const QDomNode &node = nodes.at(i);
-        if (!node.isElement()) {
-            continue;
-        }
-        const QDomElement &item = node.toElement();
-        if (item.tagName() == QLatin1String("script")) {
-            setScript(item.text());
+        // the header is all we need for now
+        if (!snippets) {
+            return true;
         }
-        if (item.tagName() != QLatin1String("item")) {
-            continue;
-        }
-        Snippet *snippet = new Snippet;
-        const QDomNodeList &children = node.childNodes();
-        for (int j = 0; j < children.size(); ++j) {
-            const QDomNode &childNode = children.at(j);
-            if (!childNode.isElement()) {
+
+        // parse children, i.e. <item>'s
+        while (xml.readNextStartElement()) {
+            if (xml.name() == QLatin1String("script")) {
+                setScript(xml.readElementText(QXmlStreamReader::IncludeChildElements));
+                continue;
+            }
+            if (xml.name() != QLatin1String("item")) {
+                xml.skipCurrentElement();
                 continue;
             }
-            const QDomElement &child = childNode.toElement();
-            if (child.tagName() == QLatin1String("match")) {
-                snippet->setText(child.text());
-            } else if (child.tagName() == QLatin1String("fillin")) {
-                snippet->setSnippet(child.text());
+            QPair<QString, QString> snippet;
+            while (xml.readNextStartElement()) {
+                if (xml.name() == QLatin1String("match")) {
+                    snippet.first = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+                } else if (xml.name() == QLatin1String("fillin")) {
+                    snippet.second = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+                } else {
+                    xml.skipCurrentElement();
+                }
             }
+            snippets->append(snippet);
         }
-        // require at least a non-empty name and snippet
-        if (snippet->text().isEmpty() || snippet->snippet().isEmpty()) {
-            delete snippet;
-            continue;
-        } else {
-            const QStringList shortcuts = config.readEntry(QLatin1String("shortcut ") + snippet->text(), QStringList());
-            QList<QKeySequence> sequences;
-            for (const QString &shortcut : shortcuts) {
-                sequences << QKeySequence::fromString(shortcut);
-            }
+    }
+
+    if (xml.hasError()) {
+        KMessageBox::error(QApplication::activeWindow(),
+                           i18n("<qt>The error <b>%4</b><br /> has been detected in the file %1 at %2/%3</qt>",
+                                m_file,
+                                xml.lineNumber(),
+                                xml.columnNumber(),
+                                i18nc("QXml", xml.errorString().toUtf8().data())));
+        return false;
+    }
+    return true;
+}
+
+QString SnippetRepository::cacheFile() const
+{
+    const QByteArray hash = QCryptographicHash::hash(m_file.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/snippets/") + QString::fromLatin1(hash) + QLatin1String(".cache");
+}
+
+bool SnippetRepository::readCache(QList<QPair<QString, QString>> *snippets)
+{
+    QFile file(cacheFile());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_10);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString fileName;
+    qint64 mtime = 0;
+    qint64 size = 0;
+    stream >> magic >> version >> fileName >> mtime >> size;
+
+    const QFileInfo info(m_file);
+    if (stream.status() != QDataStream::Ok || magic != CacheMagic || version != CacheVersion || fileName != m_file || mtime != info.lastModified().toMSecsSinceEpoch()
+        || size != info.size()) {
+        return false;
+    }
+
+    QString name;
+    QString license;
+    QString authors;
+    QStringList fileTypes;
+    QString completionNamespace;
+    QString script;
+    stream >> name >> license >> authors >> fileTypes >> completionNamespace >> script;
+    if (snippets) {
+        *snippets = {};
+        stream >> *snippets;
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
 
-            snippet->action()->setShortcuts(sequences);
+    setText(name);
+    setLicense(license);
+    setAuthors(authors);
+    setFileTypes(fileTypes);
+    setCompletionNamespace(completionNamespace);
+    setScript(script);
+    return true;
+}
+
+void SnippetRepository::writeCache(const QList<QPair<QString, QString>> &snippets)
+{
+    const QString fileName = cacheFile();
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
 
-            appendRow(snippet);
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_10);
+
+    const QFileInfo info(m_file);
+    stream << CacheMagic << CacheVersion << m_file << info.lastModified().toMSecsSinceEpoch() << info.size();
+    stream << text() << m_license << m_authors << m_filetypes << m_namespace << m_script << snippets;
+    file.commit();
+}
+
+void SnippetRepository::writeCache()
+{
+    QList<QPair<QString, QString>> snippets;
+    for (int i = 0; i < rowCount(); ++i) {
+        if (Snippet *snippet = dynamic_cast<Snippet *>(child(i))) {
+            snippets.append(qMakePair(snippet->text(), snippet->snippet()));
         }
     }
+    writeCache(snippets);
 }
 
 QVariant SnippetRepository::data(int role) const
@@ -112,6 +112,18 @@ public:
      */
     void setScript(const QString &script);
 
+    /**
+     * Whether the snippets were loaded, at first only the name, filetypes and
+     * the other attributes of the repository are.
+     */
+    bool isLoaded() const;
+
+    /**
+     * Load the snippets, if not done yet. Reads the cache if the file did
+     * not change since it was written, else parses the file.
+     */
+    void load();
+
     /**
      * Remove this repository from the disk. Also deletes the item and all its children.
      */
@@ -131,8 +143,19 @@ public:
     void setData(const QVariant &value, int role = Qt::UserRole + 1) override;
 
 private Q_SLOTS:
-    /// parses the XML file and load the containing snippets.
-    void slotParseFile();
+    /// reads the attributes of the repository from the cache or the XML file.
+    void slotParseHeader();
+
+private:
+    /// parses the XML file, only the root element if @p snippets is null.
+    bool parseFile(QList<QPair<QString, QString>> *snippets);
+
+    /// path of the binary copy of the repository file
+    QString cacheFile() const;
+    /// reads the cache, the snippets only if @p snippets is not null.
+    bool readCache(QList<QPair<QString, QString>> *snippets);
+    void writeCache(const QList<QPair<QString, QString>> &snippets);
+    void writeCache();
 
 private:
     /// path to the repository file
@@ -147,6 +170,8 @@ private:
     QString m_namespace;
     /// QtScript with functions to be used in the snippets; common to all snippets
     QString m_script;
+    /// whether the snippets were loaded
+    bool m_loaded = false;
 };
 
 #endif
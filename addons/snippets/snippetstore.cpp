@@ -119,3 +119,21 @@ SnippetRepository *SnippetStore::repositoryForFile(const QString &file)
     }
     return nullptr;
 }
+
+bool SnippetStore::hasChildren(const QModelIndex &parent) const
+{
+    return canFetchMore(parent) || QStandardItemModel::hasChildren(parent);
+}
+
+bool SnippetStore::canFetchMore(const QModelIndex &parent) const
+{
+    SnippetRepository *repo = dynamic_cast<SnippetRepository *>(itemFromIndex(parent));
+    return repo && !repo->isLoaded();
+}
+
+void SnippetStore::fetchMore(const QModelIndex &parent)
+{
+    if (SnippetRepository *repo = dynamic_cast<SnippetRepository *>(itemFromIndex(parent))) {
+        repo->load();
+    }
+}
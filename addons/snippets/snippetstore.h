@@ -49,6 +49,13 @@ public:
      */
     SnippetRepository *repositoryForFile(const QString &file);
 
+    /**
+     * The snippets of a repository are loaded when it is expanded.
+     */
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
 private:
     SnippetStore(KateSnippetGlobal *plugin);
 
@@ -88,6 +88,18 @@ SnippetView::SnippetView(KateSnippetGlobal *plugin, KTextEditor::MainWindow *mai
     m_proxy->setFilterKeyColumn(0);
     m_proxy->setSourceModel(SnippetStore::self());
 
+    // the filter searches all snippets, load them first
+    connect(filterText, &KLineEdit::textChanged, this, [](const QString &text) {
+        if (text.isEmpty()) {
+            return;
+        }
+        SnippetStore *store = SnippetStore::self();
+        for (int i = 0; i < store->rowCount(); i++) {
+            if (auto repo = dynamic_cast<SnippetRepository *>(store->item(i))) {
+                repo->load();
+            }
+        }
+    });
     connect(filterText, &KLineEdit::textChanged, m_proxy, &QSortFilterProxyModel::setFilterFixedString);
 
     snippetTree->setModel(m_proxy);
@@ -247,6 +259,9 @@ void SnippetView::slotAddSnippet()
             return;
     }
 
+    // the new snippet goes after the existing ones
+    repo->load();
+
     EditSnippet dlg(repo, nullptr, this);
     dlg.exec();
 }
@@ -0,0 +1,102 @@
+/* This file is part of the KDE project
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#include "symbolindextest.h"
+#include "symbolindex.h"
+
+#include <QTreeWidgetItem>
+#include <QtTestWidgets>
+
+QTEST_MAIN(KateSymbolIndexTest)
+
+static QTreeWidgetItem *addSymbol(QTreeWidgetItem *parent, const QString &name, int line)
+{
+    QTreeWidgetItem *item = new QTreeWidgetItem(parent);
+    item->setText(0, name);
+    item->setText(1, QString::number(line));
+    return item;
+}
+
+void KateSymbolIndexTest::testList()
+{
+    QTreeWidgetItem root;
+    // no position, e.g. "Sorry, not supported yet!"
+    addSymbol(&root, QStringLiteral("Sorry"), -1);
+    addSymbol(&root, QStringLiteral("b"), 20);
+    QTreeWidgetItem *a = addSymbol(&root, QStringLiteral("a"), 10);
+    QTreeWidgetItem *c = addSymbol(&root, QStringLiteral("c"), 20);
+
+    KateSymbolIndex index;
+    index.rebuild(&root);
+    QCOMPARE(index.size(), 3);
+
+    QVERIFY(!index.itemAt(-1));
+    QVERIFY(!index.itemAt(9));
+    QCOMPARE(index.itemAt(10), a);
+    QCOMPARE(index.itemAt(19), a);
+    // same line, the last one of the tree
+    QCOMPARE(index.itemAt(20), c);
+    QCOMPARE(index.itemAt(1000), c);
+
+    index.clear();
+    QVERIFY(!index.itemAt(20));
+}
+
+void KateSymbolIndexTest::testTree()
+{
+    // the category nodes have no position, like in tree mode
+    QTreeWidgetItem root;
+    QTreeWidgetItem *functions = new QTreeWidgetItem(&root);
+    functions->setText(0, QStringLiteral("Functions"));
+    QTreeWidgetItem *classes = new QTreeWidgetItem(&root);
+    classes->setText(0, QStringLiteral("Classes"));
+
+    QTreeWidgetItem *main = addSymbol(functions, QStringLiteral("main"), 50);
+    QTreeWidgetItem *foo = addSymbol(classes, QStringLiteral("Foo"), 5);
+    QTreeWidgetItem *bar = addSymbol(foo, QStringLiteral("bar"), 7);
+
+    KateSymbolIndex index;
+    index.rebuild(&root);
+    QCOMPARE(index.size(), 5);
+
+    QCOMPARE(index.itemAt(0), classes);
+    QCOMPARE(index.itemAt(5), foo);
+    QCOMPARE(index.itemAt(6), foo);
+    QCOMPARE(index.itemAt(7), bar);
+    QCOMPARE(index.itemAt(49), bar);
+    QCOMPARE(index.itemAt(50), main);
+}
+
+void KateSymbolIndexTest::benchmarkItemAt()
+{
+    const int SymbolCount = 10000;
+    QTreeWidgetItem root;
+    for (int i = 0; i < SymbolCount / 10; ++i) {
+        QTreeWidgetItem *cls = addSymbol(&root, QStringLiteral("Class%1").arg(i), i * 100);
+        for (int j = 1; j < 10; ++j) {
+            addSymbol(cls, QStringLiteral("method%1").arg(j), i * 100 + j * 10);
+        }
+    }
+
+    KateSymbolIndex index;
+    QBENCHMARK_ONCE {
+        index.rebuild(&root);
+    }
+    QCOMPARE(index.size(), SymbolCount);
+
+    for (int line = 0; line < SymbolCount * 10; line += 7) {
+        QCOMPARE(index.itemAt(line)->text(1).toInt(), line - line % 10);
+    }
+
+    // a cursor moving through the whole file
+    QTreeWidgetItem *item = nullptr;
+    QBENCHMARK {
+        for (int line = 0; line < SymbolCount * 10; line++) {
+            item = index.itemAt(line);
+        }
+    }
+    QCOMPARE(item->text(0), QStringLiteral("method9"));
+}
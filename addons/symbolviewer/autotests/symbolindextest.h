@@ -0,0 +1,24 @@
+/* This file is part of the KDE project
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#ifndef SYMBOL_INDEX_TEST_H
+#define SYMBOL_INDEX_TEST_H
+
+#include <QObject>
+
+class KateSymbolIndexTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testList();
+    void testTree();
+    void benchmarkItemAt();
+};
+
+#endif
+
+// kate: space-indent on; indent-width 4; replace-tabs on;
@@ -9,13 +9,10 @@
    SPDX-License-Identifier: GPL-2.0-or-later
 ***************************************************************************/
 
-#include "plugin_katesymbolviewer.h"
+#include "symbolparser.h"
 
-void KatePluginSymbolViewerView::parseBashSymbols(void)
+void KateSymbolParser::parseBashSymbols(void)
 {
-    if (!m_mainWindow->activeView())
-        return;
-
     QString currline;
     QString funcStr(QStringLiteral("function "));
 
@@ -26,29 +23,27 @@ void KatePluginSymbolViewerView::parseBashSymbols(void)
     QTreeWidgetItem *funcNode = nullptr;
     QTreeWidgetItem *lastFuncNode = nullptr;
 
-    QPixmap func(class_xpm);
+    const Icon func = ClassIcon;
 
     // It is necessary to change names
-    m_func->setText(i18n("Show Functions"));
+    m_funcLabel = i18n("Show Functions");
 
-    if (m_treeOn->isChecked()) {
-        funcNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Functions")));
-        funcNode->setIcon(0, QIcon(func));
+    if (m_options.treeMode) {
+        funcNode = new QTreeWidgetItem(m_root, QStringList(i18n("Functions")));
+        setIcon(funcNode, func);
 
-        if (m_expandOn->isChecked()) {
-            m_symbols->expandItem(funcNode);
+        if (m_options.expandTree) {
+            expandItem(funcNode);
         }
 
         lastFuncNode = funcNode;
 
-        m_symbols->setRootIsDecorated(1);
+        m_rootIsDecorated = true;
     } else
-        m_symbols->setRootIsDecorated(0);
-
-    KTextEditor::Document *kDoc = m_mainWindow->activeView()->document();
+        m_rootIsDecorated = false;
 
-    for (i = 0; i < kDoc->lines(); i++) {
-        currline = kDoc->line(i);
+    for (i = 0; i < m_lines.size(); i++) {
+        currline = m_lines.at(i);
         currline = currline.trimmed();
         currline = currline.simplified();
 
@@ -60,7 +55,7 @@ void KatePluginSymbolViewerView::parseBashSymbols(void)
             comment = true;
 
         // mainprog=false;
-        if (!comment && m_func->isChecked()) {
+        if (!comment && m_options.showFunctions) {
             QString funcName;
 
             // skip line if no function defined
@@ -75,14 +70,14 @@ void KatePluginSymbolViewerView::parseBashSymbols(void)
                 continue;
             funcName.append(QLatin1String("()"));
 
-            if (m_treeOn->isChecked()) {
+            if (m_options.treeMode) {
                 node = new QTreeWidgetItem(funcNode, lastFuncNode);
                 lastFuncNode = node;
             } else
-                node = new QTreeWidgetItem(m_symbols);
+                node = new QTreeWidgetItem(m_root);
 
             node->setText(0, funcName);
-            node->setIcon(0, QIcon(func));
+            setIcon(node, func);
             node->setText(1, QString::number(i, 10));
         }
     } // for i loop
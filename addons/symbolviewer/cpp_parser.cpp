@@ -10,13 +10,13 @@
  *   SPDX-License-Identifier: GPL-2.0-or-later
  *                                                                         *
  ***************************************************************************/
-#include "plugin_katesymbolviewer.h"
+#include "symbolparser.h"
 
-void KatePluginSymbolViewerView::parseCppSymbols(void)
-{
-    if (!m_mainWindow->activeView())
-        return;
+// how often the state is kept to resume from
+static const int CheckpointInterval = 256;
 
+void KateSymbolParser::parseCppSymbols(void)
+{
     QString cl; // Current Line
     QString stripped;
     int i, j, tmpPos = 0;
@@ -24,47 +24,101 @@ void KatePluginSymbolViewerView::parseCppSymbols(void)
     char mclass = 0, block = 0, comment = 0; // comment: 0-no comment 1-inline comment 2-multiline comment 3-string
     char macro = 0 /*, macro_pos = 0*/, func_close = 0;
     bool structure = false;
-    QPixmap cls(class_xpm);
-    QPixmap sct(struct_xpm);
-    QPixmap mcr(macro_xpm);
-    QPixmap mtd(method_xpm);
+    const Icon cls = ClassIcon;
+    const Icon sct = StructIcon;
+    const Icon mcr = MacroIcon;
+    const Icon mtd = MethodIcon;
 
     // It is necessary to change names to defaults
-    m_macro->setText(i18n("Show Macros"));
-    m_struct->setText(i18n("Show Structures"));
-    m_func->setText(i18n("Show Functions"));
+    m_macroLabel = i18n("Show Macros");
+    m_structLabel = i18n("Show Structures");
+    m_funcLabel = i18n("Show Functions");
 
     QTreeWidgetItem *node = nullptr;
     QTreeWidgetItem *mcrNode = nullptr, *sctNode = nullptr, *clsNode = nullptr, *mtdNode = nullptr;
     QTreeWidgetItem *lastMcrNode = nullptr, *lastSctNode = nullptr, *lastClsNode = nullptr, *lastMtdNode = nullptr;
 
-    KTextEditor::Document *kv = m_mainWindow->activeView()->document();
+    i = 0;
+    auto checkpoint = m_cppCheckpoints.upperBound(m_firstChangedLine);
+    if (checkpoint != m_cppCheckpoints.begin()) {
+        // resume with the state at the start of the checkpoint line
+        --checkpoint;
+        i = checkpoint.key();
+        const CppState &state = checkpoint.value();
+        stripped = state.stripped;
+        tmpPos = state.tmpPos;
+        par = state.par;
+        graph = state.graph;
+        mclass = state.mclass;
+        block = state.block;
+        comment = state.comment;
+        macro = state.macro;
+        structure = state.structure;
+        mcrNode = state.mcrNode;
+        sctNode = state.sctNode;
+        clsNode = state.clsNode;
+        mtdNode = state.mtdNode;
+        lastMcrNode = state.lastMcrNode;
+        lastSctNode = state.lastSctNode;
+        lastClsNode = state.lastClsNode;
+        lastMtdNode = state.lastMtdNode;
 
-    // qDebug(13000)<<"Lines counted :"<<kv->lines();
-    if (m_treeOn->isChecked()) {
-        mcrNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Macros")));
-        sctNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Structures")));
-        clsNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Functions")));
-        mcrNode->setIcon(0, QIcon(mcr));
-        sctNode->setIcon(0, QIcon(sct));
-        clsNode->setIcon(0, QIcon(cls));
-        if (m_expandOn->isChecked()) {
-            m_symbols->expandItem(mcrNode);
-            m_symbols->expandItem(sctNode);
-            m_symbols->expandItem(clsNode);
+        // the symbols from there on are found again
+        while (m_cppCheckpoints.lastKey() > i) {
+            m_cppCheckpoints.erase(--m_cppCheckpoints.end());
         }
-        lastMcrNode = mcrNode;
-        lastSctNode = sctNode;
-        lastClsNode = clsNode;
-        mtdNode = clsNode;
-        lastMtdNode = clsNode;
-        m_symbols->setRootIsDecorated(1);
-    } else
-        m_symbols->setRootIsDecorated(0);
+        truncate(i);
+    } else {
+        clear();
+
+        // qDebug(13000)<<"Lines counted :"<<m_lines.size();
+        if (m_options.treeMode) {
+            mcrNode = new QTreeWidgetItem(m_root, QStringList(i18n("Macros")));
+            sctNode = new QTreeWidgetItem(m_root, QStringList(i18n("Structures")));
+            clsNode = new QTreeWidgetItem(m_root, QStringList(i18n("Functions")));
+            setIcon(mcrNode, mcr);
+            setIcon(sctNode, sct);
+            setIcon(clsNode, cls);
+            if (m_options.expandTree) {
+                expandItem(mcrNode);
+                expandItem(sctNode);
+                expandItem(clsNode);
+            }
+            lastMcrNode = mcrNode;
+            lastSctNode = sctNode;
+            lastClsNode = clsNode;
+            mtdNode = clsNode;
+            lastMtdNode = clsNode;
+            m_rootIsDecorated = true;
+        } else
+            m_rootIsDecorated = false;
+    }
 
-    for (i = 0; i < kv->lines(); i++) {
+    for (; i < m_lines.size(); i++) {
         // qDebug(13000)<<"Current line :"<<i;
-        cl = kv->line(i);
+        m_currentLine = i;
+        if (i % CheckpointInterval == 0) {
+            CppState &state = m_cppCheckpoints[i];
+            state.stripped = stripped;
+            state.tmpPos = tmpPos;
+            state.par = par;
+            state.graph = graph;
+            state.mclass = mclass;
+            state.block = block;
+            state.comment = comment;
+            state.macro = macro;
+            state.structure = structure;
+            state.mcrNode = mcrNode;
+            state.sctNode = sctNode;
+            state.clsNode = clsNode;
+            state.mtdNode = mtdNode;
+            state.lastMcrNode = lastMcrNode;
+            state.lastSctNode = lastSctNode;
+            state.lastClsNode = lastClsNode;
+            state.lastMtdNode = lastMtdNode;
+        }
+
+        cl = m_lines.at(i);
         cl = cl.trimmed();
         func_close = 0;
         if ((cl.length() >= 2) && (cl.at(0) == QLatin1Char('/') && cl.at(1) == QLatin1Char('/')))
@@ -106,14 +160,14 @@ void KatePluginSymbolViewerView::parseCppSymbols(void)
                 if (macro == 4) {
                     // stripped.replace(0x9, QLatin1String(" "));
                     stripped = stripped.trimmed();
-                    if (m_macro->isChecked()) {
-                        if (m_treeOn->isChecked()) {
+                    if (m_options.showMacros) {
+                        if (m_options.treeMode) {
                             node = new QTreeWidgetItem(mcrNode, lastMcrNode);
                             lastMcrNode = node;
                         } else
-                            node = new QTreeWidgetItem(m_symbols);
+                            node = new QTreeWidgetItem(m_root);
                         node->setText(0, stripped);
-                        node->setIcon(0, QIcon(mcr));
+                        setIcon(node, mcr);
                         node->setText(1, QString::number(i, 10));
                     }
                     macro = 0;
@@ -146,18 +200,18 @@ void KatePluginSymbolViewerView::parseCppSymbols(void)
                     }
                     stripped += cl.at(j);
                 }
-                if (m_func->isChecked()) {
-                    if (m_treeOn->isChecked()) {
+                if (m_options.showFunctions) {
+                    if (m_options.treeMode) {
                         node = new QTreeWidgetItem(clsNode, lastClsNode);
-                        if (m_expandOn->isChecked())
-                            m_symbols->expandItem(node);
+                        if (m_options.expandTree)
+                            expandItem(node);
                         lastClsNode = node;
                         mtdNode = lastClsNode;
                         lastMtdNode = lastClsNode;
                     } else
-                        node = new QTreeWidgetItem(m_symbols);
+                        node = new QTreeWidgetItem(m_root);
                     node->setText(0, stripped);
-                    node->setIcon(0, QIcon(cls));
+                    setIcon(node, cls);
                     node->setText(1, QString::number(i, 10));
                     stripped.clear();
                     if (mclass == 1)
@@ -254,9 +308,9 @@ void KatePluginSymbolViewerView::parseCppSymbols(void)
 
                             if ((cl.at(j) == QLatin1Char('{') && structure == false && cl.indexOf(QLatin1Char(';')) < 0) || (cl.at(j) == QLatin1Char('{') && structure == false && cl.indexOf(QLatin1Char('}')) > j)) {
                                 stripped.replace(0x9, QLatin1String(" "));
-                                if (m_func->isChecked()) {
+                                if (m_options.showFunctions) {
                                     QString strippedWithTypes = stripped;
-                                    if (!m_typesOn->isChecked()) {
+                                    if (!m_options.showTypes) {
                                         while (stripped.indexOf(QLatin1Char('(')) >= 0)
                                             stripped = stripped.left(stripped.indexOf(QLatin1Char('(')));
                                         while (stripped.indexOf(QLatin1String("::")) >= 0)
@@ -267,7 +321,7 @@ void KatePluginSymbolViewerView::parseCppSymbols(void)
                                         while ((stripped.length() > 0) && ((stripped.at(0) == QLatin1Char('*')) || (stripped.at(0) == QLatin1Char('&'))))
                                             stripped = stripped.right(stripped.length() - 1);
                                     }
-                                    if (m_treeOn->isChecked()) {
+                                    if (m_options.treeMode) {
                                         if (mclass == 4) {
                                             node = new QTreeWidgetItem(mtdNode, lastMtdNode);
                                             lastMtdNode = node;
@@ -276,12 +330,12 @@ void KatePluginSymbolViewerView::parseCppSymbols(void)
                                             lastClsNode = node;
                                         }
                                     } else
-                                        node = new QTreeWidgetItem(m_symbols);
+                                        node = new QTreeWidgetItem(m_root);
                                     node->setText(0, stripped);
                                     if (mclass == 4)
-                                        node->setIcon(0, QIcon(mtd));
+                                        setIcon(node, mtd);
                                     else
-                                        node->setIcon(0, QIcon(cls));
+                                        setIcon(node, cls);
                                     node->setText(1, QString::number(tmpPos, 10));
                                     node->setToolTip(0, strippedWithTypes);
                                 }
@@ -327,14 +381,14 @@ void KatePluginSymbolViewerView::parseCppSymbols(void)
                                 // stripped.replace(0x9, QLatin1String(" "));
                                 stripped.remove(QLatin1Char('{'));
                                 stripped.replace(QLatin1Char('}'), QLatin1String(" "));
-                                if (m_struct->isChecked()) {
-                                    if (m_treeOn->isChecked()) {
+                                if (m_options.showStructures) {
+                                    if (m_options.treeMode) {
                                         node = new QTreeWidgetItem(sctNode, lastSctNode);
                                         lastSctNode = node;
                                     } else
-                                        node = new QTreeWidgetItem(m_symbols);
+                                        node = new QTreeWidgetItem(m_root);
                                     node->setText(0, stripped);
-                                    node->setIcon(0, QIcon(sct));
+                                    setIcon(node, sct);
                                     node->setText(1, QString::number(tmpPos, 10));
                                 }
                                 // qDebug(13000)<<"Structure -- Inserted : "<<stripped<<" at row : "<<i;
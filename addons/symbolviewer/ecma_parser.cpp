@@ -10,14 +10,10 @@
  *   SPDX-License-Identifier: GPL-2.0-or-later
  *                                                                         *
  ***************************************************************************/
-#include "plugin_katesymbolviewer.h"
+#include "symbolparser.h"
 
-void KatePluginSymbolViewerView::parseEcmaSymbols(void)
+void KateSymbolParser::parseEcmaSymbols(void)
 {
-    // make sure there is an active view to attach to
-    if (!m_mainWindow->activeView())
-        return;
-
     // the current line
     QString cl;
     // the current line stripped of all comments and strings
@@ -37,21 +33,20 @@ void KatePluginSymbolViewerView::parseEcmaSymbols(void)
     // a list of inserted nodes with the index being the brace depth at insertion
     QList<QTreeWidgetItem *> nodes;
 
-    QPixmap cls(class_xpm);
-    QPixmap mtd(method_xpm);
+    const Icon cls = ClassIcon;
+    const Icon mtd = MethodIcon;
     QTreeWidgetItem *node = nullptr;
 
-    if (m_treeOn->isChecked()) {
-        m_symbols->setRootIsDecorated(1);
+    if (m_options.treeMode) {
+        m_rootIsDecorated = true;
     } else {
-        m_symbols->setRootIsDecorated(0);
+        m_rootIsDecorated = false;
     }
 
     // read the document line by line
-    KTextEditor::Document *kv = m_mainWindow->activeView()->document();
-    for (line = 0; line < kv->lines(); line++) {
+    for (line = 0; line < m_lines.size(); line++) {
         // get a line to process, trimming off whitespace
-        cl = kv->line(line);
+        cl = m_lines.at(line);
         cl = cl.trimmed();
         stripped.clear();
         bool in_string = false;
@@ -126,19 +121,19 @@ void KatePluginSymbolViewerView::parseEcmaSymbols(void)
                 // trim whitespace
                 identifier = identifier.trimmed();
                 // get the node to add the class entry to
-                if ((m_treeOn->isChecked()) && (!nodes.isEmpty())) {
+                if ((m_options.treeMode) && (!nodes.isEmpty())) {
                     node = new QTreeWidgetItem(nodes.last());
-                    if (m_expandOn->isChecked())
-                        m_symbols->expandItem(node);
+                    if (m_options.expandTree)
+                        expandItem(node);
                 } else {
-                    node = new QTreeWidgetItem(m_symbols);
+                    node = new QTreeWidgetItem(m_root);
                 }
                 // add an entry for the class
                 node->setText(0, identifier);
-                node->setIcon(0, QIcon(cls));
+                setIcon(node, cls);
                 node->setText(1, QString::number(line, 10));
-                if (m_expandOn->isChecked())
-                    m_symbols->expandItem(node);
+                if (m_options.expandTree)
+                    expandItem(node);
             } // (look for classes)
 
             // look for function definitions
@@ -203,25 +198,25 @@ void KatePluginSymbolViewerView::parseEcmaSymbols(void)
                     if (!nodes.isEmpty()) {
                         parent = nodes.last();
                     }
-                    if ((m_treeOn->isChecked()) && (parent != nullptr))
+                    if ((m_options.treeMode) && (parent != nullptr))
                         node = new QTreeWidgetItem(parent);
                     else
-                        node = new QTreeWidgetItem(m_symbols);
+                        node = new QTreeWidgetItem(m_root);
                     // mark the parent as a class (if it's not the root level)
                     if (parent != nullptr) {
-                        parent->setIcon(0, QIcon(cls));
+                        setIcon(parent, cls);
                         // mark this function as a method of the parent
-                        node->setIcon(0, QIcon(mtd));
+                        setIcon(node, mtd);
                     }
                     // mark root-level functions as classes
                     else {
-                        node->setIcon(0, QIcon(cls));
+                        setIcon(node, cls);
                     }
                     // add the function
                     node->setText(0, identifier);
                     node->setText(1, QString::number(line, 10));
-                    if (m_expandOn->isChecked())
-                        m_symbols->expandItem(node);
+                    if (m_options.expandTree)
+                        expandItem(node);
                 }
             } // (look for functions)
 
@@ -249,19 +244,19 @@ void KatePluginSymbolViewerView::parseEcmaSymbols(void)
                     if (!nodes.isEmpty()) {
                         parent = nodes.last();
                     }
-                    if ((m_treeOn->isChecked()) && (parent != nullptr))
+                    if ((m_options.treeMode) && (parent != nullptr))
                         node = new QTreeWidgetItem(parent);
                     else
-                        node = new QTreeWidgetItem(m_symbols);
+                        node = new QTreeWidgetItem(m_root);
 
                     // mark the node as a class
-                    node->setIcon(0, QIcon(cls));
+                    setIcon(node, cls);
 
                     // add the id
                     node->setText(0, identifier);
                     node->setText(1, QString::number(line, 10));
-                    if (m_expandOn->isChecked())
-                        m_symbols->expandItem(node);
+                    if (m_options.expandTree)
+                        expandItem(node);
                 }
             }
 
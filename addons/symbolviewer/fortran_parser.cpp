@@ -11,13 +11,10 @@
  *                                                                         *
  ***************************************************************************/
 
-#include "plugin_katesymbolviewer.h"
+#include "symbolparser.h"
 
-void KatePluginSymbolViewerView::parseFortranSymbols(void)
+void KateSymbolParser::parseFortranSymbols(void)
 {
-    if (!m_mainWindow->activeView())
-        return;
-
     QString currline;
     QString subrStr(QStringLiteral("subroutine "));
     QString funcStr(QStringLiteral("function "));
@@ -32,40 +29,38 @@ void KatePluginSymbolViewerView::parseFortranSymbols(void)
     QTreeWidgetItem *subrNode = nullptr, *funcNode = nullptr, *modNode = nullptr;
     QTreeWidgetItem *lastSubrNode = nullptr, *lastFuncNode = nullptr, *lastModNode = nullptr;
 
-    QPixmap func(class_xpm);
-    QPixmap subr(macro_xpm);
-    QPixmap mod(struct_xpm);
+    const Icon func = ClassIcon;
+    const Icon subr = MacroIcon;
+    const Icon mod = StructIcon;
 
     // It is necessary to change names
-    m_macro->setText(i18n("Show Subroutines"));
-    m_struct->setText(i18n("Show Modules"));
-    m_func->setText(i18n("Show Functions"));
-
-    if (m_treeOn->isChecked()) {
-        funcNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Functions")));
-        subrNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Subroutines")));
-        modNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Modules")));
-        funcNode->setIcon(0, QIcon(func));
-        modNode->setIcon(0, QIcon(mod));
-        subrNode->setIcon(0, QIcon(subr));
-
-        if (m_expandOn->isChecked()) {
-            m_symbols->expandItem(funcNode);
-            m_symbols->expandItem(subrNode);
-            m_symbols->expandItem(modNode);
+    m_macroLabel = i18n("Show Subroutines");
+    m_structLabel = i18n("Show Modules");
+    m_funcLabel = i18n("Show Functions");
+
+    if (m_options.treeMode) {
+        funcNode = new QTreeWidgetItem(m_root, QStringList(i18n("Functions")));
+        subrNode = new QTreeWidgetItem(m_root, QStringList(i18n("Subroutines")));
+        modNode = new QTreeWidgetItem(m_root, QStringList(i18n("Modules")));
+        setIcon(funcNode, func);
+        setIcon(modNode, mod);
+        setIcon(subrNode, subr);
+
+        if (m_options.expandTree) {
+            expandItem(funcNode);
+            expandItem(subrNode);
+            expandItem(modNode);
         }
 
         lastSubrNode = subrNode;
         lastFuncNode = funcNode;
         lastModNode = modNode;
-        m_symbols->setRootIsDecorated(1);
+        m_rootIsDecorated = true;
     } else
-        m_symbols->setRootIsDecorated(0);
-
-    KTextEditor::Document *kDoc = m_mainWindow->activeView()->document();
+        m_rootIsDecorated = false;
 
-    for (i = 0; i < kDoc->lines(); i++) {
-        currline = kDoc->line(i);
+    for (i = 0; i < m_lines.size(); i++) {
+        currline = m_lines.at(i);
         currline = currline.trimmed();
         // currline = currline.simplified(); is this really needed ?
         // Fortran is case insensitive
@@ -105,7 +100,7 @@ void KatePluginSymbolViewerView::parseFortranSymbols(void)
             if (block == 1) {
                 if (currline.startsWith(QLatin1String("program ")))
                     mainprog = true;
-                if (m_macro->isChecked()) // not really a macro, but a subroutines
+                if (m_options.showMacros) // not really a macro, but a subroutines
                 {
                     stripped += currline.rightRef(currline.length());
                     stripped = stripped.simplified();
@@ -129,13 +124,13 @@ void KatePluginSymbolViewerView::parseFortranSymbols(void)
                         if (mainprog && stripped.indexOf(QLatin1Char('(')) < 0 && stripped.indexOf(QLatin1Char(')')) < 0)
                             stripped.prepend(QLatin1String("Main: "));
                         if (stripped.indexOf(QLatin1Char('=')) == -1) {
-                            if (m_treeOn->isChecked()) {
+                            if (m_options.treeMode) {
                                 node = new QTreeWidgetItem(subrNode, lastSubrNode);
                                 lastSubrNode = node;
                             } else
-                                node = new QTreeWidgetItem(m_symbols);
+                                node = new QTreeWidgetItem(m_root);
                             node->setText(0, stripped);
-                            node->setIcon(0, QIcon(subr));
+                            setIcon(node, subr);
                             node->setText(1, QString::number(i, 10));
                         }
                         stripped.clear();
@@ -151,7 +146,7 @@ void KatePluginSymbolViewerView::parseFortranSymbols(void)
 
             // Modules
             else if (block == 2) {
-                if (m_struct->isChecked()) // not really a struct, but a module
+                if (m_options.showStructures) // not really a struct, but a module
                 {
                     stripped = currline.right(currline.length());
                     stripped = stripped.simplified();
@@ -162,13 +157,13 @@ void KatePluginSymbolViewerView::parseFortranSymbols(void)
                         stripped.truncate(fnd);
                     }
                     if (stripped.indexOf(QLatin1Char('=')) == -1) {
-                        if (m_treeOn->isChecked()) {
+                        if (m_options.treeMode) {
                             node = new QTreeWidgetItem(modNode, lastModNode);
                             lastModNode = node;
                         } else
-                            node = new QTreeWidgetItem(m_symbols);
+                            node = new QTreeWidgetItem(m_root);
                         node->setText(0, stripped);
-                        node->setIcon(0, QIcon(mod));
+                        setIcon(node, mod);
                         node->setText(1, QString::number(i, 10));
                     }
                     stripped.clear();
@@ -179,7 +174,7 @@ void KatePluginSymbolViewerView::parseFortranSymbols(void)
 
             // Functions
             else if (block == 3) {
-                if (m_func->isChecked()) {
+                if (m_options.showFunctions) {
                     stripped += currline.rightRef(currline.length());
                     stripped = stripped.trimmed();
                     stripped.remove(QLatin1String("function"));
@@ -197,13 +192,13 @@ void KatePluginSymbolViewerView::parseFortranSymbols(void)
 
                     if (paro == parc && stripped.endsWith(QLatin1Char('&')) == false) {
                         stripped.remove(QLatin1Char('&'));
-                        if (m_treeOn->isChecked()) {
+                        if (m_options.treeMode) {
                             node = new QTreeWidgetItem(funcNode, lastFuncNode);
                             lastFuncNode = node;
                         } else
-                            node = new QTreeWidgetItem(m_symbols);
+                            node = new QTreeWidgetItem(m_root);
                         node->setText(0, stripped);
-                        node->setIcon(0, QIcon(func));
+                        setIcon(node, func);
                         node->setText(1, QString::number(i, 10));
                         stripped.clear();
                         block = 0;
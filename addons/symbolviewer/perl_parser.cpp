@@ -10,52 +10,47 @@
  *   SPDX-License-Identifier: GPL-2.0-or-later
  *                                                                         *
  ***************************************************************************/
-#include "plugin_katesymbolviewer.h"
+#include "symbolparser.h"
 
-void KatePluginSymbolViewerView::parsePerlSymbols(void)
+void KateSymbolParser::parsePerlSymbols(void)
 {
-    if (!m_mainWindow->activeView())
-        return;
-
-    m_macro->setText(i18n("Show Uses"));
-    m_struct->setText(i18n("Show Pragmas"));
-    m_func->setText(i18n("Show Subroutines"));
+    m_macroLabel = i18n("Show Uses");
+    m_structLabel = i18n("Show Pragmas");
+    m_funcLabel = i18n("Show Subroutines");
     QString cl; // Current Line
     QString stripped;
     char comment = 0;
-    QPixmap cls(class_xpm);
-    QPixmap sct(struct_xpm);
-    QPixmap mcr(macro_xpm);
-    QPixmap cls_int(class_int_xpm);
+    const Icon cls = ClassIcon;
+    const Icon sct = StructIcon;
+    const Icon mcr = MacroIcon;
+    const Icon cls_int = ClassIntIcon;
     QTreeWidgetItem *node = nullptr;
     QTreeWidgetItem *mcrNode = nullptr, *sctNode = nullptr, *clsNode = nullptr;
     QTreeWidgetItem *lastMcrNode = nullptr, *lastSctNode = nullptr, *lastClsNode = nullptr;
 
-    KTextEditor::Document *kv = m_mainWindow->activeView()->document();
-
     // kdDebug(13000)<<"Lines counted :"<<kv->numLines()<<endl;
-    if (m_treeOn->isChecked()) {
-        mcrNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Uses")));
-        sctNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Pragmas")));
-        clsNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Subroutines")));
-        mcrNode->setIcon(0, QIcon(mcr));
-        sctNode->setIcon(0, QIcon(sct));
-        clsNode->setIcon(0, QIcon(cls));
+    if (m_options.treeMode) {
+        mcrNode = new QTreeWidgetItem(m_root, QStringList(i18n("Uses")));
+        sctNode = new QTreeWidgetItem(m_root, QStringList(i18n("Pragmas")));
+        clsNode = new QTreeWidgetItem(m_root, QStringList(i18n("Subroutines")));
+        setIcon(mcrNode, mcr);
+        setIcon(sctNode, sct);
+        setIcon(clsNode, cls);
 
-        if (m_expandOn->isChecked()) {
-            m_symbols->expandItem(mcrNode);
-            m_symbols->expandItem(sctNode);
-            m_symbols->expandItem(clsNode);
+        if (m_options.expandTree) {
+            expandItem(mcrNode);
+            expandItem(sctNode);
+            expandItem(clsNode);
         }
         lastMcrNode = mcrNode;
         lastSctNode = sctNode;
         lastClsNode = clsNode;
-        m_symbols->setRootIsDecorated(1);
+        m_rootIsDecorated = true;
     } else
-        m_symbols->setRootIsDecorated(0);
+        m_rootIsDecorated = false;
 
-    for (int i = 0; i < kv->lines(); i++) {
-        cl = kv->line(i);
+    for (int i = 0; i < m_lines.size(); i++) {
+        cl = m_lines.at(i);
         // qDebug()<< "Line " << i << " : "<< cl;
 
         if (cl.isEmpty() || cl.at(0) == QLatin1Char('#'))
@@ -72,50 +67,50 @@ void KatePluginSymbolViewerView::parsePerlSymbols(void)
         cl = cl.trimmed();
         // qDebug()<<"Trimmed line " << i << " : "<< cl;
 
-        if (cl.indexOf(QRegularExpression(QLatin1String("^use +[A-Z]"))) == 0 && m_macro->isChecked()) {
+        if (cl.indexOf(QRegularExpression(QLatin1String("^use +[A-Z]"))) == 0 && m_options.showMacros) {
             QString stripped = cl.remove(QRegularExpression(QLatin1String("^use +")));
             // stripped=stripped.replace( QRegularExpression(QLatin1String(";$")), "" ); // Doesn't work ??
             stripped = stripped.left(stripped.indexOf(QLatin1Char(';')));
-            if (m_treeOn->isChecked()) {
+            if (m_options.treeMode) {
                 node = new QTreeWidgetItem(mcrNode, lastMcrNode);
                 lastMcrNode = node;
             } else
-                node = new QTreeWidgetItem(m_symbols);
+                node = new QTreeWidgetItem(m_root);
 
             node->setText(0, stripped);
-            node->setIcon(0, QIcon(mcr));
+            setIcon(node, mcr);
             node->setText(1, QString::number(i, 10));
         }
 #if 1
-        if (cl.indexOf(QRegularExpression(QLatin1String("^use +[a-z]"))) == 0 && m_struct->isChecked()) {
+        if (cl.indexOf(QRegularExpression(QLatin1String("^use +[a-z]"))) == 0 && m_options.showStructures) {
             QString stripped = cl.remove(QRegularExpression(QLatin1String("^use +")));
             stripped.remove(QRegularExpression(QLatin1String(";$")));
-            if (m_treeOn->isChecked()) {
+            if (m_options.treeMode) {
                 node = new QTreeWidgetItem(sctNode, lastSctNode);
                 lastMcrNode = node;
             } else
-                node = new QTreeWidgetItem(m_symbols);
+                node = new QTreeWidgetItem(m_root);
 
             node->setText(0, stripped);
-            node->setIcon(0, QIcon(sct));
+            setIcon(node, sct);
             node->setText(1, QString::number(i, 10));
         }
 #endif
 #if 1
-        if (cl.indexOf(QRegularExpression(QLatin1String("^sub +"))) == 0 && m_func->isChecked()) {
+        if (cl.indexOf(QRegularExpression(QLatin1String("^sub +"))) == 0 && m_options.showFunctions) {
             QString stripped = cl.remove(QRegularExpression(QLatin1String("^sub +")));
             stripped.remove(QRegularExpression(QLatin1String("[{;] *$")));
-            if (m_treeOn->isChecked()) {
+            if (m_options.treeMode) {
                 node = new QTreeWidgetItem(clsNode, lastClsNode);
                 lastClsNode = node;
             } else
-                node = new QTreeWidgetItem(m_symbols);
+                node = new QTreeWidgetItem(m_root);
             node->setText(0, stripped);
 
             if (!stripped.isEmpty() && stripped.at(0) == QLatin1Char('_'))
-                node->setIcon(0, QIcon(cls_int));
+                setIcon(node, cls_int);
             else
-                node->setIcon(0, QIcon(cls));
+                setIcon(node, cls);
 
             node->setText(1, QString::number(i, 10));
         }
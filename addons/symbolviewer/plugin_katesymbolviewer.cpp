@@ -56,6 +56,51 @@
 
 #include <QHeaderView>
 #include <QPainter>
+#include <QRunnable>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace
+{
+class ParseTask : public QRunnable
+{
+public:
+    explicit ParseTask(const std::function<void()> &task)
+        : m_task(task)
+    {
+    }
+
+    void run() override
+    {
+        m_task();
+    }
+
+private:
+    std::function<void()> m_task;
+};
+
+/**
+ * Sort the detached symbols like the view would.
+ */
+void sortSymbols(QTreeWidgetItem *item, Qt::SortOrder order)
+{
+    QList<QTreeWidgetItem *> children = item->takeChildren();
+    std::stable_sort(children.begin(), children.end(), [order](QTreeWidgetItem *a, QTreeWidgetItem *b) {
+        return order == Qt::AscendingOrder ? *a < *b : *b < *a;
+    });
+    for (QTreeWidgetItem *child : qAsConst(children)) {
+        sortSymbols(child, order);
+    }
+    item->addChildren(children);
+}
+
+bool sameSymbol(const QTreeWidgetItem *a, const QTreeWidgetItem *b)
+{
+    return a->text(0) == b->text(0) && a->data(0, KateSymbolParser::IconRole) == b->data(0, KateSymbolParser::IconRole);
+}
+}
 
 K_PLUGIN_FACTORY_WITH_JSON(KatePluginSymbolViewerFactory, "katesymbolviewerplugin.json", registerPlugin<KatePluginSymbolViewer>();)
 
@@ -110,8 +155,16 @@ KatePluginSymbolViewerView::KatePluginSymbolViewerView(KatePluginSymbolViewer *p
     m_currItemTimer.setSingleShot(true);
     connect(&m_currItemTimer, &QTimer::timeout, this, &KatePluginSymbolViewerView::updateCurrTreeItem);
 
+    m_parserThread.setMaxThreadCount(1);
+
     QPixmap cls(class_xpm);
 
+    m_icons[KateSymbolParser::ClassIcon] = QIcon(cls);
+    m_icons[KateSymbolParser::ClassIntIcon] = QIcon(QPixmap(class_int_xpm));
+    m_icons[KateSymbolParser::StructIcon] = QIcon(QPixmap(struct_xpm));
+    m_icons[KateSymbolParser::MacroIcon] = QIcon(QPixmap(macro_xpm));
+    m_icons[KateSymbolParser::MethodIcon] = QIcon(QPixmap(method_xpm));
+
     m_toolview = m_mainWindow->createToolView(plugin, QStringLiteral("kate_plugin_symbolviewer"), KTextEditor::MainWindow::Left, cls, i18n("Symbol List"));
 
     QWidget *container = new QWidget(m_toolview);
@@ -151,6 +204,9 @@ KatePluginSymbolViewerView::KatePluginSymbolViewerView(KatePluginSymbolViewer *p
 
 KatePluginSymbolViewerView::~KatePluginSymbolViewerView()
 {
+    // the parser task uses this view
+    m_parserThread.waitForDone();
+
     // un-register view
     m_plugin->m_views.remove(this);
 
@@ -161,6 +217,8 @@ KatePluginSymbolViewerView::~KatePluginSymbolViewerView()
 
 void KatePluginSymbolViewerView::slotDocChanged()
 {
+    // changes of the document were not tracked while it was not active
+    m_firstChangedLine = 0;
     parseSymbols();
 
     KTextEditor::View *view = m_mainWindow->activeView();
@@ -170,6 +228,8 @@ void KatePluginSymbolViewerView::slotDocChanged()
 
         if (view->document()) {
             connect(view->document(), &KTextEditor::Document::textChanged, this, &KatePluginSymbolViewerView::slotDocEdited, Qt::UniqueConnection);
+            connect(view->document(), &KTextEditor::Document::textInserted, this, &KatePluginSymbolViewerView::slotTextChanged, Qt::UniqueConnection);
+            connect(view->document(), &KTextEditor::Document::textRemoved, this, &KatePluginSymbolViewerView::slotTextChanged, Qt::UniqueConnection);
         }
     }
 }
@@ -180,9 +240,17 @@ void KatePluginSymbolViewerView::slotDocEdited()
     m_updateTimer.start(500);
 }
 
+void KatePluginSymbolViewerView::slotTextChanged(KTextEditor::Document *doc, const KTextEditor::Range &range)
+{
+    KTextEditor::View *view = m_mainWindow->activeView();
+    if (view && view->document() == doc) {
+        m_firstChangedLine = qMin(m_firstChangedLine, range.start().line());
+    }
+}
+
 void KatePluginSymbolViewerView::cursorPositionChanged()
 {
-    if (m_updateTimer.isActive()) {
+    if (m_updateTimer.isActive() || m_parsing) {
         // No need for update, will come anyway
         return;
     }
@@ -214,15 +282,7 @@ void KatePluginSymbolViewerView::updateCurrTreeItem()
 
     int currLine = editView->cursorPositionVirtual().line();
 
-    int newItemLine = 0;
-    QTreeWidgetItem *newItem = nullptr;
-    QTreeWidgetItem *tmp = nullptr;
-    for (int i = 0; i < m_symbols->topLevelItemCount(); i++) {
-        tmp = newActveItem(newItemLine, currLine, m_symbols->topLevelItem(i));
-        if (tmp)
-            newItem = tmp;
-    }
-
+    QTreeWidgetItem *newItem = m_symbolIndex.itemAt(currLine);
     if (!newItem) {
         return;
     }
@@ -240,25 +300,6 @@ void KatePluginSymbolViewerView::updateCurrTreeItem()
     m_symbols->blockSignals(false);
 }
 
-QTreeWidgetItem *KatePluginSymbolViewerView::newActveItem(int &newItemLine, int currLine, QTreeWidgetItem *item)
-{
-    QTreeWidgetItem *newItem = nullptr;
-    QTreeWidgetItem *tmp = nullptr;
-    int itemLine = item->data(1, Qt::DisplayRole).toInt();
-    if ((itemLine <= currLine) && (itemLine >= newItemLine)) {
-        newItemLine = itemLine;
-        newItem = item;
-    }
-
-    for (int i = 0; i < item->childCount(); i++) {
-        tmp = newActveItem(newItemLine, currLine, item->child(i));
-        if (tmp)
-            newItem = tmp;
-    }
-
-    return newItem;
-}
-
 bool KatePluginSymbolViewerView::eventFilter(QObject *obj, QEvent *event)
 {
     if (event->type() == QEvent::KeyPress) {
@@ -293,58 +334,90 @@ void KatePluginSymbolViewerView::parseSymbols()
     if (!m_symbols)
         return;
 
-    m_symbols->clear();
-    // Qt docu recommends to populate view with disabled sorting
-    // https://doc.qt.io/qt-5/qtreeview.html#sortingEnabled-prop
-    m_symbols->setSortingEnabled(false);
-    Qt::SortOrder sortOrder = m_symbols->header()->sortIndicatorOrder();
-
-    if (!m_mainWindow->activeView())
+    // only one parse at a time, the next one starts once it is done
+    if (m_parsing) {
+        m_parseAgain = true;
         return;
+    }
 
-    KTextEditor::Document *doc = m_mainWindow->activeView()->document();
+    KTextEditor::Document *doc = m_mainWindow->activeView() ? m_mainWindow->activeView()->document() : nullptr;
 
     // be sure we have some document around !
-    if (!doc)
+    if (!doc) {
+        m_symbols->clear();
+        m_symbolIndex.clear();
         return;
+    }
 
-    /** Get the current highlighting mode */
-    QString hlModeName = doc->mode();
-
-    if (hlModeName.contains(QLatin1String("C++")) || hlModeName == QLatin1Char('C') || hlModeName == QLatin1String("ANSI C89"))
-        parseCppSymbols();
-    else if (hlModeName == QLatin1String("PHP (HTML)"))
-        parsePhpSymbols();
-    else if (hlModeName == QLatin1String("Tcl/Tk"))
-        parseTclSymbols();
-    else if (hlModeName.contains(QLatin1String("Fortran")))
-        parseFortranSymbols();
-    else if (hlModeName == QLatin1String("Perl"))
-        parsePerlSymbols();
-    else if (hlModeName == QLatin1String("Python"))
-        parsePythonSymbols();
-    else if (hlModeName == QLatin1String("Ruby"))
-        parseRubySymbols();
-    else if (hlModeName == QLatin1String("Java"))
-        parseCppSymbols();
-    else if (hlModeName == QLatin1String("xslt"))
-        parseXsltSymbols();
-    else if (hlModeName == QLatin1String("XML") || hlModeName == QLatin1String("HTML"))
-        parseXMLSymbols();
-    else if (hlModeName == QLatin1String("Bash"))
-        parseBashSymbols();
-    else if (hlModeName == QLatin1String("ActionScript 2.0") || hlModeName == QLatin1String("JavaScript") || hlModeName == QLatin1String("QML"))
-        parseEcmaSymbols();
-    else {
-        QTreeWidgetItem *node = new QTreeWidgetItem(m_symbols);
-        node->setText(0, i18n("Sorry, not supported yet!"));
-        // Setting invalid line number avoid jump to top of document when clicked
-        node->setText(1, QStringLiteral("-1"));
-        node = new QTreeWidgetItem(m_symbols);
-        node->setText(0, i18n("File type: %1", hlModeName));
-        node->setText(1, QStringLiteral("-1"));
+    KateSymbolParser::Options options;
+    options.mode = doc->mode();
+    options.treeMode = m_treeOn->isChecked();
+    options.expandTree = m_expandOn->isChecked();
+    options.showMacros = m_macro->isChecked();
+    options.showStructures = m_struct->isChecked();
+    options.showFunctions = m_func->isChecked();
+    options.showTypes = m_typesOn->isChecked();
+
+    // the parser works on a snapshot, the document may change meanwhile
+    QStringList lines;
+    lines.reserve(doc->lines());
+    for (int i = 0; i < doc->lines(); i++) {
+        lines.append(doc->line(i));
     }
 
+    const int firstChangedLine = m_firstChangedLine;
+    m_firstChangedLine = std::numeric_limits<int>::max();
+    m_parsing = true;
+
+    const quintptr document = reinterpret_cast<quintptr>(doc);
+    m_parserThread.start(new ParseTask([this, document, options, lines, firstChangedLine]() {
+        const std::shared_ptr<KateSymbolParser::Result> result = m_parser.parse(document, options, lines, firstChangedLine);
+        QMetaObject::invokeMethod(
+            this,
+            [this, result]() {
+                symbolsParsed(result);
+            },
+            Qt::QueuedConnection);
+    }));
+}
+
+void KatePluginSymbolViewerView::symbolsParsed(const std::shared_ptr<KateSymbolParser::Result> &result)
+{
+    m_parsing = false;
+
+    if (m_parseAgain) {
+        // outdated already
+        m_parseAgain = false;
+        parseSymbols();
+        return;
+    }
+
+    if (!m_mainWindow->activeView()) {
+        m_symbols->clear();
+        m_symbolIndex.clear();
+        return;
+    }
+
+    if (!result->macroLabel.isEmpty())
+        m_macro->setText(result->macroLabel);
+    if (!result->structLabel.isEmpty())
+        m_struct->setText(result->structLabel);
+    if (!result->funcLabel.isEmpty())
+        m_func->setText(result->funcLabel);
+    m_symbols->setRootIsDecorated(result->rootIsDecorated);
+
+    // Qt docu recommends to populate view with disabled sorting
+    // https://doc.qt.io/qt-5/qtreeview.html#sortingEnabled-prop
+    m_symbols->setSortingEnabled(false);
+    Qt::SortOrder sortOrder = m_symbols->header()->sortIndicatorOrder();
+
+    // sort the new symbols first, else the ones in the view never match
+    if (m_sort->isChecked()) {
+        sortSymbols(result->root.get(), sortOrder);
+    }
+    mergeSymbols(m_symbols->invisibleRootItem(), result->root.get());
+    m_symbolIndex.rebuild(m_symbols->invisibleRootItem());
+
     m_oldCursorLine = -1;
     updateCurrTreeItem();
     if (m_sort->isChecked()) {
@@ -353,6 +426,71 @@ void KatePluginSymbolViewerView::parseSymbols()
     }
 }
 
+/**
+ * Patch the children of @p target to become the ones of @p source.
+ * The symbols the same at the start and at the end are kept, with their
+ * selection and expanded state, only the ones in between are replaced.
+ */
+void KatePluginSymbolViewerView::mergeSymbols(QTreeWidgetItem *target, QTreeWidgetItem *source)
+{
+    const int targetCount = target->childCount();
+    const int sourceCount = source->childCount();
+
+    int prefix = 0;
+    while (prefix < targetCount && prefix < sourceCount && sameSymbol(target->child(prefix), source->child(prefix))) {
+        prefix++;
+    }
+    int suffix = 0;
+    while (suffix < targetCount - prefix && suffix < sourceCount - prefix && sameSymbol(target->child(targetCount - 1 - suffix), source->child(sourceCount - 1 - suffix))) {
+        suffix++;
+    }
+
+    for (int i = targetCount - suffix - 1; i >= prefix; i--) {
+        delete target->takeChild(i);
+    }
+    QList<QTreeWidgetItem *> added;
+    for (int i = prefix; i < sourceCount - suffix; i++) {
+        added.append(source->child(i)->clone());
+    }
+    target->insertChildren(prefix, added);
+    for (QTreeWidgetItem *item : qAsConst(added)) {
+        showSymbols(item);
+    }
+
+    // the kept ones may have moved, or have changed children
+    for (int i = 0; i < sourceCount; i++) {
+        if (i >= prefix && i < sourceCount - suffix) {
+            continue;
+        }
+        QTreeWidgetItem *item = target->child(i);
+        QTreeWidgetItem *symbol = source->child(i);
+        if (item->text(1) != symbol->text(1)) {
+            item->setText(1, symbol->text(1));
+        }
+        if (item->toolTip(0) != symbol->toolTip(0)) {
+            item->setToolTip(0, symbol->toolTip(0));
+        }
+        mergeSymbols(item, symbol);
+    }
+}
+
+/**
+ * Set the icons and expand the new items, this needs them to be in the view.
+ */
+void KatePluginSymbolViewerView::showSymbols(QTreeWidgetItem *item)
+{
+    const int icon = item->data(0, KateSymbolParser::IconRole).toInt();
+    if (icon > KateSymbolParser::NoIcon && icon <= KateSymbolParser::MethodIcon) {
+        item->setIcon(0, m_icons[icon]);
+    }
+    if (item->data(0, KateSymbolParser::ExpandRole).toBool()) {
+        item->setExpanded(true);
+    }
+    for (int i = 0; i < item->childCount(); i++) {
+        showSymbols(item->child(i));
+    }
+}
+
 void KatePluginSymbolViewerView::goToSymbol(QTreeWidgetItem *it)
 {
     KTextEditor::View *kv = m_mainWindow->activeView();
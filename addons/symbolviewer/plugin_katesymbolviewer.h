@@ -15,6 +15,9 @@
 #ifndef _PLUGIN_KATE_SYMBOLVIEWER_H_
 #define _PLUGIN_KATE_SYMBOLVIEWER_H_
 
+#include "symbolindex.h"
+#include "symbolparser.h"
+
 #include <KTextEditor/ConfigPage>
 #include <KTextEditor/Document>
 #include <KTextEditor/MainWindow>
@@ -30,6 +33,7 @@
 #include <QPixmap>
 #include <QResizeEvent>
 #include <QSet>
+#include <QThreadPool>
 #include <QTimer>
 #include <QTreeWidget>
 
@@ -103,9 +107,9 @@ public Q_SLOTS:
     void goToSymbol(QTreeWidgetItem *);
     void slotShowContextMenu(const QPoint &);
     void cursorPositionChanged();
-    QTreeWidgetItem *newActveItem(int &currMinLine, int currLine, QTreeWidgetItem *item);
     void updateCurrTreeItem();
     void slotDocEdited();
+    void slotTextChanged(KTextEditor::Document *doc, const KTextEditor::Range &range);
 
 protected:
     bool eventFilter(QObject *obj, QEvent *ev) override;
@@ -128,19 +132,25 @@ private:
     QTimer m_currItemTimer;
     int m_oldCursorLine = 0;
 
+    // the parser runs in a single worker thread, one parse at a time
+    KateSymbolParser m_parser;
+    QThreadPool m_parserThread;
+    bool m_parsing = false;
+    bool m_parseAgain = false;
+
+    // first line of the active document changed since the last snapshot
+    int m_firstChangedLine = 0;
+
+    QIcon m_icons[KateSymbolParser::MethodIcon + 1];
+
+    // the symbols of m_symbols by line, rebuilt with them
+    KateSymbolIndex m_symbolIndex;
+
     void updatePixmapScroll();
 
-    void parseCppSymbols(void);
-    void parseTclSymbols(void);
-    void parseFortranSymbols(void);
-    void parsePerlSymbols(void);
-    void parsePythonSymbols(void);
-    void parseRubySymbols(void);
-    void parseXsltSymbols(void);
-    void parseXMLSymbols(void);
-    void parsePhpSymbols(void);
-    void parseBashSymbols(void);
-    void parseEcmaSymbols(void);
+    void symbolsParsed(const std::shared_ptr<KateSymbolParser::Result> &result);
+    void mergeSymbols(QTreeWidgetItem *target, QTreeWidgetItem *source);
+    void showSymbols(QTreeWidgetItem *item);
 };
 
 class KatePluginSymbolViewer : public KTextEditor::Plugin
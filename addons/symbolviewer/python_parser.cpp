@@ -10,21 +10,18 @@
  *   SPDX-License-Identifier: GPL-2.0-or-later
  *                                                                         *
  ***************************************************************************/
-#include "plugin_katesymbolviewer.h"
+#include "symbolparser.h"
 
-void KatePluginSymbolViewerView::parsePythonSymbols(void)
+void KateSymbolParser::parsePythonSymbols(void)
 {
-    if (!m_mainWindow->activeView())
-        return;
-
-    m_macro->setText(i18n("Show Globals"));
-    m_struct->setText(i18n("Show Methods"));
-    m_func->setText(i18n("Show Classes"));
+    m_macroLabel = i18n("Show Globals");
+    m_structLabel = i18n("Show Methods");
+    m_funcLabel = i18n("Show Classes");
 
     QString cl; // Current Line
-    QPixmap cls(class_xpm);
-    QPixmap mtd(method_xpm);
-    QPixmap mcr(macro_xpm);
+    const Icon cls = ClassIcon;
+    const Icon mtd = MethodIcon;
+    const Icon mcr = MacroIcon;
 
     int in_class = 0, state = 0, j;
     QString name;
@@ -33,38 +30,36 @@ void KatePluginSymbolViewerView::parsePythonSymbols(void)
     QTreeWidgetItem *mcrNode = nullptr, *mtdNode = nullptr, *clsNode = nullptr;
     QTreeWidgetItem *lastMcrNode = nullptr, *lastMtdNode = nullptr, *lastClsNode = nullptr;
 
-    KTextEditor::Document *kv = m_mainWindow->activeView()->document();
-
     // kdDebug(13000)<<"Lines counted :"<<kv->numLines()<<endl;
-    if (m_treeOn->isChecked()) {
-        clsNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Classes")));
-        mcrNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Globals")));
-        mcrNode->setIcon(0, QIcon(mcr));
-        clsNode->setIcon(0, QIcon(cls));
-
-        if (m_expandOn->isChecked()) {
-            m_symbols->expandItem(mcrNode);
-            m_symbols->expandItem(clsNode);
+    if (m_options.treeMode) {
+        clsNode = new QTreeWidgetItem(m_root, QStringList(i18n("Classes")));
+        mcrNode = new QTreeWidgetItem(m_root, QStringList(i18n("Globals")));
+        setIcon(mcrNode, mcr);
+        setIcon(clsNode, cls);
+
+        if (m_options.expandTree) {
+            expandItem(mcrNode);
+            expandItem(clsNode);
         }
         lastClsNode = clsNode;
         lastMcrNode = mcrNode;
         mtdNode = clsNode;
         lastMtdNode = clsNode;
-        m_symbols->setRootIsDecorated(1);
+        m_rootIsDecorated = true;
     } else
-        m_symbols->setRootIsDecorated(0);
+        m_rootIsDecorated = false;
 
-    for (int i = 0; i < kv->lines(); i++) {
+    for (int i = 0; i < m_lines.size(); i++) {
         int line = i;
-        cl = kv->line(i);
+        cl = m_lines.at(i);
         // concatenate continued lines and remove continuation marker
         if (cl.length() == 0)
             continue;
         while (cl[cl.length() - 1] == QLatin1Char('\\')) {
             cl = cl.left(cl.length() - 1);
             i++;
-            if (i < kv->lines())
-                cl += kv->line(i);
+            if (i < m_lines.size())
+                cl += m_lines.at(i);
             else
                 break;
         }
@@ -109,43 +104,43 @@ void KatePluginSymbolViewerView::parsePythonSymbols(void)
             else // strip off the word "def "
                 name = name.trimmed().mid(4);
 
-            if (m_func->isChecked() && in_class == 1) {
-                if (m_treeOn->isChecked()) {
+            if (m_options.showFunctions && in_class == 1) {
+                if (m_options.treeMode) {
                     node = new QTreeWidgetItem(clsNode, lastClsNode);
-                    if (m_expandOn->isChecked())
-                        m_symbols->expandItem(node);
+                    if (m_options.expandTree)
+                        expandItem(node);
                     lastClsNode = node;
                     mtdNode = lastClsNode;
                     lastMtdNode = lastClsNode;
                 } else
-                    node = new QTreeWidgetItem(m_symbols);
+                    node = new QTreeWidgetItem(m_root);
 
                 node->setText(0, name);
-                node->setIcon(0, QIcon(cls));
+                setIcon(node, cls);
                 node->setText(1, QString::number(line, 10));
             }
 
-            if (m_struct->isChecked() && in_class == 2) {
-                if (m_treeOn->isChecked()) {
+            if (m_options.showStructures && in_class == 2) {
+                if (m_options.treeMode) {
                     node = new QTreeWidgetItem(mtdNode, lastMtdNode);
                     lastMtdNode = node;
                 } else
-                    node = new QTreeWidgetItem(m_symbols);
+                    node = new QTreeWidgetItem(m_root);
 
                 node->setText(0, name);
-                node->setIcon(0, QIcon(mtd));
+                setIcon(node, mtd);
                 node->setText(1, QString::number(line, 10));
             }
 
-            if (m_macro->isChecked() && in_class == 0) {
-                if (m_treeOn->isChecked()) {
+            if (m_options.showMacros && in_class == 0) {
+                if (m_options.treeMode) {
                     node = new QTreeWidgetItem(mcrNode, lastMcrNode);
                     lastMcrNode = node;
                 } else
-                    node = new QTreeWidgetItem(m_symbols);
+                    node = new QTreeWidgetItem(m_root);
 
                 node->setText(0, name);
-                node->setIcon(0, QIcon(mcr));
+                setIcon(node, mcr);
                 node->setText(1, QString::number(line, 10));
             }
 
@@ -10,21 +10,17 @@
  *   SPDX-License-Identifier: GPL-2.0-or-later
  *                                                                         *
  ***************************************************************************/
-#include "plugin_katesymbolviewer.h"
+#include "symbolparser.h"
 
-void KatePluginSymbolViewerView::parseRubySymbols(void)
+void KateSymbolParser::parseRubySymbols(void)
 {
-    if (!m_mainWindow->activeView())
-        return;
-
-    m_macro->setText(i18n("Show Globals"));
-    m_struct->setText(i18n("Show Methods"));
-    m_func->setText(i18n("Show Classes"));
+    m_macroLabel = i18n("Show Globals");
+    m_structLabel = i18n("Show Methods");
+    m_funcLabel = i18n("Show Classes");
 
     QString cl; // Current Line
-    QPixmap cls(class_xpm);
-    QPixmap mtd(method_xpm);
-    QPixmap mcr(macro_xpm);
+    const Icon cls = ClassIcon;
+    const Icon mtd = MethodIcon;
 
     int i;
     QString name;
@@ -33,57 +29,56 @@ void KatePluginSymbolViewerView::parseRubySymbols(void)
     QTreeWidgetItem *mtdNode = nullptr, *clsNode = nullptr;
     QTreeWidgetItem *lastMtdNode = nullptr, *lastClsNode = nullptr;
 
-    KTextEditor::Document *kv = m_mainWindow->activeView()->document();
     // kdDebug(13000)<<"Lines counted :"<<kv->numLines()<<endl;
 
-    if (m_treeOn->isChecked()) {
-        clsNode = new QTreeWidgetItem(m_symbols);
+    if (m_options.treeMode) {
+        clsNode = new QTreeWidgetItem(m_root);
         clsNode->setText(0, i18n("Classes"));
-        clsNode->setIcon(0, QIcon(cls));
-        if (m_expandOn->isChecked())
-            m_symbols->expandItem(clsNode);
+        setIcon(clsNode, cls);
+        if (m_options.expandTree)
+            expandItem(clsNode);
         lastClsNode = clsNode;
         mtdNode = clsNode;
         lastMtdNode = clsNode;
-        m_symbols->setRootIsDecorated(1);
+        m_rootIsDecorated = true;
     } else
-        m_symbols->setRootIsDecorated(0);
+        m_rootIsDecorated = false;
 
-    for (i = 0; i < kv->lines(); i++) {
-        cl = kv->line(i);
+    for (i = 0; i < m_lines.size(); i++) {
+        cl = m_lines.at(i);
         cl = cl.trimmed();
 
         if (cl.indexOf(QRegularExpression(QLatin1String("^class [a-zA-Z0-9]+[^#]"))) >= 0) {
-            if (m_func->isChecked()) {
-                if (m_treeOn->isChecked()) {
+            if (m_options.showFunctions) {
+                if (m_options.treeMode) {
                     node = new QTreeWidgetItem(clsNode, lastClsNode);
-                    if (m_expandOn->isChecked())
-                        m_symbols->expandItem(node);
+                    if (m_options.expandTree)
+                        expandItem(node);
                     lastClsNode = node;
                     mtdNode = lastClsNode;
                     lastMtdNode = lastClsNode;
                 } else
-                    node = new QTreeWidgetItem(m_symbols);
+                    node = new QTreeWidgetItem(m_root);
                 node->setText(0, cl.mid(6));
-                node->setIcon(0, QIcon(cls));
+                setIcon(node, cls);
                 node->setText(1, QString::number(i, 10));
             }
         }
         if (cl.indexOf(QRegularExpression(QLatin1String("^def [a-zA-Z_]+[^#]"))) >= 0) {
-            if (m_struct->isChecked()) {
-                if (m_treeOn->isChecked()) {
+            if (m_options.showStructures) {
+                if (m_options.treeMode) {
                     node = new QTreeWidgetItem(mtdNode, lastMtdNode);
                     lastMtdNode = node;
                 } else
-                    node = new QTreeWidgetItem(m_symbols);
+                    node = new QTreeWidgetItem(m_root);
 
                 name = cl.mid(4);
                 node->setToolTip(0, name);
-                if (!m_typesOn->isChecked()) {
+                if (!m_options.showTypes) {
                     name = name.left(name.indexOf(QLatin1Char('(')));
                 }
                 node->setText(0, name);
-                node->setIcon(0, QIcon(mtd));
+                setIcon(node, mtd);
                 node->setText(1, QString::number(i, 10));
             }
         }
@@ -0,0 +1,72 @@
+/***************************************************************************
+ *                                                                         *
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ *                                                                         *
+ ***************************************************************************/
+
+#include "symbolindex.h"
+
+#include <QTreeWidgetItem>
+
+#include <algorithm>
+#include <numeric>
+
+void KateSymbolIndex::rebuild(QTreeWidgetItem *root)
+{
+    clear();
+    for (int i = 0; i < root->childCount(); i++) {
+        add(root->child(i));
+    }
+
+    // the parsers mostly add in line order, but not in tree mode or once sorted
+    if (!std::is_sorted(m_lines.cbegin(), m_lines.cend())) {
+        QVector<int> order(m_lines.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+            return m_lines.at(a) < m_lines.at(b);
+        });
+
+        QVector<int> lines;
+        QVector<QTreeWidgetItem *> items;
+        lines.reserve(order.size());
+        items.reserve(order.size());
+        for (int i : qAsConst(order)) {
+            lines.append(m_lines.at(i));
+            items.append(m_items.at(i));
+        }
+        m_lines.swap(lines);
+        m_items.swap(items);
+    }
+}
+
+void KateSymbolIndex::clear()
+{
+    m_lines.clear();
+    m_items.clear();
+}
+
+int KateSymbolIndex::size() const
+{
+    return m_items.size();
+}
+
+QTreeWidgetItem *KateSymbolIndex::itemAt(int line) const
+{
+    const auto it = std::upper_bound(m_lines.cbegin(), m_lines.cend(), line);
+    if (it == m_lines.cbegin()) {
+        return nullptr;
+    }
+    return m_items.at(int(it - m_lines.cbegin()) - 1);
+}
+
+void KateSymbolIndex::add(QTreeWidgetItem *item)
+{
+    const int line = item->data(1, Qt::DisplayRole).toInt();
+    if (line >= 0) {
+        m_lines.append(line);
+        m_items.append(item);
+    }
+    for (int i = 0; i < item->childCount(); i++) {
+        add(item->child(i));
+    }
+}
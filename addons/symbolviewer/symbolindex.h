@@ -0,0 +1,44 @@
+/***************************************************************************
+ *                                                                         *
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef _SYMBOLINDEX_H_
+#define _SYMBOLINDEX_H_
+
+#include <QVector>
+
+class QTreeWidgetItem;
+
+/**
+ * Lines of the symbols in a tree, sorted, to find the symbol at a line
+ * with a binary search. A symbol spans the lines up to the next one.
+ * Symbols on the same line keep the order of the tree, the last one wins.
+ */
+class KateSymbolIndex
+{
+public:
+    /**
+     * Index all items below @p root, the line is read from column 1.
+     * Items with a negative line are left out.
+     */
+    void rebuild(QTreeWidgetItem *root);
+    void clear();
+
+    int size() const;
+
+    /**
+     * @return the last symbol starting at @p line or before, nullptr if none
+     */
+    QTreeWidgetItem *itemAt(int line) const;
+
+private:
+    void add(QTreeWidgetItem *item);
+
+private:
+    QVector<int> m_lines;
+    QVector<QTreeWidgetItem *> m_items;
+};
+
+#endif
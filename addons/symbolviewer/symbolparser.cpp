@@ -0,0 +1,131 @@
+/***************************************************************************
+ *                                                                         *
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ *                                                                         *
+ ***************************************************************************/
+
+#include "symbolparser.h"
+
+KateSymbolParser::KateSymbolParser()
+    : m_root(new QTreeWidgetItem)
+{
+}
+
+KateSymbolParser::~KateSymbolParser()
+{
+    delete m_root;
+}
+
+std::shared_ptr<KateSymbolParser::Result> KateSymbolParser::parse(quintptr document, const Options &options, const QStringList &lines, int firstChangedLine)
+{
+    // another document or other options, start over
+    if (document != m_document || options != m_options) {
+        clear();
+        m_document = document;
+        m_options = options;
+        firstChangedLine = 0;
+    }
+
+    m_lines = lines;
+    m_firstChangedLine = firstChangedLine;
+    m_currentLine = -1;
+    m_macroLabel.clear();
+    m_structLabel.clear();
+    m_funcLabel.clear();
+
+    /** Get the current highlighting mode */
+    const QString &hlModeName = m_options.mode;
+
+    if (hlModeName.contains(QLatin1String("C++")) || hlModeName == QLatin1Char('C') || hlModeName == QLatin1String("ANSI C89") || hlModeName == QLatin1String("Java")) {
+        // resumes on its own
+        parseCppSymbols();
+    } else {
+        clear();
+        if (hlModeName == QLatin1String("PHP (HTML)"))
+            parsePhpSymbols();
+        else if (hlModeName == QLatin1String("Tcl/Tk"))
+            parseTclSymbols();
+        else if (hlModeName.contains(QLatin1String("Fortran")))
+            parseFortranSymbols();
+        else if (hlModeName == QLatin1String("Perl"))
+            parsePerlSymbols();
+        else if (hlModeName == QLatin1String("Python"))
+            parsePythonSymbols();
+        else if (hlModeName == QLatin1String("Ruby"))
+            parseRubySymbols();
+        else if (hlModeName == QLatin1String("xslt"))
+            parseXsltSymbols();
+        else if (hlModeName == QLatin1String("XML") || hlModeName == QLatin1String("HTML"))
+            parseXMLSymbols();
+        else if (hlModeName == QLatin1String("Bash"))
+            parseBashSymbols();
+        else if (hlModeName == QLatin1String("ActionScript 2.0") || hlModeName == QLatin1String("JavaScript") || hlModeName == QLatin1String("QML"))
+            parseEcmaSymbols();
+        else {
+            QTreeWidgetItem *node = new QTreeWidgetItem(m_root);
+            node->setText(0, i18n("Sorry, not supported yet!"));
+            // Setting invalid line number avoid jump to top of document when clicked
+            node->setText(1, QStringLiteral("-1"));
+            node = new QTreeWidgetItem(m_root);
+            node->setText(0, i18n("File type: %1", hlModeName));
+            node->setText(1, QStringLiteral("-1"));
+        }
+    }
+
+    // the snapshot is not needed until the next parse
+    m_lines.clear();
+
+    // the view gets a copy, the tree is kept to resume
+    auto result = std::make_shared<Result>();
+    result->root.reset(m_root->clone());
+    result->rootIsDecorated = m_rootIsDecorated;
+    result->macroLabel = m_macroLabel;
+    result->structLabel = m_structLabel;
+    result->funcLabel = m_funcLabel;
+    return result;
+}
+
+void KateSymbolParser::clear()
+{
+    qDeleteAll(m_root->takeChildren());
+    m_cppCheckpoints.clear();
+}
+
+void KateSymbolParser::truncate(int line)
+{
+    QVector<QTreeWidgetItem *> items{m_root};
+    while (!items.isEmpty()) {
+        QTreeWidgetItem *item = items.takeLast();
+        for (int i = item->childCount() - 1; i >= 0; --i) {
+            QTreeWidgetItem *child = item->child(i);
+            const QVariant created = child->data(0, CreatedRole);
+            if (created.isValid() && created.toInt() >= line) {
+                delete item->takeChild(i);
+            } else {
+                items.append(child);
+            }
+        }
+    }
+}
+
+void KateSymbolParser::setIcon(QTreeWidgetItem *item, Icon icon)
+{
+    item->setData(0, IconRole, icon);
+    item->setData(0, CreatedRole, m_currentLine);
+}
+
+void KateSymbolParser::expandItem(QTreeWidgetItem *item)
+{
+    item->setData(0, ExpandRole, true);
+}
+
+QList<QTreeWidgetItem *> KateSymbolParser::findItems(const QString &text) const
+{
+    QList<QTreeWidgetItem *> items;
+    for (int i = 0; i < m_root->childCount(); ++i) {
+        if (m_root->child(i)->text(0) == text) {
+            items.append(m_root->child(i));
+        }
+    }
+    return items;
+}
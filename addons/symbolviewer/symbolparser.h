@@ -0,0 +1,142 @@
+/***************************************************************************
+ *                                                                         *
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef _SYMBOLPARSER_H_
+#define _SYMBOLPARSER_H_
+
+#include <QMap>
+#include <QStringList>
+#include <QTreeWidgetItem>
+
+#include <KLocalizedString>
+
+#include <memory>
+
+/**
+ * Runs the parser for the highlighting mode over a snapshot of the document
+ * lines, this is done in a worker thread.
+ *
+ * The symbols are a detached tree of items. The icons and the expanded state
+ * are only stored as data, they are set once the tree is merged into the view.
+ * The C++ parser keeps its state every few lines, the next parse of the same
+ * document resumes at the last of these before the first changed line.
+ */
+class KateSymbolParser
+{
+public:
+    enum Icon { NoIcon, ClassIcon, ClassIntIcon, StructIcon, MacroIcon, MethodIcon };
+
+    // roles of column 0
+    enum Roles { IconRole = Qt::UserRole + 1, ExpandRole, CreatedRole };
+
+    struct Options {
+        QString mode;
+        bool treeMode = false;
+        bool expandTree = false;
+        bool showMacros = true;
+        bool showStructures = true;
+        bool showFunctions = true;
+        bool showTypes = false;
+
+        bool operator==(const Options &other) const
+        {
+            return mode == other.mode && treeMode == other.treeMode && expandTree == other.expandTree && showMacros == other.showMacros && showStructures == other.showStructures
+                && showFunctions == other.showFunctions && showTypes == other.showTypes;
+        }
+        bool operator!=(const Options &other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    struct Result {
+        std::unique_ptr<QTreeWidgetItem> root;
+        bool rootIsDecorated = false;
+
+        // texts of the show actions, empty to keep them
+        QString macroLabel;
+        QString structLabel;
+        QString funcLabel;
+    };
+
+    KateSymbolParser();
+    ~KateSymbolParser();
+
+    KateSymbolParser(const KateSymbolParser &) = delete;
+    KateSymbolParser &operator=(const KateSymbolParser &) = delete;
+
+    /**
+     * Parse @p lines of @p document. Nothing before @p firstChangedLine
+     * changed since the last call, unless the document or the options differ.
+     */
+    std::shared_ptr<Result> parse(quintptr document, const Options &options, const QStringList &lines, int firstChangedLine);
+
+private:
+    void clear();
+
+    /**
+     * Remove the items created while parsing line @p line or later.
+     */
+    void truncate(int line);
+
+    /**
+     * Set the icon, once in the view. Also remembers the line being parsed,
+     * to know which items to remove when resuming, see truncate().
+     */
+    void setIcon(QTreeWidgetItem *item, Icon icon);
+    void expandItem(QTreeWidgetItem *item);
+    QList<QTreeWidgetItem *> findItems(const QString &text) const;
+
+    void parseCppSymbols(void);
+    void parseTclSymbols(void);
+    void parseFortranSymbols(void);
+    void parsePerlSymbols(void);
+    void parsePythonSymbols(void);
+    void parseRubySymbols(void);
+    void parseXsltSymbols(void);
+    void parseXMLSymbols(void);
+    void parsePhpSymbols(void);
+    void parseBashSymbols(void);
+    void parseEcmaSymbols(void);
+
+private:
+    // state of the C++ parser at the start of a line
+    struct CppState {
+        QString stripped;
+        int tmpPos = 0;
+        int par = 0;
+        int graph = 0;
+        char mclass = 0;
+        char block = 0;
+        char comment = 0;
+        char macro = 0;
+        bool structure = false;
+        QTreeWidgetItem *mcrNode = nullptr;
+        QTreeWidgetItem *sctNode = nullptr;
+        QTreeWidgetItem *clsNode = nullptr;
+        QTreeWidgetItem *mtdNode = nullptr;
+        QTreeWidgetItem *lastMcrNode = nullptr;
+        QTreeWidgetItem *lastSctNode = nullptr;
+        QTreeWidgetItem *lastClsNode = nullptr;
+        QTreeWidgetItem *lastMtdNode = nullptr;
+    };
+
+    quintptr m_document = 0;
+    Options m_options;
+    QStringList m_lines;
+    int m_firstChangedLine = 0;
+    int m_currentLine = -1;
+
+    QTreeWidgetItem *m_root;
+    bool m_rootIsDecorated = false;
+    QString m_macroLabel;
+    QString m_structLabel;
+    QString m_funcLabel;
+
+    QMap<int, CppState> m_cppCheckpoints;
+};
+
+#endif
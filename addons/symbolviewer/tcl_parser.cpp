@@ -11,14 +11,10 @@
  *                                                                         *
  ***************************************************************************/
 
-#include "plugin_katesymbolviewer.h"
-#include <QPixmap>
+#include "symbolparser.h"
 
-void KatePluginSymbolViewerView::parseTclSymbols(void)
+void KateSymbolParser::parseTclSymbols(void)
 {
-    if (!m_mainWindow->activeView())
-        return;
-
     QString currline, prevline;
     bool prevComment = false;
     QString varStr(QStringLiteral("set "));
@@ -31,33 +27,31 @@ void KatePluginSymbolViewerView::parseTclSymbols(void)
     QTreeWidgetItem *mcrNode = nullptr, *clsNode = nullptr;
     QTreeWidgetItem *lastMcrNode = nullptr, *lastClsNode = nullptr;
 
-    QPixmap mcr(macro_xpm);
-    QPixmap cls(class_xpm);
+    const Icon mcr = MacroIcon;
+    const Icon cls = ClassIcon;
 
-    if (m_treeOn->isChecked()) {
-        clsNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Functions")));
-        mcrNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Globals")));
-        clsNode->setIcon(0, QIcon(cls));
-        mcrNode->setIcon(0, QIcon(mcr));
+    if (m_options.treeMode) {
+        clsNode = new QTreeWidgetItem(m_root, QStringList(i18n("Functions")));
+        mcrNode = new QTreeWidgetItem(m_root, QStringList(i18n("Globals")));
+        setIcon(clsNode, cls);
+        setIcon(mcrNode, mcr);
 
         lastMcrNode = mcrNode;
         lastClsNode = clsNode;
 
-        if (m_expandOn->isChecked()) {
-            m_symbols->expandItem(clsNode);
-            m_symbols->expandItem(mcrNode);
+        if (m_options.expandTree) {
+            expandItem(clsNode);
+            expandItem(mcrNode);
         }
-        m_symbols->setRootIsDecorated(1);
+        m_rootIsDecorated = true;
     } else
-        m_symbols->setRootIsDecorated(0);
-
-    KTextEditor::Document *kDoc = m_mainWindow->activeView()->document();
+        m_rootIsDecorated = false;
 
     // positions.resize(kDoc->numLines() + 3); // Maximum m_symbols number o.O
     // positions.fill(0);
 
-    for (i = 0; i < kDoc->lines(); i++) {
-        currline = kDoc->line(i);
+    for (i = 0; i < m_lines.size(); i++) {
+        currline = m_lines.at(i);
         currline = currline.trimmed();
         bool comment = false;
         // qDebug(13000)<<currline;
@@ -67,7 +61,7 @@ void KatePluginSymbolViewerView::parseTclSymbols(void)
             comment = true;
 
         if (i > 0) {
-            prevline = kDoc->line(i - 1);
+            prevline = m_lines.at(i - 1);
             if (prevline.endsWith(QLatin1String("\\")) && prevComment)
                 comment = true;
         }
@@ -75,7 +69,7 @@ void KatePluginSymbolViewerView::parseTclSymbols(void)
 
         if (!comment) {
             if (currline.startsWith(varStr) && block == 0) {
-                if (m_macro->isChecked()) // not really a macro, but a variable
+                if (m_options.showMacros) // not really a macro, but a variable
                 {
                     stripped = currline.right(currline.length() - 3);
                     stripped = stripped.simplified();
@@ -84,13 +78,13 @@ void KatePluginSymbolViewerView::parseTclSymbols(void)
                     if (fnd > 0)
                         stripped = stripped.left(fnd);
 
-                    if (m_treeOn->isChecked()) {
+                    if (m_options.treeMode) {
                         node = new QTreeWidgetItem(mcrNode, lastMcrNode);
                         lastMcrNode = node;
                     } else
-                        node = new QTreeWidgetItem(m_symbols);
+                        node = new QTreeWidgetItem(m_root);
                     node->setText(0, stripped);
-                    node->setIcon(0, QIcon(mcr));
+                    setIcon(node, mcr);
                     node->setText(1, QString::number(i, 10));
                     stripped.clear();
                 } // macro
@@ -122,14 +116,14 @@ void KatePluginSymbolViewerView::parseTclSymbols(void)
                             args_par--;
                             if (args_par == 0) {
                                 // stripped = stripped.simplified();
-                                if (m_func->isChecked()) {
-                                    if (m_treeOn->isChecked()) {
+                                if (m_options.showFunctions) {
+                                    if (m_options.treeMode) {
                                         node = new QTreeWidgetItem(clsNode, lastClsNode);
                                         lastClsNode = node;
                                     } else
-                                        node = new QTreeWidgetItem(m_symbols);
+                                        node = new QTreeWidgetItem(m_root);
                                     node->setText(0, stripped);
-                                    node->setIcon(0, QIcon(cls));
+                                    setIcon(node, cls);
                                     node->setText(1, QString::number(i, 10));
                                 }
                                 stripped.clear();
@@ -138,7 +132,7 @@ void KatePluginSymbolViewerView::parseTclSymbols(void)
                         }
                     } // block = 0
                 }     // for j loop
-            }         // m_func->isChecked()
+            }         // m_options.showFunctions
         }             // not a comment
     }                 // for i loop
 
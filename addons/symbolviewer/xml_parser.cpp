@@ -14,14 +14,11 @@
  *
  ***************************************************************************/
 
-#include "plugin_katesymbolviewer.h"
+#include "symbolparser.h"
 
-void KatePluginSymbolViewerView::parseXMLSymbols(void)
+void KateSymbolParser::parseXMLSymbols(void)
 {
-    if (!m_mainWindow->activeView())
-        return;
-
-    m_struct->setText(i18n("Show Tags"));
+    m_structLabel = i18n("Show Tags");
 
     QString cl;
     QString stripped;
@@ -29,18 +26,16 @@ void KatePluginSymbolViewerView::parseXMLSymbols(void)
     char comment = 0;
     int i;
 
-    QPixmap cls(class_xpm);
-    QPixmap sct(struct_xpm);
+    const Icon cls = ClassIcon;
+    const Icon sct = StructIcon;
 
     QTreeWidgetItem *node = nullptr;
     QTreeWidgetItem *topNode = nullptr;
 
-    KTextEditor::Document *kv = m_mainWindow->activeView()->document();
-
-    m_symbols->setRootIsDecorated(0);
+    m_rootIsDecorated = false;
 
-    for (i = 0; i < kv->lines(); i++) {
-        cl = kv->line(i);
+    for (i = 0; i < m_lines.size(); i++) {
+        cl = m_lines.at(i);
         cl = cl.trimmed();
 
         if (cl.indexOf(QRegularExpression(QLatin1String("<!--"))) >= 0) {
@@ -55,7 +50,7 @@ void KatePluginSymbolViewerView::parseXMLSymbols(void)
             continue;
         }
 
-        if (cl.indexOf(QRegularExpression(QLatin1String("^<[a-zA-Z_]+[a-zA-Z0-9_\\.\\-]*"))) == 0 && m_struct->isChecked()) {
+        if (cl.indexOf(QRegularExpression(QLatin1String("^<[a-zA-Z_]+[a-zA-Z0-9_\\.\\-]*"))) == 0 && m_options.showStructures) {
             /* Get the tag type */
             QString type;
             QRegularExpressionMatch match;
@@ -68,14 +63,14 @@ void KatePluginSymbolViewerView::parseXMLSymbols(void)
             QString stripped = cl.remove(QRegularExpression(QLatin1String("^<[a-zA-Z_]+[a-zA-Z0-9_\\.\\-]* *")));
             stripped.remove(QRegularExpression(QLatin1String(" */*>.*")));
 
-            if (m_treeOn->isChecked()) {
+            if (m_options.treeMode) {
                 /* See if group already exists */
-                QList<QTreeWidgetItem *> reslist = m_symbols->findItems(type, Qt::MatchExactly);
+                QList<QTreeWidgetItem *> reslist = findItems(type);
                 if (reslist.isEmpty()) {
-                    topNode = new QTreeWidgetItem(m_symbols, QStringList(type));
-                    topNode->setIcon(0, QIcon(cls));
-                    if (m_expandOn->isChecked()) {
-                        m_symbols->expandItem(topNode);
+                    topNode = new QTreeWidgetItem(m_root, QStringList(type));
+                    setIcon(topNode, cls);
+                    if (m_options.expandTree) {
+                        expandItem(topNode);
                     }
                 } else {
                     topNode = reslist[0];
@@ -83,9 +78,9 @@ void KatePluginSymbolViewerView::parseXMLSymbols(void)
                 node = new QTreeWidgetItem(topNode);
                 topNode->addChild(node);
             } else {
-                node = new QTreeWidgetItem(m_symbols);
+                node = new QTreeWidgetItem(m_root);
             }
-            node->setIcon(0, QIcon(sct));
+            setIcon(node, sct);
             node->setText(0, stripped);
             node->setText(1, QString::number(i, 10));
         }
@@ -11,16 +11,13 @@
  *                                                                         *
  ***************************************************************************/
 
-#include "plugin_katesymbolviewer.h"
+#include "symbolparser.h"
 
-void KatePluginSymbolViewerView::parseXsltSymbols(void)
+void KateSymbolParser::parseXsltSymbols(void)
 {
-    if (!m_mainWindow->activeView())
-        return;
-
-    m_macro->setText(i18n("Show Params"));
-    m_struct->setText(i18n("Show Variables"));
-    m_func->setText(i18n("Show Templates"));
+    m_macroLabel = i18n("Show Params");
+    m_structLabel = i18n("Show Variables");
+    m_funcLabel = i18n("Show Templates");
 
     QString cl; // Current Line
     QString stripped;
@@ -29,43 +26,42 @@ void KatePluginSymbolViewerView::parseXsltSymbols(void)
     char templ = 0;
     int i;
 
-    QPixmap cls(class_xpm);
-    QPixmap sct(struct_xpm);
-    QPixmap mcr(macro_xpm);
-    QPixmap cls_int(class_int_xpm);
+    const Icon cls = ClassIcon;
+    const Icon sct = StructIcon;
+    const Icon mcr = MacroIcon;
+    const Icon cls_int = ClassIntIcon;
 
     QTreeWidgetItem *node = nullptr;
     QTreeWidgetItem *mcrNode = nullptr, *sctNode = nullptr, *clsNode = nullptr;
     QTreeWidgetItem *lastMcrNode = nullptr, *lastSctNode = nullptr, *lastClsNode = nullptr;
 
-    KTextEditor::Document *kv = m_mainWindow->activeView()->document();
     // kdDebug(13000)<<"Lines counted :"<<kv->numLines()<<endl;
 
-    if (m_treeOn->isChecked()) {
-        mcrNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Params")));
-        sctNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Variables")));
-        clsNode = new QTreeWidgetItem(m_symbols, QStringList(i18n("Templates")));
-        mcrNode->setIcon(0, QIcon(mcr));
-        sctNode->setIcon(0, QIcon(sct));
-        clsNode->setIcon(0, QIcon(cls));
-
-        if (m_expandOn->isChecked()) {
-            m_symbols->expandItem(mcrNode);
-            m_symbols->expandItem(sctNode);
-            m_symbols->expandItem(clsNode);
+    if (m_options.treeMode) {
+        mcrNode = new QTreeWidgetItem(m_root, QStringList(i18n("Params")));
+        sctNode = new QTreeWidgetItem(m_root, QStringList(i18n("Variables")));
+        clsNode = new QTreeWidgetItem(m_root, QStringList(i18n("Templates")));
+        setIcon(mcrNode, mcr);
+        setIcon(sctNode, sct);
+        setIcon(clsNode, cls);
+
+        if (m_options.expandTree) {
+            expandItem(mcrNode);
+            expandItem(sctNode);
+            expandItem(clsNode);
         }
 
         lastMcrNode = mcrNode;
         lastSctNode = sctNode;
         lastClsNode = clsNode;
 
-        m_symbols->setRootIsDecorated(1);
+        m_rootIsDecorated = true;
     } else {
-        m_symbols->setRootIsDecorated(0);
+        m_rootIsDecorated = false;
     }
 
-    for (i = 0; i < kv->lines(); i++) {
-        cl = kv->line(i);
+    for (i = 0; i < m_lines.size(); i++) {
+        cl = m_lines.at(i);
         cl = cl.trimmed();
 
         if (cl.indexOf(QRegularExpression(QLatin1String("<!--"))) >= 0) {
@@ -88,59 +84,59 @@ void KatePluginSymbolViewerView::parseXsltSymbols(void)
             continue;
         }
 
-        if (cl.indexOf(QRegularExpression(QLatin1String("^<xsl:param "))) == 0 && m_macro->isChecked()) {
+        if (cl.indexOf(QRegularExpression(QLatin1String("^<xsl:param "))) == 0 && m_options.showMacros) {
             QString stripped = cl.remove(QRegularExpression(QLatin1String("^<xsl:param +name=\"")));
             stripped.remove(QRegularExpression(QLatin1String("\".*")));
 
-            if (m_treeOn->isChecked()) {
+            if (m_options.treeMode) {
                 node = new QTreeWidgetItem(mcrNode, lastMcrNode);
                 lastMcrNode = node;
             } else
-                node = new QTreeWidgetItem(m_symbols);
+                node = new QTreeWidgetItem(m_root);
             node->setText(0, stripped);
-            node->setIcon(0, QIcon(mcr));
+            setIcon(node, mcr);
             node->setText(1, QString::number(i, 10));
         }
 
-        if (cl.indexOf(QRegularExpression(QLatin1String("^<xsl:variable "))) == 0 && m_struct->isChecked()) {
+        if (cl.indexOf(QRegularExpression(QLatin1String("^<xsl:variable "))) == 0 && m_options.showStructures) {
             QString stripped = cl.remove(QRegularExpression(QLatin1String("^<xsl:variable +name=\"")));
             stripped.remove(QRegularExpression(QLatin1String("\".*")));
 
-            if (m_treeOn->isChecked()) {
+            if (m_options.treeMode) {
                 node = new QTreeWidgetItem(sctNode, lastSctNode);
                 lastSctNode = node;
             } else
-                node = new QTreeWidgetItem(m_symbols);
+                node = new QTreeWidgetItem(m_root);
             node->setText(0, stripped);
-            node->setIcon(0, QIcon(sct));
+            setIcon(node, sct);
             node->setText(1, QString::number(i, 10));
         }
 
-        if (cl.indexOf(QRegularExpression(QLatin1String("^<xsl:template +match="))) == 0 && m_func->isChecked()) {
+        if (cl.indexOf(QRegularExpression(QLatin1String("^<xsl:template +match="))) == 0 && m_options.showFunctions) {
             QString stripped = cl.remove(QRegularExpression(QLatin1String("^<xsl:template +match=\"")));
             stripped.remove(QRegularExpression(QLatin1String("\".*")));
 
-            if (m_treeOn->isChecked()) {
+            if (m_options.treeMode) {
                 node = new QTreeWidgetItem(clsNode, lastClsNode);
                 lastClsNode = node;
             } else
-                node = new QTreeWidgetItem(m_symbols);
+                node = new QTreeWidgetItem(m_root);
             node->setText(0, stripped);
-            node->setIcon(0, QIcon(cls_int));
+            setIcon(node, cls_int);
             node->setText(1, QString::number(i, 10));
         }
 
-        if (cl.indexOf(QRegularExpression(QLatin1String("^<xsl:template +name="))) == 0 && m_func->isChecked()) {
+        if (cl.indexOf(QRegularExpression(QLatin1String("^<xsl:template +name="))) == 0 && m_options.showFunctions) {
             QString stripped = cl.remove(QRegularExpression(QLatin1String("^<xsl:template +name=\"")));
             stripped.remove(QRegularExpression(QLatin1String("\".*")));
 
-            if (m_treeOn->isChecked()) {
+            if (m_options.treeMode) {
                 node = new QTreeWidgetItem(clsNode, lastClsNode);
                 lastClsNode = node;
             } else
-                node = new QTreeWidgetItem(m_symbols);
+                node = new QTreeWidgetItem(m_root);
             node->setText(0, stripped);
-            node->setIcon(0, QIcon(cls));
+            setIcon(node, cls);
             node->setText(1, QString::number(i, 10));
         }
 
@@ -29,6 +29,7 @@
 #include <KActionCollection>
 #include <KAuthorized>
 #include <KConfigGroup>
+#include <KFormat>
 #include <KPluginFactory>
 #include <KSharedConfig>
 #include <KXMLGUIFactory>
@@ -36,13 +37,22 @@
 #include <QApplication>
 #include <QClipboard>
 
+#include <ktexteditor/movinginterface.h>
+
 K_PLUGIN_FACTORY_WITH_JSON(TextFilterPluginFactory, "textfilterplugin.json", registerPlugin<PluginKateTextFilter>();)
 
+// characters encoded and written at once, also the bytes queued for the process at most
+static const int InputChunkSize = 64 * 1024;
+
 PluginKateTextFilter::PluginKateTextFilter(QObject *parent, const QList<QVariant> &)
     : KTextEditor::Plugin(parent)
 {
     // register command
     new PluginKateTextFilterCommand(this);
+
+    // only filters taking a while show their progress
+    m_progressTimer.setInterval(500);
+    connect(&m_progressTimer, &QTimer::timeout, this, &PluginKateTextFilter::slotUpdateProgress);
 }
 
 PluginKateTextFilter::~PluginKateTextFilter()
@@ -63,71 +73,135 @@ QObject *PluginKateTextFilter::createView(KTextEditor::MainWindow *mainWindow)
 
 void PluginKateTextFilter::slotFilterReceivedStdout()
 {
-    m_strFilterOutput += QString::fromLocal8Bit(m_pFilterProcess->readAllStandardOutput());
+    const QByteArray block = m_pFilterProcess->readAllStandardOutput();
+    m_outputSize += block.size();
+    m_strFilterOutput += m_stdoutDecoder->toUnicode(block);
 }
 
 void PluginKateTextFilter::slotFilterReceivedStderr()
 {
-    const QString block = QString::fromLocal8Bit(m_pFilterProcess->readAllStandardError());
+    const QString block = m_stderrDecoder->toUnicode(m_pFilterProcess->readAllStandardError());
     if (mergeOutput)
         m_strFilterOutput += block;
     else
         m_stderrOutput += block;
 }
 
+void PluginKateTextFilter::slotFilterBytesWritten()
+{
+    writeInput();
+}
+
+void PluginKateTextFilter::writeInput()
+{
+    if (m_inputClosed) {
+        return;
+    }
+
+    while (m_inputPosition < m_input.size() && m_pFilterProcess->bytesToWrite() < InputChunkSize) {
+        const int length = qMin(InputChunkSize, m_input.size() - m_inputPosition);
+        m_pFilterProcess->write(m_encoder->fromUnicode(m_input.constData() + m_inputPosition, length));
+        m_inputPosition += length;
+    }
+
+    if (m_inputPosition >= m_input.size()) {
+        m_inputClosed = true;
+        m_pFilterProcess->closeWriteChannel();
+    }
+}
+
 void PluginKateTextFilter::slotFilterProcessExited(int, QProcess::ExitStatus)
 {
-    KTextEditor::View *kv(KTextEditor::Editor::instance()->application()->activeMainWindow()->activeView());
-    if (!kv)
+    m_progressTimer.stop();
+    delete m_progressMessage;
+
+    m_input.clear();
+    std::unique_ptr<KTextEditor::MovingRange> range = std::move(m_range);
+    KTextEditor::Document *doc = m_document;
+    m_document.clear();
+    if (m_canceled || !doc) {
+        m_strFilterOutput.clear();
         return;
+    }
 
     // Is there any error output to display?
     if (!mergeOutput && !m_stderrOutput.isEmpty()) {
         QPointer<KTextEditor::Message> message = new KTextEditor::Message(xi18nc("@info", "<title>Result of:</title><nl /><pre><code>$ %1\n<nl />%2</code></pre>", m_last_command, m_stderrOutput), KTextEditor::Message::Error);
         message->setWordWrap(true);
         message->setAutoHide(1000);
-        kv->document()->postMessage(message);
+        doc->postMessage(message);
     }
 
     if (copyResult) {
         QApplication::clipboard()->setText(m_strFilterOutput);
+        m_strFilterOutput.clear();
         return;
     }
 
     // Do not even try to change the document if no result collected...
-    if (m_strFilterOutput.isEmpty())
+    if (m_strFilterOutput.isEmpty() || !range)
         return;
 
-    KTextEditor::Document::EditingTransaction transaction(kv->document());
+    // the text of the selection may have moved meanwhile
+    const KTextEditor::Range target = range->toRange();
+    range.reset();
+
+    KTextEditor::Document::EditingTransaction transaction(doc);
+    doc->removeText(target, m_blockSelection);
+    doc->insertText(target.start(), m_strFilterOutput, m_blockSelection);
+    m_strFilterOutput.clear();
+}
 
-    KTextEditor::Cursor start = kv->cursorPosition();
-    if (kv->selection()) {
-        start = kv->selectionRange().start();
-        kv->removeSelectionText();
+void PluginKateTextFilter::slotCancelFilter()
+{
+    if (!m_pFilterProcess || m_pFilterProcess->state() == QProcess::NotRunning) {
+        return;
     }
 
-    kv->setCursorPosition(start); // for block selection
+    // the result is dropped once the process is gone
+    m_canceled = true;
+    m_pFilterProcess->kill();
+    m_pFilterProcess->waitForFinished();
+}
+
+void PluginKateTextFilter::slotDocumentInvalidated(KTextEditor::Document *doc)
+{
+    if (doc != m_document) {
+        return;
+    }
 
-    kv->insertText(m_strFilterOutput);
+    // reloaded or closed, nothing to replace anymore
+    m_range.reset();
+    slotCancelFilter();
 }
 
-static void slipInFilter(KProcess &proc, KTextEditor::View &view, const QString &command)
+void PluginKateTextFilter::slotUpdateProgress()
 {
-    QString inputText;
+    if (!m_document) {
+        return;
+    }
 
-    if (view.selection()) {
-        inputText = view.selectionText();
+    KFormat format;
+    QString text;
+    if (!m_inputClosed) {
+        const int percent = m_input.isEmpty() ? 100 : int(qint64(m_inputPosition) * 100 / m_input.size());
+        text = i18n("Filtering through <b>%1</b>: %2% of the text written, %3 read.", m_last_command.toHtmlEscaped(), percent, format.formatByteSize(m_outputSize));
+    } else {
+        text = i18n("Filtering through <b>%1</b>: %2 read.", m_last_command.toHtmlEscaped(), format.formatByteSize(m_outputSize));
     }
 
-    proc.clearProgram();
-    proc.setShellCommand(command);
+    if (m_progressMessage) {
+        m_progressMessage->setText(text);
+        return;
+    }
 
-    proc.start();
-    QByteArray encoded = inputText.toLocal8Bit();
-    proc.write(encoded);
-    proc.closeWriteChannel();
-    //  TODO: Put up a modal dialog to defend the text from further
-    //  keystrokes while the command is out. With a cancel button...
+    m_progressMessage = new KTextEditor::Message(text, KTextEditor::Message::Information);
+    m_progressMessage->setPosition(KTextEditor::Message::TopInView);
+    m_progressMessage->setWordWrap(true);
+    QAction *cancel = new QAction(QIcon::fromTheme(QStringLiteral("process-stop")), i18n("Cancel"), nullptr);
+    connect(cancel, &QAction::triggered, this, &PluginKateTextFilter::slotCancelFilter);
+    m_progressMessage->addAction(cancel);
+    m_document->postMessage(m_progressMessage);
 }
 
 void PluginKateTextFilter::slotEditFilter()
@@ -173,7 +247,6 @@ void PluginKateTextFilter::slotEditFilter()
             config.writeEntry("Completion list", ui.filterBox->historyItems());
             config.writeEntry("Copy result", copyResult);
             config.writeEntry("Merge output", mergeOutput);
-            m_last_command = filter;
             runFilter(kv, filter);
         }
     }
@@ -181,8 +254,14 @@ void PluginKateTextFilter::slotEditFilter()
 
 void PluginKateTextFilter::runFilter(KTextEditor::View *kv, const QString &filter)
 {
+    // one filter at a time
+    slotCancelFilter();
+    m_canceled = false;
+
     m_strFilterOutput.clear();
     m_stderrOutput.clear();
+    m_outputSize = 0;
+    m_last_command = filter;
 
     if (!m_pFilterProcess) {
         m_pFilterProcess = new KProcess;
@@ -191,11 +270,47 @@ void PluginKateTextFilter::runFilter(KTextEditor::View *kv, const QString &filte
 
         connect(m_pFilterProcess, &KProcess::readyReadStandardError, this, &PluginKateTextFilter::slotFilterReceivedStderr);
 
+        connect(m_pFilterProcess, &KProcess::bytesWritten, this, &PluginKateTextFilter::slotFilterBytesWritten);
+
         connect(m_pFilterProcess, static_cast<void (KProcess::*)(int, KProcess::ExitStatus)>(&KProcess::finished), this, &PluginKateTextFilter::slotFilterProcessExited);
+
+        // no finished() then, drop the filter the same way
+        connect(m_pFilterProcess, &KProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) {
+                m_canceled = true;
+                slotFilterProcessExited(-1, QProcess::CrashExit);
+            }
+        });
     }
     m_pFilterProcess->setOutputChannelMode(mergeOutput ? KProcess::MergedChannels : KProcess::SeparateChannels);
 
-    slipInFilter(*m_pFilterProcess, *kv, filter);
+    // remember what to replace, the document stays editable meanwhile
+    KTextEditor::Document *doc = kv->document();
+    m_document = doc;
+    m_blockSelection = kv->blockSelection();
+    const KTextEditor::Range range = kv->selection() ? kv->selectionRange() : KTextEditor::Range(kv->cursorPosition(), kv->cursorPosition());
+    if (KTextEditor::MovingInterface *moving = qobject_cast<KTextEditor::MovingInterface *>(doc)) {
+        m_range.reset(moving->newMovingRange(range));
+        connect(doc, SIGNAL(aboutToInvalidateMovingInterfaceContent(KTextEditor::Document *)), this, SLOT(slotDocumentInvalidated(KTextEditor::Document *)), Qt::UniqueConnection);
+        connect(doc, SIGNAL(aboutToDeleteMovingInterfaceContent(KTextEditor::Document *)), this, SLOT(slotDocumentInvalidated(KTextEditor::Document *)), Qt::UniqueConnection);
+    }
+
+    m_input = kv->selection() ? kv->selectionText() : QString();
+    m_inputPosition = 0;
+    m_inputClosed = false;
+
+    // stateful, characters may be split between chunks
+    QTextCodec *codec = QTextCodec::codecForLocale();
+    m_encoder.reset(codec->makeEncoder());
+    m_stdoutDecoder.reset(codec->makeDecoder());
+    m_stderrDecoder.reset(codec->makeDecoder());
+
+    m_pFilterProcess->clearProgram();
+    m_pFilterProcess->setShellCommand(filter);
+    m_pFilterProcess->start();
+    writeInput();
+
+    m_progressTimer.start();
 }
 
 // BEGIN Kate::Command methods
@@ -19,12 +19,19 @@
 #include <KTextEditor/Command>
 #include <KTextEditor/Document>
 #include <KTextEditor/MainWindow>
+#include <KTextEditor/Message>
+#include <KTextEditor/MovingRange>
 #include <KTextEditor/Plugin>
 #include <KTextEditor/View>
 
 #include <KProcess>
+#include <QPointer>
+#include <QTextCodec>
+#include <QTimer>
 #include <QVariantList>
 
+#include <memory>
+
 class PluginKateTextFilter : public KTextEditor::Plugin
 {
     Q_OBJECT
@@ -42,6 +49,11 @@ public:
     void runFilter(KTextEditor::View *kv, const QString &filter);
 
 private:
+    /**
+     * Write the next chunks of the input, only a few are queued at once.
+     */
+    void writeInput();
+
     QString m_strFilterOutput;
     QString m_stderrOutput;
     QString m_last_command;
@@ -49,11 +61,31 @@ private:
     QStringList completionList;
     bool copyResult = false;
     bool mergeOutput = false;
+
+    // the running filter and the text it replaces
+    QPointer<KTextEditor::Document> m_document;
+    std::unique_ptr<KTextEditor::MovingRange> m_range;
+    bool m_blockSelection = false;
+    bool m_canceled = false;
+    QString m_input;
+    int m_inputPosition = 0;
+    bool m_inputClosed = false;
+    qint64 m_outputSize = 0;
+    std::unique_ptr<QTextEncoder> m_encoder;
+    std::unique_ptr<QTextDecoder> m_stdoutDecoder;
+    std::unique_ptr<QTextDecoder> m_stderrDecoder;
+    QPointer<KTextEditor::Message> m_progressMessage;
+    QTimer m_progressTimer;
+
 public Q_SLOTS:
     void slotEditFilter();
     void slotFilterReceivedStdout();
     void slotFilterReceivedStderr();
+    void slotFilterBytesWritten();
     void slotFilterProcessExited(int exitCode, QProcess::ExitStatus exitStatus);
+    void slotCancelFilter();
+    void slotUpdateProgress();
+    void slotDocumentInvalidated(KTextEditor::Document *doc);
 };
 
 class PluginKateTextFilterCommand : public KTextEditor::Command
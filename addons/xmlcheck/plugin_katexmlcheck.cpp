@@ -1,5 +1,5 @@
 /***************************************************************************
-                           plugin_katexmlcheck.cpp - checks XML files using xmllint
+                           plugin_katexmlcheck.cpp - checks XML files using libxml2
                            -------------------
     begin                : 2002-07-06
     copyright            : (C) 2002 by Daniel Naber
@@ -37,11 +37,7 @@
 // Remove copyright above due to author orphaned this plugin?
 // Possibility to check only well-formdness without validation
 // Hide output in dock when switching to another tab
-// Make ability to validate against xml schema and then edit docbook
 // Should del space in [km] strang in katexmlcheck.desktop?
-// Which variant should I choose? QUrl.adjusted(rm filename).path() or QUrl.toString(rm filename|rm schema)
-// What about replace xmllint xmlstarlet or something?
-// Maybe use QXmlReader to take dtds and xsds?
 
 #include "plugin_katexmlcheck.h"
 #include <QHBoxLayout>
@@ -49,31 +45,19 @@
 
 #include <KActionCollection>
 #include <QApplication>
-#include <QFile>
+#include <QDebug>
 #include <QHeaderView>
-#include <QInputDialog>
-#include <QRegExp>
+#include <QMimeDatabase>
+#include <QRunnable>
 #include <QString>
-#include <QTextStream>
 #include <QTreeWidget>
 
-#include <KCursor>
+#include <KConfigGroup>
 #include <KLocalizedString>
-#include <KMessageBox>
 #include <KPluginFactory>
+#include <KSharedConfig>
 #include <QAction>
-#include <QTemporaryFile>
-
-#include <QComboBox>
-#include <QFile>
-#include <QFileDialog>
-#include <QGuiApplication>
-#include <QLabel>
-#include <QLineEdit>
-#include <QPushButton>
-#include <QRegExp>
-#include <QStandardPaths>
-#include <QString>
+
 #include <QUrl>
 #include <QVBoxLayout>
 
@@ -81,8 +65,32 @@
 
 #include <kxmlguifactory.h>
 
+#include <functional>
+
 K_PLUGIN_FACTORY_WITH_JSON(PluginKateXMLCheckFactory, "katexmlcheck.json", registerPlugin<PluginKateXMLCheck>();)
 
+namespace
+{
+class ValidateTask : public QRunnable
+{
+public:
+    explicit ValidateTask(const std::function<void()> &task)
+        : m_task(task)
+    {
+    }
+
+    void run() override
+    {
+        m_task();
+    }
+
+private:
+    std::function<void()> m_task;
+};
+
+enum Roles { LineRole = Qt::UserRole + 1, ColumnRole };
+}
+
 PluginKateXMLCheck::PluginKateXMLCheck(QObject *const parent, const QVariantList &)
     : KTextEditor::Plugin(parent)
 {
@@ -108,10 +116,14 @@ PluginKateXMLCheckView::PluginKateXMLCheckView(KTextEditor::Plugin *plugin, KTex
 
     dock = m_mainWindow->createToolView(plugin, QStringLiteral("kate_plugin_xmlcheck_ouputview"), KTextEditor::MainWindow::Bottom, QIcon::fromTheme(QStringLiteral("misc")), i18n("XML Checker Output"));
     listview = new QTreeWidget(dock);
-    m_tmp_file = nullptr;
     QAction *a = actionCollection()->addAction(QStringLiteral("xml_check"));
     a->setText(i18n("Validate XML"));
     connect(a, &QAction::triggered, this, &PluginKateXMLCheckView::slotValidate);
+
+    m_idleAction = actionCollection()->addAction(QStringLiteral("xml_check_on_idle"));
+    m_idleAction->setText(i18n("Validate XML While Editing"));
+    m_idleAction->setCheckable(true);
+    connect(m_idleAction, &QAction::toggled, this, &PluginKateXMLCheckView::slotValidateOnIdle);
     // TODO?:
     //(void)  new KAction ( i18n("Indent XML"), KShortcut(), this,
     //	SLOT(slotIndent()), actionCollection(), "xml_indent" );
@@ -131,61 +143,49 @@ PluginKateXMLCheckView::PluginKateXMLCheckView(KTextEditor::Plugin *plugin, KTex
     header->setSectionResizeMode(1, QHeaderView::ResizeToContents);
     header->setSectionResizeMode(2, QHeaderView::ResizeToContents);
 
-    /* TODO?: invalidate the listview when document has changed
-       Kate::View *kv = application()->activeMainWindow()->activeView();
-       if( ! kv ) {
-       qDebug() << "Warning: no Kate::View";
-       return;
-       }
-       connect(kv, SIGNAL(modifiedChanged()), this, SLOT(slotUpdate()));
-    */
-
-    connect(&m_proc, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &PluginKateXMLCheckView::slotProcExited);
-    // we currently only want errors:
-    m_proc.setProcessChannelMode(QProcess::SeparateChannels);
-    // m_proc.setProcessChannelMode(QProcess::ForwardedChannels); // For Debugging. Do not use this.
+    // one document at a time, so the cached DTDs and schemas need no locking
+    m_validatorThread.setMaxThreadCount(1);
+
+    // validate once the user pauses typing
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(1000);
+    connect(&m_idleTimer, &QTimer::timeout, this, &PluginKateXMLCheckView::validate);
+
+    connect(m_mainWindow, &KTextEditor::MainWindow::viewChanged, this, &PluginKateXMLCheckView::slotViewChanged);
+    slotViewChanged(m_mainWindow->activeView());
+    m_idleAction->setChecked(KConfigGroup(KSharedConfig::openConfig(), "XML Check").readEntry("ValidateOnIdle", false));
+
     mainwin->guiFactory()->addClient(this);
 }
 
 PluginKateXMLCheckView::~PluginKateXMLCheckView()
 {
+    m_validatorThread.waitForDone();
     m_mainWindow->guiFactory()->removeClient(this);
-    delete m_tmp_file;
     delete dock;
 }
 
-void PluginKateXMLCheckView::slotProcExited(int exitCode, QProcess::ExitStatus exitStatus)
+void PluginKateXMLCheckView::validated(const KateXmlValidator::Result &result)
 {
-    Q_UNUSED(exitCode);
-
-    // FIXME: doesn't work correct the first time:
-    // if( m_dockwidget->isDockBackPossible() ) {
-    //	m_dockwidget->dockBack();
-    //	}
-
-    if (exitStatus != QProcess::NormalExit) {
-        QTreeWidgetItem *item = new QTreeWidgetItem();
-        item->setText(0, QStringLiteral("1").rightJustified(4, ' '));
-        item->setText(3, QStringLiteral("Validate process crashed."));
-        listview->addTopLevelItem(item);
+    m_running = false;
+    if (m_validateAgain) {
+        // outdated already
+        m_validateAgain = false;
+        validate();
         return;
     }
 
-    qDebug() << "slotProcExited()";
-    QApplication::restoreOverrideCursor();
-    delete m_tmp_file;
-    QString proc_stderr = QString::fromLocal8Bit(m_proc.readAllStandardError());
-    m_tmp_file = nullptr;
     listview->clear();
     uint list_count = 0;
     uint err_count = 0;
-    if (!m_validating) {
+    const bool validating = result.grammar != KateXmlValidator::Result::None && !result.grammarMissing;
+    if (!validating) {
         // no i18n here, so we don't get an ugly English<->Non-english mixup:
         QString msg;
-        if (m_dtdname.isEmpty()) {
+        if (result.grammarUrl.isEmpty()) {
             msg = QStringLiteral("No DOCTYPE found, will only check well-formedness.");
         } else {
-            msg = '\'' + m_dtdname + "' not found, will only check well-formedness.";
+            msg = '\'' + result.grammarUrl + "' not found, will only check well-formedness.";
         }
         QTreeWidgetItem *item = new QTreeWidgetItem();
         item->setText(0, QStringLiteral("1").rightJustified(4, ' '));
@@ -193,52 +193,38 @@ void PluginKateXMLCheckView::slotProcExited(int exitCode, QProcess::ExitStatus e
         listview->addTopLevelItem(item);
         list_count++;
     }
-    if (!proc_stderr.isEmpty()) {
-#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
-        QStringList lines = proc_stderr.split('\n', QString::SkipEmptyParts);
-#else
-        QStringList lines = proc_stderr.split('\n', Qt::SkipEmptyParts);
-#endif
-        QString linenumber, msg;
-        int line_count = 0;
-        for (QStringList::Iterator it = lines.begin(); it != lines.end(); ++it) {
-            QString line = *it;
-            line_count++;
-            int semicolon_1 = line.indexOf(':');
-            int semicolon_2 = line.indexOf(':', semicolon_1 + 1);
-            int semicolon_3 = line.indexOf(':', semicolon_2 + 2);
-            int caret_pos = line.indexOf('^');
-            if (semicolon_1 != -1 && semicolon_2 != -1 && semicolon_3 != -1) {
-                linenumber = line.mid(semicolon_1 + 1, semicolon_2 - semicolon_1 - 1).trimmed();
-                linenumber = linenumber.rightJustified(6, ' '); // for sorting numbers
-                msg = line.mid(semicolon_3 + 1, line.length() - semicolon_3 - 1).trimmed();
-            } else if (caret_pos != -1 || line_count == lines.size()) {
-                // TODO: this fails if "^" occurs in the real text?!
-                if (line_count == lines.size() && caret_pos == -1) {
-                    msg = msg + '\n' + line;
-                }
-                QString col = QString::number(caret_pos);
-                if (col == QLatin1String("-1")) {
-                    col = QLatin1String("");
-                }
-                err_count++;
-                list_count++;
-                QTreeWidgetItem *item = new QTreeWidgetItem();
-                item->setText(0, QString::number(list_count).rightJustified(4, ' '));
-                item->setText(1, linenumber);
-                item->setTextAlignment(1, (item->textAlignment(1) & ~Qt::AlignHorizontal_Mask) | Qt::AlignRight);
-                item->setText(2, col);
-                item->setTextAlignment(2, (item->textAlignment(2) & ~Qt::AlignHorizontal_Mask) | Qt::AlignRight);
-                item->setText(3, msg);
-                listview->addTopLevelItem(item);
-            } else {
-                msg = msg + '\n' + line;
-            }
+
+    for (const KateXmlValidator::Diagnostic &diagnostic : result.diagnostics) {
+        if (!diagnostic.warning) {
+            err_count++;
+        }
+        list_count++;
+        QTreeWidgetItem *item = new QTreeWidgetItem();
+        item->setText(0, QString::number(list_count).rightJustified(4, ' '));
+        if (diagnostic.line > 0) {
+            item->setText(1, QString::number(diagnostic.line).rightJustified(6, ' ')); // for sorting numbers
+            item->setData(0, LineRole, diagnostic.line);
         }
+        item->setTextAlignment(1, (item->textAlignment(1) & ~Qt::AlignHorizontal_Mask) | Qt::AlignRight);
+        if (diagnostic.column > 0) {
+            item->setText(2, QString::number(diagnostic.column));
+            item->setData(0, ColumnRole, diagnostic.column);
+        }
+        item->setTextAlignment(2, (item->textAlignment(2) & ~Qt::AlignHorizontal_Mask) | Qt::AlignRight);
+        item->setText(3, diagnostic.warning ? QStringLiteral("warning: ") + diagnostic.message : diagnostic.message);
+        listview->addTopLevelItem(item);
+    }
+
+    if (result.truncated) {
+        QTreeWidgetItem *item = new QTreeWidgetItem();
+        item->setText(0, QString::number(++list_count).rightJustified(4, ' '));
+        item->setText(3, QStringLiteral("Too many problems, only the first %1 are shown.").arg(KateXmlValidator::MaxDiagnostics)); // no i18n here
+        listview->addTopLevelItem(item);
     }
+
     if (err_count == 0) {
         QString msg;
-        if (m_validating) {
+        if (validating) {
             msg = QStringLiteral("No errors found, document is valid."); // no i18n here
         } else {
             msg = QStringLiteral("No errors found, document is well-formed."); // no i18n here
@@ -254,24 +240,57 @@ void PluginKateXMLCheckView::slotClicked(QTreeWidgetItem *item, int column)
 {
     Q_UNUSED(column);
     qDebug() << "slotClicked";
-    if (item) {
-        bool ok = true;
-        uint line = item->text(1).toUInt(&ok);
-        bool ok2 = true;
-        uint column = item->text(2).toUInt(&ok);
-        if (ok && ok2) {
-            KTextEditor::View *kv = m_mainWindow->activeView();
-            if (!kv)
-                return;
-
-            kv->setCursorPosition(KTextEditor::Cursor(line - 1, column));
-        }
+    if (item && item->data(0, LineRole).isValid()) {
+        KTextEditor::View *kv = m_mainWindow->activeView();
+        if (!kv)
+            return;
+
+        const int line = item->data(0, LineRole).toInt();
+        const int column = qMax(0, item->data(0, ColumnRole).toInt() - 1);
+        kv->setCursorPosition(KTextEditor::Cursor(line - 1, column));
     }
 }
 
 void PluginKateXMLCheckView::slotUpdate()
 {
-    qDebug() << "slotUpdate() (not implemented yet)";
+    if (m_idleAction->isChecked() && isXml(m_document)) {
+        m_idleTimer.start();
+    }
+}
+
+void PluginKateXMLCheckView::slotValidateOnIdle(bool enabled)
+{
+    KConfigGroup config(KSharedConfig::openConfig(), "XML Check");
+    config.writeEntry("ValidateOnIdle", enabled);
+
+    if (enabled) {
+        slotUpdate();
+    } else {
+        m_idleTimer.stop();
+    }
+}
+
+void PluginKateXMLCheckView::slotViewChanged(KTextEditor::View *view)
+{
+    if (m_document) {
+        disconnect(m_document, &KTextEditor::Document::textChanged, this, &PluginKateXMLCheckView::slotUpdate);
+    }
+
+    m_idleTimer.stop();
+    m_document = view ? view->document() : nullptr;
+    if (m_document) {
+        connect(m_document, &KTextEditor::Document::textChanged, this, &PluginKateXMLCheckView::slotUpdate);
+        slotUpdate();
+    }
+}
+
+bool PluginKateXMLCheckView::isXml(KTextEditor::Document *document) const
+{
+    if (!document) {
+        return false;
+    }
+    const QMimeType mimeType = QMimeDatabase().mimeTypeForName(document->mimeType());
+    return mimeType.inherits(QStringLiteral("application/xml"));
 }
 
 bool PluginKateXMLCheckView::slotValidate()
@@ -279,116 +298,38 @@ bool PluginKateXMLCheckView::slotValidate()
     qDebug() << "slotValidate()";
 
     m_mainWindow->showToolView(dock);
-    m_validating = false;
-    m_dtdname = QLatin1String("");
+    return validate();
+}
+
+bool PluginKateXMLCheckView::validate()
+{
+    m_idleTimer.stop();
 
     KTextEditor::View *kv = m_mainWindow->activeView();
     if (!kv)
         return false;
-    delete m_tmp_file;
-    m_tmp_file = new QTemporaryFile();
-    if (!m_tmp_file->open()) {
-        qDebug() << "Error (slotValidate()): could not create '" << m_tmp_file->fileName() << "': " << m_tmp_file->errorString();
-        KMessageBox::error(nullptr,
-                           i18n("<b>Error:</b> Could not create "
-                                "temporary file '%1'.",
-                                m_tmp_file->fileName()));
-        delete m_tmp_file;
-        m_tmp_file = nullptr;
-        return false;
-    }
-
-    QTextStream s(m_tmp_file);
-    s << kv->document()->text();
-    s.flush();
-
-    QString exe = QStandardPaths::findExecutable(QStringLiteral("xmllint"));
-    if (exe.isEmpty()) {
-        exe = QStandardPaths::locate(QStandardPaths::ApplicationsLocation, QStringLiteral("xmllint"));
-    }
-    // qDebug() << "exe=" <<exe;
-    // 	// use catalogs for KDE docbook:
-    // 	if( ! getenv("XML_CATALOG_FILES") ) {
-    // 		KComponentData ins("katexmlcheckplugin");
-    // 		QString catalogs;
-    // 		catalogs += ins.dirs()->findResource("data", "ksgmltools2/customization/catalog.xml");
-    // 		qDebug() << "catalogs: " << catalogs;
-    // 		setenv("XML_CATALOG_FILES", QFile::encodeName( catalogs ).data(), 1);
-    // 	}
-    // qDebug() << "**catalogs: " << getenv("XML_CATALOG_FILES");
-    QStringList args;
-    args << QStringLiteral("--noout");
-
-    // tell xmllint the working path of the document's file, if possible.
-    // otherwise it will not find relative DTDs
-
-    // I should give path to location of file, but remove filename
-    // I can make QUrl.adjusted(rm filename).path()
-    // or QUrl.toString(rm filename|rm schema)
-    // Result is the same. Which variant should I choose?
-    // QString path = kv->document()->url().adjusted(QUrl::RemoveFilename).path();
-    // xmllint uses space- or colon-separated path option, so spaces should be encoded to %20. It is done with EncodeSpaces.
-
-    // Now what about colons in file names or paths?
-    // This way xmllint works normally:
-    // xmllint --noout --path "/home/user/my/with:colon/" --valid "/home/user/my/with:colon/demo-1.xml"
-    // but because this plugin makes temp file path to file is another and this way xmllint refuses to find dtd:
-    // xmllint --noout --path "/home/user/my/with:colon/" --valid "/tmp/kate.X23725"
-    // As workaround we can encode ':' with %3A
-    QString path = kv->document()->url().toString(QUrl::RemoveFilename | QUrl::PreferLocalFile | QUrl::EncodeSpaces);
-    path.replace(':', QLatin1String("%3A"));
-    // because of such inconvenience with xmllint and paths, maybe switch to xmlstarlet?
-
-    qDebug() << "path=" << path;
-
-    if (!path.isEmpty()) {
-        args << QStringLiteral("--path") << path;
-    }
 
-    // heuristic: assume that the doctype is in the first 10,000 bytes:
-    QString text_start = kv->document()->text().left(10000);
-    // remove comments before looking for doctype (as a doctype might be commented out
-    // and needs to be ignored then):
-    QRegExp re("<!--.*-->");
-    re.setMinimal(true);
-    text_start.remove(re);
-    QRegExp re_doctype("<!DOCTYPE\\s+(.*)\\s+(?:PUBLIC\\s+[\"'].*[\"']\\s+[\"'](.*)[\"']|SYSTEM\\s+[\"'](.*)[\"'])", Qt::CaseInsensitive);
-    re_doctype.setMinimal(true);
-
-    if (re_doctype.indexIn(text_start) != -1) {
-        QString dtdname;
-        if (!re_doctype.cap(2).isEmpty()) {
-            dtdname = re_doctype.cap(2);
-        } else {
-            dtdname = re_doctype.cap(3);
-        }
-        if (!dtdname.startsWith(QLatin1String("http:"))) { // todo: u_dtd.isLocalFile() doesn't work :-(
-            // a local DTD is used
-            m_validating = true;
-            args << QStringLiteral("--valid");
-        } else {
-            m_validating = true;
-            args << QStringLiteral("--valid");
-        }
-    } else if (text_start.indexOf(QLatin1String("<!DOCTYPE")) != -1) {
-        // DTD is inside the XML file
-        m_validating = true;
-        args << QStringLiteral("--valid");
-    }
-    args << m_tmp_file->fileName();
-    qDebug() << "m_tmp_file->fileName()=" << m_tmp_file->fileName();
-
-    m_proc.start(exe, args);
-    qDebug() << "m_proc.program():" << m_proc.program(); // I want to see parameters
-    qDebug() << "args=" << args;
-    qDebug() << "exit code:" << m_proc.exitCode();
-    if (!m_proc.waitForStarted(-1)) {
-        KMessageBox::error(nullptr,
-                           i18n("<b>Error:</b> Failed to execute xmllint. Please make "
-                                "sure that xmllint is installed. It is part of libxml2."));
-        return false;
+    if (m_running) {
+        // the running one is outdated, validate again once it is done
+        m_validateAgain = true;
+        return true;
     }
-    QApplication::setOverrideCursor(Qt::WaitCursor);
+    m_running = true;
+
+    // relative DTDs and schemas are looked up from the document's location
+    const QUrl url = kv->document()->url();
+    const QString baseUrl = url.isLocalFile() ? url.toLocalFile() : url.toString();
+    const QByteArray text = kv->document()->text().toUtf8();
+
+    m_validatorThread.start(new ValidateTask([this, text, baseUrl]() {
+        const KateXmlValidator::Result result = m_validator.validate(text, baseUrl);
+        QMetaObject::invokeMethod(
+            this,
+            [this, result]() {
+                validated(result);
+            },
+            Qt::QueuedConnection);
+    }));
     return true;
 }
 
@@ -25,7 +25,7 @@
 #ifndef PLUGIN_KATEXMLCHECK_H
 #define PLUGIN_KATEXMLCHECK_H
 
-#include <QProcess>
+#include "xmlvalidator.h"
 
 #include <ktexteditor/application.h>
 #include <ktexteditor/mainwindow.h>
@@ -34,13 +34,15 @@
 #include <ktexteditor/document.h>
 #include <ktexteditor/view.h>
 
+#include <QPointer>
 #include <QString>
+#include <QThreadPool>
+#include <QTimer>
 #include <QVariantList>
 
+class QAction;
 class QTreeWidget;
 class QTreeWidgetItem;
-class QTemporaryFile;
-class QProcess;
 
 class PluginKateXMLCheckView : public QObject, public KXMLGUIClient
 {
@@ -56,16 +58,31 @@ public:
 public Q_SLOTS:
     bool slotValidate();
     void slotClicked(QTreeWidgetItem *item, int column);
-    void slotProcExited(int exitCode, QProcess::ExitStatus exitStatus);
+    /**
+     * The document was edited, validate it once the user pauses, if wanted.
+     */
     void slotUpdate();
+    void slotValidateOnIdle(bool enabled);
+    void slotViewChanged(KTextEditor::View *view);
 
 private:
-    QTemporaryFile *m_tmp_file;
-    KParts::ReadOnlyPart *part = nullptr;
-    bool m_validating = false;
-    QProcess m_proc;
-    QString m_proc_stderr;
-    QString m_dtdname;
+    /**
+     * Validate a snapshot of the active document in the worker thread.
+     */
+    bool validate();
+    void validated(const KateXmlValidator::Result &result);
+    bool isXml(KTextEditor::Document *document) const;
+
+    // the worker is gone before the validator
+    KateXmlValidator m_validator;
+    QThreadPool m_validatorThread;
+    bool m_running = false;
+    bool m_validateAgain = false;
+
+    QTimer m_idleTimer;
+    QAction *m_idleAction;
+    QPointer<KTextEditor::Document> m_document;
+
     QTreeWidget *listview;
 };
 
@@ -0,0 +1,332 @@
+/***************************************************************************
+ *                                                                         *
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ *                                                                         *
+ ***************************************************************************/
+
+#include "xmlvalidator.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QPair>
+#include <QStringList>
+#include <QUrl>
+
+#include <libxml/hash.h>
+#include <libxml/parser.h>
+#include <libxml/uri.h>
+#include <libxml/valid.h>
+#include <libxml/xmlerror.h>
+#include <libxml/xmlschemas.h>
+#include <libxml/xmlversion.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+/**
+ * Collects the errors of libxml2 for one run.
+ */
+struct ErrorCollector {
+    KateXmlValidator::Result *result = nullptr;
+    QByteArray baseUrl;
+
+    // references of entities that are declared in the external DTD, which
+    // is not loaded while parsing, these are sorted out once it is
+    QVector<QPair<QByteArray, KateXmlValidator::Diagnostic>> undeclaredEntities;
+
+    void append(const KateXmlValidator::Diagnostic &diagnostic)
+    {
+        if (result->diagnostics.size() >= KateXmlValidator::MaxDiagnostics) {
+            result->truncated = true;
+            return;
+        }
+        result->diagnostics.append(diagnostic);
+    }
+};
+
+#if LIBXML_VERSION >= 21200
+void collectError(void *userData, const xmlError *error)
+#else
+void collectError(void *userData, xmlErrorPtr error)
+#endif
+{
+    ErrorCollector *collector = static_cast<ErrorCollector *>(userData);
+    if (!error || error->level == XML_ERR_NONE) {
+        return;
+    }
+
+    KateXmlValidator::Diagnostic diagnostic;
+    diagnostic.warning = error->level == XML_ERR_WARNING;
+    diagnostic.message = QString::fromUtf8(error->message).trimmed();
+
+    // errors in the DTD or schema can't be shown in the document
+    if (error->file && (collector->baseUrl.isEmpty() || std::strcmp(error->file, collector->baseUrl.constData()) != 0)) {
+        diagnostic.message = QStringLiteral("%1:%2: %3").arg(QString::fromUtf8(error->file)).arg(error->line).arg(diagnostic.message);
+    } else {
+        diagnostic.line = error->line;
+        diagnostic.column = error->int2;
+    }
+
+    if (error->code == XML_WAR_UNDECLARED_ENTITY && error->str1) {
+        collector->undeclaredEntities.append(qMakePair(QByteArray(error->str1), diagnostic));
+        return;
+    }
+
+    collector->append(diagnostic);
+}
+
+/**
+ * The root element must have the name of the doctype, with its prefix.
+ */
+void checkRootName(xmlDocPtr doc, xmlDtdPtr doctype, ErrorCollector &collector)
+{
+    xmlNodePtr root = xmlDocGetRootElement(doc);
+    if (!root || !root->name || !doctype->name) {
+        return;
+    }
+
+    QByteArray name(reinterpret_cast<const char *>(root->name));
+    if (root->ns && root->ns->prefix) {
+        name = QByteArray(reinterpret_cast<const char *>(root->ns->prefix)) + ':' + name;
+    }
+    const QByteArray doctypeName(reinterpret_cast<const char *>(doctype->name));
+    if (name == doctypeName) {
+        return;
+    }
+
+    KateXmlValidator::Diagnostic diagnostic;
+    diagnostic.line = int(xmlGetLineNo(root));
+    diagnostic.message = QStringLiteral("root and DTD name do not match '%1' and '%2'").arg(QString::fromUtf8(name), QString::fromUtf8(doctypeName));
+    collector.append(diagnostic);
+}
+
+QString resolve(const xmlChar *uri, const xmlChar *base)
+{
+    xmlChar *resolved = xmlBuildURI(uri, base);
+    const QString url = QString::fromUtf8(reinterpret_cast<const char *>(resolved ? resolved : uri));
+    xmlFree(resolved);
+    return url;
+}
+
+/**
+ * The schema location of the root element, for its namespace if it has
+ * several.
+ */
+QString schemaLocation(xmlDocPtr doc)
+{
+    xmlNodePtr root = xmlDocGetRootElement(doc);
+    if (!root) {
+        return QString();
+    }
+
+    const xmlChar *xsi = BAD_CAST "http://www.w3.org/2001/XMLSchema-instance";
+    QString location;
+    if (xmlChar *value = xmlGetNsProp(root, BAD_CAST "noNamespaceSchemaLocation", xsi)) {
+        location = QString::fromUtf8(reinterpret_cast<const char *>(value)).trimmed();
+        xmlFree(value);
+    } else if (xmlChar *locations = xmlGetNsProp(root, BAD_CAST "schemaLocation", xsi)) {
+        // pairs of namespace and location
+        const QStringList parts = QString::fromUtf8(reinterpret_cast<const char *>(locations)).simplified().split(QLatin1Char(' '));
+        xmlFree(locations);
+        const QString ns = root->ns && root->ns->href ? QString::fromUtf8(reinterpret_cast<const char *>(root->ns->href)) : QString();
+        for (int i = 0; i + 1 < parts.size(); i += 2) {
+            if (location.isEmpty() || parts.at(i) == ns) {
+                location = parts.at(i + 1);
+            }
+        }
+    }
+
+    if (location.isEmpty()) {
+        return QString();
+    }
+    return resolve(BAD_CAST location.toUtf8().constData(), doc->URL);
+}
+}
+
+KateXmlValidator::KateXmlValidator()
+{
+    // must be done in the main thread, before any worker uses libxml2
+    xmlInitParser();
+}
+
+KateXmlValidator::~KateXmlValidator()
+{
+    for (const auto &cached : qAsConst(m_dtds)) {
+        xmlFreeDtd(cached.grammar);
+    }
+    for (const auto &cached : qAsConst(m_schemas)) {
+        xmlSchemaFree(cached.grammar);
+    }
+}
+
+KateXmlValidator::Result KateXmlValidator::validate(const QByteArray &text, const QString &baseUrl)
+{
+    Result result;
+    ErrorCollector collector;
+    collector.result = &result;
+    collector.baseUrl = baseUrl.toUtf8();
+
+    // the error handler is per thread
+    xmlSetStructuredErrorFunc(&collector, collectError);
+
+    // the text is UTF-8 whatever the XML declaration says
+    xmlParserCtxtPtr context = xmlNewParserCtxt();
+    xmlDocPtr doc = context ? xmlCtxtReadMemory(context,
+                                                text.constData(),
+                                                text.size(),
+                                                collector.baseUrl.isEmpty() ? nullptr : collector.baseUrl.constData(),
+                                                "UTF-8",
+                                                XML_PARSE_BIG_LINES)
+                            : nullptr;
+
+    // where to look up the entities the parser didn't know
+    xmlDtdPtr entityDtd = nullptr;
+
+    if (doc && doc->intSubset) {
+        result.grammar = Result::Dtd;
+        xmlDtdPtr doctype = doc->intSubset;
+        xmlValidCtxtPtr validContext = xmlNewValidCtxt();
+
+        if (doctype->SystemID && !doctype->children) {
+            // only an external DTD, that is parsed once and then taken from the cache
+            result.grammarUrl = resolve(doctype->SystemID, doc->URL);
+            const QString publicId = doctype->ExternalID ? QString::fromUtf8(reinterpret_cast<const char *>(doctype->ExternalID)) : QString();
+            entityDtd = dtd(publicId, result.grammarUrl);
+            if (entityDtd) {
+                // xmlValidateDtd() hides the doctype, so it doesn't check the root element against it
+                checkRootName(doc, doctype, collector);
+                xmlValidateDtd(validContext, doc, entityDtd);
+            } else {
+                result.grammarMissing = true;
+            }
+        } else {
+            // there are internal declarations, they can't be combined with a cached DTD
+            if (doctype->SystemID) {
+                result.grammarUrl = resolve(doctype->SystemID, doc->URL);
+            }
+            xmlValidateDocument(validContext, doc);
+            entityDtd = doc->extSubset;
+        }
+
+        xmlFreeValidCtxt(validContext);
+    } else if (doc) {
+        result.grammarUrl = schemaLocation(doc);
+        if (!result.grammarUrl.isEmpty()) {
+            result.grammar = Result::Schema;
+            if (xmlSchemaPtr grammar = schema(result.grammarUrl)) {
+                xmlSchemaValidCtxtPtr validContext = xmlSchemaNewValidCtxt(grammar);
+                if (validContext) {
+                    xmlSchemaValidateDoc(validContext, doc);
+                    xmlSchemaFreeValidCtxt(validContext);
+                }
+            } else {
+                result.grammarMissing = true;
+            }
+        }
+    }
+
+    for (const auto &entity : qAsConst(collector.undeclaredEntities)) {
+        const bool declared = (entityDtd && entityDtd->entities && xmlHashLookup(static_cast<xmlHashTablePtr>(entityDtd->entities), BAD_CAST entity.first.constData()))
+            || (doc && doc->intSubset && doc->intSubset->entities && xmlHashLookup(static_cast<xmlHashTablePtr>(doc->intSubset->entities), BAD_CAST entity.first.constData()));
+        if (!declared) {
+            collector.append(entity.second);
+        }
+    }
+
+    xmlSetStructuredErrorFunc(nullptr, nullptr);
+    xmlFreeDoc(doc);
+    xmlFreeParserCtxt(context);
+
+    // parsing and validation report in turns, show them by position
+    std::stable_sort(result.diagnostics.begin(), result.diagnostics.end(), [](const Diagnostic &a, const Diagnostic &b) {
+        return a.line < b.line;
+    });
+    return result;
+}
+
+xmlDtdPtr KateXmlValidator::dtd(const QString &publicId, const QString &url)
+{
+    const QString key = publicId + QLatin1Char('\n') + url;
+    const qint64 fileStamp = stamp(url);
+    auto it = m_dtds.find(key);
+    if (it != m_dtds.end()) {
+        if (it->stamp == fileStamp) {
+            return it->grammar;
+        }
+        xmlFreeDtd(it->grammar);
+        m_dtds.erase(it);
+    }
+
+    const QByteArray publicIdData = publicId.toUtf8();
+    const QByteArray urlData = url.toUtf8();
+    xmlDtdPtr grammar = xmlParseDTD(publicId.isEmpty() ? nullptr : BAD_CAST publicIdData.constData(), BAD_CAST urlData.constData());
+    if (!grammar) {
+        // not cached, it may be there next time
+        return nullptr;
+    }
+
+    if (m_dtds.size() >= MaxCached) {
+        for (const auto &cached : qAsConst(m_dtds)) {
+            xmlFreeDtd(cached.grammar);
+        }
+        m_dtds.clear();
+    }
+
+    Cached<xmlDtdPtr> cached;
+    cached.grammar = grammar;
+    cached.stamp = fileStamp;
+    m_dtds.insert(key, cached);
+    return grammar;
+}
+
+xmlSchemaPtr KateXmlValidator::schema(const QString &url)
+{
+    const qint64 fileStamp = stamp(url);
+    auto it = m_schemas.find(url);
+    if (it != m_schemas.end()) {
+        if (it->stamp == fileStamp) {
+            return it->grammar;
+        }
+        xmlSchemaFree(it->grammar);
+        m_schemas.erase(it);
+    }
+
+    xmlSchemaParserCtxtPtr parserContext = xmlSchemaNewParserCtxt(url.toUtf8().constData());
+    if (!parserContext) {
+        return nullptr;
+    }
+    xmlSchemaPtr grammar = xmlSchemaParse(parserContext);
+    xmlSchemaFreeParserCtxt(parserContext);
+    if (!grammar) {
+        return nullptr;
+    }
+
+    if (m_schemas.size() >= MaxCached) {
+        for (const auto &cached : qAsConst(m_schemas)) {
+            xmlSchemaFree(cached.grammar);
+        }
+        m_schemas.clear();
+    }
+
+    Cached<xmlSchemaPtr> cached;
+    cached.grammar = grammar;
+    cached.stamp = fileStamp;
+    m_schemas.insert(url, cached);
+    return grammar;
+}
+
+qint64 KateXmlValidator::stamp(const QString &url)
+{
+    const QUrl u(url);
+    QString fileName;
+    if (u.isLocalFile()) {
+        fileName = u.toLocalFile();
+    } else if (u.scheme().isEmpty()) {
+        fileName = url;
+    } else {
+        return 0;
+    }
+    return QFileInfo(fileName).lastModified().toMSecsSinceEpoch();
+}
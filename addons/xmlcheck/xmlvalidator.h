@@ -0,0 +1,89 @@
+/***************************************************************************
+ *                                                                         *
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef XMLVALIDATOR_H
+#define XMLVALIDATOR_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+typedef struct _xmlDtd *xmlDtdPtr;
+typedef struct _xmlSchema *xmlSchemaPtr;
+
+/**
+ * Checks XML documents with libxml2, in process.
+ *
+ * A document is validated against its external DTD or, if there is none,
+ * against the XML schema its root element points to. Without either only
+ * the well-formedness is checked. The parsed DTDs and schemas are kept
+ * for the next runs, until their files change.
+ *
+ * validate() may be called from a worker thread, but only from one
+ * thread at a time.
+ */
+class KateXmlValidator
+{
+public:
+    struct Diagnostic {
+        bool warning = false;
+        int line = 0; // 1-based, 0 if unknown
+        int column = 0; // 1-based, 0 if unknown
+        QString message;
+    };
+
+    struct Result {
+        enum Grammar { None, Dtd, Schema };
+
+        QVector<Diagnostic> diagnostics;
+        Grammar grammar = None;
+        /// DTD or schema that is used or could not be loaded
+        QString grammarUrl;
+        bool grammarMissing = false;
+        bool truncated = false;
+    };
+
+    KateXmlValidator();
+    ~KateXmlValidator();
+
+    KateXmlValidator(const KateXmlValidator &) = delete;
+    KateXmlValidator &operator=(const KateXmlValidator &) = delete;
+
+    /**
+     * Check the UTF-8 encoded @p text, relative DTDs and schemas are looked
+     * up from @p baseUrl, the document's location.
+     */
+    Result validate(const QByteArray &text, const QString &baseUrl);
+
+    /**
+     * At most that many diagnostics are reported for one document.
+     */
+    static const int MaxDiagnostics = 1000;
+
+    /**
+     * At most that many DTDs and schemas are kept each.
+     */
+    static const int MaxCached = 16;
+
+private:
+    template<typename T> struct Cached {
+        T grammar = nullptr;
+        qint64 stamp = 0;
+    };
+
+    xmlDtdPtr dtd(const QString &publicId, const QString &url);
+    xmlSchemaPtr schema(const QString &url);
+
+    /**
+     * Modification time of local files, else 0, they are loaded only once.
+     */
+    static qint64 stamp(const QString &url);
+
+    QHash<QString, Cached<xmlDtdPtr>> m_dtds;
+    QHash<QString, Cached<xmlSchemaPtr>> m_schemas;
+};
+
+#endif // XMLVALIDATOR_H
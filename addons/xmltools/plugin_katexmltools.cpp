@@ -60,8 +60,6 @@ TODO:
 -Only offer 'valid' elements, i.e. don't take the elements as a set but check
  if the DTD is matched ( order, number of occurrences, ... )
 
--Maybe only read the meta DTD file once, then store the resulting QMap on disk ( using QDataStream )?
- We'll then have to compare timeOf_cacheFile <-> timeOf_metaDtd.
 -Try to use libxml
 */
 
@@ -69,8 +67,11 @@ TODO:
 
 #include <QAction>
 #include <QComboBox>
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QFile>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QGuiApplication>
 #include <QLabel>
 #include <QLineEdit>
@@ -432,7 +433,7 @@ void PluginKateXMLToolsCompletionModel::getDTD()
         // no meta dtd found for this file
         url = QFileDialog::getOpenFileUrl(KTextEditor::Editor::instance()->application()->activeMainWindow()->window(), i18n("Assign Meta DTD in XML Format"), QUrl::fromLocalFile(m_urlString), QStringLiteral("*.xml"));
     } else {
-        url.setUrl(defaultDir + filename);
+        url = QUrl::fromLocalFile(defaultDir + filename);
         KMessageBox::information(nullptr,
                                  i18n("The current file has been identified "
                                       "as a document of type \"%1\". The meta DTD for this document type "
@@ -448,10 +449,22 @@ void PluginKateXMLToolsCompletionModel::getDTD()
 
     m_urlString = url.url(); // remember directory for next time
 
-    if (m_dtds[m_urlString]) {
-        assignDTD(m_dtds[m_urlString], kv);
+    PseudoDTD *dtd = m_dtds.value(m_urlString);
+    if (!dtd && url.isLocalFile()) {
+        // analyzed in an earlier session, no need to even read the file
+        dtd = new PseudoDTD();
+        if (dtd->readCache(m_urlString, metaDtdStamp(url, QByteArray()))) {
+            m_dtds.insert(m_urlString, dtd);
+        } else {
+            delete dtd;
+            dtd = nullptr;
+        }
+    }
+
+    if (dtd) {
+        assignDTD(dtd, kv);
     } else {
-        m_dtdString.clear();
+        m_dtdData.clear();
         m_viewToAssignTo = kv;
 
         QGuiApplication::setOverrideCursor(Qt::WaitCursor);
@@ -476,21 +489,34 @@ void PluginKateXMLToolsCompletionModel::slotFinished(KJob *job)
                            i18n("XML Plugin Error"));
     } else {
         PseudoDTD *dtd = new PseudoDTD();
-        dtd->analyzeDTD(m_urlString, m_dtdString);
+        const QByteArray stamp = metaDtdStamp(QUrl(m_urlString), m_dtdData);
+        if (!dtd->readCache(m_urlString, stamp) && dtd->analyzeDTD(m_urlString, m_dtdData)) {
+            dtd->writeCache(m_urlString, stamp);
+        }
 
         m_dtds.insert(m_urlString, dtd);
         assignDTD(dtd, m_viewToAssignTo);
 
         // clean up a bit
         m_viewToAssignTo = nullptr;
-        m_dtdString.clear();
+        m_dtdData.clear();
     }
     QGuiApplication::restoreOverrideCursor();
 }
 
 void PluginKateXMLToolsCompletionModel::slotData(KIO::Job *, const QByteArray &data)
 {
-    m_dtdString += QString(data);
+    // decoded by the parser, a chunk may end within a character
+    m_dtdData += data;
+}
+
+QByteArray PluginKateXMLToolsCompletionModel::metaDtdStamp(const QUrl &url, const QByteArray &metaDtd)
+{
+    if (url.isLocalFile()) {
+        const QFileInfo info(url.toLocalFile());
+        return QByteArray::number(info.lastModified().toMSecsSinceEpoch()) + ':' + QByteArray::number(info.size());
+    }
+    return QCryptographicHash::hash(metaDtd, QCryptographicHash::Sha1);
 }
 
 void PluginKateXMLToolsCompletionModel::assignDTD(PseudoDTD *dtd, KTextEditor::View *view)
@@ -115,8 +115,12 @@ protected:
     /// Assign the PseudoDTD @p dtd to the Kate::View @p view
     void assignDTD(PseudoDTD *dtd, KTextEditor::View *view);
 
+    /// Stamp of the meta DTD @p url for the disk cache: modification time and
+    /// size of local files, else a checksum of the downloaded @p metaDtd
+    static QByteArray metaDtdStamp(const QUrl &url, const QByteArray &metaDtd);
+
     /// temporary placeholder for the metaDTD file
-    QString m_dtdString;
+    QByteArray m_dtdData;
     /// temporary placeholder for the view to assign a DTD to while the file is loaded
     KTextEditor::View *m_viewToAssignTo;
     /// URL of the last loaded meta DTD
@@ -22,11 +22,66 @@
 
 #include "pseudo_dtd.h"
 
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProgressDialog>
 #include <QRegExp>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QXmlStreamReader>
 
 #include <KLocalizedString>
 #include <KMessageBox>
 
+#include <algorithm>
+
+static const quint32 CacheMagic = 0x31445444; // "DTD1"
+static const quint32 CacheVersion = 1;
+
+static QDataStream &operator<<(QDataStream &stream, const ElementAttributes &attrs)
+{
+    return stream << attrs.optionalAttributes << attrs.requiredAttributes;
+}
+
+static QDataStream &operator>>(QDataStream &stream, ElementAttributes &attrs)
+{
+    return stream >> attrs.optionalAttributes >> attrs.requiredAttributes;
+}
+
+static QString cacheFile(const QString &metaDtdUrl)
+{
+    const QByteArray hash = QCryptographicHash::hash(metaDtdUrl.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/katexmltools/") + QString::fromLatin1(hash) + QLatin1String(".cache");
+}
+
+/**
+ * Collect the names of all <element-name> below the current element and
+ * leave the reader at its end. @p empty is set if there is an <empty/>.
+ */
+static void collectElementNames(QXmlStreamReader &xml, QSet<QString> &names, bool *empty)
+{
+    int depth = 0;
+    while (!xml.atEnd()) {
+        const QXmlStreamReader::TokenType token = xml.readNext();
+        if (token == QXmlStreamReader::StartElement) {
+            ++depth;
+            if (xml.name() == QLatin1String("element-name")) {
+                names.insert(xml.attributes().value(QLatin1String("name")).toString());
+            } else if (empty && xml.name() == QLatin1String("empty")) {
+                *empty = true;
+            }
+        } else if (token == QXmlStreamReader::EndElement) {
+            if (depth-- == 0) {
+                return;
+            }
+        }
+    }
+}
+
 PseudoDTD::PseudoDTD()
 {
     // "SGML support" only means case-insensivity, because HTML is case-insensitive up to version 4:
@@ -37,19 +92,62 @@ PseudoDTD::~PseudoDTD()
 {
 }
 
-void PseudoDTD::analyzeDTD(QString &metaDtdUrl, QString &metaDtd)
+bool PseudoDTD::analyzeDTD(const QString &metaDtdUrl, const QByteArray &metaDtd)
 {
-    QDomDocument doc(QStringLiteral("dtdIn_xml"));
-    if (!doc.setContent(metaDtd)) {
+    clear();
+
+    QProgressDialog progress(i18n("Analyzing meta DTD..."), i18n("Cancel"), 0, metaDtd.size());
+    progress.setMinimumDuration(400);
+    progress.setValue(0);
+
+    // Get information from meta DTD and put it in Qt data structures for fast access,
+    // everything is collected in a single pass over the file:
+    QXmlStreamReader xml(metaDtd);
+    bool isDtd = false;
+    int count = 0;
+    while (!xml.atEnd()) {
+        const QXmlStreamReader::TokenType token = xml.readNext();
+        if (token == QXmlStreamReader::DTD) {
+            isDtd = xml.dtdName() == QLatin1String("dtd");
+        } else if (token == QXmlStreamReader::StartElement) {
+            if (!isDtd) {
+                break;
+            }
+
+            // updating the dialog is not for free, only do it now and then
+            if (++count % 64 == 0) {
+                if (progress.wasCanceled()) {
+                    clear();
+                    return false;
+                }
+                progress.setValue(qMin<qint64>(xml.characterOffset(), metaDtd.size()));
+            }
+
+            if (xml.name() == QLatin1String("entity")) {
+                parseEntity(xml);
+            } else if (xml.name() == QLatin1String("element")) {
+                parseElement(xml);
+            } else if (xml.name() == QLatin1String("attlist")) {
+                parseAttributes(xml);
+            }
+            // else: the <dtd> root or something we don't know, look inside
+        }
+    }
+
+    progress.setValue(metaDtd.size()); // just to make sure the dialog disappears
+
+    if (xml.hasError()) {
+        clear();
         KMessageBox::error(nullptr,
                            i18n("The file '%1' could not be parsed. "
                                 "Please check that the file is well-formed XML.",
                                 metaDtdUrl),
                            i18n("XML Plugin Error"));
-        return;
+        return false;
     }
 
-    if (doc.doctype().name() != QLatin1String("dtd")) {
+    if (!isDtd) {
+        clear();
         KMessageBox::error(nullptr,
                            i18n("The file '%1' is not in the expected format. "
                                 "Please check that the file is of this type:\n"
@@ -58,134 +156,125 @@ void PseudoDTD::analyzeDTD(QString &metaDtdUrl, QString &metaDtd)
                                 "See the Kate Plugin documentation for more information.",
                                 metaDtdUrl),
                            i18n("XML Plugin Error"));
-        return;
+        return false;
     }
 
-    uint listLength = 0;
-    listLength += doc.elementsByTagName(QStringLiteral("entity")).count();
-    listLength += doc.elementsByTagName(QStringLiteral("element")).count();
-    // count this twice, as it will be iterated twice ( TODO: optimize that? ):
-    listLength += doc.elementsByTagName(QStringLiteral("attlist")).count() * 2;
-
-    QProgressDialog progress(i18n("Analyzing meta DTD..."), i18n("Cancel"), 0, listLength);
-    progress.setMinimumDuration(400);
-    progress.setValue(0);
+    return true;
+}
 
-    // Get information from meta DTD and put it in Qt data structures for fast access:
-    if (!parseEntities(&doc, &progress)) {
-        return;
+bool PseudoDTD::readCache(const QString &metaDtdUrl, const QByteArray &stamp)
+{
+    QFile file(cacheFile(metaDtdUrl));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
     }
 
-    if (!parseElements(&doc, &progress)) {
-        return;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_10);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString url;
+    QByteArray fileStamp;
+    bool sgmlSupport = false;
+    stream >> magic >> version >> url >> fileStamp >> sgmlSupport;
+    if (stream.status() != QDataStream::Ok || magic != CacheMagic || version != CacheVersion || url != metaDtdUrl || fileStamp != stamp || sgmlSupport != m_sgmlSupport) {
+        return false;
     }
 
-    if (!parseAttributes(&doc, &progress)) {
-        return;
+    QMap<QString, QString> entityList;
+    QHash<QString, QStringList> elementsList;
+    QHash<QString, ElementAttributes> attributesList;
+    QHash<QString, QHash<QString, QStringList>> attributevaluesList;
+    stream >> entityList >> elementsList >> attributesList >> attributevaluesList;
+    if (stream.status() != QDataStream::Ok) {
+        return false;
     }
 
-    if (!parseAttributeValues(&doc, &progress)) {
+    m_entityList.swap(entityList);
+    m_elementsList.swap(elementsList);
+    m_attributesList.swap(attributesList);
+    m_attributevaluesList.swap(attributevaluesList);
+    return true;
+}
+
+void PseudoDTD::writeCache(const QString &metaDtdUrl, const QByteArray &stamp) const
+{
+    const QString fileName = cacheFile(metaDtdUrl);
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
         return;
     }
 
-    progress.setValue(listLength); // just to make sure the dialog disappears
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_10);
+
+    stream << CacheMagic << CacheVersion << metaDtdUrl << stamp << m_sgmlSupport;
+    stream << m_entityList << m_elementsList << m_attributesList << m_attributevaluesList;
+    file.commit();
+}
+
+QString PseudoDTD::key(const QString &name) const
+{
+    return m_sgmlSupport ? name.toLower() : name;
+}
+
+void PseudoDTD::clear()
+{
+    m_entityList.clear();
+    m_elementsList.clear();
+    m_attributesList.clear();
+    m_attributevaluesList.clear();
 }
 
 // ========================================================================
-// DOM stuff:
+// XML stuff:
 
 /**
- * Iterate through the XML to get a mapping which sub-elements are allowed for
- * all elements.
+ * Get the sub-elements allowed in the <element> the reader is at, and leave
+ * the reader at its end.
  */
-bool PseudoDTD::parseElements(QDomDocument *doc, QProgressDialog *progress)
+void PseudoDTD::parseElement(QXmlStreamReader &xml)
 {
-    m_elementsList.clear();
+    const QString name = xml.attributes().value(QLatin1String("name")).toString();
+
     // We only display a list, i.e. we pretend that the content model is just
-    // a set, so we use a map. This is necessary e.g. for xhtml 1.0's head element,
+    // a set. This is necessary e.g. for xhtml 1.0's head element,
     // which would otherwise display some elements twice.
-    QMap<QString, bool> subelementList; // the bool is not used
+    QSet<QString> subelementList;
+    QSet<QString> exclusionsList;
+    bool contentModel = false;
+    bool empty = false;
 
-    QDomNodeList list = doc->elementsByTagName(QStringLiteral("element"));
-    uint listLength = list.count(); // speedup (really! )
-
-    for (uint i = 0; i < listLength; i++) {
-        if (progress->wasCanceled()) {
-            return false;
-        }
-
-        progress->setValue(progress->value() + 1);
-        // FIXME!:
-        // qApp->processEvents();
-
-        subelementList.clear();
-        QDomNode node = list.item(i);
-        QDomElement elem = node.toElement();
-
-        if (!elem.isNull()) {
+    while (xml.readNextStartElement()) {
+        if (xml.name() == QLatin1String("content-model-expanded") && !contentModel) {
             // Enter the expanded content model, which may also include stuff not allowed.
             // We do not care if it's a <sequence-group> or whatever.
-            QDomNodeList contentModelList = elem.elementsByTagName(QStringLiteral("content-model-expanded"));
-            QDomNode contentModelNode = contentModelList.item(0);
-            QDomElement contentModelElem = contentModelNode.toElement();
-            if (!contentModelElem.isNull()) {
-                // check for <pcdata/>:
-                QDomNodeList pcdataList = contentModelElem.elementsByTagName(QStringLiteral("pcdata"));
-
-                // check for other sub elements:
-                QDomNodeList subList = contentModelElem.elementsByTagName(QStringLiteral("element-name"));
-                uint subListLength = subList.count();
-                for (uint l = 0; l < subListLength; l++) {
-                    QDomNode subNode = subList.item(l);
-                    QDomElement subElem = subNode.toElement();
-                    if (!subElem.isNull()) {
-                        subelementList[subElem.attribute(QStringLiteral("name"))] = true;
-                    }
-                }
-
-                // anders: check if this is an EMPTY element, and put "__EMPTY" in the
-                // sub list, so that we can insert tags in empty form if required.
-                QDomNodeList emptyList = elem.elementsByTagName(QStringLiteral("empty"));
-                if (emptyList.count()) {
-                    subelementList[QStringLiteral("__EMPTY")] = true;
-                }
-            }
+            contentModel = true;
+            collectElementNames(xml, subelementList, &empty);
+        } else if (xml.name() == QLatin1String("exclusions")) {
+            // sometimes there are no exclusions ( e.g. in XML DTDs there are never exclusions )
+            collectElementNames(xml, exclusionsList, nullptr);
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
 
-            // Now remove the elements not allowed (e.g. <a> is explicitly not allowed in <a>
-            // in the HTML 4.01 Strict DTD):
-            QDomNodeList exclusionsList = elem.elementsByTagName(QStringLiteral("exclusions"));
-            if (exclusionsList.length() > 0) {
-                // sometimes there are no exclusions ( e.g. in XML DTDs there are never exclusions )
-                QDomNode exclusionsNode = exclusionsList.item(0);
-                QDomElement exclusionsElem = exclusionsNode.toElement();
-                if (!exclusionsElem.isNull()) {
-                    QDomNodeList subList = exclusionsElem.elementsByTagName(QStringLiteral("element-name"));
-                    uint subListLength = subList.count();
-                    for (uint l = 0; l < subListLength; l++) {
-                        QDomNode subNode = subList.item(l);
-                        QDomElement subElem = subNode.toElement();
-                        if (!subElem.isNull()) {
-                            QMap<QString, bool>::Iterator it = subelementList.find(subElem.attribute(QStringLiteral("name")));
-                            if (it != subelementList.end()) {
-                                subelementList.erase(it);
-                            }
-                        }
-                    }
-                }
-            }
+    // anders: check if this is an EMPTY element, and put "__EMPTY" in the
+    // sub list, so that we can insert tags in empty form if required.
+    if (empty) {
+        subelementList.insert(QStringLiteral("__EMPTY"));
+    }
 
-            // turn the map into a list:
-            QStringList subelementListTmp;
-            QMap<QString, bool>::Iterator it;
-            for (it = subelementList.begin(); it != subelementList.end(); ++it) {
-                subelementListTmp.append(it.key());
-            }
+    // Now remove the elements not allowed (e.g. <a> is explicitly not allowed in <a>
+    // in the HTML 4.01 Strict DTD):
+    subelementList.subtract(exclusionsList);
 
-            m_elementsList.insert(elem.attribute(QStringLiteral("name")), subelementListTmp);
-        }
-
-    } // end iteration over all <element> nodes
-    return true;
+    QStringList subelements = subelementList.values();
+    std::sort(subelements.begin(), subelements.end());
+    m_elementsList.insert(key(name), subelements);
 }
 
 /**
@@ -193,142 +282,61 @@ bool PseudoDTD::parseElements(QDomDocument *doc, QProgressDialog *progress)
  * a list of allowed elements, but it doesn't care about order or if only a certain
  * number of occurrences is allowed.
  */
-QStringList PseudoDTD::allowedElements(const QString &parentElement)
+QStringList PseudoDTD::allowedElements(const QString &parentElement) const
 {
-    if (m_sgmlSupport) {
-        // find the matching element, ignoring case:
-        QMap<QString, QStringList>::Iterator it;
-        for (it = m_elementsList.begin(); it != m_elementsList.end(); ++it) {
-            if (it.key().compare(parentElement, Qt::CaseInsensitive) == 0) {
-                return it.value();
-            }
-        }
-    } else if (m_elementsList.contains(parentElement)) {
-        return m_elementsList[parentElement];
-    }
-
-    return QStringList();
+    return m_elementsList.value(key(parentElement));
 }
 
 /**
- * Iterate through the XML to get a mapping which attributes are allowed inside
- * all elements.
+ * Get the attributes and their values allowed in the <attlist> the reader is
+ * at, and leave the reader at its end.
  */
-bool PseudoDTD::parseAttributes(QDomDocument *doc, QProgressDialog *progress)
+void PseudoDTD::parseAttributes(QXmlStreamReader &xml)
 {
-    m_attributesList.clear();
-    //   QStringList allowedAttributes;
-    QDomNodeList list = doc->elementsByTagName(QStringLiteral("attlist"));
-    uint listLength = list.count();
-
-    for (uint i = 0; i < listLength; i++) {
-        if (progress->wasCanceled()) {
-            return false;
-        }
-
-        progress->setValue(progress->value() + 1);
-        // FIXME!!
-        // qApp->processEvents();
-
-        ElementAttributes attrs;
-        QDomNode node = list.item(i);
-        QDomElement elem = node.toElement();
-        if (!elem.isNull()) {
-            QDomNodeList attributeList = elem.elementsByTagName(QStringLiteral("attribute"));
-            uint attributeListLength = attributeList.count();
-            for (uint l = 0; l < attributeListLength; l++) {
-                QDomNode attributeNode = attributeList.item(l);
-                QDomElement attributeElem = attributeNode.toElement();
-
-                if (!attributeElem.isNull()) {
-                    if (attributeElem.attribute(QStringLiteral("type")) == QLatin1String("#REQUIRED")) {
-                        attrs.requiredAttributes.append(attributeElem.attribute(QStringLiteral("name")));
-                    } else {
-                        attrs.optionalAttributes.append(attributeElem.attribute(QStringLiteral("name")));
-                    }
+    const QString name = xml.attributes().value(QLatin1String("name")).toString();
+    ElementAttributes attrs;
+    QHash<QString, QStringList> attributevaluesTmp; // 1 attribute : n possible values
+
+    int depth = 0;
+    while (!xml.atEnd()) {
+        const QXmlStreamReader::TokenType token = xml.readNext();
+        if (token == QXmlStreamReader::StartElement) {
+            ++depth;
+            if (xml.name() == QLatin1String("attribute")) {
+                const QXmlStreamAttributes attributes = xml.attributes();
+                const QString attribute = attributes.value(QLatin1String("name")).toString();
+                if (attributes.value(QLatin1String("type")) == QLatin1String("#REQUIRED")) {
+                    attrs.requiredAttributes.append(attribute);
+                } else {
+                    attrs.optionalAttributes.append(attribute);
                 }
+                attributevaluesTmp.insert(key(attribute), attributes.value(QLatin1String("value")).toString().split(QChar(' ')));
+            }
+        } else if (token == QXmlStreamReader::EndElement) {
+            if (depth-- == 0) {
+                break;
             }
-            m_attributesList.insert(elem.attribute(QStringLiteral("name")), attrs);
         }
     }
 
-    return true;
+    m_attributesList.insert(key(name), attrs);
+    m_attributevaluesList.insert(key(name), attributevaluesTmp);
 }
 
 /** Check which attributes are allowed for an element.
  */
-QStringList PseudoDTD::allowedAttributes(const QString &element)
+QStringList PseudoDTD::allowedAttributes(const QString &element) const
 {
-    if (m_sgmlSupport) {
-        // find the matching element, ignoring case:
-        QMap<QString, ElementAttributes>::Iterator it;
-        for (it = m_attributesList.begin(); it != m_attributesList.end(); ++it) {
-            if (it.key().compare(element, Qt::CaseInsensitive) == 0) {
-                return it.value().optionalAttributes + it.value().requiredAttributes;
-            }
-        }
-    } else if (m_attributesList.contains(element)) {
-        return m_attributesList[element].optionalAttributes + m_attributesList[element].requiredAttributes;
+    const auto it = m_attributesList.constFind(key(element));
+    if (it == m_attributesList.constEnd()) {
+        return QStringList();
     }
-
-    return QStringList();
+    return it->optionalAttributes + it->requiredAttributes;
 }
 
 QStringList PseudoDTD::requiredAttributes(const QString &element) const
 {
-    if (m_sgmlSupport) {
-        QMap<QString, ElementAttributes>::ConstIterator it;
-        for (it = m_attributesList.begin(); it != m_attributesList.end(); ++it) {
-            if (it.key().compare(element, Qt::CaseInsensitive) == 0) {
-                return it.value().requiredAttributes;
-            }
-        }
-    } else if (m_attributesList.contains(element)) {
-        return m_attributesList[element].requiredAttributes;
-    }
-
-    return QStringList();
-}
-
-/**
- * Iterate through the XML to get a mapping which attribute values are allowed
- * for all attributes inside all elements.
- */
-bool PseudoDTD::parseAttributeValues(QDomDocument *doc, QProgressDialog *progress)
-{
-    m_attributevaluesList.clear();                 // 1 element : n possible attributes
-    QMap<QString, QStringList> attributevaluesTmp; // 1 attribute : n possible values
-    QDomNodeList list = doc->elementsByTagName(QStringLiteral("attlist"));
-    uint listLength = list.count();
-
-    for (uint i = 0; i < listLength; i++) {
-        if (progress->wasCanceled()) {
-            return false;
-        }
-
-        progress->setValue(progress->value() + 1);
-        // FIXME!
-        // qApp->processEvents();
-
-        attributevaluesTmp.clear();
-        QDomNode node = list.item(i);
-        QDomElement elem = node.toElement();
-        if (!elem.isNull()) {
-            // Enter the list of <attribute>:
-            QDomNodeList attributeList = elem.elementsByTagName(QStringLiteral("attribute"));
-            uint attributeListLength = attributeList.count();
-            for (uint l = 0; l < attributeListLength; l++) {
-                QDomNode attributeNode = attributeList.item(l);
-                QDomElement attributeElem = attributeNode.toElement();
-                if (!attributeElem.isNull()) {
-                    QString value = attributeElem.attribute(QStringLiteral("value"));
-                    attributevaluesTmp.insert(attributeElem.attribute(QStringLiteral("name")), value.split(QChar(' ')));
-                }
-            }
-            m_attributevaluesList.insert(elem.attribute(QStringLiteral("name")), attributevaluesTmp);
-        }
-    }
-    return true;
+    return m_attributesList.value(key(element)).requiredAttributes;
 }
 
 /**
@@ -336,93 +344,66 @@ bool PseudoDTD::parseAttributeValues(QDomDocument *doc, QProgressDialog *progres
  * (the element is necessary because e.g. "href" inside <a> could be different
  * to an "href" inside <link>):
  */
-QStringList PseudoDTD::attributeValues(const QString &element, const QString &attribute)
+QStringList PseudoDTD::attributeValues(const QString &element, const QString &attribute) const
 {
-    // Direct access would be faster than iteration of course but not always correct,
-    // because we need to be case-insensitive.
-    if (m_sgmlSupport) {
-        // first find the matching element, ignoring case:
-        QMap<QString, QMap<QString, QStringList>>::Iterator it;
-        for (it = m_attributevaluesList.begin(); it != m_attributevaluesList.end(); ++it) {
-            if (it.key().compare(element, Qt::CaseInsensitive) == 0) {
-                QMap<QString, QStringList> attrVals = it.value();
-                QMap<QString, QStringList>::Iterator itV;
-                // then find the matching attribute for that element, ignoring case:
-                for (itV = attrVals.begin(); itV != attrVals.end(); ++itV) {
-                    if (itV.key().compare(attribute, Qt::CaseInsensitive) == 0) {
-                        return (itV.value());
-                    }
-                }
-            }
-        }
-    } else if (m_attributevaluesList.contains(element)) {
-        QMap<QString, QStringList> attrVals = m_attributevaluesList[element];
-        if (attrVals.contains(attribute)) {
-            return attrVals[attribute];
-        }
+    // the keys are folded if we need to be case-insensitive
+    const auto it = m_attributevaluesList.constFind(key(element));
+    if (it == m_attributevaluesList.constEnd()) {
+        // no predefined values available:
+        return QStringList();
     }
-
-    // no predefined values available:
-    return QStringList();
+    return it->value(key(attribute));
 }
 
 /**
- * Iterate through the XML to get a mapping of all entity names and their expanded
- * version, e.g. nbsp => &#160;. Parameter entities are ignored.
+ * Get the mapping of the name of the <entity> the reader is at to its expanded
+ * version, e.g. nbsp => &#160;, and leave the reader at its end. Parameter
+ * entities are ignored.
  */
-bool PseudoDTD::parseEntities(QDomDocument *doc, QProgressDialog *progress)
+void PseudoDTD::parseEntity(QXmlStreamReader &xml)
 {
-    m_entityList.clear();
-    QDomNodeList list = doc->elementsByTagName(QStringLiteral("entity"));
-    uint listLength = list.count();
-
-    for (uint i = 0; i < listLength; i++) {
-        if (progress->wasCanceled()) {
-            return false;
-        }
-
-        progress->setValue(progress->value() + 1);
-        // FIXME!!
-        // qApp->processEvents();
-        QDomNode node = list.item(i);
-        QDomElement elem = node.toElement();
-        if (!elem.isNull() && elem.attribute(QStringLiteral("type")) != QLatin1String("param")) {
+    const QXmlStreamAttributes attributes = xml.attributes();
+    const QString name = attributes.value(QLatin1String("name")).toString();
+    const bool isParameter = attributes.value(QLatin1String("type")) == QLatin1String("param");
+
+    QString exp;
+    bool expanded = false;
+    while (xml.readNextStartElement()) {
+        if (xml.name() == QLatin1String("text-expanded") && !expanded) {
             // TODO: what's cdata <-> gen ?
-            QDomNodeList expandedList = elem.elementsByTagName(QStringLiteral("text-expanded"));
-            QDomNode expandedNode = expandedList.item(0);
-            QDomElement expandedElem = expandedNode.toElement();
-            if (!expandedElem.isNull()) {
-                QString exp = expandedElem.text();
-                // TODO: support more than one &#...; in the expanded text
-                /* TODO include do this when the unicode font problem is solved:
-                if( exp.contains(QRegularExpression("^&#x[a-zA-Z0-9]+;$")) ) {
-                // hexadecimal numbers, e.g. "&#x236;"
-                uint end = exp.find( ";" );
-                exp = exp.mid( 3, end-3 );
-                exp = QChar();
-                } else if( exp.contains(QRegularExpression("^&#[0-9]+;$")) ) {
-                // decimal numbers, e.g. "&#236;"
-                uint end = exp.find( ";" );
-                exp = exp.mid( 2, end-2 );
-                exp = QChar( exp.toInt() );
-                }
-                */
-                m_entityList.insert(elem.attribute(QStringLiteral("name")), exp);
-            } else {
-                m_entityList.insert(elem.attribute(QStringLiteral("name")), QString());
+            expanded = true;
+            exp = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+            // TODO: support more than one &#...; in the expanded text
+            /* TODO include do this when the unicode font problem is solved:
+            if( exp.contains(QRegularExpression("^&#x[a-zA-Z0-9]+;$")) ) {
+            // hexadecimal numbers, e.g. "&#x236;"
+            uint end = exp.find( ";" );
+            exp = exp.mid( 3, end-3 );
+            exp = QChar();
+            } else if( exp.contains(QRegularExpression("^&#[0-9]+;$")) ) {
+            // decimal numbers, e.g. "&#236;"
+            uint end = exp.find( ";" );
+            exp = exp.mid( 2, end-2 );
+            exp = QChar( exp.toInt() );
             }
+            */
+        } else {
+            xml.skipCurrentElement();
         }
     }
-    return true;
+
+    if (!isParameter) {
+        m_entityList.insert(name, exp);
+    }
 }
 
 /**
  * Get a list of all ( non-parameter ) entities that start with a certain string.
  */
-QStringList PseudoDTD::entities(const QString &start)
+QStringList PseudoDTD::entities(const QString &start) const
 {
     QStringList entities;
-    QMap<QString, QString>::Iterator it;
+    QMap<QString, QString>::ConstIterator it;
     for (it = m_entityList.begin(); it != m_entityList.end(); ++it) {
         if ((*it).startsWith(start)) {
             const QString &str = it.key();
@@ -23,9 +23,11 @@
 #ifndef PSEUDO_DTD_H
 #define PSEUDO_DTD_H
 
+#include <QHash>
 #include <QMap>
-#include <QProgressDialog>
-#include <qdom.h>
+#include <QStringList>
+
+class QXmlStreamReader;
 
 /**
  * This class contains the attributes for one element.
@@ -44,30 +46,47 @@ public:
     PseudoDTD();
     ~PseudoDTD();
 
-    void analyzeDTD(QString &metaDtdUrl, QString &metaDtd);
+    /**
+     * Parse the meta DTD @p metaDtd in one pass.
+     * @return false if it could not be parsed or the user canceled
+     */
+    bool analyzeDTD(const QString &metaDtdUrl, const QByteArray &metaDtd);
+
+    /**
+     * Read the tables of @p metaDtdUrl from the disk cache, if it was written
+     * for the same @p stamp, e.g. the modification time of the meta DTD.
+     */
+    bool readCache(const QString &metaDtdUrl, const QByteArray &stamp);
+    void writeCache(const QString &metaDtdUrl, const QByteArray &stamp) const;
 
-    QStringList allowedElements(const QString &parentElement);
-    QStringList allowedAttributes(const QString &parentElement);
-    QStringList attributeValues(const QString &element, const QString &attribute);
-    QStringList entities(const QString &start);
+    QStringList allowedElements(const QString &parentElement) const;
+    QStringList allowedAttributes(const QString &parentElement) const;
+    QStringList attributeValues(const QString &element, const QString &attribute) const;
+    QStringList entities(const QString &start) const;
     QStringList requiredAttributes(const QString &parentElement) const;
 
 protected:
-    bool parseElements(QDomDocument *doc, QProgressDialog *progress);
-    bool parseAttributes(QDomDocument *doc, QProgressDialog *progress);
-    bool parseAttributeValues(QDomDocument *doc, QProgressDialog *progress);
-    bool parseEntities(QDomDocument *doc, QProgressDialog *progress);
+    void parseEntity(QXmlStreamReader &xml);
+    void parseElement(QXmlStreamReader &xml);
+    void parseAttributes(QXmlStreamReader &xml);
+
+    /**
+     * Key of the tables for @p name, folded if case doesn't matter.
+     */
+    QString key(const QString &name) const;
+
+    void clear();
 
     bool m_sgmlSupport;
 
     // Entities, e.g. <"nbsp", "160">
     QMap<QString, QString> m_entityList;
     // Elements, e.g. <"a", ( "b", "i", "em", "strong" )>
-    QMap<QString, QStringList> m_elementsList;
+    QHash<QString, QStringList> m_elementsList;
     // Attributes e.g. <"a", ( "href", "lang", "title" )>
-    QMap<QString, ElementAttributes> m_attributesList;
+    QHash<QString, ElementAttributes> m_attributesList;
     // Attribute values e.g. <"td", <"align", ( "left", "right", "justify" )>>
-    QMap<QString, QMap<QString, QStringList>> m_attributevaluesList;
+    QHash<QString, QHash<QString, QStringList>> m_attributevaluesList;
 };
 
 #endif // PSEUDO_DTD_H
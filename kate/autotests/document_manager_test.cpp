@@ -0,0 +1,140 @@
+/*  SPDX-License-Identifier: LGPL-2.0-or-later
+
+    SPDX-FileCopyrightText: 2021 Kate Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "document_manager_test.h"
+#include "kateapp.h"
+#include "katedocmanager.h"
+#include "katesessionmanager.h"
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTestWidgets>
+
+QTEST_MAIN(KateDocumentManagerTest)
+
+static QUrl createFile(const QString &path, const QByteArray &content = QByteArray())
+{
+    QFile file(path);
+    file.open(QIODevice::WriteOnly);
+    file.write(content);
+    return QUrl::fromLocalFile(path);
+}
+
+void KateDocumentManagerTest::initTestCase()
+{
+    /**
+     * init resources from our static lib
+     */
+    Q_INIT_RESOURCE(kate);
+
+    // we need an application object, the document manager uses it
+    m_app = new KateApp(QCommandLineParser());
+    m_app->sessionManager()->activateAnonymousSession();
+}
+
+void KateDocumentManagerTest::cleanupTestCase()
+{
+    delete m_app;
+}
+
+void KateDocumentManagerTest::init()
+{
+    m_tempdir = new QTemporaryDir;
+    QVERIFY(m_tempdir->isValid());
+}
+
+void KateDocumentManagerTest::cleanup()
+{
+    m_app->documentManager()->closeAllDocuments(false);
+    delete m_tempdir;
+}
+
+void KateDocumentManagerTest::findDocument()
+{
+    KateDocManager *manager = m_app->documentManager();
+
+    const QUrl url = createFile(m_tempdir->path() + QStringLiteral("/a.txt"), "a");
+    QVERIFY(QDir(m_tempdir->path()).mkdir(QStringLiteral("sub")));
+    QVERIFY(QFile::link(url.toLocalFile(), m_tempdir->path() + QStringLiteral("/link.txt")));
+
+    KTextEditor::Document *doc = manager->openUrl(url);
+    QVERIFY(doc);
+    QCOMPARE(manager->findDocument(url), doc);
+    QCOMPARE(manager->findDocument(QUrl::fromLocalFile(m_tempdir->path() + QStringLiteral("/sub/../a.txt"))), doc);
+    QCOMPARE(manager->findDocument(QUrl::fromLocalFile(m_tempdir->path() + QStringLiteral("/link.txt"))), doc);
+    QCOMPARE(manager->openUrl(url), doc);
+
+    // the index follows a rename
+    const QUrl renamed = QUrl::fromLocalFile(m_tempdir->path() + QStringLiteral("/b.txt"));
+    QVERIFY(doc->saveAs(renamed));
+    QCOMPARE(manager->findDocument(renamed), doc);
+    QVERIFY(!manager->findDocument(url));
+
+    QVERIFY(manager->closeDocument(doc));
+    QVERIFY(!manager->findDocument(renamed));
+}
+
+void KateDocumentManagerTest::openUrlsIsLazy()
+{
+    KateDocManager *manager = m_app->documentManager();
+
+    const QUrl a = createFile(m_tempdir->path() + QStringLiteral("/a.txt"), "a");
+    const QUrl b = createFile(m_tempdir->path() + QStringLiteral("/b.txt"), "b");
+    const QUrl c = createFile(m_tempdir->path() + QStringLiteral("/c.txt"), "c");
+
+    // the untitled document is reused and loaded, the others wait
+    QSignalSpy spy(manager, &KateDocManager::documentsCreated);
+    const QList<KTextEditor::Document *> docs = manager->openUrls({a, b, c, b});
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(docs.size(), 4);
+    QCOMPARE(docs[1], docs[3]);
+    QCOMPARE(manager->documentList().size(), 3);
+
+    QVERIFY(!manager->isPending(docs[0]));
+    QCOMPARE(docs[0]->text(), QStringLiteral("a"));
+
+    QVERIFY(manager->isPending(docs[1]));
+    QVERIFY(docs[1]->url().isEmpty());
+    QCOMPARE(manager->documentUrl(docs[1]), b);
+    QCOMPARE(manager->documentName(docs[1]), QStringLiteral("b.txt"));
+    QCOMPARE(manager->findDocument(b), docs[1]);
+
+    manager->loadDocument(docs[1]);
+    QVERIFY(!manager->isPending(docs[1]));
+    QCOMPARE(docs[1]->url(), b);
+    QCOMPARE(docs[1]->text(), QStringLiteral("b"));
+    QCOMPARE(manager->findDocument(b), docs[1]);
+
+    // opening it for real loads it
+    QCOMPARE(manager->openUrl(c), docs[2]);
+    QCOMPARE(docs[2]->text(), QStringLiteral("c"));
+}
+
+void KateDocumentManagerTest::benchmarkOpenUrls()
+{
+    KateDocManager *manager = m_app->documentManager();
+
+    const int FileCount = 10000;
+    QList<QUrl> urls;
+    urls.reserve(FileCount);
+    for (int i = 0; i < FileCount; ++i) {
+        urls.append(createFile(m_tempdir->path() + QStringLiteral("/file%1.txt").arg(i)));
+    }
+
+    QList<KTextEditor::Document *> docs;
+    QBENCHMARK_ONCE {
+        docs = manager->openUrls(urls);
+    }
+    QCOMPARE(docs.size(), FileCount);
+    QCOMPARE(manager->documentList().size(), FileCount);
+
+    QBENCHMARK {
+        QCOMPARE(manager->findDocument(urls.at(FileCount / 2)), docs.at(FileCount / 2));
+    }
+}
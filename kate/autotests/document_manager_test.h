@@ -0,0 +1,32 @@
+/*  SPDX-License-Identifier: LGPL-2.0-or-later
+
+    SPDX-FileCopyrightText: 2021 Kate Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATE_DOCUMENT_MANAGER_TEST_H
+#define KATE_DOCUMENT_MANAGER_TEST_H
+
+#include <QObject>
+
+class KateDocumentManagerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void initTestCase();
+    void cleanupTestCase();
+
+    void findDocument();
+    void openUrlsIsLazy();
+    void benchmarkOpenUrls();
+
+private:
+    class QTemporaryDir *m_tempdir;
+    class KateApp *m_app; // dependency, sigh...
+};
+
+#endif
@@ -0,0 +1,137 @@
+/*  SPDX-License-Identifier: LGPL-2.0-or-later
+
+    SPDX-FileCopyrightText: 2021 Kate Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "metainfo_store_test.h"
+#include "katemetainfostore.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtTest>
+
+QTEST_GUILESS_MAIN(KateMetaInfoStoreTest)
+
+static KateMetaInfoStore::Entry entry(const QByteArray &checksum, const QByteArray &data, const QDateTime &time = QDateTime::currentDateTimeUtc())
+{
+    KateMetaInfoStore::Entry e;
+    e.checksum = checksum;
+    e.time = time;
+    e.data = data;
+    return e;
+}
+
+void KateMetaInfoStoreTest::init()
+{
+    m_tempdir = new QTemporaryDir;
+    QVERIFY(m_tempdir->isValid());
+    m_fileName = m_tempdir->path() + QStringLiteral("/metainfos");
+}
+
+void KateMetaInfoStoreTest::cleanup()
+{
+    delete m_tempdir;
+}
+
+void KateMetaInfoStoreTest::persistence()
+{
+    const QUrl a(QStringLiteral("file:///tmp/a.txt"));
+    const QUrl b(QStringLiteral("file:///tmp/b.txt"));
+
+    {
+        KateMetaInfoStore store(m_fileName);
+        QCOMPARE(store.size(), 0);
+        store.insert(a, entry("1234", "a"));
+        store.insert(b, entry("5678", "b"));
+        store.flush();
+        store.insert(a, entry("abcd", "a2"));
+        store.remove(b);
+        QVERIFY(store.contains(a));
+        QVERIFY(!store.contains(b));
+    }
+
+    KateMetaInfoStore store(m_fileName);
+    QCOMPARE(store.size(), 1);
+    QVERIFY(store.contains(a));
+    QVERIFY(!store.contains(b));
+    QCOMPARE(store.value(a).checksum, QByteArray("abcd"));
+    QCOMPARE(store.value(a).data, QByteArray("a2"));
+}
+
+void KateMetaInfoStoreTest::damagedFile()
+{
+    const QUrl a(QStringLiteral("file:///tmp/a.txt"));
+
+    {
+        KateMetaInfoStore store(m_fileName);
+        store.insert(a, entry("1234", "a"));
+    }
+
+    // a record cut off by a crash
+    const qint64 size = QFileInfo(m_fileName).size();
+    {
+        QFile file(m_fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+        file.write("\0\0\1\0garbage", 11);
+    }
+
+    {
+        KateMetaInfoStore store(m_fileName);
+        QCOMPARE(store.size(), 1);
+        QCOMPARE(store.value(a).data, QByteArray("a"));
+        QCOMPARE(QFileInfo(m_fileName).size(), size);
+    }
+
+    // not a store at all
+    {
+        QFile file(m_fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("[file:///tmp/a.txt]\nChecksum=1234\n");
+    }
+
+    KateMetaInfoStore store(m_fileName);
+    QCOMPARE(store.size(), 0);
+}
+
+void KateMetaInfoStoreTest::compaction()
+{
+    const QUrl a(QStringLiteral("file:///tmp/a.txt"));
+    const QByteArray data(1024, 'x');
+
+    KateMetaInfoStore store(m_fileName);
+    for (int i = 0; i < 1000; ++i) {
+        store.insert(a, entry(QByteArray::number(i), data));
+    }
+    store.flush();
+    store.waitForFlushed();
+
+    // only the last version is kept
+    QVERIFY(QFileInfo(m_fileName).size() < 2 * data.size());
+
+    KateMetaInfoStore reopened(m_fileName);
+    QCOMPARE(reopened.size(), 1);
+    QCOMPARE(reopened.value(a).checksum, QByteArray("999"));
+}
+
+void KateMetaInfoStoreTest::removeOlderThan()
+{
+    const QUrl a(QStringLiteral("file:///tmp/a.txt"));
+    const QUrl b(QStringLiteral("file:///tmp/b.txt"));
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+
+    {
+        KateMetaInfoStore store(m_fileName);
+        store.insert(a, entry("1234", "a", now.addDays(-100)));
+        store.insert(b, entry("5678", "b", now));
+        store.removeOlderThan(now.addDays(-30));
+        QVERIFY(!store.contains(a));
+        QVERIFY(store.contains(b));
+    }
+
+    KateMetaInfoStore store(m_fileName);
+    QCOMPARE(store.size(), 1);
+    QVERIFY(store.contains(b));
+}
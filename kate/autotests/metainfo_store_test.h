@@ -0,0 +1,31 @@
+/*  SPDX-License-Identifier: LGPL-2.0-or-later
+
+    SPDX-FileCopyrightText: 2021 Kate Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATE_METAINFO_STORE_TEST_H
+#define KATE_METAINFO_STORE_TEST_H
+
+#include <QObject>
+
+class KateMetaInfoStoreTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void persistence();
+    void damagedFile();
+    void compaction();
+    void removeOlderThan();
+
+private:
+    class QTemporaryDir *m_tempdir;
+    QString m_fileName;
+};
+
+#endif
@@ -7,10 +7,15 @@
 
 #include "session_manager_test.h"
 #include "kateapp.h"
+#include "katedocmanager.h"
+#include "katemainwindow.h"
 #include "katesessionmanager.h"
+#include "kateviewmanager.h"
 
 #include <KConfig>
 #include <KConfigGroup>
+#include <KTextEditor/Document>
+#include <KTextEditor/View>
 
 #include <QCommandLineParser>
 #include <QTemporaryDir>
@@ -163,3 +168,97 @@ void KateSessionManagerTest::startNonEmpty()
     KateSessionManager m(this, m_tempdir->path());
     QCOMPARE(m.sessionList().size(), 2);
 }
+
+void KateSessionManagerTest::cachedDocumentCount()
+{
+    const QString file = m_tempdir->path() + QLatin1String("/cached.katesession");
+    {
+        KConfig config(file, KConfig::SimpleConfig);
+        config.group("Open Documents").writeEntry("Count", 3);
+    }
+
+    // the count is read once and kept in the catalog
+    {
+        KateSessionManager m(this, m_tempdir->path());
+        QCOMPARE(m.giveSession(QStringLiteral("cached"))->documents(), 3u);
+    }
+
+    // an unchanged file is not read again
+    const QDateTime modified = QFileInfo(file).lastModified();
+    {
+        KConfig config(file, KConfig::SimpleConfig);
+        config.group("Open Documents").writeEntry("Count", 5);
+    }
+    {
+        QFile f(file);
+        QVERIFY(f.open(QIODevice::ReadWrite));
+        QVERIFY(f.setFileTime(modified, QFileDevice::FileModificationTime));
+    }
+
+    KateSessionManager m(this, m_tempdir->path());
+    KateSession::Ptr s = m.giveSession(QStringLiteral("cached"));
+    QCOMPARE(s->documents(), 3u);
+
+    // a written file is read again
+    {
+        KConfig config(file, KConfig::SimpleConfig);
+        config.group("Open Documents").writeEntry("Count", 7);
+    }
+
+    // what KDirWatch does once it notices, without waiting for it
+    QVERIFY(QMetaObject::invokeMethod(&m, "sessionFileChanged", Q_ARG(QString, file)));
+    QCOMPARE(s->documents(), 7u);
+}
+
+void KateSessionManagerTest::viewStateOfUnshownTabs()
+{
+    const QString a = m_tempdir->path() + QLatin1String("/a.txt");
+    const QString b = m_tempdir->path() + QLatin1String("/b.txt");
+    for (const QString &path : {a, b}) {
+        QFile f(path);
+        QVERIFY(f.open(QIODevice::WriteOnly));
+        f.write("1\n2\n3\n4\n");
+    }
+    const QUrl urlB = QUrl::fromLocalFile(b);
+
+    // the group "MainWindow<n>-ViewSpace <n> <url>" of b
+    auto viewGroupOfB = [urlB](KConfig *config) {
+        const QString suffix = QLatin1Char(' ') + urlB.toString();
+        const QStringList groups = config->groupList();
+        for (const QString &group : groups) {
+            if (group.contains(QLatin1String("-ViewSpace ")) && group.endsWith(suffix)) {
+                return KConfigGroup(config, group);
+            }
+        }
+        return KConfigGroup();
+    };
+
+    QVERIFY(m_manager->activateSession(QStringLiteral("views"), false));
+    KateSession::Ptr session = m_manager->activeSession();
+    KateViewManager *viewManager = m_app->activeKateMainWindow()->viewManager();
+
+    viewManager->openUrl(urlB, QString());
+    KTextEditor::View *viewB = viewManager->activeView();
+    QVERIFY(viewB);
+    viewB->setCursorPosition(KTextEditor::Cursor(2, 0));
+    viewManager->openUrl(QUrl::fromLocalFile(a), QString());
+
+    QVERIFY(m_manager->saveActiveSession());
+    QVERIFY(viewGroupOfB(session->config()).exists());
+
+    // restore it, only a is shown, b is not loaded yet
+    QVERIFY(m_manager->activateSession(QStringLiteral("other"), false, false));
+    m_app->documentManager()->closeAllDocuments(false);
+    QVERIFY(m_manager->activateSession(QStringLiteral("views"), false));
+    KTextEditor::Document *docB = m_app->documentManager()->findDocument(urlB);
+    QVERIFY(docB);
+    QVERIFY(m_app->documentManager()->isPending(docB));
+
+    // saving again keeps the cursor of b
+    QVERIFY(m_manager->saveActiveSession());
+    const KConfigGroup group = viewGroupOfB(session->config());
+    QVERIFY(group.exists());
+    QCOMPARE(group.readEntry("CursorLine", -1), 2);
+
+    m_app->documentManager()->closeAllDocuments(false);
+}
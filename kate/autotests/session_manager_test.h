@@ -31,6 +31,8 @@ private Q_SLOTS:
 
     void deletingSessionFilesUnderRunningApp();
     void startNonEmpty();
+    void cachedDocumentCount();
+    void viewStateOfUnshownTabs();
 
 private:
     class QTemporaryDir *m_tempdir;
@@ -0,0 +1,91 @@
+/*  SPDX-License-Identifier: LGPL-2.0-or-later
+
+    SPDX-FileCopyrightText: 2021 Kate Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "trace_test.h"
+#include "katetrace.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QtTest>
+
+QTEST_GUILESS_MAIN(KateTraceTest)
+
+void KateTraceTest::disabled()
+{
+    QVERIFY(!KateTrace::isEnabled());
+    {
+        KateTraceScope trace("phase", QStringLiteral("nothing"));
+    }
+    QVERIFY(KateTrace::self().spans().isEmpty());
+}
+
+void KateTraceTest::spans()
+{
+    KateTrace::self().start(QString());
+    QVERIFY(KateTrace::isEnabled());
+
+    {
+        KateTraceScope outer("phase", QStringLiteral("outer"));
+        {
+            KateTraceScope load("plugin", QStringLiteral("plugin"), QStringLiteral("load"));
+            KateTraceScope constructor("plugin", QStringLiteral("plugin"), QStringLiteral("constructor"));
+            QTest::qWait(2);
+        }
+        KateTraceScope document("document", QStringLiteral("a.txt"));
+    }
+
+    const QVector<KateTrace::Span> &spans = KateTrace::self().spans();
+    QCOMPARE(spans.size(), 4);
+
+    // appended once done, the innermost first
+    QCOMPARE(spans[0].detail, QStringLiteral("constructor"));
+    QCOMPARE(spans[0].depth, 2);
+    QCOMPARE(spans[3].name, QStringLiteral("outer"));
+    QCOMPARE(spans[3].depth, 0);
+    QVERIFY(spans[3].wall >= spans[1].wall);
+    QVERIFY(spans[1].wall >= spans[0].wall);
+
+    // the nested plugin span is part of the outer one
+    const QString summary = KateTrace::self().summary();
+    QVERIFY(summary.contains(QRegularExpression(QStringLiteral("plugins\\s+1\\s"))));
+    QVERIFY(summary.contains(QRegularExpression(QStringLiteral("documents\\s+1\\s"))));
+    QVERIFY(summary.contains(QStringLiteral("outer")));
+}
+
+void KateTraceTest::write()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QStringLiteral("/trace.json");
+    KateTrace::self().start(fileName);
+    KateTrace::self().mark(QStringLiteral("idle"));
+    QVERIFY(KateTrace::self().write());
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QJsonArray events = QJsonDocument::fromJson(file.readAll()).object().value(QStringLiteral("traceEvents")).toArray();
+
+    int complete = 0;
+    int instant = 0;
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        const QString phase = event.value(QStringLiteral("ph")).toString();
+        if (phase == QLatin1String("X")) {
+            ++complete;
+            QVERIFY(event.contains(QStringLiteral("ts")));
+            QVERIFY(event.contains(QStringLiteral("dur")));
+        } else if (phase == QLatin1String("i")) {
+            ++instant;
+            QCOMPARE(event.value(QStringLiteral("name")).toString(), QStringLiteral("idle"));
+        }
+    }
+    QCOMPARE(complete, KateTrace::self().spans().size());
+    QCOMPARE(instant, 1);
+}
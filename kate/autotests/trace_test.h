@@ -0,0 +1,23 @@
+/*  SPDX-License-Identifier: LGPL-2.0-or-later
+
+    SPDX-FileCopyrightText: 2021 Kate Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATE_TRACE_TEST_H
+#define KATE_TRACE_TEST_H
+
+#include <QObject>
+
+class KateTraceTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void disabled();
+    void spans();
+    void write();
+};
+
+#endif
@@ -7,6 +7,8 @@
 
 #include "kateapp.h"
 
+#include "katestdinstream.h"
+#include "katetrace.h"
 #include "kateviewmanager.h"
 
 #include <KConfigGroup>
@@ -31,6 +33,8 @@
 #include <QCommandLineParser>
 #include <QFileInfo>
 #include <QFileOpenEvent>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QTextCodec>
 
 #include "../../urlinfo.h"
@@ -53,12 +57,17 @@ KateApp::KateApp(const QCommandLineParser &args)
     /**
      * re-route some signals to application wrapper
      */
-    connect(&m_docManager, &KateDocManager::documentCreated, &m_wrapper, &KTextEditor::Application::documentCreated);
-    connect(&m_docManager, &KateDocManager::documentWillBeDeleted, &m_wrapper, &KTextEditor::Application::documentWillBeDeleted);
-    connect(&m_docManager, &KateDocManager::documentDeleted, &m_wrapper, &KTextEditor::Application::documentDeleted);
+    connect(&m_docManager, &KateDocManager::documentExposed, &m_wrapper, &KTextEditor::Application::documentCreated);
+    connect(&m_docManager, &KateDocManager::documentWillBeHidden, &m_wrapper, &KTextEditor::Application::documentWillBeDeleted);
+    connect(&m_docManager, &KateDocManager::documentHidden, &m_wrapper, &KTextEditor::Application::documentDeleted);
     connect(&m_docManager, &KateDocManager::aboutToCreateDocuments, &m_wrapper, &KTextEditor::Application::aboutToCreateDocuments);
     connect(&m_docManager, &KateDocManager::documentsCreated, &m_wrapper, &KTextEditor::Application::documentsCreated);
 
+    /**
+     * plugins may wait for the first document of some mode
+     */
+    connect(&m_docManager, &KateDocManager::documentCreated, &m_pluginManager, &KatePluginManager::documentCreated);
+
     /**
      * handle mac os x like file open request via event filter
      */
@@ -118,6 +127,8 @@ KateApp *KateApp::self()
 
 bool KateApp::init()
 {
+    KateTraceScope trace("phase", QStringLiteral("KateApp::init"));
+
     // set KATE_PID for use in child processes
     qputenv("KATE_PID", QStringLiteral("%1").arg(QCoreApplication::applicationPid()).toLatin1().constData());
 
@@ -138,6 +149,8 @@ bool KateApp::init()
 
 void KateApp::restoreKate()
 {
+    KateTraceScope trace("phase", QStringLiteral("KateApp::restoreKate"));
+
     KConfig *sessionConfig = KConfigGui::sessionConfig();
 
     // activate again correct session!!!
@@ -163,11 +176,17 @@ void KateApp::restoreKate()
 
 bool KateApp::startupKate()
 {
+    KateTraceScope trace("phase", QStringLiteral("KateApp::startupKate"));
+
     // user specified session to open
     if (m_args.isSet(QStringLiteral("start"))) {
         sessionManager()->activateSession(m_args.value(QStringLiteral("start")), false);
     } else if (m_args.isSet(QStringLiteral("startanon"))) {
         sessionManager()->activateAnonymousSession();
+    } else if (m_args.isSet(QStringLiteral("benchmark-startup")) && m_args.positionalArguments().isEmpty()) {
+        // no chooser to wait for, benchmark the last session
+        const KConfigGroup c(KSharedConfig::openConfig(), "General");
+        sessionManager()->activateSession(c.readEntry("Last Session", QString()), false);
     } else if (!m_args.isSet(QStringLiteral("stdin")) && (m_args.positionalArguments().count() == 0)) { // only start session if no files specified
         // let the user choose session if possible
         if (!sessionManager()->chooseSession()) {
@@ -200,16 +219,32 @@ bool KateApp::startupKate()
     const QString codec_name = codec ? QString::fromLatin1(codec->name()) : QString();
 
     //  Bug 397913: Reverse the order here so the new tabs are opened in same order as the files were passed in on the command line
-    QString positionalArgument;
+    QVector<UrlInfo> infos;
+    QList<QUrl> urls;
     for (int i = m_args.positionalArguments().count() - 1; i >= 0; --i) {
-        positionalArgument = m_args.positionalArguments().at(i);
-        UrlInfo info(positionalArgument);
+        UrlInfo info(m_args.positionalArguments().at(i));
 
         // this file is no local dir, open it, else warn
         bool noDir = !info.url.isLocalFile() || !QFileInfo(info.url.toLocalFile()).isDir();
 
         if (noDir) {
-            doc = openDocUrl(info.url, codec_name, tempfileSet);
+            infos.append(info);
+            urls.append(info.url);
+        } else {
+            KMessageBox::sorry(activeKateMainWindow(), i18n("The file '%1' could not be opened: it is not a normal file, it is a folder.", info.url.toString()));
+        }
+    }
+
+    // open all files as one batch, each is loaded once it is shown
+    if (!urls.isEmpty()) {
+        KateTraceScope openTrace("phase", QStringLiteral("KateViewManager::openUrls"), QString::number(urls.size()));
+        doc = activeKateMainWindow()->viewManager()->openUrls(urls, codec_name, tempfileSet);
+    }
+
+    // files with a cursor are shown right away to place it
+    for (const UrlInfo &info : qAsConst(infos)) {
+        if (info.cursor.isValid() || info.url.hasQuery()) {
+            openDocUrl(info.url, codec_name, tempfileSet);
             if (info.cursor.isValid()) {
                 setCursor(info.cursor.line(), info.cursor.column());
             } else if (info.url.hasQuery()) {
@@ -227,13 +262,16 @@ bool KateApp::startupKate()
 
                 setCursor(line, column);
             }
-        } else {
-            KMessageBox::sorry(activeKateMainWindow(), i18n("The file '%1' could not be opened: it is not a normal file, it is a folder.", info.url.toString()));
         }
     }
 
     // handle stdin input
-    if (m_args.isSet(QStringLiteral("stdin"))) {
+    if (m_args.isSet(QStringLiteral("stdin")) && m_args.isSet(QStringLiteral("stream"))) {
+        auto stream = new KateStdinStream(this);
+        if (!stream->start(codec_name)) {
+            delete stream;
+        }
+    } else if (m_args.isSet(QStringLiteral("stdin"))) {
         QTextStream input(stdin, QIODevice::ReadOnly);
 
         // set chosen codec
@@ -392,6 +430,7 @@ KateMainWindow *KateApp::newMainWindow(KConfig *sconfig_, const QString &sgroup_
     KConfig *sconfig = sconfig_ ? sconfig_ : KSharedConfig::openConfig().data();
     QString sgroup = !sgroup_.isEmpty() ? sgroup_ : QStringLiteral("MainWindow0");
 
+    KateTraceScope trace("phase", QStringLiteral("KateApp::newMainWindow"));
     KateMainWindow *mainWindow = new KateMainWindow(sconfig, sgroup);
     mainWindow->show();
 
@@ -485,27 +524,50 @@ void KateApp::remoteMessageReceived(const QString &message, QObject *)
     if (!jsonMessage.isObject())
         return;
 
+    openMessage(jsonMessage.object());
+}
+
+QStringList KateApp::openMessage(const QJsonObject &message)
+{
+    const QString encoding = message.value(QLatin1String("encoding")).toString();
+    const bool tempfile = message.value(QLatin1String("tempfile")).toBool();
+
     /**
      * open all passed urls
+     * Bug 397913: in reverse order, so the new tabs are in the same order as the urls
      */
-    const QJsonArray urls = jsonMessage.object().value(QLatin1String("urls")).toArray();
-    for (QJsonValue urlObject : urls) {
+    QStringList tokens;
+    const QJsonArray urls = message.value(QLatin1String("urls")).toArray();
+    for (int i = urls.size() - 1; i >= 0; --i) {
         /**
          * get url meta data
          */
-        const QUrl url = urlObject.toObject().value(QLatin1String("url")).toVariant().toUrl();
-        const int line = urlObject.toObject().value(QLatin1String("line")).toVariant().toInt();
-        const int column = urlObject.toObject().value(QLatin1String("column")).toVariant().toInt();
+        const QJsonObject urlObject = urls.at(i).toObject();
+        const QUrl url(urlObject.value(QLatin1String("url")).toString());
+        const int line = urlObject.value(QLatin1String("line")).toInt(-1);
+        const int column = urlObject.value(QLatin1String("column")).toInt(-1);
 
         /**
          * open file + set line/column if requested
          */
-        openUrl(url, QString(), false);
+        KTextEditor::Document *doc = openDocUrl(url, encoding, tempfile);
+        if (!doc) {
+            continue;
+        }
+        tokens.prepend(QStringLiteral("%1").arg(reinterpret_cast<qptrdiff>(doc)));
         if (line >= 0 && column >= 0) {
             setCursor(line, column);
         }
     }
 
+    if (message.contains(QLatin1String("line")) || message.contains(QLatin1String("column"))) {
+        setCursor(message.value(QLatin1String("line")).toInt(), message.value(QLatin1String("column")).toInt());
+    }
+
     // try to activate current window
-    m_adaptor.activate();
+    if (message.value(QLatin1String("activate")).toBool(true)) {
+        m_adaptor.activate();
+    }
+
+    return tokens;
 }
@@ -23,6 +23,7 @@
 #include "katetests_export.h"
 
 #include <KConfig>
+#include <QJsonObject>
 #include <QList>
 
 class KateSessionManager;
@@ -225,6 +226,17 @@ public:
      */
     bool openInput(const QString &text, const QString &encoding);
 
+    /**
+     * Open the urls of another kate process, all in one go.
+     * The message holds
+     *  - "urls": list of { "url", "line", "column" }, a cursor is set if line and column are >= 0
+     *  - "encoding", "tempfile": like --encoding and --tempfile
+     *  - "line", "column": cursor for the active view, like --line and --column
+     *  - "activate": raise the window, default true
+     * @return a token per opened document, to be told when it is closed
+     */
+    QStringList openMessage(const QJsonObject &message);
+
     //
     // KTextEditor::Application interface, called by wrappers via invokeMethod
     //
@@ -265,7 +277,8 @@ public Q_SLOTS:
      */
     QList<KTextEditor::Document *> documents()
     {
-        return m_docManager.documentList();
+        // documents not loaded yet are empty, they are left out until they are loaded
+        return m_docManager.loadedDocuments();
     }
 
     /**
@@ -276,7 +289,10 @@ public Q_SLOTS:
      */
     KTextEditor::Document *findUrl(const QUrl &url)
     {
-        return m_docManager.findDocument(url);
+        // a plugin asking for a document wants its content, load it if it stems from a session
+        KTextEditor::Document *doc = m_docManager.findDocument(url);
+        m_docManager.loadDocument(doc);
+        return doc;
     }
 
     /**
@@ -336,11 +352,22 @@ public Q_SLOTS:
     /**
      * A message is received from an external instance, if we use QtSingleApplication
      *
-     * \p message is a serialized message (at the moment just the file list separated by ';')
+     * \p message is a serialized message, see openMessage()
      * \p socket is the QLocalSocket used for the communication
      */
     void remoteMessageReceived(const QString &message, QObject *socket);
 
+    /**
+     * Not part of the KTextEditor::Application interface, plugins like the
+     * file tree call this via invokeMethod on the parent of the wrapper.
+     * \param document the document
+     * \return rough estimate of the memory used by \p document in bytes
+     */
+    qint64 documentMemoryUsage(KTextEditor::Document *document)
+    {
+        return m_docManager.memoryUsage(document);
+    }
+
 Q_SIGNALS:
     /**
      * Emitted when the configuration got changed via the global config dialog.
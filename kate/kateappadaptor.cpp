@@ -18,6 +18,9 @@
 #include <kwindowsystem_version.h>
 
 #include <QApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
 
 /**
  * add the adapter to the global application instance to have
@@ -98,6 +101,30 @@ QString KateAppAdaptor::tokenOpenUrlAt(const QString &url, int line, int column,
     m_app->setCursor(line, column);
     return QStringLiteral("%1").arg(reinterpret_cast<qptrdiff>(doc));
 }
+
+QStringList KateAppAdaptor::openUrls(const QString &message)
+{
+    const QJsonObject object = QJsonDocument::fromJson(message.toUtf8()).object();
+
+    // special case: on all desktops! that is -1 aka NET::OnAllDesktops
+    if (object.contains(QLatin1String("desktop"))) {
+        const int desktop = desktopNumber();
+        if (desktop != object.value(QLatin1String("desktop")).toInt() && desktop != NET::OnAllDesktops) {
+            return QStringList(QStringLiteral("REFUSED"));
+        }
+    }
+
+    // the caller doesn't wait for the documents
+    if (!object.value(QLatin1String("wait")).toBool(true)) {
+        KateApp *app = m_app;
+        QTimer::singleShot(0, app, [app, object]() {
+            app->openMessage(object);
+        });
+        return QStringList();
+    }
+
+    return m_app->openMessage(object);
+}
 //--------
 
 bool KateAppAdaptor::setCursor(int line, int column)
@@ -121,6 +148,21 @@ int KateAppAdaptor::desktopNumber()
     return appInfo.desktop();
 }
 
+QString KateAppAdaptor::documentMemoryUsage()
+{
+    KateDocManager *docManager = m_app->documentManager();
+
+    QString text;
+    for (KTextEditor::Document *doc : docManager->documentList()) {
+        text += QStringLiteral("%1 %2 %3\n")
+                    .arg(docManager->memoryUsage(doc), 12)
+                    .arg(docManager->isPending(doc) ? QStringLiteral("unloaded") : QStringLiteral("loaded"), -8)
+                    .arg(docManager->documentUrl(doc).isEmpty() ? docManager->documentName(doc) : docManager->documentUrl(doc).toDisplayString());
+    }
+    text += QStringLiteral("%1 total\n").arg(docManager->totalMemoryUsage(), 12);
+    return text;
+}
+
 QString KateAppAdaptor::activeSession()
 {
     return m_app->sessionManager()->activeSession()->name();
@@ -64,6 +64,14 @@ public Q_SLOTS:
 
     QString tokenOpenUrlAt(const QString &url, int line, int column, const QString &encoding, bool isTempFile);
 
+    /**
+     * open all urls of @p message in one call, see KateApp::openMessage()
+     * "desktop": only accept the urls if on this virtual desktop
+     * "wait": false to reply right away and open the urls afterwards
+     * @return tokens of the opened documents, REFUSED if on another desktop
+     */
+    QStringList openUrls(const QString &message);
+
     /**
      * set cursor of active view in active main window
      * will clear selection
@@ -91,6 +99,13 @@ public Q_SLOTS:
 
     int desktopNumber();
 
+    /**
+     * estimated memory use of the open documents, one line per document
+     * with bytes, whether it is loaded and its url, then the total
+     * @return the table, e.g. for qdbus org.kde.kate-<pid> /MainApplication documentMemoryUsage
+     */
+    QString documentMemoryUsage();
+
     /**
      * activate this kate instance
      */
@@ -144,6 +144,20 @@ void KateConfigDialog::addBehaviorPage()
     connect(m_tabLimit, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &KateConfigDialog::slotChanged);
     vbox->addLayout(hlayout);
 
+    hlayout = new QHBoxLayout;
+    label = new QLabel(i18n("&Free the views of tabs unused for:"), buttonGroup);
+    hlayout->addWidget(label);
+    m_closeIdleViews = new KPluralHandlingSpinBox(buttonGroup);
+    hlayout->addWidget(m_closeIdleViews);
+    label->setBuddy(m_closeIdleViews);
+    m_closeIdleViews->setRange(0, 24 * 60);
+    m_closeIdleViews->setSpecialValueText(i18nc("The special case of 'Free the views of tabs unused for'", "(never)"));
+    m_closeIdleViews->setSuffix(ki18ncp("The suffix of 'Free the views of tabs unused for'", " minute", " minutes"));
+    m_closeIdleViews->setValue(cgGeneral.readEntry("Close Idle Views After", 0));
+    m_closeIdleViews->setToolTip(i18n("The view of a tab is created again when the tab is shown, with the same cursor and scroll position."));
+    connect(m_closeIdleViews, static_cast<void (KPluralHandlingSpinBox::*)(int)>(&KPluralHandlingSpinBox::valueChanged), this, &KateConfigDialog::slotChanged);
+    vbox->addLayout(hlayout);
+
     m_showTabCloseButton = new QCheckBox(i18n("&Show close button"), buttonGroup);
     m_showTabCloseButton->setChecked(cgGeneral.readEntry("Show Tabs Close Button", true));
     m_showTabCloseButton->setToolTip(i18n("When checked each tab will display a close button."));
@@ -200,6 +214,27 @@ void KateConfigDialog::addSessionPage()
     sessionConfigUi.restoreVC->setChecked(cgGeneral.readEntry("Restore Window Configuration", true));
     connect(sessionConfigUi.restoreVC, &QCheckBox::toggled, this, &KateConfigDialog::slotChanged);
 
+    // documents loaded in advance after a session was restored
+    sessionConfigUi.prefetchDocuments->setMaximum(100);
+    sessionConfigUi.prefetchDocuments->setSpecialValueText(i18nc("The special case of 'Load in the background'", "(none)"));
+    sessionConfigUi.prefetchDocuments->setSuffix(ki18ncp("The suffix of 'Load in the background'", " document", " documents"));
+    sessionConfigUi.prefetchDocuments->setValue(KateApp::self()->documentManager()->getPrefetchDocuments());
+    connect(sessionConfigUi.prefetchDocuments, static_cast<void (KPluralHandlingSpinBox::*)(int)>(&KPluralHandlingSpinBox::valueChanged), this, &KateConfigDialog::slotChanged);
+
+    // unused documents are unloaded after a while or over a memory budget
+    sessionConfigUi.unloadDocuments->setMaximum(10080);
+    sessionConfigUi.unloadDocuments->setSpecialValueText(i18nc("The special case of 'Unload unused documents after'", "(never)"));
+    sessionConfigUi.unloadDocuments->setSuffix(ki18ncp("The suffix of 'Unload unused documents after'", " minute", " minutes"));
+    sessionConfigUi.unloadDocuments->setValue(KateApp::self()->documentManager()->getUnloadDocumentsAfter());
+    connect(sessionConfigUi.unloadDocuments, static_cast<void (KPluralHandlingSpinBox::*)(int)>(&KPluralHandlingSpinBox::valueChanged), this, &KateConfigDialog::slotChanged);
+
+    sessionConfigUi.documentMemoryBudget->setMaximum(65536);
+    sessionConfigUi.documentMemoryBudget->setSingleStep(64);
+    sessionConfigUi.documentMemoryBudget->setSpecialValueText(i18nc("The special case of 'Unload documents over'", "(no limit)"));
+    sessionConfigUi.documentMemoryBudget->setSuffix(ki18ncp("The suffix of 'Unload documents over'", " MiB", " MiB"));
+    sessionConfigUi.documentMemoryBudget->setValue(KateApp::self()->documentManager()->getDocumentMemoryBudget());
+    connect(sessionConfigUi.documentMemoryBudget, static_cast<void (KPluralHandlingSpinBox::*)(int)>(&KPluralHandlingSpinBox::valueChanged), this, &KateConfigDialog::slotChanged);
+
     sessionConfigUi.spinBoxRecentFilesCount->setValue(recentFilesMaxCount());
     connect(sessionConfigUi.spinBoxRecentFilesCount, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &KateConfigDialog::slotChanged);
 
@@ -258,9 +293,13 @@ void KateConfigDialog::addFeedbackPage()
 
 void KateConfigDialog::addPluginPages()
 {
-    const KatePluginList &pluginList(KateApp::self()->pluginManager()->pluginList());
-    for (const KatePluginInfo &plugin : pluginList) {
-        if (plugin.load) {
+    KatePluginList &pluginList(KateApp::self()->pluginManager()->pluginList());
+    for (KatePluginInfo &plugin : pluginList) {
+        // the pages of plugins waiting for their triggers are only known once loaded
+        if (plugin.pending) {
+            KateApp::self()->pluginManager()->activatePlugin(&plugin);
+        }
+        if (plugin.load && plugin.plugin) {
             addPluginPage(plugin.plugin);
         }
     }
@@ -354,6 +393,15 @@ void KateConfigDialog::slotApply()
         cg.writeEntry("Days Meta Infos", sessionConfigUi.daysMetaInfos->value());
         KateApp::self()->documentManager()->setDaysMetaInfos(sessionConfigUi.daysMetaInfos->value());
 
+        cg.writeEntry("Prefetch Documents", sessionConfigUi.prefetchDocuments->value());
+        KateApp::self()->documentManager()->setPrefetchDocuments(sessionConfigUi.prefetchDocuments->value());
+
+        cg.writeEntry("Unload Documents After", sessionConfigUi.unloadDocuments->value());
+        KateApp::self()->documentManager()->setUnloadDocumentsAfter(sessionConfigUi.unloadDocuments->value());
+
+        cg.writeEntry("Document Memory Budget", sessionConfigUi.documentMemoryBudget->value());
+        KateApp::self()->documentManager()->setDocumentMemoryBudget(sessionConfigUi.documentMemoryBudget->value());
+
         cg.writeEntry("Modified Notification", m_modNotifications->isChecked());
         m_mainWindow->setModNotificationEnabled(m_modNotifications->isChecked());
 
@@ -368,6 +416,8 @@ void KateConfigDialog::slotApply()
 
         cg.writeEntry("Tabbar Tab Limit", m_tabLimit->value());
 
+        cg.writeEntry("Close Idle Views After", m_closeIdleViews->value());
+
         cg.writeEntry("Show Tabs Close Button", m_showTabCloseButton->isChecked());
 
         cg.writeEntry("Expand Tabs", m_expandTabs->isChecked());
@@ -82,6 +82,7 @@ private:
     QComboBox *m_cmbQuickOpenMatchMode;
     QComboBox *m_cmbQuickOpenListMode;
     QSpinBox *m_tabLimit;
+    KPluralHandlingSpinBox *m_closeIdleViews;
     QCheckBox *m_showTabCloseButton;
     QCheckBox *m_expandTabs;
     QCheckBox *m_tabDoubleClickNewDocument;
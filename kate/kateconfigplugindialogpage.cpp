@@ -14,6 +14,7 @@
 
 #include <KLocalizedString>
 
+#include <QSignalBlocker>
 #include <QVBoxLayout>
 
 class KatePluginListItem : public QTreeWidgetItem
@@ -59,11 +60,11 @@ KateConfigPluginPage::KateConfigPluginPage(QWidget *parent, KateConfigDialog *di
     layout->setSpacing(0);
     layout->setContentsMargins(0, 0, 0, 0);
 
-    KatePluginListView *listView = new KatePluginListView(this);
+    listView = new KatePluginListView(this);
     layout->addWidget(listView);
 
     QStringList headers;
-    headers << i18n("Name") << i18n("Description");
+    headers << i18n("Name") << i18n("Description") << i18n("Load Time");
     listView->setHeaderLabels(headers);
     listView->setWhatsThis(i18n("Here you can see all available Kate plugins. Those with a check mark are loaded, and will be loaded again the next time Kate is started."));
 
@@ -72,10 +73,12 @@ KateConfigPluginPage::KateConfigPluginPage(QWidget *parent, KateConfigDialog *di
         QTreeWidgetItem *item = new KatePluginListItem(pluginInfo.load, &pluginInfo);
         item->setText(0, pluginInfo.metaData.name());
         item->setText(1, pluginInfo.metaData.description());
+        updateLoadTime(item);
         listView->addTopLevelItem(item);
     }
 
     listView->resizeColumnToContents(0);
+    listView->resizeColumnToContents(2);
     listView->sortByColumn(0, Qt::AscendingOrder);
     connect(listView, &KatePluginListView::stateChange, this, &KateConfigPluginPage::stateChange);
 }
@@ -101,6 +104,7 @@ void KateConfigPluginPage::loadPlugin(KatePluginListItem *item)
     myDialog->addPluginPage(item->info()->plugin);
 
     item->setCheckState(0, Qt::Checked);
+    updateLoadTime(item);
 }
 
 void KateConfigPluginPage::unloadPlugin(KatePluginListItem *item)
@@ -109,4 +113,34 @@ void KateConfigPluginPage::unloadPlugin(KatePluginListItem *item)
     KateApp::self()->pluginManager()->unloadPlugin(item->info());
 
     item->setCheckState(0, Qt::Unchecked);
+    updateLoadTime(item);
+}
+
+void KateConfigPluginPage::showEvent(QShowEvent *event)
+{
+    // plugins may have been loaded on demand meanwhile
+    for (int i = 0; i < listView->topLevelItemCount(); ++i) {
+        updateLoadTime(listView->topLevelItem(i));
+    }
+    QFrame::showEvent(event);
+}
+
+void KateConfigPluginPage::updateLoadTime(QTreeWidgetItem *item)
+{
+    // no state change of the plugin
+    const QSignalBlocker blocker(item->treeWidget());
+
+    const KatePluginInfo *info = static_cast<KatePluginListItem *>(item)->info();
+    if (info->pending) {
+        item->setText(2, i18n("On demand"));
+    } else if (info->plugin && info->loadTime >= 0) {
+        item->setText(2, i18nc("@item:intable plugin load time", "%1 ms", info->loadTime));
+    } else {
+        item->setText(2, QString());
+    }
+
+    // what loads a plugin that is not loaded right away
+    if (!info->triggers.isEmpty()) {
+        item->setToolTip(2, i18n("Loaded on demand: %1", info->triggers.join(QStringLiteral(", "))));
+    }
 }
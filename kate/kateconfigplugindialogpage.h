@@ -36,8 +36,15 @@ class KateConfigPluginPage : public QFrame
 public:
     KateConfigPluginPage(QWidget *parent, class KateConfigDialog *dialog);
 
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    void updateLoadTime(QTreeWidgetItem *item);
+
 private:
     class KateConfigDialog *myDialog;
+    KatePluginListView *listView;
 
 Q_SIGNALS:
     void changed();
@@ -12,8 +12,10 @@
 #include "katedebug.h"
 #include "katemainwindow.h"
 #include "katesavemodifieddialog.h"
+#include "katetrace.h"
 #include "kateviewmanager.h"
 
+#include <ktexteditor/markinterface.h>
 #include <ktexteditor/view.h>
 
 #include <KColorScheme>
@@ -23,21 +25,56 @@
 #include <KMessageBox>
 
 #include <QApplication>
+#include <QDataStream>
+#include <QFile>
 #include <QFileDialog>
 #include <QListView>
-#include <QProgressDialog>
+#include <QRunnable>
+#include <QStandardPaths>
 #include <QTextCodec>
+#include <QThreadPool>
 #include <QTimer>
 
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+// rough costs for memoryUsage(): the document with its buffer and highlighting,
+// each line with its attributes and folding state, each mark
+const qint64 DocumentOverhead = 64 * 1024;
+const qint64 LineOverhead = 64;
+const qint64 MarkOverhead = 32;
+
+// how often unused documents are looked for
+const int UnloadInterval = 60 * 1000;
+}
+
 KateDocManager::KateDocManager(QObject *parent)
     : QObject(parent)
-    , m_metaInfos(QStringLiteral("katemetainfos"), KConfig::NoGlobals)
+    , m_metaInfos(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/metainfos"))
     , m_saveMetaInfos(true)
     , m_daysMetaInfos(0)
+    , m_prefetchDocuments(0)
 {
     // set our application wrapper
     KTextEditor::Editor::instance()->setApplication(KateApp::self()->wrapper());
 
+    // load one prefetched document per event loop iteration, to keep the ui responsive
+    m_prefetchTimer.setSingleShot(true);
+    m_prefetchTimer.setInterval(0);
+    connect(&m_prefetchTimer, &QTimer::timeout, this, &KateDocManager::prefetchNext);
+
+    // only running once unloading is enabled
+    m_clock.start();
+    m_unloadTimer.setInterval(UnloadInterval);
+    connect(&m_unloadTimer, &QTimer::timeout, this, &KateDocManager::unloadUnusedDocuments);
+
+    // take over the meta infos of older versions
+    if (m_metaInfos.size() == 0) {
+        importMetaInfos();
+    }
+
     // create one doc, we always have at least one around!
     createDoc();
 }
@@ -51,18 +88,7 @@ KateDocManager::~KateDocManager()
 
         // purge saved filesessions
         if (m_daysMetaInfos > 0) {
-            const QStringList groups = m_metaInfos.groupList();
-#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
-            QDateTime def(QDate(1970, 1, 1));
-#else
-            QDateTime def(QDate(1970, 1, 1).startOfDay());
-#endif
-            for (const auto &group : groups) {
-                QDateTime last = m_metaInfos.group(group).readEntry("Time", def);
-                if (last.daysTo(QDateTime::currentDateTimeUtc()) > m_daysMetaInfos) {
-                    m_metaInfos.deleteGroup(group);
-                }
-            }
+            m_metaInfos.removeOlderThan(QDateTime::currentDateTimeUtc().addDays(-m_daysMetaInfos));
         }
     }
 
@@ -82,8 +108,13 @@ KTextEditor::Document *KateDocManager::createDoc(const KateDocumentInfo &docInfo
 
     m_docList.append(doc);
     m_docInfos.insert(doc, new KateDocumentInfo(docInfo));
+    m_docInfos.value(doc)->lastUsed = m_clock.elapsed();
+
+    // a pending document is found by its url, too
+    indexDocument(doc);
 
     // connect internal signals...
+    connect(doc, &KTextEditor::Document::documentUrlChanged, this, &KateDocManager::indexDocument);
     connect(doc, &KTextEditor::Document::modifiedChanged, this, &KateDocManager::slotModChanged1);
     connect(doc,
             SIGNAL(modifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)),
@@ -94,6 +125,13 @@ KTextEditor::Document *KateDocManager::createDoc(const KateDocumentInfo &docInfo
     emit documentCreated(doc);
     emit documentCreatedViewManager(doc);
 
+    // plugins only see it once it is loaded
+    if (isPending(doc)) {
+        m_hiddenDocuments.insert(doc);
+    } else {
+        emit documentExposed(doc);
+    }
+
     // return our new document
     return doc;
 }
@@ -103,6 +141,253 @@ KateDocumentInfo *KateDocManager::documentInfo(KTextEditor::Document *doc)
     return m_docInfos.contains(doc) ? m_docInfos[doc] : nullptr;
 }
 
+void KateDocManager::loadDocument(KTextEditor::Document *doc)
+{
+    KateDocumentInfo *info = documentInfo(doc);
+    if (!info || info->pendingUrl.isEmpty()) {
+        return;
+    }
+
+    KateTraceScope trace("document", info->pendingUrl.fileName(), info->pendingUrl.toString());
+
+    const QUrl url = info->pendingUrl;
+    const QString encoding = info->pendingEncoding;
+    const QMap<QString, QString> sessionConfig = info->pendingSessionConfig;
+
+    info->pendingUrl.clear();
+    info->pendingSessionConfig.clear();
+    info->pendingEncoding.clear();
+    info->lastUsed = m_clock.elapsed();
+    m_prefetchQueue.removeAll(doc);
+
+    // plugins see the document load, like one opened by the user
+    if (m_hiddenDocuments.remove(doc)) {
+        emit documentExposed(doc);
+    }
+
+    if (sessionConfig.isEmpty()) {
+        // opened as part of a batch
+        if (!encoding.isEmpty()) {
+            doc->setEncoding(encoding);
+        }
+        doc->openUrl(url);
+        loadMetaInfos(doc, url);
+    } else {
+        // replay the session config of the document, this opens the url
+        KConfig config(QString(), KConfig::SimpleConfig);
+        KConfigGroup cg(&config, "Document");
+        for (auto it = sessionConfig.cbegin(); it != sessionConfig.cend(); ++it) {
+            cg.writeEntry(it.key(), it.value());
+        }
+
+        connect(doc, SIGNAL(completed()), this, SLOT(documentOpened()));
+        connect(doc, &KParts::ReadOnlyPart::canceled, this, &KateDocManager::documentOpened);
+
+        doc->readSessionConfig(cg);
+    }
+
+    // the url might not have changed or the loading might have failed
+    indexDocument(doc);
+}
+
+QList<KTextEditor::Document *> KateDocManager::loadedDocuments() const
+{
+    if (m_hiddenDocuments.isEmpty()) {
+        return m_docList;
+    }
+
+    QList<KTextEditor::Document *> documents;
+    documents.reserve(m_docList.size() - m_hiddenDocuments.size());
+    for (KTextEditor::Document *doc : qAsConst(m_docList)) {
+        if (!m_hiddenDocuments.contains(doc)) {
+            documents.append(doc);
+        }
+    }
+    return documents;
+}
+
+bool KateDocManager::isPending(KTextEditor::Document *doc) const
+{
+    const KateDocumentInfo *info = m_docInfos.value(doc);
+    return info && !info->pendingUrl.isEmpty();
+}
+
+QUrl KateDocManager::documentUrl(KTextEditor::Document *doc) const
+{
+    const KateDocumentInfo *info = m_docInfos.value(doc);
+    if (info && !info->pendingUrl.isEmpty()) {
+        return info->pendingUrl;
+    }
+    return doc->url();
+}
+
+QString KateDocManager::documentName(KTextEditor::Document *doc) const
+{
+    const KateDocumentInfo *info = m_docInfos.value(doc);
+    if (info && !info->pendingUrl.isEmpty()) {
+        return info->pendingUrl.fileName();
+    }
+    return doc->documentName();
+}
+
+void KateDocManager::prefetchDocuments(const QVector<KTextEditor::Document *> &docs)
+{
+    m_prefetchQueue.clear();
+    for (KTextEditor::Document *doc : docs.mid(0, m_prefetchDocuments)) {
+        if (isPending(doc)) {
+            m_prefetchQueue.append(doc);
+        }
+    }
+
+    if (!m_prefetchQueue.isEmpty()) {
+        m_prefetchTimer.start();
+    }
+}
+
+qint64 KateDocManager::memoryUsage(KTextEditor::Document *doc) const
+{
+    if (isPending(doc)) {
+        return DocumentOverhead;
+    }
+
+    qint64 usage = DocumentOverhead + qint64(doc->totalCharacters()) * qint64(sizeof(QChar)) + qint64(doc->lines()) * LineOverhead;
+    if (KTextEditor::MarkInterface *iface = qobject_cast<KTextEditor::MarkInterface *>(doc)) {
+        usage += iface->marks().size() * MarkOverhead;
+    }
+    return usage;
+}
+
+qint64 KateDocManager::totalMemoryUsage() const
+{
+    qint64 usage = 0;
+    for (KTextEditor::Document *doc : qAsConst(m_docList)) {
+        usage += memoryUsage(doc);
+    }
+    return usage;
+}
+
+bool KateDocManager::unloadDocument(KTextEditor::Document *doc)
+{
+    KateDocumentInfo *info = documentInfo(doc);
+    if (!info || isPending(doc) || doc->url().isEmpty() || doc->isModified() || !doc->views().isEmpty()) {
+        return false;
+    }
+
+    // nothing to reload these from
+    if (info->modifiedOnDisc || !info->openSuccess || m_tempFiles.contains(doc)) {
+        return false;
+    }
+
+    // keep bookmarks and the like, the session config brings back mode, encoding...
+    saveMetaInfos({doc});
+
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup cg(&config, "Document");
+    doc->writeSessionConfig(cg);
+
+    // plugins would see an empty document without url, they lose it until it is loaded again
+    emit documentWillBeHidden(doc);
+    m_hiddenDocuments.insert(doc);
+
+    // pending before closing, the url stays indexed and the tabs keep showing it
+    info->pendingUrl = doc->url();
+    info->pendingSessionConfig = cg.entryMap();
+    const bool closed = doc->closeUrl();
+    if (!closed) {
+        info->pendingUrl.clear();
+        info->pendingSessionConfig.clear();
+        m_hiddenDocuments.remove(doc);
+    }
+
+    emit documentHidden(doc);
+
+    if (!closed) {
+        emit documentExposed(doc);
+        return false;
+    }
+
+    indexDocument(doc);
+    return true;
+}
+
+void KateDocManager::setUnloadDocumentsAfter(int minutes)
+{
+    m_unloadAfter = minutes;
+    updateUnloadTimer();
+}
+
+void KateDocManager::setDocumentMemoryBudget(int mib)
+{
+    m_memoryBudget = mib;
+    updateUnloadTimer();
+}
+
+void KateDocManager::updateUnloadTimer()
+{
+    if (m_unloadAfter <= 0 && m_memoryBudget <= 0) {
+        m_unloadTimer.stop();
+    } else if (!m_unloadTimer.isActive()) {
+        m_unloadTimer.start();
+    }
+}
+
+void KateDocManager::unloadUnusedDocuments()
+{
+    const qint64 now = m_clock.elapsed();
+
+    // documents with a view are in use, the loaded others might be unloaded
+    QVector<KTextEditor::Document *> unused;
+    for (KTextEditor::Document *doc : qAsConst(m_docList)) {
+        if (!doc->views().isEmpty()) {
+            m_docInfos.value(doc)->lastUsed = now;
+        } else if (!isPending(doc)) {
+            unused.append(doc);
+        }
+    }
+
+    // least recently used first
+    std::sort(unused.begin(), unused.end(), [this](KTextEditor::Document *a, KTextEditor::Document *b) {
+        return m_docInfos.value(a)->lastUsed < m_docInfos.value(b)->lastUsed;
+    });
+
+    if (m_unloadAfter > 0) {
+        const qint64 idle = qint64(m_unloadAfter) * 60 * 1000;
+        for (KTextEditor::Document *doc : qAsConst(unused)) {
+            if (now - m_docInfos.value(doc)->lastUsed >= idle) {
+                unloadDocument(doc);
+            }
+        }
+    }
+
+    if (m_memoryBudget > 0) {
+        const qint64 budget = qint64(m_memoryBudget) * 1024 * 1024;
+        qint64 usage = totalMemoryUsage();
+        for (KTextEditor::Document *doc : qAsConst(unused)) {
+            if (usage <= budget) {
+                break;
+            }
+
+            const qint64 before = memoryUsage(doc);
+            if (unloadDocument(doc)) {
+                usage -= before - memoryUsage(doc);
+            }
+        }
+    }
+}
+
+void KateDocManager::prefetchNext()
+{
+    if (m_prefetchQueue.isEmpty()) {
+        return;
+    }
+
+    loadDocument(m_prefetchQueue.takeFirst());
+
+    if (!m_prefetchQueue.isEmpty()) {
+        m_prefetchTimer.start();
+    }
+}
+
 static QUrl normalizeUrl(const QUrl &url)
 {
     // Resolve symbolic links for local files (done anyway in KTextEditor)
@@ -117,25 +402,138 @@ static QUrl normalizeUrl(const QUrl &url)
     return url.adjusted(QUrl::NormalizePathSegments);
 }
 
+KateDocManager::ResolvedUrl KateDocManager::resolveUrl(const QUrl &url)
+{
+    ResolvedUrl resolved;
+
+    // same as normalizeUrl(), but keep the file info around
+    if (url.isLocalFile()) {
+        const QFileInfo fi(url.toLocalFile());
+        const QString canonicalPath = fi.canonicalFilePath();
+        if (!canonicalPath.isEmpty()) {
+            resolved.url = QUrl::fromLocalFile(canonicalPath);
+            resolved.lastModified = fi.lastModified();
+            return resolved;
+        }
+    }
+
+    resolved.url = url.adjusted(QUrl::NormalizePathSegments);
+    return resolved;
+}
+
+namespace
+{
+/**
+ * Resolves a slice of a batch of urls on the thread pool.
+ */
+class ResolveTask : public QRunnable
+{
+public:
+    ResolveTask(std::function<void()> function)
+        : m_function(std::move(function))
+    {
+    }
+
+    void run() override
+    {
+        m_function();
+    }
+
+private:
+    std::function<void()> m_function;
+};
+}
+
+QVector<KateDocManager::ResolvedUrl> KateDocManager::resolveUrls(const QList<QUrl> &urls)
+{
+    QVector<ResolvedUrl> resolved(urls.size());
+
+    // not worth the threads for the usual handful of files
+    const int SliceSize = 64;
+    if (urls.size() <= SliceSize) {
+        for (int i = 0; i < urls.size(); ++i) {
+            resolved[i] = resolveUrl(urls[i]);
+        }
+        return resolved;
+    }
+
+    // each task writes its own slice only
+    ResolvedUrl *results = resolved.data();
+    QThreadPool pool;
+    for (int begin = 0; begin < urls.size(); begin += SliceSize) {
+        const int end = std::min(begin + SliceSize, urls.size());
+        pool.start(new ResolveTask([&urls, results, begin, end]() {
+            for (int i = begin; i < end; ++i) {
+                results[i] = resolveUrl(urls.at(i));
+            }
+        }));
+    }
+    pool.waitForDone();
+
+    return resolved;
+}
+
 KTextEditor::Document *KateDocManager::findDocument(const QUrl &url) const
 {
-    const QUrl u(normalizeUrl(url));
-    for (KTextEditor::Document *it : m_docList) {
-        if (it->url() == u) {
-            return it;
+    return m_urlToDoc.value(normalizeUrl(url));
+}
+
+void KateDocManager::indexDocument(KTextEditor::Document *doc)
+{
+    const QUrl url = documentUrl(doc);
+    auto it = m_docToUrl.constFind(doc);
+    if (it != m_docToUrl.constEnd() && it.value() == url) {
+        return;
+    }
+
+    unindexDocument(doc);
+
+    // untitled documents are never found by url
+    if (url.isEmpty()) {
+        return;
+    }
+
+    m_docToUrl.insert(doc, url);
+    if (!m_urlToDoc.contains(url)) {
+        m_urlToDoc.insert(url, doc);
+    }
+}
+
+void KateDocManager::unindexDocument(KTextEditor::Document *doc)
+{
+    auto it = m_docToUrl.find(doc);
+    if (it == m_docToUrl.end()) {
+        return;
+    }
+
+    const QUrl url = it.value();
+    m_docToUrl.erase(it);
+
+    if (m_urlToDoc.value(url) != doc) {
+        return;
+    }
+    m_urlToDoc.remove(url);
+
+    // rare: another document has the same url, e.g. after save as
+    for (KTextEditor::Document *other : qAsConst(m_docList)) {
+        if (other != doc && m_docToUrl.value(other) == url) {
+            m_urlToDoc.insert(url, other);
+            break;
         }
     }
-    return nullptr;
 }
 
 QList<KTextEditor::Document *> KateDocManager::openUrls(const QList<QUrl> &urls, const QString &encoding, bool isTempFile, const KateDocumentInfo &docInfo)
 {
+    const QVector<ResolvedUrl> resolved = resolveUrls(urls);
+
     QList<KTextEditor::Document *> docs;
+    docs.reserve(resolved.size());
 
     emit aboutToCreateDocuments();
 
-    for (const QUrl &url : urls) {
-        docs << openUrl(url, encoding, isTempFile, docInfo);
+    for (const ResolvedUrl &url : resolved) {
+        docs << openResolvedUrl(url, encoding, isTempFile, docInfo, false);
     }
 
     emit documentsCreated(docs);
@@ -144,60 +542,85 @@ QList<KTextEditor::Document *> KateDocManager::openUrls(const QList<QUrl> &urls,
 }
 
 KTextEditor::Document *KateDocManager::openUrl(const QUrl &url, const QString &encoding, bool isTempFile, const KateDocumentInfo &docInfo)
+{
+    return openResolvedUrl(resolveUrl(url), encoding, isTempFile, docInfo, true);
+}
+
+KTextEditor::Document *KateDocManager::openResolvedUrl(const ResolvedUrl &url, const QString &encoding, bool isTempFile, const KateDocumentInfo &docInfo, bool load)
 {
     // special handling: if only one unmodified empty buffer in the list,
     // keep this buffer in mind to close it after opening the new url
     KTextEditor::Document *untitledDoc = nullptr;
-    if ((documentList().count() == 1) && (!documentList().at(0)->isModified() && documentList().at(0)->url().isEmpty())) {
+    if ((documentList().count() == 1) && (!documentList().at(0)->isModified() && documentList().at(0)->url().isEmpty() && !isPending(documentList().at(0)))) {
         untitledDoc = documentList().first();
     }
 
     //
     // create new document
     //
-    const QUrl u(normalizeUrl(url));
+    const QUrl &u = url.url;
     KTextEditor::Document *doc = nullptr;
 
     // always new document if url is empty...
     if (!u.isEmpty()) {
-        doc = findDocument(u);
+        doc = m_urlToDoc.value(u);
+
+        // the document might not be loaded yet
+        if (load) {
+            loadDocument(doc);
+        }
     }
 
     if (!doc) {
+        // documents of a batch are loaded once they are shown,
+        // the untitled document is shown already
+        KateDocumentInfo info(docInfo);
+        const bool pending = !load && !u.isEmpty() && !untitledDoc;
+        if (pending) {
+            info.pendingUrl = u;
+            info.pendingEncoding = encoding;
+        }
+
         if (untitledDoc) {
             // reuse the untitled document which is not needed
-            auto &info = m_docInfos.find(untitledDoc).value();
-            delete info;
-            info = new KateDocumentInfo(docInfo);
+            *m_docInfos.value(untitledDoc) = info;
             doc = untitledDoc;
+            indexDocument(doc);
         } else {
-            doc = createDoc(docInfo);
+            doc = createDoc(info);
         }
 
-        if (!encoding.isEmpty()) {
-            doc->setEncoding(encoding);
-        }
+        if (!pending) {
+            if (!encoding.isEmpty()) {
+                doc->setEncoding(encoding);
+            }
 
-        if (!u.isEmpty()) {
-            doc->openUrl(u);
-            loadMetaInfos(doc, u);
+            if (!u.isEmpty()) {
+                doc->openUrl(u);
+                loadMetaInfos(doc, u);
+            }
         }
     }
 
     //
     // if needed, register as temporary file
     //
-    if (isTempFile && u.isLocalFile()) {
-        QFileInfo fi(u.toLocalFile());
-        if (fi.exists()) {
-            m_tempFiles[doc] = qMakePair(u, fi.lastModified());
-            qCDebug(LOG_KATE) << "temporary file will be deleted after use unless modified: " << u;
-        }
+    if (isTempFile && u.isLocalFile() && url.lastModified.isValid()) {
+        m_tempFiles[doc] = qMakePair(u, url.lastModified);
+        qCDebug(LOG_KATE) << "temporary file will be deleted after use unless modified: " << u;
     }
 
     return doc;
 }
 
+void KateDocManager::setTemporaryFile(KTextEditor::Document *doc)
+{
+    const QUrl url = doc->url();
+    if (url.isLocalFile()) {
+        m_tempFiles[doc] = qMakePair(url, QFileInfo(url.toLocalFile()).lastModified());
+    }
+}
+
 bool KateDocManager::closeDocuments(const QList<KTextEditor::Document *> &documents, bool closeUrl)
 {
     if (documents.isEmpty()) {
@@ -235,15 +658,24 @@ bool KateDocManager::closeDocuments(const QList<KTextEditor::Document *> &docume
 
         KateApp::self()->emitDocumentClosed(QString::number(reinterpret_cast<qptrdiff>(doc)));
 
-        // document will be deleted, soon
+        // document will be deleted, soon, plugins never saw it if it was not loaded
+        const bool exposed = !m_hiddenDocuments.remove(doc);
+        if (exposed) {
+            emit documentWillBeHidden(doc);
+        }
         emit documentWillBeDeleted(doc);
 
         // really delete the document and its infos
+        m_prefetchQueue.removeAll(doc);
+        unindexDocument(doc);
         delete m_docInfos.take(doc);
         delete m_docList.takeAt(m_docList.indexOf(doc));
 
         // document is gone, emit our signals
         emit documentDeleted(doc);
+        if (exposed) {
+            emit documentHidden(doc);
+        }
 
         last++;
     }
@@ -418,13 +850,29 @@ void KateDocManager::saveDocumentList(KConfig *config)
     int i = 0;
     for (KTextEditor::Document *doc : qAsConst(m_docList)) {
         KConfigGroup cg(config, QStringLiteral("Document %1").arg(i));
-        doc->writeSessionConfig(cg);
+
+        // documents not loaded yet keep the config they were restored with
+        const KateDocumentInfo *info = m_docInfos.value(doc);
+        if (info && !info->pendingSessionConfig.isEmpty()) {
+            for (auto it = info->pendingSessionConfig.cbegin(); it != info->pendingSessionConfig.cend(); ++it) {
+                cg.writeEntry(it.key(), it.value());
+            }
+        } else if (info && !info->pendingUrl.isEmpty()) {
+            cg.writeEntry("URL", info->pendingUrl.toString());
+            if (!info->pendingEncoding.isEmpty()) {
+                cg.writeEntry("Encoding", info->pendingEncoding);
+            }
+        } else {
+            doc->writeSessionConfig(cg);
+        }
         i++;
     }
 }
 
 void KateDocManager::restoreDocumentList(KConfig *config)
 {
+    KateTraceScope trace("phase", QStringLiteral("KateDocManager::restoreDocumentList"));
+
     KConfigGroup openDocGroup(config, "Open Documents");
     unsigned int count = openDocGroup.readEntry("Count", 0);
 
@@ -432,29 +880,46 @@ void KateDocManager::restoreDocumentList(KConfig *config)
         return;
     }
 
-    QProgressDialog progress;
-    progress.setWindowTitle(i18n("Starting Up"));
-    progress.setLabelText(i18n("Reopening files from the last session..."));
-    progress.setModal(true);
-    progress.setCancelButton(nullptr);
-    progress.setRange(0, count);
+    QList<KConfigGroup> groups;
+    QList<QUrl> urls;
+    for (unsigned int i = 0; i < count; i++) {
+        groups.append(KConfigGroup(config, QStringLiteral("Document %1").arg(i)));
+        urls.append(QUrl(groups.last().readEntry("URL")));
+    }
+
+    const QVector<ResolvedUrl> resolved = resolveUrls(urls);
 
     for (unsigned int i = 0; i < count; i++) {
-        KConfigGroup cg(config, QStringLiteral("Document %1").arg(i));
+        const KConfigGroup &cg = groups.at(i);
+
+        // documents with an url are only loaded once they are shown, see loadDocument()
+        KateDocumentInfo info;
+        if (!urls.at(i).isEmpty()) {
+            info.pendingUrl = resolved.at(i).url;
+            info.pendingSessionConfig = cg.entryMap();
+        }
+
         KTextEditor::Document *doc = nullptr;
 
         if (i == 0) {
             doc = m_docList.first();
+            *documentInfo(doc) = info;
+            indexDocument(doc);
+
+            // this document might be shown already, e.g. when switching sessions
+            loadDocument(doc);
         } else {
-            doc = createDoc();
+            doc = createDoc(info);
+        }
+
+        if (!info.pendingUrl.isEmpty()) {
+            continue;
         }
 
         connect(doc, SIGNAL(completed()), this, SLOT(documentOpened()));
         connect(doc, &KParts::ReadOnlyPart::canceled, this, &KateDocManager::documentOpened);
 
         doc->readSessionConfig(cg);
-
-        progress.setValue(i);
     }
 }
 
@@ -467,6 +932,27 @@ void KateDocManager::slotModifiedOnDisc(KTextEditor::Document *doc, bool b, KTex
     }
 }
 
+/**
+ * The session config of a document is stored as the map of its entries.
+ */
+static QByteArray encodeSessionConfig(const QMap<QString, QString> &entries)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << entries;
+    return data;
+}
+
+static void decodeSessionConfig(const QByteArray &data, KConfigGroup &cg)
+{
+    QMap<QString, QString> entries;
+    QDataStream stream(data);
+    stream >> entries;
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+        cg.writeEntry(it.key(), it.value());
+    }
+}
+
 /**
  * Load file's meta-information if the checksum didn't change since last time.
  */
@@ -476,17 +962,20 @@ bool KateDocManager::loadMetaInfos(KTextEditor::Document *doc, const QUrl &url)
         return false;
     }
 
-    if (!m_metaInfos.hasGroup(url.toDisplayString())) {
+    if (!m_metaInfos.contains(url)) {
         return false;
     }
 
     const QByteArray checksum = doc->checksum().toHex();
     bool ok = true;
     if (!checksum.isEmpty()) {
-        KConfigGroup urlGroup(&m_metaInfos, url.toDisplayString());
-        const QString old_checksum = urlGroup.readEntry("Checksum");
+        const KateMetaInfoStore::Entry entry = m_metaInfos.value(url);
+
+        if (checksum == entry.checksum) {
+            KConfig config(QString(), KConfig::SimpleConfig);
+            KConfigGroup urlGroup(&config, "Document");
+            decodeSessionConfig(entry.data, urlGroup);
 
-        if (QString::fromLatin1(checksum) == old_checksum) {
             QSet<QString> flags;
             if (documentInfo(doc)->openedByUser) {
                 flags << QStringLiteral("SkipEncoding");
@@ -494,11 +983,9 @@ bool KateDocManager::loadMetaInfos(KTextEditor::Document *doc, const QUrl &url)
             flags << QStringLiteral("SkipUrl");
             doc->readSessionConfig(urlGroup, flags);
         } else {
-            urlGroup.deleteGroup();
+            m_metaInfos.remove(url);
             ok = false;
         }
-
-        m_metaInfos.sync();
     }
 
     return ok && doc->url() == url;
@@ -532,23 +1019,60 @@ void KateDocManager::saveMetaInfos(const QList<KTextEditor::Document *> &documen
         const QByteArray checksum = doc->checksum().toHex();
         if (!checksum.isEmpty()) {
             /**
-             * write the group with checksum and time
+             * write document session config
              */
-            KConfigGroup urlGroup(&m_metaInfos, doc->url().toString());
-            urlGroup.writeEntry("Checksum", QString::fromLatin1(checksum));
-            urlGroup.writeEntry("Time", now);
+            KConfig config(QString(), KConfig::SimpleConfig);
+            KConfigGroup urlGroup(&config, "Document");
+            doc->writeSessionConfig(urlGroup);
 
             /**
-             * write document session config
+             * store it with checksum and time, the store writes it to disk later on
              */
-            doc->writeSessionConfig(urlGroup);
+            KateMetaInfoStore::Entry entry;
+            entry.checksum = checksum;
+            entry.time = now;
+            entry.data = encodeSessionConfig(urlGroup.entryMap());
+            m_metaInfos.insert(doc->url(), entry);
         }
     }
+}
 
-    /**
-     * sync to not loose data
-     */
-    m_metaInfos.sync();
+/**
+ * Older versions kept the meta-information in a config file, one group per url.
+ */
+void KateDocManager::importMetaInfos()
+{
+    const QString fileName = QStandardPaths::locate(QStandardPaths::GenericConfigLocation, QStringLiteral("katemetainfos"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    const KConfig oldMetaInfos(fileName, KConfig::SimpleConfig);
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const QStringList groups = oldMetaInfos.groupList();
+    for (const QString &group : groups) {
+        const KConfigGroup urlGroup(&oldMetaInfos, group);
+
+        QMap<QString, QString> entries = urlGroup.entryMap();
+        entries.remove(QStringLiteral("Checksum"));
+        entries.remove(QStringLiteral("Time"));
+
+        KateMetaInfoStore::Entry entry;
+        entry.checksum = urlGroup.readEntry("Checksum").toLatin1();
+        entry.time = urlGroup.readEntry("Time", now);
+        entry.data = encodeSessionConfig(entries);
+        m_metaInfos.insert(QUrl(group), entry);
+    }
+
+    // import only once, the old file is kept under another name
+    m_metaInfos.flush();
+    m_metaInfos.waitForFlushed();
+
+    const QString importedName = fileName + QStringLiteral(".imported");
+    QFile::remove(importedName);
+    if (!QFile::rename(fileName, importedName)) {
+        qCWarning(LOG_KATE) << "Unable to rename imported meta infos" << fileName;
+    }
 }
 
 void KateDocManager::slotModChanged(KTextEditor::Document *doc)
@@ -8,17 +8,24 @@
 #ifndef __KATE_DOCMANAGER_H__
 #define __KATE_DOCMANAGER_H__
 
+#include "katemetainfostore.h"
+
 #include <ktexteditor/document.h>
 #include <ktexteditor/editor.h>
 #include <ktexteditor/modificationinterface.h>
 
 #include <QByteArray>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QList>
 #include <QMap>
 #include <QObject>
 #include <QPair>
+#include <QSet>
+#include <QTimer>
+#include <QUrl>
+#include <QVector>
 
 #include <KConfig>
 
@@ -37,6 +44,20 @@ public:
 
     bool openedByUser = false;
     bool openSuccess = true;
+
+    /**
+     * Documents of a restored session or of a batch of opened urls are only
+     * loaded once they are needed. Until then the document is empty and these
+     * hold its url and its session config, or the encoding to open it with.
+     */
+    QUrl pendingUrl;
+    QMap<QString, QString> pendingSessionConfig;
+    QString pendingEncoding;
+
+    /**
+     * When the document last had a view, on the clock of the document manager.
+     */
+    qint64 lastUsed = 0;
 };
 
 class KateDocManager : public QObject
@@ -51,6 +72,50 @@ public:
 
     KateDocumentInfo *documentInfo(KTextEditor::Document *doc);
 
+    /**
+     * Load @p doc if it was restored from a session and is not loaded yet.
+     * Called before the first view of a document is created.
+     */
+    void loadDocument(KTextEditor::Document *doc);
+
+    /**
+     * @return true if @p doc was restored from a session and is not loaded yet
+     */
+    bool isPending(KTextEditor::Document *doc) const;
+
+    /**
+     * Url and name of @p doc, these are known for documents not loaded yet, too.
+     */
+    QUrl documentUrl(KTextEditor::Document *doc) const;
+    QString documentName(KTextEditor::Document *doc) const;
+
+    /**
+     * Load the first getPrefetchDocuments() documents of @p docs one by one
+     * while the event loop is idle, the ones already loaded are skipped.
+     */
+    void prefetchDocuments(const QVector<KTextEditor::Document *> &docs);
+
+    /**
+     * Rough estimate in bytes of the memory used by @p doc: its text, the
+     * per line highlighting and folding state and its marks. The undo history
+     * and the moving ranges are not accessible and not accounted for.
+     * Documents not loaded yet only count with the fixed overhead.
+     */
+    qint64 memoryUsage(KTextEditor::Document *doc) const;
+
+    /**
+     * Sum of memoryUsage() of all documents.
+     */
+    qint64 totalMemoryUsage() const;
+
+    /**
+     * Turn @p doc back into a document which is loaded once it is shown again,
+     * see loadDocument(). Only unmodified documents without a view are unloaded.
+     * Plugins see the document go away until then, see documentHidden().
+     * @return true if the document was unloaded
+     */
+    bool unloadDocument(KTextEditor::Document *doc);
+
     /** Returns the documentNumber of the doc with url URL or -1 if no such doc is found */
     KTextEditor::Document *findDocument(const QUrl &url) const;
 
@@ -59,10 +124,27 @@ public:
         return m_docList;
     }
 
+    /**
+     * All documents but the ones not loaded yet. Plugins only get to see
+     * these through the KTextEditor API, the others are empty placeholders.
+     */
+    QList<KTextEditor::Document *> loadedDocuments() const;
+
     KTextEditor::Document *openUrl(const QUrl &, const QString &encoding = QString(), bool isTempFile = false, const KateDocumentInfo &docInfo = KateDocumentInfo());
 
+    /**
+     * Open a batch of urls. The local files are resolved in parallel and the
+     * documents are only loaded once they are shown, see loadDocument().
+     * documentsCreated() is emitted once for the whole batch.
+     */
     QList<KTextEditor::Document *> openUrls(const QList<QUrl> &, const QString &encoding = QString(), bool isTempFile = false, const KateDocumentInfo &docInfo = KateDocumentInfo());
 
+    /**
+     * Delete the file of @p doc once it is closed, unless it was modified
+     * meanwhile, like the files opened with --tempfile.
+     */
+    void setTemporaryFile(KTextEditor::Document *doc);
+
     bool closeDocument(KTextEditor::Document *, bool closeUrl = true);
     bool closeDocuments(const QList<KTextEditor::Document *> &documents, bool closeUrl = true);
     bool closeDocumentList(const QList<KTextEditor::Document *> &documents);
@@ -93,6 +175,33 @@ public:
         m_daysMetaInfos = i;
     }
 
+    inline int getPrefetchDocuments()
+    {
+        return m_prefetchDocuments;
+    }
+    inline void setPrefetchDocuments(int i)
+    {
+        m_prefetchDocuments = i;
+    }
+
+    /**
+     * Unload unused documents after that many minutes, 0 to never unload them.
+     */
+    inline int getUnloadDocumentsAfter()
+    {
+        return m_unloadAfter;
+    }
+    void setUnloadDocumentsAfter(int minutes);
+
+    /**
+     * Unload unused documents while all together use more than that many MiB, 0 for no limit.
+     */
+    inline int getDocumentMemoryBudget()
+    {
+        return m_memoryBudget;
+    }
+    void setDocumentMemoryBudget(int mib);
+
 public Q_SLOTS:
     /**
      * saves all documents that has at least one view.
@@ -145,6 +254,15 @@ Q_SIGNALS:
      */
     void documentDeleted(KTextEditor::Document *document);
 
+    /**
+     * The KTextEditor API counterparts of documentCreated(), documentWillBeDeleted()
+     * and documentDeleted(). Documents not loaded yet are kept from plugins, for
+     * them documentExposed() is only emitted once they are loaded.
+     */
+    void documentExposed(KTextEditor::Document *document);
+    void documentWillBeHidden(KTextEditor::Document *document);
+    void documentHidden(KTextEditor::Document *document);
+
     /**
      * This signal is emitted before the batch of documents is being created.
      *
@@ -179,18 +297,58 @@ private Q_SLOTS:
     void slotModifiedOnDisc(KTextEditor::Document *doc, bool b, KTextEditor::ModificationInterface::ModifiedOnDiskReason reason);
     void slotModChanged(KTextEditor::Document *doc);
     void slotModChanged1(KTextEditor::Document *doc);
+    void prefetchNext();
+    void unloadUnusedDocuments();
 
 private:
+    /**
+     * Normalized url, plus the modification time for existing local files.
+     * Resolving involves syscalls, so it is done off the GUI thread for batches.
+     */
+    struct ResolvedUrl {
+        QUrl url;
+        QDateTime lastModified;
+    };
+    static ResolvedUrl resolveUrl(const QUrl &url);
+    static QVector<ResolvedUrl> resolveUrls(const QList<QUrl> &urls);
+
+    KTextEditor::Document *openResolvedUrl(const ResolvedUrl &url, const QString &encoding, bool isTempFile, const KateDocumentInfo &docInfo, bool load);
+
+    /**
+     * Keep the url index in sync with the url of @p doc
+     */
+    void indexDocument(KTextEditor::Document *doc);
+    void unindexDocument(KTextEditor::Document *doc);
+
+    void updateUnloadTimer();
+
     bool loadMetaInfos(KTextEditor::Document *doc, const QUrl &url);
     void saveMetaInfos(const QList<KTextEditor::Document *> &docs);
+    void importMetaInfos();
 
     QList<KTextEditor::Document *> m_docList;
     QHash<KTextEditor::Document *, KateDocumentInfo *> m_docInfos;
 
-    KConfig m_metaInfos;
+    // normalized url => first document with that url, and the reverse mapping
+    QHash<QUrl, KTextEditor::Document *> m_urlToDoc;
+    QHash<KTextEditor::Document *, QUrl> m_docToUrl;
+
+    KateMetaInfoStore m_metaInfos;
     bool m_saveMetaInfos;
     int m_daysMetaInfos;
 
+    int m_prefetchDocuments;
+    QVector<KTextEditor::Document *> m_prefetchQueue;
+    // pending documents, which were not exposed to plugins yet
+    QSet<KTextEditor::Document *> m_hiddenDocuments;
+    QTimer m_prefetchTimer;
+
+    // the documents with a view are marked as used on each check
+    int m_unloadAfter = 0;
+    int m_memoryBudget = 0;
+    QElapsedTimer m_clock;
+    QTimer m_unloadTimer;
+
     typedef QPair<QUrl, QDateTime> TPair;
     QMap<KTextEditor::Document *, TPair> m_tempFiles;
 
@@ -600,6 +600,9 @@ void KateMainWindow::readOptions()
     m_modCloseAfterLast = generalGroup.readEntry("Close After Last", false);
     KateApp::self()->documentManager()->setSaveMetaInfos(generalGroup.readEntry("Save Meta Infos", true));
     KateApp::self()->documentManager()->setDaysMetaInfos(generalGroup.readEntry("Days Meta Infos", 30));
+    KateApp::self()->documentManager()->setPrefetchDocuments(generalGroup.readEntry("Prefetch Documents", 0));
+    KateApp::self()->documentManager()->setUnloadDocumentsAfter(generalGroup.readEntry("Unload Documents After", 0));
+    KateApp::self()->documentManager()->setDocumentMemoryBudget(generalGroup.readEntry("Document Memory Budget", 0));
 
     m_paShowPath->setChecked(generalGroup.readEntry("Show Full Path in Title", false));
     m_paShowStatusBar->setChecked(generalGroup.readEntry("Show Status Bar", true));
@@ -625,6 +628,11 @@ void KateMainWindow::saveOptions()
 
     generalGroup.writeEntry("Days Meta Infos", KateApp::self()->documentManager()->getDaysMetaInfos());
 
+    generalGroup.writeEntry("Prefetch Documents", KateApp::self()->documentManager()->getPrefetchDocuments());
+
+    generalGroup.writeEntry("Unload Documents After", KateApp::self()->documentManager()->getUnloadDocumentsAfter());
+    generalGroup.writeEntry("Document Memory Budget", KateApp::self()->documentManager()->getDocumentMemoryBudget());
+
     generalGroup.writeEntry("Show Full Path in Title", m_paShowPath->isChecked());
     generalGroup.writeEntry("Show Status Bar", m_paShowStatusBar->isChecked());
     generalGroup.writeEntry("Show Menu Bar", m_paShowMenuBar->isChecked());
@@ -844,6 +844,11 @@ ToolView *MainWindow::toolView(const QString &identifier) const
     return m_idToWidget[identifier];
 }
 
+KMultiTabBar::KMultiTabBarPosition MainWindow::toolViewPosition(ToolView *widget) const
+{
+    return widget->sidebar()->position();
+}
+
 void MainWindow::toolViewDeleted(ToolView *widget)
 {
     if (!widget) {
@@ -294,6 +294,13 @@ public:
      */
     ToolView *toolView(const QString &identifier) const;
 
+    /**
+     * sidebar the given toolview is in
+     * @param widget toolview
+     * @return position of its sidebar
+     */
+    KMultiTabBar::KMultiTabBarPosition toolViewPosition(ToolView *widget) const;
+
     /**
      * set the toolview's tabbar style.
      * @param style the tabbar style.
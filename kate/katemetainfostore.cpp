@@ -0,0 +1,308 @@
+/* This file is part of the KDE project
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#include "katemetainfostore.h"
+
+#include "katedebug.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <functional>
+
+namespace
+{
+const quint32 Magic = 0x314d4b4b; // "KKM1"
+
+// magic + version
+const int HeaderSize = 8;
+const quint32 Version = 1;
+
+// size, key, time, checksum size, data size
+const int RecordOverhead = 4 + 8 + 8 + 4 + 4;
+
+// rewrite the file once it is more than twice as large as needed
+const int CompactionFactor = 2;
+const qint64 MinCompactionSize = 64 * 1024;
+
+const int FlushDelay = 2000;
+
+qint64 recordSize(const KateMetaInfoStore::Entry &entry)
+{
+    return RecordOverhead + entry.checksum.size() + entry.data.size();
+}
+
+/**
+ * A record without checksum removes the key.
+ */
+void writeRecord(QByteArray &buffer, quint64 key, const KateMetaInfoStore::Entry &entry)
+{
+    QDataStream stream(&buffer, QIODevice::WriteOnly | QIODevice::Append);
+    stream << quint32(recordSize(entry) - 4) << key << (entry.time.isValid() ? entry.time.toMSecsSinceEpoch() : qint64(0));
+    stream.writeBytes(entry.checksum.constData(), entry.checksum.size());
+    stream.writeBytes(entry.data.constData(), entry.data.size());
+}
+
+QByteArray header()
+{
+    QByteArray buffer;
+    QDataStream stream(&buffer, QIODevice::WriteOnly);
+    stream << Magic << Version;
+    return buffer;
+}
+
+class WriteTask : public QRunnable
+{
+public:
+    WriteTask(std::function<void()> function)
+        : m_function(std::move(function))
+    {
+    }
+
+    void run() override
+    {
+        m_function();
+    }
+
+private:
+    std::function<void()> m_function;
+};
+}
+
+KateMetaInfoStore::KateMetaInfoStore(const QString &fileName, QObject *parent)
+    : QObject(parent)
+    , m_fileName(fileName)
+{
+    m_writer.setMaxThreadCount(1);
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FlushDelay);
+    connect(&m_flushTimer, &QTimer::timeout, this, &KateMetaInfoStore::flush);
+
+    load();
+}
+
+KateMetaInfoStore::~KateMetaInfoStore()
+{
+    flush();
+    waitForFlushed();
+}
+
+quint64 KateMetaInfoStore::key(const QUrl &url)
+{
+    // must be stable across runs, unlike qHash
+    const QByteArray hash = QCryptographicHash::hash(url.toString().toUtf8(), QCryptographicHash::Sha1);
+    return qFromBigEndian<quint64>(reinterpret_cast<const uchar *>(hash.constData()));
+}
+
+bool KateMetaInfoStore::contains(const QUrl &url) const
+{
+    return m_entries.contains(key(url));
+}
+
+KateMetaInfoStore::Entry KateMetaInfoStore::value(const QUrl &url) const
+{
+    return m_entries.value(key(url));
+}
+
+int KateMetaInfoStore::size() const
+{
+    return m_entries.size();
+}
+
+void KateMetaInfoStore::insert(const QUrl &url, const Entry &entry)
+{
+    if (entry.checksum.isEmpty()) {
+        remove(url);
+        return;
+    }
+    append(key(url), entry);
+}
+
+void KateMetaInfoStore::remove(const QUrl &url)
+{
+    const quint64 k = key(url);
+    if (m_entries.contains(k)) {
+        append(k, Entry());
+    }
+}
+
+void KateMetaInfoStore::removeOlderThan(const QDateTime &time)
+{
+    bool removed = false;
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->time < time) {
+            m_liveSize -= recordSize(it.value());
+            it = m_entries.erase(it);
+            removed = true;
+        } else {
+            ++it;
+        }
+    }
+
+    // no need for a removal record each, rewrite the file
+    if (removed) {
+        compact();
+    }
+}
+
+void KateMetaInfoStore::append(quint64 key, const Entry &entry)
+{
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        m_liveSize -= recordSize(it.value());
+    }
+
+    if (entry.checksum.isEmpty()) {
+        if (it != m_entries.end()) {
+            m_entries.erase(it);
+        }
+    } else {
+        m_entries.insert(key, entry);
+        m_liveSize += recordSize(entry);
+    }
+
+    const int before = m_pending.size();
+    writeRecord(m_pending, key, entry);
+    m_fileSize += m_pending.size() - before;
+
+    scheduleFlush();
+}
+
+void KateMetaInfoStore::scheduleFlush()
+{
+    if (!m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+void KateMetaInfoStore::flush()
+{
+    m_flushTimer.stop();
+
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    if (m_fileSize > MinCompactionSize && m_fileSize > CompactionFactor * (HeaderSize + m_liveSize)) {
+        compact();
+        return;
+    }
+
+    const QString fileName = m_fileName;
+    const QByteArray data = m_pending;
+    m_pending.clear();
+
+    m_writer.start(new WriteTask([fileName, data]() {
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            qCWarning(LOG_KATE) << "Unable to write meta infos" << fileName << file.errorString();
+            return;
+        }
+        if (file.size() == 0) {
+            file.write(header());
+        }
+        file.write(data);
+    }));
+}
+
+void KateMetaInfoStore::compact()
+{
+    m_flushTimer.stop();
+    m_pending.clear();
+    m_fileSize = HeaderSize + m_liveSize;
+
+    // the hash is implicitly shared, the copy is cheap and safe to read from the writer
+    const QString fileName = m_fileName;
+    const QHash<quint64, Entry> entries = m_entries;
+
+    m_writer.start(new WriteTask([fileName, entries]() {
+        QByteArray data = header();
+        for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+            writeRecord(data, it.key(), it.value());
+        }
+
+        QSaveFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+            qCWarning(LOG_KATE) << "Unable to write meta infos" << fileName << file.errorString();
+        }
+    }));
+}
+
+void KateMetaInfoStore::waitForFlushed()
+{
+    m_writer.waitForDone();
+}
+
+void KateMetaInfoStore::load()
+{
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+
+    // the header is written along with the first record
+    m_fileSize = HeaderSize;
+
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    const QByteArray data = file.readAll();
+    file.close();
+
+    QDataStream stream(data);
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != Magic || version != Version) {
+        // unknown format, start over
+        qCWarning(LOG_KATE) << "Ignoring meta infos of unknown format" << m_fileName;
+        QFile::remove(m_fileName);
+        return;
+    }
+
+    qint64 valid = HeaderSize;
+    while (data.size() - valid >= 4) {
+        quint32 size = 0;
+        stream >> size;
+        if (size < RecordOverhead - 4 || data.size() - valid - 4 < size) {
+            break;
+        }
+
+        quint64 key = 0;
+        qint64 time = 0;
+        Entry entry;
+        stream >> key >> time >> entry.checksum >> entry.data;
+        if (stream.status() != QDataStream::Ok || stream.device()->pos() != valid + 4 + size) {
+            break;
+        }
+
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            m_liveSize -= recordSize(it.value());
+            m_entries.erase(it);
+        }
+        if (!entry.checksum.isEmpty()) {
+            entry.time = QDateTime::fromMSecsSinceEpoch(time, Qt::UTC);
+            m_entries.insert(key, entry);
+            m_liveSize += recordSize(entry);
+        }
+
+        valid += 4 + size;
+    }
+
+    // drop a record cut off by a crash, later records are appended to the valid part
+    if (valid < data.size()) {
+        qCWarning(LOG_KATE) << "Truncating damaged meta infos" << m_fileName;
+        QFile::resize(m_fileName, valid);
+    }
+    m_fileSize = valid;
+}
@@ -0,0 +1,92 @@
+/* This file is part of the KDE project
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#ifndef KATE_METAINFOSTORE_H
+#define KATE_METAINFOSTORE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <QUrl>
+
+/**
+ * Persistent store of the per file meta information, e.g. bookmarks.
+ *
+ * All entries are kept in a hash keyed by a hash of the url, so lookups
+ * never touch the disk. The file is an append only log of records; it is
+ * written from a worker thread, a little after the last change, and
+ * rewritten with only the live records once most of it is garbage.
+ */
+class KateMetaInfoStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry {
+        QByteArray checksum;
+        QDateTime time;
+        QByteArray data;
+    };
+
+    explicit KateMetaInfoStore(const QString &fileName, QObject *parent = nullptr);
+
+    /**
+     * Writes what is still pending and waits for it.
+     */
+    ~KateMetaInfoStore() override;
+
+    static quint64 key(const QUrl &url);
+
+    bool contains(const QUrl &url) const;
+    Entry value(const QUrl &url) const;
+    int size() const;
+
+    void insert(const QUrl &url, const Entry &entry);
+    void remove(const QUrl &url);
+
+    /**
+     * Remove all entries last written before @p time.
+     */
+    void removeOlderThan(const QDateTime &time);
+
+    /**
+     * Hand the pending changes to the writer thread.
+     */
+    void flush();
+
+    /**
+     * Block until all flushed changes are on disk.
+     */
+    void waitForFlushed();
+
+private:
+    void load();
+    void append(quint64 key, const Entry &entry);
+    void scheduleFlush();
+    void compact();
+
+private:
+    const QString m_fileName;
+    QHash<quint64, Entry> m_entries;
+
+    // records not handed to the writer yet
+    QByteArray m_pending;
+
+    // size of the file once the writer is done, and what compaction would leave of it
+    qint64 m_fileSize = 0;
+    qint64 m_liveSize = 0;
+
+    QTimer m_flushTimer;
+
+    // a single thread, so the writes are done in order
+    QThreadPool m_writer;
+};
+
+#endif
@@ -11,17 +11,113 @@
 #include "kateapp.h"
 #include "katedebug.h"
 #include "katemainwindow.h"
+#include "katetrace.h"
 
 #include <KConfig>
 #include <KConfigGroup>
+#include <KLocalizedString>
 #include <KPluginFactory>
 #include <KPluginLoader>
 
+#include <KTextEditor/Command>
+#include <KTextEditor/Document>
+#include <KTextEditor/Editor>
+#include <KTextEditor/Message>
+#include <KTextEditor/View>
+
+#include <QAbstractEventDispatcher>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
+#include <QIcon>
+#include <QJsonArray>
+#include <QLabel>
+#include <QTimer>
 
 #include <ktexteditor/sessionconfiginterface.h>
 
+namespace
+{
+/**
+ * Activation triggers, e.g. "X-Kate-Activation=toolview:kateproject:left;mode:C++;command:grep;idle"
+ */
+QStringList activationTriggers(const KPluginMetaData &metaData)
+{
+    const QJsonValue value = metaData.rawData().value(QStringLiteral("X-Kate-Activation"));
+    if (value.isArray()) {
+        QStringList triggers;
+        const QJsonArray array = value.toArray();
+        for (const QJsonValue &trigger : array) {
+            triggers.append(trigger.toString());
+        }
+        return triggers;
+    }
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+    return value.toString().split(QLatin1Char(';'), QString::SkipEmptyParts);
+#else
+    return value.toString().split(QLatin1Char(';'), Qt::SkipEmptyParts);
+#endif
+}
+
+KTextEditor::MainWindow::ToolViewPosition positionFromName(const QString &name)
+{
+    if (name == QLatin1String("left")) {
+        return KTextEditor::MainWindow::Left;
+    } else if (name == QLatin1String("right")) {
+        return KTextEditor::MainWindow::Right;
+    } else if (name == QLatin1String("top")) {
+        return KTextEditor::MainWindow::Top;
+    }
+    return KTextEditor::MainWindow::Bottom;
+}
+
+/**
+ * Stands in for the commands of a plugin waiting for its triggers.
+ * The command is run once the plugin is loaded, it registers the real one.
+ */
+class CommandStub : public KTextEditor::Command
+{
+public:
+    CommandStub(const QString &command, const QString &plugin, KatePluginManager *manager)
+        : KTextEditor::Command(QStringList() << command, manager)
+        , m_plugin(plugin)
+        , m_manager(manager)
+    {
+    }
+
+    bool exec(KTextEditor::View *view, const QString &cmd, QString &, const KTextEditor::Range &range) override
+    {
+        // this stub is deleted when the plugin is loaded, not while it runs
+        const QPointer<KTextEditor::View> target(view);
+        const QString plugin = m_plugin;
+        KatePluginManager *manager = m_manager;
+        QTimer::singleShot(0, manager, [manager, plugin, target, cmd, range]() {
+            manager->activatePlugin(plugin);
+            KTextEditor::Command *command = KTextEditor::Editor::instance()->queryCommand(cmd);
+            if (!target || !command) {
+                return;
+            }
+            QString msg;
+            command->exec(target, cmd, msg, range);
+            if (!msg.isEmpty()) {
+                target->document()->postMessage(new KTextEditor::Message(msg, KTextEditor::Message::Information));
+            }
+        });
+        return true;
+    }
+
+    bool help(KTextEditor::View *, const QString &, QString &msg) override
+    {
+        msg = i18n("Loads the plugin providing this command first.");
+        return true;
+    }
+
+private:
+    const QString m_plugin;
+    KatePluginManager *const m_manager;
+};
+}
+
 QString KatePluginInfo::saveName() const
 {
     return QFileInfo(metaData.fileName()).baseName();
@@ -48,6 +144,8 @@ KatePluginManager::~KatePluginManager()
 
 void KatePluginManager::setupPluginList()
 {
+    KateTraceScope trace("phase", QStringLiteral("KatePluginManager::setupPluginList"));
+
     // activate a hand-picked list of plugins per default, give them a hand-picked sort order for loading
     const QMap<QString, int> defaultPlugins {
         {QStringLiteral("katefiletreeplugin"), -1000},
@@ -78,6 +176,7 @@ void KatePluginManager::setupPluginList()
 
         info.defaultLoad = defaultPlugins.contains(info.saveName());
         info.sortOrder = defaultPlugins.value(info.saveName());
+        info.triggers = activationTriggers(pluginMetaData);
         info.load = false;
         info.plugin = nullptr;
         m_pluginList.push_back(info);
@@ -96,6 +195,8 @@ void KatePluginManager::setupPluginList()
 
 void KatePluginManager::loadConfig(KConfig *config)
 {
+    KateTraceScope trace("phase", QStringLiteral("KatePluginManager::loadConfig"));
+
     // first: unload the plugins
     unloadAllPlugins();
 
@@ -116,6 +217,14 @@ void KatePluginManager::loadConfig(KConfig *config)
      */
     for (auto &pluginInfo : m_pluginList) {
         if (pluginInfo.load) {
+            // only stand-ins until one of the triggers fires
+            if (!pluginInfo.triggers.isEmpty()) {
+                deferPlugin(&pluginInfo, config);
+                continue;
+            }
+
+            KateTraceScope pluginTrace("plugin", pluginInfo.saveName(), QStringLiteral("load"));
+
             /**
              * load plugin + trigger update of GUI for already existing main windows
              */
@@ -129,6 +238,8 @@ void KatePluginManager::loadConfig(KConfig *config)
             }
         }
     }
+
+    scheduleIdleActivation();
 }
 
 void KatePluginManager::writeConfig(KConfig *config)
@@ -146,13 +257,21 @@ void KatePluginManager::writeConfig(KConfig *config)
             KConfigGroup group(config, QStringLiteral("Plugin:%1:").arg(saveName));
             interface->writeSessionConfig(group);
         }
+
+        // keep the config of plugins not loaded yet
+        for (auto it = plugin.pendingSessionConfig.cbegin(); it != plugin.pendingSessionConfig.cend(); ++it) {
+            KConfigGroup group(config, it.key());
+            for (auto entry = it.value().cbegin(); entry != it.value().cend(); ++entry) {
+                group.writeEntry(entry.key(), entry.value());
+            }
+        }
     }
 }
 
 void KatePluginManager::unloadAllPlugins()
 {
     for (auto &pluginInfo : m_pluginList) {
-        if (pluginInfo.plugin) {
+        if (pluginInfo.plugin || pluginInfo.pending) {
             unloadPlugin(&pluginInfo);
         }
     }
@@ -163,6 +282,13 @@ void KatePluginManager::enableAllPluginsGUI(KateMainWindow *win, KConfigBase *co
     for (auto &pluginInfo : m_pluginList) {
         if (pluginInfo.plugin) {
             enablePluginGUI(&pluginInfo, win, config);
+        } else if (pluginInfo.pending) {
+            // this window's config is the one to apply once loaded
+            const QString group = QStringLiteral("Plugin:%1:MainWindow:0").arg(pluginInfo.saveName());
+            if (config && config->hasGroup(group)) {
+                pluginInfo.pendingSessionConfig.insert(group, config->group(group).entryMap());
+            }
+            installToolViewStubs(&pluginInfo, win);
         }
     }
 }
@@ -178,6 +304,10 @@ void KatePluginManager::disableAllPluginsGUI(KateMainWindow *win)
 
 bool KatePluginManager::loadPlugin(KatePluginInfo *item)
 {
+    KateTraceScope trace("plugin", item->saveName(), QStringLiteral("constructor"));
+    QElapsedTimer timer;
+    timer.start();
+
     /**
      * try to load the plugin
      */
@@ -186,6 +316,7 @@ bool KatePluginManager::loadPlugin(KatePluginInfo *item)
         item->plugin = factory->create<KTextEditor::Plugin>(this, QVariantList() << item->saveName());
     }
     item->load = item->plugin != nullptr;
+    item->loadTime = item->plugin ? timer.elapsed() : -1;
 
     /**
      * tell the world about the success
@@ -199,6 +330,14 @@ bool KatePluginManager::loadPlugin(KatePluginInfo *item)
 
 void KatePluginManager::unloadPlugin(KatePluginInfo *item)
 {
+    if (item->pending) {
+        removeStubs(item);
+        item->pending = false;
+        item->pendingSessionConfig.clear();
+        item->load = false;
+        return;
+    }
+
     disablePluginGUI(item);
     delete item->plugin;
     KTextEditor::Plugin *plugin = item->plugin;
@@ -217,11 +356,16 @@ void KatePluginManager::enablePluginGUI(KatePluginInfo *item, KateMainWindow *wi
     // lookup if there is already a view for it..
     QObject *createdView = nullptr;
     if (!win->pluginViews().contains(item->plugin)) {
+        KateTraceScope trace("plugin", item->saveName(), QStringLiteral("createView"));
+        QElapsedTimer timer;
+        timer.start();
+
         // create the view + try to correctly load shortcuts, if it's a GUI Client
         createdView = item->plugin->createView(win->wrapper());
         if (createdView) {
             win->pluginViews().insert(item->plugin, createdView);
         }
+        item->loadTime += timer.elapsed();
     }
 
     // load session config if needed
@@ -293,8 +437,13 @@ KTextEditor::Plugin *KatePluginManager::plugin(const QString &name)
 
     /**
      * real plugin instance, if any ;)
+     * asking for it is reason enough to load one waiting for its triggers
      */
-    return m_name2Plugin.value(name)->plugin;
+    KatePluginInfo *info = m_name2Plugin.value(name);
+    if (info->pending) {
+        activatePlugin(info);
+    }
+    return info->plugin;
 }
 
 bool KatePluginManager::pluginAvailable(const QString &name)
@@ -314,7 +463,11 @@ class KTextEditor::Plugin *KatePluginManager::loadPlugin(const QString &name, bo
     /**
      * load, bail out on error
      */
-    loadPlugin(m_name2Plugin.value(name));
+    if (m_name2Plugin.value(name)->pending) {
+        activatePlugin(m_name2Plugin.value(name));
+    } else {
+        loadPlugin(m_name2Plugin.value(name));
+    }
     if (!m_name2Plugin.value(name)->plugin) {
         return nullptr;
     }
@@ -345,3 +498,208 @@ void KatePluginManager::unloadPlugin(const QString &name, bool permanent)
      */
     m_name2Plugin.value(name)->load = !permanent;
 }
+
+void KatePluginManager::deferPlugin(KatePluginInfo *item, KConfig *config)
+{
+    const QString name = item->saveName();
+    item->pending = true;
+    item->pendingSessionConfig.clear();
+
+    // applied once loaded, see activatePlugin()
+    const QStringList groups = {QStringLiteral("Plugin:%1:").arg(name), QStringLiteral("Plugin:%1:MainWindow:0").arg(name)};
+    for (const QString &group : groups) {
+        if (config && config->hasGroup(group)) {
+            item->pendingSessionConfig.insert(group, config->group(group).entryMap());
+        }
+    }
+
+    bool modeTriggers = false;
+    for (const QString &trigger : qAsConst(item->triggers)) {
+        if (trigger.startsWith(QLatin1String("command:"))) {
+            m_commandStubs.insert(name, new CommandStub(trigger.mid(8), name, this));
+        } else if (trigger == QLatin1String("idle")) {
+            m_idleQueue.append(name);
+        } else if (trigger.startsWith(QLatin1String("mode:"))) {
+            modeTriggers = true;
+        }
+    }
+
+    // windows created later get their stubs in enableAllPluginsGUI()
+    for (int i = 0; i < KateApp::self()->mainWindowsCount(); i++) {
+        installToolViewStubs(item, KateApp::self()->mainWindow(i));
+    }
+
+    // documents created later are checked in documentCreated()
+    if (modeTriggers) {
+        const auto documents = KateApp::self()->documentManager()->documentList();
+        for (auto document : documents) {
+            documentModeChanged(document);
+        }
+    }
+}
+
+void KatePluginManager::installToolViewStubs(KatePluginInfo *item, KateMainWindow *win)
+{
+    const QString name = item->saveName();
+    for (const QString &trigger : qAsConst(item->triggers)) {
+        // toolview:<identifier>:<left|right|top|bottom>, the identifier of one of the plugin's tool views
+        const QStringList parts = trigger.split(QLatin1Char(':'));
+        if (parts.value(0) != QLatin1String("toolview") || parts.value(1).isEmpty()) {
+            continue;
+        }
+
+        // it takes the place of the real one, so the session keeps its position and visibility
+        const QIcon icon = QIcon::fromTheme(item->metaData.iconName(), QIcon::fromTheme(QStringLiteral("preferences-plugin")));
+        QWidget *stub = win->createToolView(nullptr, parts.value(1), positionFromName(parts.value(2)), icon, item->metaData.name());
+        if (!stub) {
+            continue;
+        }
+        stub->setObjectName(parts.value(1));
+        new QLabel(i18n("Loading %1...", item->metaData.name()), stub);
+
+        m_toolViewStubs.insert(name, stub);
+        connect(static_cast<KateMDI::ToolView *>(stub), &KateMDI::ToolView::toolVisibleChanged, this, [this, name](bool visible) {
+            if (visible) {
+                requestActivation(name);
+            }
+        });
+    }
+}
+
+void KatePluginManager::removeStubs(KatePluginInfo *item)
+{
+    const QString name = item->saveName();
+    m_idleQueue.removeAll(name);
+
+    qDeleteAll(m_commandStubs.values(name));
+    m_commandStubs.remove(name);
+
+    // the windows may have deleted them already
+    const auto stubs = m_toolViewStubs.values(name);
+    for (const auto &stub : stubs) {
+        delete stub.data();
+    }
+    m_toolViewStubs.remove(name);
+}
+
+void KatePluginManager::requestActivation(const QString &name)
+{
+    // not from within the signal of a stub or document
+    QTimer::singleShot(0, this, [this, name]() {
+        activatePlugin(name);
+    });
+}
+
+bool KatePluginManager::activatePlugin(const QString &name)
+{
+    KatePluginInfo *info = m_name2Plugin.value(name);
+    return info && activatePlugin(info);
+}
+
+bool KatePluginManager::activatePlugin(KatePluginInfo *item)
+{
+    if (!item->pending) {
+        return item->plugin != nullptr;
+    }
+
+    KateTraceScope trace("plugin", item->saveName(), QStringLiteral("activate"));
+
+    // the plugin creates its tool views with the identifiers of the stubs, remember where they are
+    struct Place {
+        QPointer<KateMainWindow> window;
+        QString id;
+        KMultiTabBar::KMultiTabBarPosition position;
+        bool visible;
+    };
+    QVector<Place> places;
+    const auto stubs = m_toolViewStubs.values(item->saveName());
+    for (const auto &stub : stubs) {
+        auto toolView = qobject_cast<KateMDI::ToolView *>(stub.data());
+        auto window = toolView ? qobject_cast<KateMainWindow *>(toolView->window()) : nullptr;
+        if (window) {
+            places.append({window, toolView->objectName(), window->toolViewPosition(toolView), toolView->toolVisible()});
+        }
+    }
+
+    removeStubs(item);
+    item->pending = false;
+
+    // the session config as it was when the plugin was deferred, in memory only
+    KConfig config(QString(), KConfig::SimpleConfig);
+    for (auto it = item->pendingSessionConfig.cbegin(); it != item->pendingSessionConfig.cend(); ++it) {
+        KConfigGroup group(&config, it.key());
+        for (auto entry = it.value().cbegin(); entry != it.value().cend(); ++entry) {
+            group.writeEntry(entry.key(), entry.value());
+        }
+    }
+    item->pendingSessionConfig.clear();
+
+    /**
+     * load plugin + its views for all main windows, like loadConfig() does
+     */
+    if (!loadPlugin(item)) {
+        return false;
+    }
+
+    for (int i = 0; i < KateApp::self()->mainWindowsCount(); i++) {
+        enablePluginGUI(item, KateApp::self()->mainWindow(i), &config);
+    }
+
+    if (auto interface = qobject_cast<KTextEditor::SessionConfigInterface *>(item->plugin)) {
+        KConfigGroup group(&config, QStringLiteral("Plugin:%1:").arg(item->saveName()));
+        interface->readSessionConfig(group);
+    }
+
+    for (const Place &place : qAsConst(places)) {
+        KateMDI::ToolView *toolView = place.window ? place.window->toolView(place.id) : nullptr;
+        if (!toolView) {
+            continue;
+        }
+        if (place.window->toolViewPosition(toolView) != place.position) {
+            place.window->moveToolView(toolView, static_cast<KTextEditor::MainWindow::ToolViewPosition>(place.position));
+        }
+        if (place.visible) {
+            place.window->showToolView(toolView);
+        }
+    }
+
+    return true;
+}
+
+void KatePluginManager::documentCreated(KTextEditor::Document *document)
+{
+    connect(document, &KTextEditor::Document::modeChanged, this, &KatePluginManager::documentModeChanged);
+    documentModeChanged(document);
+}
+
+void KatePluginManager::documentModeChanged(KTextEditor::Document *document)
+{
+    const QString trigger = QStringLiteral("mode:") + document->mode();
+    for (const auto &pluginInfo : qAsConst(m_pluginList)) {
+        if (pluginInfo.pending && pluginInfo.triggers.contains(trigger)) {
+            requestActivation(pluginInfo.saveName());
+        }
+    }
+}
+
+void KatePluginManager::scheduleIdleActivation()
+{
+    if (m_idleQueue.isEmpty() || m_idleConnection) {
+        return;
+    }
+
+    // one plugin each time the event loop has nothing else to do, the window stays responsive
+    m_idleConnection = connect(QAbstractEventDispatcher::instance(), &QAbstractEventDispatcher::aboutToBlock, this, [this]() {
+        disconnect(m_idleConnection);
+        m_idleConnection = QMetaObject::Connection();
+        QTimer::singleShot(0, this, &KatePluginManager::activateIdlePlugin);
+    });
+}
+
+void KatePluginManager::activateIdlePlugin()
+{
+    if (!m_idleQueue.isEmpty()) {
+        activatePlugin(m_idleQueue.takeFirst());
+    }
+    scheduleIdleActivation();
+}
@@ -16,10 +16,20 @@
 
 #include <QList>
 #include <QMap>
+#include <QMultiHash>
 #include <QObject>
+#include <QPointer>
+#include <QStringList>
 
 class KConfig;
 class KateMainWindow;
+class QWidget;
+
+namespace KTextEditor
+{
+class Command;
+class Document;
+}
 
 class KatePluginInfo
 {
@@ -31,6 +41,27 @@ public:
     int sortOrder = 0;
     QString saveName() const;
     bool operator<(const KatePluginInfo &other) const;
+
+    /**
+     * activation triggers from the X-Kate-Activation metadata entry,
+     * plugins without any are loaded right away
+     */
+    QStringList triggers;
+
+    /**
+     * to be loaded, but waiting for one of its triggers
+     */
+    bool pending = false;
+
+    /**
+     * session config to apply once loaded, by group name
+     */
+    QMap<QString, QMap<QString, QString>> pendingSessionConfig;
+
+    /**
+     * milliseconds it took to construct the plugin and its views, -1 if never loaded
+     */
+    qint64 loadTime = -1;
 };
 
 typedef QList<KatePluginInfo> KatePluginList;
@@ -71,9 +102,27 @@ public:
     KTextEditor::Plugin *loadPlugin(const QString &name, bool permanent = true);
     void unloadPlugin(const QString &name, bool permanent = true);
 
+    /**
+     * Load a plugin waiting for its triggers now, with its session config and views.
+     * @return success
+     */
+    bool activatePlugin(KatePluginInfo *item);
+    bool activatePlugin(const QString &name);
+
+public Q_SLOTS:
+    void documentCreated(KTextEditor::Document *document);
+
 private:
     void setupPluginList();
 
+    void deferPlugin(KatePluginInfo *item, KConfig *config);
+    void installToolViewStubs(KatePluginInfo *item, KateMainWindow *win);
+    void removeStubs(KatePluginInfo *item);
+    void requestActivation(const QString &name);
+    void documentModeChanged(KTextEditor::Document *document);
+    void scheduleIdleActivation();
+    void activateIdlePlugin();
+
     /**
      * all known plugins
      */
@@ -84,6 +133,18 @@ private:
      * uses the info stored in the plugin list
      */
     QMap<QString, KatePluginInfo *> m_name2Plugin;
+
+    /**
+     * stand-ins of the plugins waiting for their triggers, by plugin name
+     */
+    QMultiHash<QString, QPointer<QWidget>> m_toolViewStubs;
+    QMultiHash<QString, KTextEditor::Command *> m_commandStubs;
+
+    /**
+     * plugins to load one by one once the event loop is idle
+     */
+    QStringList m_idleQueue;
+    QMetaObject::Connection m_idleConnection;
 };
 
 #endif
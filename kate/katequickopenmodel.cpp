@@ -81,8 +81,10 @@ void KateQuickOpenModel::refresh()
     }
 
     for (auto *doc : qAsConst(openDocs)) {
-        const auto normalizedUrl = doc->url().toString(QUrl::NormalizePathSegments | QUrl::PreferLocalFile);
-        allDocuments.push_back({doc->url(), doc->documentName(), normalizedUrl, true, 0});
+        // documents of a restored session might not be loaded yet
+        const QUrl url = KateApp::self()->documentManager()->documentUrl(doc);
+        const auto normalizedUrl = url.toString(QUrl::NormalizePathSegments | QUrl::PreferLocalFile);
+        allDocuments.push_back({url, KateApp::self()->documentManager()->documentName(doc), normalizedUrl, true, 0});
     }
 
     for (const auto &file : qAsConst(projectDocs)) {
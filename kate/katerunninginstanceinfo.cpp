@@ -15,14 +15,14 @@
 
 int KateRunningInstanceInfo::dummy_session = 0;
 
-bool fillinRunningKateAppInstances(KateRunningInstanceMap *map)
+QStringList runningKateServices()
 {
     QDBusConnectionInterface *i = QDBusConnection::sessionBus().interface();
     if (!i) {
-        return true; // we do not know about any others...
+        return QStringList(); // we do not know about any others...
     }
 
-    // look up all running kate instances and there sessions
+    // look up all running kate instances
     QDBusReply<QStringList> servicesReply = i->registeredServiceNames();
     QStringList services;
     if (servicesReply.isValid()) {
@@ -32,18 +32,29 @@ bool fillinRunningKateAppInstances(KateRunningInstanceMap *map)
     const bool inSandbox = QFileInfo::exists(QStringLiteral("/flatpak-info"));
     const QString my_pid = inSandbox ? QDBusConnection::sessionBus().baseService().replace(QRegularExpression(QStringLiteral("[\\.:]")), QStringLiteral("_")) : QString::number(QCoreApplication::applicationPid());
 
+    QStringList kateServices;
     for (const QString &s : qAsConst(services)) {
         if (s.startsWith(QLatin1String("org.kde.kate")) && !s.endsWith(my_pid)) {
-            KateRunningInstanceInfo *rii = new KateRunningInstanceInfo(s);
-            if (rii->valid) {
-                if (map->contains(rii->sessionName)) {
-                    return false; // ERROR no two instances may have the same session name
-                }
-                map->insert(rii->sessionName, rii);
-                // std::cerr<<qPrintable(s)<<"running instance:"<< rii->sessionName.toUtf8().data()<<std::endl;
-            } else {
-                delete rii;
+            kateServices << s;
+        }
+    }
+    return kateServices;
+}
+
+bool fillinRunningKateAppInstances(KateRunningInstanceMap *map)
+{
+    // look up the sessions of all running kate instances
+    const QStringList services = runningKateServices();
+    for (const QString &s : services) {
+        KateRunningInstanceInfo *rii = new KateRunningInstanceInfo(s);
+        if (rii->valid) {
+            if (map->contains(rii->sessionName)) {
+                return false; // ERROR no two instances may have the same session name
             }
+            map->insert(rii->sessionName, rii);
+            // std::cerr<<qPrintable(s)<<"running instance:"<< rii->sessionName.toUtf8().data()<<std::endl;
+        } else {
+            delete rii;
         }
     }
     return true;
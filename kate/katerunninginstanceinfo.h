@@ -11,6 +11,7 @@
 #include <QDBusConnection>
 #include <QDBusInterface>
 #include <QMap>
+#include <QStringList>
 #include <QVariant>
 #include <iostream>
 
@@ -63,6 +64,11 @@ private:
 
 typedef QMap<QString, KateRunningInstanceInfo *> KateRunningInstanceMap;
 
+/**
+ * D-Bus service names of the other running kate instances, without asking them anything.
+ */
+Q_DECL_EXPORT QStringList runningKateServices();
+
 Q_DECL_EXPORT bool fillinRunningKateAppInstances(KateRunningInstanceMap *map);
 Q_DECL_EXPORT void cleanupRunningKateAppInstanceMap(KateRunningInstanceMap *map);
 
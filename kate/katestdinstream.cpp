@@ -0,0 +1,210 @@
+/* This file is part of the KDE project
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#include "katestdinstream.h"
+
+#include "kateapp.h"
+#include "katedebug.h"
+#include "katedocmanager.h"
+#include "katemainwindow.h"
+#include "kateviewmanager.h"
+
+#include <KTextEditor/Document>
+#include <KTextEditor/ModificationInterface>
+
+#include <QDir>
+#include <QSocketNotifier>
+#include <QTemporaryFile>
+
+#include <cerrno>
+#include <cstdio>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+const int ChunkSize = 1024 * 1024;
+
+// reload on each change while the input is small, later only once it doubled
+const qint64 SmallSize = 4 * 1024 * 1024;
+const int ReloadDelay = 250;
+
+/**
+ * Returns what is available, up to @p size bytes, 0 at the end of the input, -1 on errors.
+ */
+qint64 readStdin(char *buffer, int size)
+{
+    qint64 result;
+    do {
+#ifdef Q_OS_WIN
+        result = _read(_fileno(stdin), buffer, unsigned(size));
+#else
+        result = ::read(STDIN_FILENO, buffer, size_t(size));
+#endif
+    } while (result < 0 && errno == EINTR);
+    return result;
+}
+
+bool createTemporaryFile(QFile &file)
+{
+    QTemporaryFile temp(QDir::tempPath() + QStringLiteral("/kate-stdin-XXXXXX.txt"));
+    temp.setAutoRemove(false);
+    if (!temp.open()) {
+        qCWarning(LOG_KATE) << "Unable to create a temporary file for stdin" << temp.errorString();
+        return false;
+    }
+
+    file.setFileName(temp.fileName());
+    return file.open(QIODevice::WriteOnly);
+}
+}
+
+KateStdinStream::KateStdinStream(QObject *parent)
+    : QObject(parent)
+{
+    m_reloadTimer.setSingleShot(true);
+    m_reloadTimer.setInterval(ReloadDelay);
+    connect(&m_reloadTimer, &QTimer::timeout, this, &KateStdinStream::reloadIfGrown);
+}
+
+KateStdinStream::~KateStdinStream()
+{
+    // the document is gone without ever showing the file
+    if (!m_document && m_file.isOpen()) {
+        m_file.remove();
+    }
+}
+
+QString KateStdinStream::readToTemporaryFile()
+{
+    QFile file;
+    if (!createTemporaryFile(file)) {
+        return QString();
+    }
+
+    QByteArray buffer(ChunkSize, Qt::Uninitialized);
+    qint64 size;
+    while ((size = readStdin(buffer.data(), buffer.size())) > 0) {
+        if (file.write(buffer.constData(), size) != size) {
+            qCWarning(LOG_KATE) << "Unable to write stdin to" << file.fileName() << file.errorString();
+            file.remove();
+            return QString();
+        }
+    }
+    return file.fileName();
+}
+
+bool KateStdinStream::start(const QString &encoding)
+{
+    if (!createTemporaryFile(m_file)) {
+        return false;
+    }
+
+    m_encoding = encoding;
+    m_buffer.resize(ChunkSize);
+
+#ifdef Q_OS_UNIX
+    m_notifier = new QSocketNotifier(STDIN_FILENO, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &KateStdinStream::readChunk);
+#else
+    // no notifications for pipes, read it all at once
+    while (m_notifier == nullptr && m_file.isOpen()) {
+        readChunk();
+    }
+#endif
+    return true;
+}
+
+void KateStdinStream::readChunk()
+{
+    const qint64 size = readStdin(m_buffer.data(), m_buffer.size());
+    if (size < 0) {
+        qCWarning(LOG_KATE) << "Unable to read stdin" << qt_error_string(errno);
+    }
+    if (size <= 0) {
+        finish();
+        return;
+    }
+
+    if (m_file.write(m_buffer.constData(), size) != size || !m_file.flush()) {
+        qCWarning(LOG_KATE) << "Unable to write stdin to" << m_file.fileName() << m_file.errorString();
+        finish();
+        return;
+    }
+    m_size += size;
+
+    if (!m_documentOpened) {
+        openDocument();
+    } else if (!m_reloadTimer.isActive()) {
+        m_reloadTimer.start();
+    }
+}
+
+void KateStdinStream::openDocument()
+{
+    m_documentOpened = true;
+    m_shownSize = m_size;
+
+    KateMainWindow *window = KateApp::self()->activeKateMainWindow();
+    m_document = window->viewManager()->openUrl(QUrl::fromLocalFile(m_file.fileName()), m_encoding, true);
+    if (!m_document) {
+        return;
+    }
+
+    // the file keeps changing, no need to tell
+    if (auto iface = qobject_cast<KTextEditor::ModificationInterface *>(m_document)) {
+        iface->setModifiedOnDiskWarning(false);
+    }
+    m_document->setReadWrite(false);
+}
+
+void KateStdinStream::reloadIfGrown()
+{
+    if (m_size > m_shownSize && (m_size <= SmallSize || m_size >= 2 * m_shownSize)) {
+        reload();
+    }
+}
+
+void KateStdinStream::reload()
+{
+    m_shownSize = m_size;
+    if (m_document) {
+        m_document->documentReload();
+    }
+}
+
+void KateStdinStream::finish()
+{
+    delete m_notifier;
+    m_notifier = nullptr;
+    m_buffer.clear();
+    m_reloadTimer.stop();
+    m_file.close();
+
+    // an empty input still gets its document
+    if (!m_documentOpened) {
+        openDocument();
+    } else if (m_size > m_shownSize) {
+        reload();
+    }
+
+    if (!m_document) {
+        QFile::remove(m_file.fileName());
+        deleteLater();
+        return;
+    }
+
+    m_document->setReadWrite(true);
+    if (auto iface = qobject_cast<KTextEditor::ModificationInterface *>(m_document)) {
+        iface->setModifiedOnDiskWarning(true);
+    }
+    KateApp::self()->documentManager()->setTemporaryFile(m_document);
+    deleteLater();
+}
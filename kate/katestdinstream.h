@@ -0,0 +1,74 @@
+/* This file is part of the KDE project
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#ifndef KATE_STDINSTREAM_H
+#define KATE_STDINSTREAM_H
+
+#include <QFile>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+
+class QSocketNotifier;
+
+namespace KTextEditor
+{
+class Document;
+}
+
+/**
+ * Shows stdin in a document while it arrives, for kate -i --stream.
+ *
+ * The input is copied chunk by chunk to a temporary file, so only one chunk
+ * is held in memory besides the document. The document shows that file,
+ * read-only until the end of the input; it is reloaded while the input is
+ * small and afterwards only each time the input doubled, so the reloads of
+ * a large stream sum up to about twice its size. Once the document is closed,
+ * the file is deleted unless it was modified.
+ */
+class KateStdinStream : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit KateStdinStream(QObject *parent = nullptr);
+    ~KateStdinStream() override;
+
+    /**
+     * Start reading stdin, the document is opened with the first chunk.
+     */
+    bool start(const QString &encoding);
+
+    /**
+     * Copy all of stdin to a new temporary file, blocking until the end of the input.
+     * @return the file name, empty on errors
+     */
+    static QString readToTemporaryFile();
+
+private Q_SLOTS:
+    void readChunk();
+    void reloadIfGrown();
+
+private:
+    void openDocument();
+    void reload();
+    void finish();
+
+private:
+    QFile m_file;
+    QString m_encoding;
+    QByteArray m_buffer;
+    QSocketNotifier *m_notifier = nullptr;
+
+    qint64 m_size = 0;
+    qint64 m_shownSize = 0;
+    QPointer<KTextEditor::Document> m_document;
+    bool m_documentOpened = false;
+    QTimer m_reloadTimer;
+};
+
+#endif
@@ -8,7 +8,9 @@
 
 #include "katetabbar.h"
 #include "kateapp.h"
+#include "katedocmanager.h"
 
+#include <QHelpEvent>
 #include <QIcon>
 #include <QMimeData>
 #include <QPainter>
@@ -17,6 +19,8 @@
 #include <QWheelEvent>
 
 #include <KConfigGroup>
+#include <KFormat>
+#include <KLocalizedString>
 #include <KSharedConfig>
 
 #include <KTextEditor/Document>
@@ -166,6 +170,22 @@ void KateTabBar::wheelEvent(QWheelEvent *event)
     setCurrentIndex(idx);
 }
 
+bool KateTabBar::event(QEvent *event)
+{
+    // the estimate changes with each edit, compute it once it is shown
+    if (event->type() == QEvent::ToolTip) {
+        const int idx = tabAt(static_cast<QHelpEvent *>(event)->pos());
+        KTextEditor::Document *doc = containsTab(idx) ? tabDocument(idx) : nullptr;
+        if (doc) {
+            KateDocManager *docManager = KateApp::self()->documentManager();
+            setTabToolTip(idx,
+                          i18nc("tab tooltip: url, memory estimate", "%1\nMemory: %2", docManager->documentUrl(doc).toDisplayString(), KFormat().formatByteSize(docManager->memoryUsage(doc))));
+        }
+    }
+
+    return QTabBar::event(event);
+}
+
 void KateTabBar::setTabDocument(int idx, KTextEditor::Document *doc)
 {
     // get right icon to use
@@ -178,8 +198,8 @@ void KateTabBar::setTabDocument(int idx, KTextEditor::Document *doc)
     KateTabButtonData buttonData = data.value<KateTabButtonData>();
     buttonData.doc = doc;
     setTabData(idx, QVariant::fromValue(buttonData));
-    setTabText(idx, doc->documentName());
-    setTabToolTip(idx, doc->url().toDisplayString());
+    setTabText(idx, KateApp::self()->documentManager()->documentName(doc));
+    setTabToolTip(idx, KateApp::self()->documentManager()->documentUrl(doc).toDisplayString());
     setTabIcon(idx, icon);
 }
 
@@ -201,7 +221,7 @@ void KateTabBar::setCurrentDocument(KTextEditor::Document *doc)
     // => create new tab and be done
     if ((m_tabCountLimit == 0) || count() < m_tabCountLimit) {
         m_beingAdded = doc;
-        insertTab(-1, doc->documentName());
+        insertTab(-1, KateApp::self()->documentManager()->documentName(doc));
         return;
     }
 
@@ -123,6 +123,9 @@ protected:
     //! Cycle through tabs
     void wheelEvent(QWheelEvent *event) override;
 
+    //! Show the memory use of the document along with its url
+    bool event(QEvent *event) override;
+
 private:
     using QTabBar::addTab;
     using QTabBar::insertTab;
@@ -0,0 +1,315 @@
+/* This file is part of the KDE project
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#include "katetrace.h"
+
+#include "katedebug.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTimer>
+
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <time.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <malloc.h>
+#endif
+
+bool KateTrace::s_enabled = false;
+
+namespace
+{
+// the slowest plugins and documents listed in the summary
+const int SummaryTop = 5;
+
+QString milliseconds(qint64 us)
+{
+    return QString::number(us / 1000.0, 'f', 1);
+}
+
+struct Total {
+    QString name;
+    int count = 0;
+    qint64 wall = 0;
+    qint64 cpu = 0;
+    qint64 heap = 0;
+};
+
+/**
+ * Totals per name, in order of first appearance. Spans within a span of the
+ * same name are part of it and not counted again.
+ */
+QVector<Total> totals(const QVector<KateTrace::Span> &spans, const char *category)
+{
+    QHash<QString, QVector<int>> byName;
+    QVector<QString> names;
+    for (int i = 0; i < spans.size(); ++i) {
+        if (qstrcmp(spans[i].category, category) == 0) {
+            QVector<int> &group = byName[spans[i].name];
+            if (group.isEmpty()) {
+                names.append(spans[i].name);
+            }
+            group.append(i);
+        }
+    }
+
+    QVector<Total> result;
+    for (const QString &name : qAsConst(names)) {
+        Total total;
+        total.name = name;
+        const QVector<int> group = byName.value(name);
+        for (int i : group) {
+            const KateTrace::Span &span = spans[i];
+            const bool nested = std::any_of(group.begin(), group.end(), [&spans, &span](int j) {
+                const KateTrace::Span &other = spans[j];
+                return other.depth < span.depth && other.start <= span.start && span.start + span.wall <= other.start + other.wall;
+            });
+            if (nested) {
+                continue;
+            }
+            ++total.count;
+            total.wall += span.wall;
+            total.cpu += qMax(span.cpu, qint64(0));
+            total.heap += span.heap;
+        }
+        result.append(total);
+    }
+    return result;
+}
+
+QString totalLine(const Total &total)
+{
+    return QStringLiteral("  %1 %2 %3 %4 %5\n")
+        .arg(total.name.left(40), -40)
+        .arg(total.count, 6)
+        .arg(milliseconds(total.wall), 10)
+        .arg(milliseconds(total.cpu), 10)
+        .arg(total.heap / 1024, 10);
+}
+
+QString categorySummary(const QVector<KateTrace::Span> &spans, const char *category, const QString &title)
+{
+    QVector<Total> result = totals(spans, category);
+    if (result.isEmpty()) {
+        return QString();
+    }
+
+    Total sum;
+    sum.name = title;
+    for (const Total &total : qAsConst(result)) {
+        sum.count += total.count;
+        sum.wall += total.wall;
+        sum.cpu += total.cpu;
+        sum.heap += total.heap;
+    }
+
+    std::sort(result.begin(), result.end(), [](const Total &a, const Total &b) {
+        return a.wall > b.wall;
+    });
+    result.resize(qMin(result.size(), SummaryTop));
+
+    QString text = totalLine(sum);
+    for (const Total &total : qAsConst(result)) {
+        text += QLatin1String("  ") + totalLine(total);
+    }
+    return text;
+}
+}
+
+KateTrace &KateTrace::self()
+{
+    static KateTrace trace;
+    return trace;
+}
+
+void KateTrace::start(const QString &fileName)
+{
+    m_fileName = fileName;
+    if (!s_enabled) {
+        m_timer.start();
+        s_enabled = true;
+    }
+}
+
+qint64 KateTrace::now() const
+{
+    return m_timer.nsecsElapsed() / 1000;
+}
+
+qint64 KateTrace::cpuTime()
+{
+#ifdef Q_OS_UNIX
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return qint64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+    }
+#endif
+    return -1;
+}
+
+qint64 KateTrace::heapSize()
+{
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 33)
+    const struct mallinfo2 info = mallinfo2();
+    return qint64(info.uordblks) + qint64(info.hblkhd);
+#else
+    const struct mallinfo info = mallinfo();
+    return qint64(uint(info.uordblks)) + qint64(uint(info.hblkhd));
+#endif
+#else
+    return 0;
+#endif
+}
+
+void KateTrace::mark(const QString &name)
+{
+    if (s_enabled) {
+        m_marks.append(qMakePair(name, now()));
+    }
+}
+
+void KateTrace::scheduleWrite()
+{
+    if (m_fileName.isEmpty() || m_writeScheduled || !QCoreApplication::instance()) {
+        return;
+    }
+
+    // once the event loop is back, the outermost span may be followed by another one
+    m_writeScheduled = true;
+    QTimer::singleShot(0, QCoreApplication::instance(), []() {
+        KateTrace::self().m_writeScheduled = false;
+        KateTrace::self().write();
+    });
+}
+
+bool KateTrace::write() const
+{
+    if (m_fileName.isEmpty()) {
+        return false;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray events;
+    QJsonObject process;
+    process[QStringLiteral("name")] = QStringLiteral("process_name");
+    process[QStringLiteral("ph")] = QStringLiteral("M");
+    process[QStringLiteral("pid")] = pid;
+    process[QStringLiteral("args")] = QJsonObject{{QStringLiteral("name"), QStringLiteral("kate")}};
+    events.append(process);
+
+    for (const Span &span : m_spans) {
+        QJsonObject args;
+        if (!span.detail.isEmpty()) {
+            args[QStringLiteral("detail")] = span.detail;
+        }
+        if (span.cpu >= 0) {
+            args[QStringLiteral("cpu")] = span.cpu;
+        }
+        args[QStringLiteral("heap")] = span.heap;
+
+        QJsonObject event;
+        event[QStringLiteral("name")] = span.name;
+        event[QStringLiteral("cat")] = QLatin1String(span.category);
+        event[QStringLiteral("ph")] = QStringLiteral("X");
+        event[QStringLiteral("ts")] = span.start;
+        event[QStringLiteral("dur")] = span.wall;
+        event[QStringLiteral("pid")] = pid;
+        event[QStringLiteral("tid")] = 1;
+        event[QStringLiteral("args")] = args;
+        events.append(event);
+    }
+
+    for (const auto &mark : m_marks) {
+        QJsonObject event;
+        event[QStringLiteral("name")] = mark.first;
+        event[QStringLiteral("ph")] = QStringLiteral("i");
+        event[QStringLiteral("s")] = QStringLiteral("p");
+        event[QStringLiteral("ts")] = mark.second;
+        event[QStringLiteral("pid")] = pid;
+        event[QStringLiteral("tid")] = 1;
+        events.append(event);
+    }
+
+    QJsonObject trace;
+    trace[QStringLiteral("traceEvents")] = events;
+    trace[QStringLiteral("displayTimeUnit")] = QStringLiteral("ms");
+
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) < 0 || !file.commit()) {
+        qCWarning(LOG_KATE) << "Unable to write trace" << m_fileName << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QString KateTrace::summary() const
+{
+    QString text;
+    for (const auto &mark : m_marks) {
+        text += QStringLiteral("%1: %2 ms\n").arg(mark.first, milliseconds(mark.second));
+    }
+
+    text += QStringLiteral("  %1 %2 %3 %4 %5\n")
+                .arg(QStringLiteral("span"), -40)
+                .arg(QStringLiteral("count"), 6)
+                .arg(QStringLiteral("wall ms"), 10)
+                .arg(QStringLiteral("cpu ms"), 10)
+                .arg(QStringLiteral("heap KiB"), 10);
+
+    const QVector<Total> phases = totals(m_spans, "phase");
+    for (const Total &total : phases) {
+        text += totalLine(total);
+    }
+    text += categorySummary(m_spans, "plugin", QStringLiteral("plugins"));
+    text += categorySummary(m_spans, "document", QStringLiteral("documents"));
+    return text;
+}
+
+KateTraceScope::KateTraceScope(const char *category, const QString &name, const QString &detail)
+    : m_active(KateTrace::isEnabled())
+{
+    if (!m_active) {
+        return;
+    }
+
+    KateTrace &trace = KateTrace::self();
+    m_span.category = category;
+    m_span.name = name;
+    m_span.detail = detail;
+    m_span.depth = trace.m_depth++;
+    m_span.heap = KateTrace::heapSize();
+    m_span.cpu = KateTrace::cpuTime();
+    m_span.start = trace.now();
+}
+
+KateTraceScope::~KateTraceScope()
+{
+    if (!m_active) {
+        return;
+    }
+
+    KateTrace &trace = KateTrace::self();
+    m_span.wall = trace.now() - m_span.start;
+    if (m_span.cpu >= 0) {
+        m_span.cpu = KateTrace::cpuTime() - m_span.cpu;
+    }
+    m_span.heap = KateTrace::heapSize() - m_span.heap;
+    trace.m_spans.append(m_span);
+
+    if (--trace.m_depth == 0) {
+        trace.scheduleWrite();
+    }
+}
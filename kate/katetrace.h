@@ -0,0 +1,105 @@
+/* This file is part of the KDE project
+   SPDX-FileCopyrightText: 2021 Kate Developers
+
+   SPDX-License-Identifier: LGPL-2.0-only
+*/
+
+#ifndef KATE_TRACE_H
+#define KATE_TRACE_H
+
+#include <QElapsedTimer>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+/**
+ * Opt-in timeline of what Kate does during startup and session switches.
+ *
+ * Enabled with KATE_TRACE_STARTUP=<file> or --trace-startup <file>, the spans
+ * are written as Chrome trace JSON, to be viewed in chrome://tracing or Perfetto.
+ * Each span records wall time, CPU time of the thread and the heap growth.
+ *
+ * Spans are only recorded in the GUI thread.
+ */
+class KateTrace
+{
+public:
+    struct Span {
+        const char *category = nullptr;
+        QString name;
+        QString detail;
+        qint64 start = 0;
+        qint64 wall = 0;
+        qint64 cpu = -1;
+        qint64 heap = 0;
+        int depth = 0;
+    };
+
+    static KateTrace &self();
+
+    static bool isEnabled()
+    {
+        return s_enabled;
+    }
+
+    /**
+     * Start recording. The trace is written to @p fileName each time the
+     * outermost span is done, an empty name only keeps it in memory.
+     */
+    void start(const QString &fileName);
+
+    /**
+     * Record a point in time, e.g. when startup is done.
+     */
+    void mark(const QString &name);
+
+    bool write() const;
+
+    /**
+     * Human readable per phase, plugin and document totals.
+     */
+    QString summary() const;
+
+    const QVector<Span> &spans() const
+    {
+        return m_spans;
+    }
+
+private:
+    KateTrace() = default;
+
+    friend class KateTraceScope;
+    qint64 now() const;
+    static qint64 cpuTime();
+    static qint64 heapSize();
+    void scheduleWrite();
+
+private:
+    static bool s_enabled;
+
+    QString m_fileName;
+    QElapsedTimer m_timer;
+    QVector<Span> m_spans;
+    QVector<QPair<QString, qint64>> m_marks;
+    int m_depth = 0;
+    bool m_writeScheduled = false;
+};
+
+/**
+ * Records a span from construction to destruction, does nothing unless tracing is enabled.
+ */
+class KateTraceScope
+{
+public:
+    KateTraceScope(const char *category, const QString &name, const QString &detail = QString());
+    ~KateTraceScope();
+
+    KateTraceScope(const KateTraceScope &) = delete;
+    KateTraceScope &operator=(const KateTraceScope &) = delete;
+
+private:
+    KateTrace::Span m_span;
+    bool m_active;
+};
+
+#endif
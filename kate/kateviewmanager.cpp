@@ -12,6 +12,7 @@
 #include "config.h"
 #include "kateapp.h"
 #include "katemainwindow.h"
+#include "katetrace.h"
 #include "kateupdatedisabler.h"
 #include "kateviewspace.h"
 
@@ -25,6 +26,7 @@
 #include <KLocalizedString>
 #include <KMessageBox>
 #include <KRecentFilesAction>
+#include <KSharedConfig>
 #include <KToolBar>
 #include <KXMLGUIFactory>
 
@@ -39,6 +41,9 @@
 
 static const qint64 FileSizeAboveToAskUserIfProceedWithOpen = 10 * 1024 * 1024; // 10MB should suffice
 
+// how often to look for idle views
+static const int EvictInterval = 60 * 1000;
+
 KateViewManager::KateViewManager(QWidget *parentW, KateMainWindow *parent)
     : QSplitter(parentW)
     , m_mainWindow(parent)
@@ -79,6 +84,12 @@ KateViewManager::KateViewManager(QWidget *parentW, KateMainWindow *parent)
     connect(KateApp::self()->documentManager(), &KateDocManager::aboutToDeleteDocuments, this, &KateViewManager::aboutToDeleteDocuments);
     connect(KateApp::self()->documentManager(), &KateDocManager::documentsDeleted, this, &KateViewManager::documentsDeleted);
 
+    m_viewClock.start();
+    m_evictTimer.setInterval(EvictInterval);
+    connect(&m_evictTimer, &QTimer::timeout, this, &KateViewManager::evictIdleViews);
+    readConfig();
+    connect(KateApp::self(), &KateApp::configurationChanged, this, &KateViewManager::readConfig);
+
     // register all already existing documents
     m_blockViewCreationAndActivation = true;
 
@@ -104,6 +115,39 @@ KateViewManager::~KateViewManager()
     }
 }
 
+void KateViewManager::readConfig()
+{
+    // in minutes, 0 == never, the default, freeing views is opt-in
+    const int minutes = KConfigGroup(KSharedConfig::openConfig(), "General").readEntry("Close Idle Views After", 0);
+    m_evictAfter = qMax(minutes, 0) * qint64(60 * 1000);
+
+    if (m_evictAfter > 0) {
+        m_evictTimer.start();
+    } else {
+        m_evictTimer.stop();
+    }
+}
+
+void KateViewManager::evictIdleViews()
+{
+    if (m_evictAfter <= 0) {
+        return;
+    }
+
+    const qint64 now = m_viewClock.elapsed();
+    const QList<KTextEditor::View *> views = m_views.keys();
+    for (KTextEditor::View *view : views) {
+        const ViewData &data = m_views[view];
+        KateViewSpace *viewspace = static_cast<KateViewSpace *>(view->parentWidget()->parentWidget());
+        if (data.active || viewspace->currentView() == view || now - data.lastUsed < m_evictAfter) {
+            continue;
+        }
+
+        viewspace->saveViewState(view);
+        deleteView(view);
+    }
+}
+
 void KateViewManager::setupActions()
 {
     /**
@@ -293,8 +337,9 @@ KTextEditor::Document *KateViewManager::openUrls(const QList<QUrl> &urls, const
 {
     const QList<KTextEditor::Document *> docs = KateApp::self()->documentManager()->openUrls(urls, encoding, isTempFile, docInfo);
 
-    for (const KTextEditor::Document *doc : docs) {
-        m_mainWindow->addRecentOpenedFile(doc->url());
+    // the documents are not loaded yet
+    for (KTextEditor::Document *doc : docs) {
+        m_mainWindow->addRecentOpenedFile(KateApp::self()->documentManager()->documentUrl(doc));
     }
 
     return docs.isEmpty() ? nullptr : docs.last();
@@ -423,6 +468,9 @@ KTextEditor::View *KateViewManager::createView(KTextEditor::Document *doc, KateV
         doc = KateApp::self()->documentManager()->createDoc();
     }
 
+    // documents restored from a session are loaded when they are shown first
+    KateApp::self()->documentManager()->loadDocument(doc);
+
     /**
      * create view, registers its XML gui itself
      * pass the view the correct main window
@@ -435,6 +483,7 @@ KTextEditor::View *KateViewManager::createView(KTextEditor::Document *doc, KateV
      */
     m_views[view].active = false;
     m_views[view].lruAge = m_minAge--;
+    m_views[view].lastUsed = m_viewClock.elapsed();
 
 #ifdef KF5Activities_FOUND
     m_views[view].activityResource = new KActivities::ResourceInstance(view->window()->winId(), view);
@@ -624,6 +673,7 @@ void KateViewManager::activateView(KTextEditor::View *view)
 
         // remember age of this view
         m_views[view].lruAge = m_minAge--;
+        m_views[view].lastUsed = m_viewClock.elapsed();
 
         emit viewChanged(view);
 
@@ -991,6 +1041,8 @@ void KateViewManager::saveViewConfiguration(KConfigGroup &config)
 
 void KateViewManager::restoreViewConfiguration(const KConfigGroup &config)
 {
+    KateTraceScope trace("phase", QStringLiteral("KateViewManager::restoreViewConfiguration"));
+
     /**
      * remove the single client that is registered at the factory, if any
      */
@@ -1035,6 +1087,9 @@ void KateViewManager::restoreViewConfiguration(const KConfigGroup &config)
         activateView(m_viewSpaceList.at(lastViewSpace)->currentView());
         // give view the focus to avoid focus stealing by toolviews / plugins
         m_viewSpaceList.at(lastViewSpace)->currentView()->setFocus();
+
+        // load the documents most likely shown next in the background
+        KateApp::self()->documentManager()->prefetchDocuments(m_viewSpaceList.at(lastViewSpace)->lruDocumentList());
     }
 
     // emergency
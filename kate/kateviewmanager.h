@@ -11,10 +11,12 @@
 
 #include "katedocmanager.h"
 
+#include <QElapsedTimer>
 #include <QList>
 #include <QMap>
 #include <QPointer>
 #include <QSplitter>
+#include <QTimer>
 
 namespace KActivities
 {
@@ -124,6 +126,14 @@ public:
 private Q_SLOTS:
     void slotViewChanged();
 
+    void readConfig();
+
+    /**
+     * Delete the views that are not shown and were not used for the configured time,
+     * their view spaces keep cursor and scroll position for a later view.
+     */
+    void evictIdleViews();
+
     void documentCreated(KTextEditor::Document *doc);
     void documentWillBeDeleted(KTextEditor::Document *doc);
 
@@ -303,6 +313,11 @@ private:
          */
         qint64 lruAge = 0;
 
+        /**
+         * when the view was shown last, see m_viewClock
+         */
+        qint64 lastUsed = 0;
+
         /**
          * activity resource for the view
          */
@@ -320,6 +335,13 @@ private:
      */
     qint64 m_minAge;
 
+    /**
+     * idle views are deleted after m_evictAfter ms, 0 for never
+     */
+    QElapsedTimer m_viewClock;
+    QTimer m_evictTimer;
+    qint64 m_evictAfter = 0;
+
     /**
      * the view that is ATM merged to the xml gui factory
      */
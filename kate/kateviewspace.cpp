@@ -12,25 +12,47 @@
 #include "katedocmanager.h"
 #include "katefileactions.h"
 #include "katemainwindow.h"
-#include "katesessionmanager.h"
 #include "kateupdatedisabler.h"
 #include "kateviewmanager.h"
 #include <KActionCollection>
 
 #include <KAcceleratorManager>
+#include <KConfig>
 #include <KConfigGroup>
 #include <KLocalizedString>
+#include <ktexteditor_version.h>
 
 #include <QApplication>
 #include <QClipboard>
 #include <QHelpEvent>
 #include <QMenu>
 #include <QMessageBox>
+#include <QScrollBar>
 #include <QStackedWidget>
+#include <QTimer>
 #include <QToolButton>
 #include <QToolTip>
 #include <QWhatsThis>
 
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+// not written by KTextEditor, the cursor alone doesn't tell which lines were shown
+const char TopLineKey[] = "TopLine";
+
+void writeViewState(KTextEditor::View *view, KConfigGroup &group)
+{
+    view->writeSessionConfig(group);
+
+    const KTextEditor::Cursor top = view->coordinatesToCursor(QPoint(view->width() / 2, 1));
+    if (top.isValid()) {
+        group.writeEntry(TopLineKey, top.line());
+    }
+}
+}
+
 // BEGIN KateViewSpace
 KateViewSpace::KateViewSpace(KateViewManager *viewManager, QWidget *parent, const char *name)
     : QWidget(parent)
@@ -94,8 +116,6 @@ KateViewSpace::KateViewSpace(KateViewManager *viewManager, QWidget *parent, cons
     stack->setSizePolicy(QSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Expanding));
     layout->addWidget(stack);
 
-    m_group.clear();
-
     // connect signal to hide/show statusbar
     connect(m_viewManager->mainWindow(), &KateMainWindow::statusBarToggled, this, &KateViewSpace::statusBarToggled);
     connect(m_viewManager->mainWindow(), &KateMainWindow::tabBarToggled, this, &KateViewSpace::tabBarToggled);
@@ -170,18 +190,7 @@ KTextEditor::View *KateViewSpace::createView(KTextEditor::Document *doc)
     v->setStatusBarEnabled(m_viewManager->mainWindow()->showStatusBar());
 
     // restore the config of this view if possible
-    if (!m_group.isEmpty()) {
-        QString fn = v->document()->url().toString();
-        if (!fn.isEmpty()) {
-            QString vgroup = QStringLiteral("%1 %2").arg(m_group, fn);
-
-            KateSession::Ptr as = KateApp::self()->sessionManager()->activeSession();
-            if (as->config() && as->config()->hasGroup(vgroup)) {
-                KConfigGroup cg(as->config(), vgroup);
-                v->readSessionConfig(cg);
-            }
-        }
-    }
+    restoreViewState(v);
 
     // register document, it is shown below through showView() then
     registerDocument(doc);
@@ -216,6 +225,52 @@ void KateViewSpace::removeView(KTextEditor::View *v)
     }
 }
 
+void KateViewSpace::saveViewState(KTextEditor::View *view)
+{
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup group(&config, "View");
+    writeViewState(view, group);
+    m_viewStates[view->document()] = group.entryMap();
+}
+
+void KateViewSpace::restoreViewState(KTextEditor::View *view)
+{
+    const auto it = m_viewStates.find(view->document());
+    if (it == m_viewStates.end()) {
+        return;
+    }
+
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup group(&config, "View");
+    for (auto entry = it->cbegin(); entry != it->cend(); ++entry) {
+        group.writeEntry(entry.key(), entry.value());
+    }
+    m_viewStates.erase(it);
+
+    view->readSessionConfig(group);
+
+    // the cursor is set by readSessionConfig(), only scroll the top line
+    // back to the top once the view has its size, that leaves the cursor alone
+    const int topLine = group.readEntry(TopLineKey, -1);
+    if (topLine >= 0) {
+        QTimer::singleShot(0, view, [view, topLine]() {
+#if KTEXTEDITOR_VERSION >= QT_VERSION_CHECK(5, 80, 0)
+            KTextEditor::Cursor top(topLine, 0);
+            view->setScrollPosition(top);
+#else
+            // the vertical scroll bar counts the lines from the top, without dynamic wrapping that is exact
+            const auto scrollBars = view->findChildren<QScrollBar *>();
+            for (QScrollBar *scrollBar : scrollBars) {
+                if (scrollBar->orientation() == Qt::Vertical) {
+                    scrollBar->setValue(topLine);
+                    break;
+                }
+            }
+#endif
+        });
+    }
+}
+
 bool KateViewSpace::showView(KTextEditor::Document *document)
 {
     /**
@@ -305,6 +360,14 @@ void KateViewSpace::makeActive(bool focusCurrentView)
     Q_ASSERT(isActiveSpace());
 }
 
+QVector<KTextEditor::Document *> KateViewSpace::lruDocumentList() const
+{
+    QVector<KTextEditor::Document *> documents;
+    documents.reserve(m_registeredDocuments.size());
+    std::copy(m_registeredDocuments.crbegin(), m_registeredDocuments.crend(), std::back_inserter(documents));
+    return documents;
+}
+
 void KateViewSpace::registerDocument(KTextEditor::Document *doc)
 {
     /**
@@ -357,6 +420,7 @@ void KateViewSpace::documentDestroyed(QObject *doc)
     KTextEditor::Document *invalidDoc = static_cast<KTextEditor::Document *>(doc);
     Q_ASSERT(m_registeredDocuments.contains(invalidDoc));
     m_registeredDocuments.removeAll(invalidDoc);
+    m_viewStates.remove(invalidDoc);
 
     /**
      * we shall have no views for this document at this point in time!
@@ -377,7 +441,7 @@ void KateViewSpace::updateDocumentName(KTextEditor::Document *doc)
     // update tab button if available, might not be the case for tab limit set!
     const int buttonId = m_tabBar->documentIdx(doc);
     if (buttonId >= 0) {
-        m_tabBar->setTabText(buttonId, doc->documentName());
+        m_tabBar->setTabText(buttonId, KateApp::self()->documentManager()->documentName(doc));
     }
 }
 
@@ -386,7 +450,7 @@ void KateViewSpace::updateDocumentUrl(KTextEditor::Document *doc)
     // update tab button if available, might not be the case for tab limit set!
     const int buttonId = m_tabBar->documentIdx(doc);
     if (buttonId >= 0) {
-        m_tabBar->setTabToolTip(buttonId, doc->url().toDisplayString());
+        m_tabBar->setTabToolTip(buttonId, KateApp::self()->documentManager()->documentUrl(doc).toDisplayString());
     }
 }
 
@@ -408,6 +472,8 @@ void KateViewSpace::closeTabRequest(int idx)
 {
     auto *doc = m_tabBar->tabDocument(idx);
     Q_ASSERT(doc);
+
+    // a document not loaded yet is closed as it is, there is nothing to save
     m_viewManager->slotDocumentClose(doc);
 }
 
@@ -443,7 +509,7 @@ void KateViewSpace::focusNextTab()
 
 int KateViewSpace::hiddenDocuments() const
 {
-    const int hiddenDocs = KateApp::self()->documents().count() - m_tabBar->count();
+    const int hiddenDocs = KateApp::self()->documentManager()->documentList().count() - m_tabBar->count();
     Q_ASSERT(hiddenDocs >= 0);
     return hiddenDocs;
 }
@@ -541,7 +607,7 @@ void KateViewSpace::saveConfig(KConfigBase *config, int myIndex, const QString &
     QVector<KTextEditor::View *> views;
     QStringList lruList;
     for (KTextEditor::Document *doc : documentList()) {
-        lruList << doc->url().toString();
+        lruList << KateApp::self()->documentManager()->documentUrl(doc).toString();
         if (m_docToView.contains(doc)) {
             views.append(m_docToView[doc]);
         }
@@ -564,11 +630,22 @@ void KateViewSpace::saveConfig(KConfigBase *config, int myIndex, const QString &
             // view config, group: "ViewSpace <n> url"
             QString vgroup = QStringLiteral("%1 %2").arg(groupname, (*it)->document()->url().toString());
             KConfigGroup viewGroup(config, vgroup);
-            (*it)->writeSessionConfig(viewGroup);
+            writeViewState(*it, viewGroup);
         }
 
         ++idx;
     }
+
+    // keep the state of the tabs without a view, too, their documents may not be loaded yet
+    for (auto it = m_viewStates.cbegin(); it != m_viewStates.cend(); ++it) {
+        const QString url = KateApp::self()->documentManager()->documentUrl(it.key()).toString();
+        if (!url.isEmpty()) {
+            KConfigGroup viewGroup(config, QStringLiteral("%1 %2").arg(groupname, url));
+            for (auto entry = it->cbegin(); entry != it->cend(); ++entry) {
+                viewGroup.writeEntry(entry.key(), entry.value());
+            }
+        }
+    }
 }
 
 void KateViewSpace::restoreConfig(KateViewManager *viewMan, const KConfigBase *config, const QString &groupname)
@@ -576,11 +653,18 @@ void KateViewSpace::restoreConfig(KateViewManager *viewMan, const KConfigBase *c
     KConfigGroup group(config, groupname);
 
     // restore Document lru list so that all tabs from the last session reappear
+    // only the tabs are created, the views once the documents are shown
     const QStringList lruList = group.readEntry("Documents", QStringList());
     for (int i = 0; i < lruList.size(); ++i) {
         // ignore non-existing documents
         if (auto doc = KateApp::self()->documentManager()->findDocument(QUrl(lruList[i]))) {
             registerDocument(doc);
+
+            // view config, group: "ViewSpace <n> url", the session config is rewritten on save
+            const QString vgroup = QStringLiteral("%1 %2").arg(groupname, lruList[i]);
+            if (config->hasGroup(vgroup)) {
+                m_viewStates[doc] = KConfigGroup(config, vgroup).entryMap();
+            }
         }
     }
 
@@ -590,13 +674,8 @@ void KateViewSpace::restoreConfig(KateViewManager *viewMan, const KConfigBase *c
         KTextEditor::Document *doc = KateApp::self()->documentManager()->findDocument(QUrl(fn));
 
         if (doc) {
-            // view config, group: "ViewSpace <n> url"
-            QString vgroup = QStringLiteral("%1 %2").arg(groupname, fn);
-            KConfigGroup configGroup(config, vgroup);
-
             auto view = viewMan->createView(doc, this);
             if (view) {
-                view->readSessionConfig(configGroup);
                 m_tabBar->setCurrentDocument(doc);
             }
         }
@@ -606,7 +685,5 @@ void KateViewSpace::restoreConfig(KateViewManager *viewMan, const KConfigBase *c
     if (m_docToView.isEmpty()) {
         viewMan->createView(KateApp::self()->documentManager()->documentList().first(), this);
     }
-
-    m_group = groupname; // used for restroing view configs later
 }
 // END KateViewSpace
@@ -16,6 +16,7 @@
 #include "katetabbar.h"
 
 #include <QHash>
+#include <QMap>
 #include <QWidget>
 
 class KConfigBase;
@@ -49,6 +50,12 @@ public:
     KTextEditor::View *createView(KTextEditor::Document *doc);
     void removeView(KTextEditor::View *v);
 
+    /**
+     * Remember cursor and scroll position of @p view, so a view created
+     * later for its document looks the same, e.g. before an idle view is deleted.
+     */
+    void saveViewState(KTextEditor::View *view);
+
     bool showView(KTextEditor::View *view)
     {
         return showView(view->document());
@@ -70,6 +77,12 @@ public:
         return m_tabBar->documentList();
     }
 
+    /**
+     * Returns the documents registered for this view space.
+     * @return document list, most recently used first
+     */
+    QVector<KTextEditor::Document *> lruDocumentList() const;
+
     /**
      * Register one document for this view space.
      * Each registered document will get e.g. a tab bar button.
@@ -136,12 +149,18 @@ private:
      */
     int hiddenDocuments() const;
 
+    /**
+     * Apply and forget the state saved for the document of @p view.
+     */
+    void restoreViewState(KTextEditor::View *view);
+
 private:
     // Kate's view manager
     KateViewManager *m_viewManager;
 
-    // config group string, used for restoring View session configuration
-    QString m_group;
+    // view session config of the documents without a view in this view space,
+    // restored from the session or saved before a view was deleted
+    QHash<KTextEditor::Document *, QMap<QString, QString>> m_viewStates;
 
     // flag that indicates whether this view space is the active one.
     // correct setter: m_viewManager->setActiveSpace(this);
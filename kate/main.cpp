@@ -9,6 +9,8 @@
 
 #include "kateapp.h"
 #include "katerunninginstanceinfo.h"
+#include "katestdinstream.h"
+#include "katetrace.h"
 #include "katewaiter.h"
 
 #include <KAboutData>
@@ -20,6 +22,7 @@
 #include <KStartupInfo>
 #include <KWindowSystem>
 
+#include <QAbstractEventDispatcher>
 #include <QApplication>
 #include <QByteArray>
 #include <QCommandLineParser>
@@ -27,6 +30,9 @@
 #include <QDBusMessage>
 #include <QDBusReply>
 #include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QSessionManager>
 #include <QTextCodec>
 #include <QUrl>
@@ -43,6 +49,77 @@
 #endif
 #include <iostream>
 
+/**
+ * Everything a running instance needs to open the given urls, see KateApp::openMessage().
+ */
+static QJsonObject remoteMessage(const QCommandLineParser &parser,
+                                 const QStringList &urls,
+                                 const QCommandLineOption &encodingOption,
+                                 const QCommandLineOption &tempfileOption,
+                                 const QCommandLineOption &lineOption,
+                                 const QCommandLineOption &columnOption,
+                                 const QCommandLineOption &asyncOption,
+                                 bool needToBlock)
+{
+    QJsonArray messageUrls;
+    for (const QString &url : urls) {
+        UrlInfo info(url);
+        QJsonObject urlMessagePart;
+        urlMessagePart[QStringLiteral("url")] = info.url.toString();
+        urlMessagePart[QStringLiteral("line")] = info.cursor.line();
+        urlMessagePart[QStringLiteral("column")] = info.cursor.column();
+        messageUrls.append(urlMessagePart);
+    }
+
+    QJsonObject message;
+    message[QStringLiteral("urls")] = messageUrls;
+    if (parser.isSet(encodingOption)) {
+        message[QStringLiteral("encoding")] = parser.value(encodingOption);
+    }
+    if (parser.isSet(tempfileOption)) {
+        message[QStringLiteral("tempfile")] = true;
+    }
+    if (parser.isSet(lineOption) || parser.isSet(columnOption)) {
+        message[QStringLiteral("line")] = parser.isSet(lineOption) ? parser.value(lineOption).toInt() - 1 : 0;
+        message[QStringLiteral("column")] = parser.isSet(columnOption) ? parser.value(columnOption).toInt() - 1 : 0;
+    }
+
+    // the tokens are needed to block
+    if (parser.isSet(asyncOption) && !needToBlock) {
+        message[QStringLiteral("wait")] = false;
+    }
+    return message;
+}
+
+#ifndef USE_QT_SINGLE_APP
+/**
+ * Hand the urls to the running instance @p serviceName in a single call.
+ * @return false if the instance doesn't know the call or refused the urls
+ */
+static bool openUrlsInInstance(const QString &serviceName, const QJsonObject &message, QStringList *tokens)
+{
+    QDBusMessage m = QDBusMessage::createMethodCall(serviceName, QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("openUrls"));
+    m.setArguments(QList<QVariant>() << QString::fromUtf8(QJsonDocument(message).toJson(QJsonDocument::Compact)));
+
+    const QDBusMessage res = QDBusConnection::sessionBus().call(m);
+    if (res.type() != QDBusMessage::ReplyMessage || res.arguments().count() != 1) {
+        return false;
+    }
+
+    const QStringList reply = res.arguments().at(0).toStringList();
+    if (reply.contains(QLatin1String("REFUSED"))) {
+        return false;
+    }
+
+    for (const QString &token : reply) {
+        if (!token.isEmpty() && token != QLatin1String("ERROR")) {
+            tokens->append(token);
+        }
+    }
+    return true;
+}
+#endif
+
 int main(int argc, char **argv)
 {
 #ifndef Q_OS_WIN
@@ -226,10 +303,30 @@ int main(int argc, char **argv)
     const QCommandLineOption readStdInOption(QStringList() << QStringLiteral("i") << QStringLiteral("stdin"), i18n("Read the contents of stdin."));
     parser.addOption(readStdInOption);
 
+    // --stream option
+    const QCommandLineOption streamOption(QStringList() << QStringLiteral("stream"),
+                                          i18n("With --stdin, show the input while it arrives, buffered in a temporary file that is deleted with the document."));
+    parser.addOption(streamOption);
+
+    // --async option
+    const QCommandLineOption asyncOption(QStringList() << QStringLiteral("async"), i18n("Hand the files to a running instance without waiting until they are opened."));
+    parser.addOption(asyncOption);
+
     // --tempfile option
     const QCommandLineOption tempfileOption(QStringList() << QStringLiteral("tempfile"), i18n("The files/URLs opened by the application will be deleted after use"));
     parser.addOption(tempfileOption);
 
+    // --trace-startup option
+    const QCommandLineOption traceStartupOption(QStringList() << QStringLiteral("trace-startup"),
+                                                i18n("Write a timeline of the startup and session switches to this file, in Chrome trace format."),
+                                                i18n("file"));
+    parser.addOption(traceStartupOption);
+
+    // --benchmark-startup option
+    const QCommandLineOption benchmarkStartupOption(QStringList() << QStringLiteral("benchmark-startup"),
+                                                    i18n("Start a new instance with the given or last session, quit once it is idle and print where the time went, implies '-n'."));
+    parser.addOption(benchmarkStartupOption);
+
     // urls to open
     parser.addPositionalArgument(QStringLiteral("urls"), i18n("Documents to open."), i18n("[urls...]"));
 
@@ -243,6 +340,18 @@ int main(int argc, char **argv)
      */
     aboutData.processCommandLine(&parser);
 
+    /**
+     * startup tracing, the option wins over the environment
+     */
+    const bool benchmarkStartup = parser.isSet(benchmarkStartupOption);
+    if (parser.isSet(traceStartupOption)) {
+        KateTrace::self().start(parser.value(traceStartupOption));
+    } else if (qEnvironmentVariableIsSet("KATE_TRACE_STARTUP")) {
+        KateTrace::self().start(qEnvironmentVariable("KATE_TRACE_STARTUP"));
+    } else if (benchmarkStartup) {
+        KateTrace::self().start(QString());
+    }
+
     /**
      * remember the urls we shall open
      */
@@ -254,7 +363,7 @@ int main(int argc, char **argv)
      * this will later be updated once more after detecting some
      * things about already running kate's, like their sessions
      */
-    bool force_new = parser.isSet(startNewInstanceOption);
+    bool force_new = parser.isSet(startNewInstanceOption) || benchmarkStartup;
     if (!force_new) {
         if (!(parser.isSet(startSessionOption) || parser.isSet(startNewInstanceOption) || parser.isSet(usePidOption) || parser.isSet(useEncodingOption) || parser.isSet(gotoLineOption) || parser.isSet(gotoColumnOption) ||
               parser.isSet(readStdInOption)) &&
@@ -274,121 +383,146 @@ int main(int argc, char **argv)
      */
 #ifndef USE_QT_SINGLE_APP
     if (QDBusConnectionInterface *const sessionBusInterface = QDBusConnection::sessionBus().interface()) {
+        QString serviceName;
+        bool session_already_opened = false;
+        bool foundRunningService = false;
+
+        // the urls, cursor and encoding, see KateApp::openMessage()
+        const QJsonObject message = remoteMessage(parser, urls, useEncodingOption, tempfileOption, gotoLineOption, gotoColumnOption, asyncOption, needToBlock);
+        QStringList tokens;
+        bool opened = false;
+
         /**
-         * try to get the current running kate instances
+         * fast path: a single running instance is used without asking it for its
+         * session, activity and desktop first, all urls are handed over in one call
+         * it refuses them if it is not on the current desktop
          */
-        KateRunningInstanceMap mapSessionRii;
-        if (!fillinRunningKateAppInstances(&mapSessionRii)) {
-            return 1;
+        if (!force_new && !parser.isSet(startAnonymousSessionOption) && !parser.isSet(startSessionOption) && !parser.isSet(usePidOption) && qEnvironmentVariableIsEmpty("KATE_PID") && !parser.isSet(readStdInOption)) {
+            const QStringList services = runningKateServices();
+            if (services.size() == 1) {
+                QJsonObject desktopMessage = message;
+                desktopMessage[QStringLiteral("desktop")] = KWindowSystem::currentDesktop();
+                opened = openUrlsInInstance(services.first(), desktopMessage, &tokens);
+                if (opened) {
+                    serviceName = services.first();
+                    foundRunningService = true;
+                }
+            }
         }
 
-        QString currentActivity;
-        QDBusMessage m = QDBusMessage::createMethodCall(QStringLiteral("org.kde.ActivityManager"), QStringLiteral("/ActivityManager/Activities"), QStringLiteral("org.kde.ActivityManager.Activities"), QStringLiteral("CurrentActivity"));
-        QDBusMessage res = QDBusConnection::sessionBus().call(m);
-        QList<QVariant> answer = res.arguments();
-        if (answer.size() == 1) {
-            currentActivity = answer.at(0).toString();
-        }
+        if (!foundRunningService) {
+            /**
+             * try to get the current running kate instances
+             */
+            KateRunningInstanceMap mapSessionRii;
+            if (!fillinRunningKateAppInstances(&mapSessionRii)) {
+                return 1;
+            }
 
-        QStringList kateServices;
-        for (KateRunningInstanceMap::const_iterator it = mapSessionRii.constBegin(); it != mapSessionRii.constEnd(); ++it) {
-            QString serviceName = (*it)->serviceName;
+            QString currentActivity;
+            QDBusMessage m = QDBusMessage::createMethodCall(QStringLiteral("org.kde.ActivityManager"), QStringLiteral("/ActivityManager/Activities"), QStringLiteral("org.kde.ActivityManager.Activities"), QStringLiteral("CurrentActivity"));
+            QDBusMessage res = QDBusConnection::sessionBus().call(m);
+            QList<QVariant> answer = res.arguments();
+            if (answer.size() == 1) {
+                currentActivity = answer.at(0).toString();
+            }
 
-            if (currentActivity.length() != 0) {
-                QDBusMessage m = QDBusMessage::createMethodCall(serviceName, QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("isOnActivity"));
+            QStringList kateServices;
+            for (KateRunningInstanceMap::const_iterator it = mapSessionRii.constBegin(); it != mapSessionRii.constEnd(); ++it) {
+                QString serviceName = (*it)->serviceName;
 
-                QList<QVariant> dbargs;
+                if (currentActivity.length() != 0) {
+                    QDBusMessage m = QDBusMessage::createMethodCall(serviceName, QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("isOnActivity"));
 
-                // convert to an url
-                dbargs.append(currentActivity);
-                m.setArguments(dbargs);
+                    QList<QVariant> dbargs;
 
-                QDBusMessage res = QDBusConnection::sessionBus().call(m);
-                QList<QVariant> answer = res.arguments();
-                if (answer.size() == 1) {
-                    const bool canBeUsed = answer.at(0).toBool();
+                    // convert to an url
+                    dbargs.append(currentActivity);
+                    m.setArguments(dbargs);
 
-                    // If the Kate instance is in a specific activity, add it to
-                    // the list of candidate reusable services
-                    if (canBeUsed) {
-                        kateServices << serviceName;
+                    QDBusMessage res = QDBusConnection::sessionBus().call(m);
+                    QList<QVariant> answer = res.arguments();
+                    if (answer.size() == 1) {
+                        const bool canBeUsed = answer.at(0).toBool();
+
+                        // If the Kate instance is in a specific activity, add it to
+                        // the list of candidate reusable services
+                        if (canBeUsed) {
+                            kateServices << serviceName;
+                        }
                     }
+                } else {
+                    kateServices << serviceName;
                 }
-            } else {
-                kateServices << serviceName;
             }
-        }
-
-        QString serviceName;
-
-        QString start_session;
-        bool session_already_opened = false;
 
-        // check if we try to start an already opened session
-        if (parser.isSet(startAnonymousSessionOption)) {
-            force_new = true;
-        } else if (parser.isSet(startSessionOption)) {
-            start_session = parser.value(startSessionOption);
-            if (mapSessionRii.contains(start_session)) {
-                serviceName = mapSessionRii[start_session]->serviceName;
-                force_new = false;
-                session_already_opened = true;
+            QString start_session;
+
+            // check if we try to start an already opened session
+            if (parser.isSet(startAnonymousSessionOption)) {
+                force_new = true;
+            } else if (parser.isSet(startSessionOption)) {
+                start_session = parser.value(startSessionOption);
+                if (mapSessionRii.contains(start_session)) {
+                    serviceName = mapSessionRii[start_session]->serviceName;
+                    force_new = false;
+                    session_already_opened = true;
+                }
             }
-        }
 
-        // cleanup map
-        cleanupRunningKateAppInstanceMap(&mapSessionRii);
+            // cleanup map
+            cleanupRunningKateAppInstanceMap(&mapSessionRii);
 
-        // if no new instance is forced and no already opened session is requested,
-        // check if a pid is given, which should be reused.
-        // two possibilities: pid given or not...
-        if ((!force_new) && serviceName.isEmpty()) {
-            if ((parser.isSet(usePidOption)) || (!qgetenv("KATE_PID").isEmpty())) {
-                QString usePid = (parser.isSet(usePidOption)) ? parser.value(usePidOption) : QString::fromLocal8Bit(qgetenv("KATE_PID"));
+            // if no new instance is forced and no already opened session is requested,
+            // check if a pid is given, which should be reused.
+            // two possibilities: pid given or not...
+            if ((!force_new) && serviceName.isEmpty()) {
+                if ((parser.isSet(usePidOption)) || (!qgetenv("KATE_PID").isEmpty())) {
+                    QString usePid = (parser.isSet(usePidOption)) ? parser.value(usePidOption) : QString::fromLocal8Bit(qgetenv("KATE_PID"));
 
-                serviceName = QLatin1String("org.kde.kate-") + usePid;
-                if (!kateServices.contains(serviceName)) {
-                    serviceName.clear();
+                    serviceName = QLatin1String("org.kde.kate-") + usePid;
+                    if (!kateServices.contains(serviceName)) {
+                        serviceName.clear();
+                    }
                 }
             }
-        }
 
-        // prefer the Kate instance running on the current virtual desktop
-        bool foundRunningService = false;
-        if ((!force_new) && (serviceName.isEmpty())) {
-            const int desktopnumber = KWindowSystem::currentDesktop();
-            for (int s = 0; s < kateServices.count(); s++) {
-                serviceName = kateServices[s];
-
-                if (!serviceName.isEmpty()) {
-                    QDBusReply<bool> there = sessionBusInterface->isServiceRegistered(serviceName);
-
-                    if (there.isValid() && there.value()) {
-                        // query instance current desktop
-                        QDBusMessage m = QDBusMessage::createMethodCall(serviceName, QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("desktopNumber"));
-
-                        QDBusMessage res = QDBusConnection::sessionBus().call(m);
-                        QList<QVariant> answer = res.arguments();
-                        if (answer.size() == 1) {
-                            // special case: on all desktops! that is -1 aka NET::OnAllDesktops, see KWindowInfo::desktop() docs
-                            const int sessionDesktopNumber = answer.at(0).toInt();
-                            if (sessionDesktopNumber == desktopnumber || sessionDesktopNumber == NET::OnAllDesktops) {
-                                // stop searching. a candidate instance in the current desktop has been found
-                                foundRunningService = true;
-                                break;
+            // prefer the Kate instance running on the current virtual desktop
+            if ((!force_new) && (serviceName.isEmpty())) {
+                const int desktopnumber = KWindowSystem::currentDesktop();
+                for (int s = 0; s < kateServices.count(); s++) {
+                    serviceName = kateServices[s];
+
+                    if (!serviceName.isEmpty()) {
+                        QDBusReply<bool> there = sessionBusInterface->isServiceRegistered(serviceName);
+
+                        if (there.isValid() && there.value()) {
+                            // query instance current desktop
+                            QDBusMessage m = QDBusMessage::createMethodCall(serviceName, QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("desktopNumber"));
+
+                            QDBusMessage res = QDBusConnection::sessionBus().call(m);
+                            QList<QVariant> answer = res.arguments();
+                            if (answer.size() == 1) {
+                                // special case: on all desktops! that is -1 aka NET::OnAllDesktops, see KWindowInfo::desktop() docs
+                                const int sessionDesktopNumber = answer.at(0).toInt();
+                                if (sessionDesktopNumber == desktopnumber || sessionDesktopNumber == NET::OnAllDesktops) {
+                                    // stop searching. a candidate instance in the current desktop has been found
+                                    foundRunningService = true;
+                                    break;
+                                }
                             }
                         }
                     }
+                    serviceName.clear();
                 }
-                serviceName.clear();
             }
-        }
 
-        // check again if service is still running
-        foundRunningService = false;
-        if (!serviceName.isEmpty()) {
-            QDBusReply<bool> there = sessionBusInterface->isServiceRegistered(serviceName);
-            foundRunningService = there.isValid() && there.value();
+            // check again if service is still running
+            foundRunningService = false;
+            if (!serviceName.isEmpty()) {
+                QDBusReply<bool> there = sessionBusInterface->isServiceRegistered(serviceName);
+                foundRunningService = there.isValid() && there.value();
+            }
         }
 
         if (foundRunningService) {
@@ -407,40 +541,59 @@ int main(int argc, char **argv)
 
             bool tempfileSet = parser.isSet(tempfileOption);
 
-            QStringList tokens;
+            // all in one call, unless stdin comes after the files
+            if (!opened && !parser.isSet(readStdInOption)) {
+                opened = openUrlsInInstance(serviceName, message, &tokens);
+            }
 
-            // open given files...
+            // open given files one by one, for instances that don't know the above
             // Bug 397913: Reverse the order here so the new tabs are opened in same order as the files were passed in on the command line
-            for (int i = urls.size() - 1; i >= 0; --i) {
-                const QString &url = urls[i];
-                QDBusMessage m = QDBusMessage::createMethodCall(serviceName, QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("tokenOpenUrlAt"));
-
-                UrlInfo info(url);
-                QList<QVariant> dbusargs;
-
-                // convert to an url
-                dbusargs.append(info.url.toString());
-                dbusargs.append(info.cursor.line());
-                dbusargs.append(info.cursor.column());
-                dbusargs.append(enc);
-                dbusargs.append(tempfileSet);
-                m.setArguments(dbusargs);
-
-                QDBusMessage res = QDBusConnection::sessionBus().call(m);
-                if (res.type() == QDBusMessage::ReplyMessage) {
-                    if (res.arguments().count() == 1) {
-                        QVariant v = res.arguments()[0];
-                        if (v.isValid()) {
-                            QString s = v.toString();
-                            if ((!s.isEmpty()) && (s != QLatin1String("ERROR"))) {
-                                tokens << s;
+            if (!opened) {
+                for (int i = urls.size() - 1; i >= 0; --i) {
+                    const QString &url = urls[i];
+                    QDBusMessage m = QDBusMessage::createMethodCall(serviceName, QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("tokenOpenUrlAt"));
+
+                    UrlInfo info(url);
+                    QList<QVariant> dbusargs;
+
+                    // convert to an url
+                    dbusargs.append(info.url.toString());
+                    dbusargs.append(info.cursor.line());
+                    dbusargs.append(info.cursor.column());
+                    dbusargs.append(enc);
+                    dbusargs.append(tempfileSet);
+                    m.setArguments(dbusargs);
+
+                    QDBusMessage res = QDBusConnection::sessionBus().call(m);
+                    if (res.type() == QDBusMessage::ReplyMessage) {
+                        if (res.arguments().count() == 1) {
+                            QVariant v = res.arguments()[0];
+                            if (v.isValid()) {
+                                QString s = v.toString();
+                                if ((!s.isEmpty()) && (s != QLatin1String("ERROR"))) {
+                                    tokens << s;
+                                }
                             }
                         }
                     }
                 }
             }
 
-            if (parser.isSet(readStdInOption)) {
+            if (parser.isSet(readStdInOption) && parser.isSet(streamOption)) {
+                // hand over a file instead of the whole text, it is deleted with the document
+                const QString fileName = KateStdinStream::readToTemporaryFile();
+                if (!fileName.isEmpty()) {
+                    QDBusMessage m = QDBusMessage::createMethodCall(serviceName, QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("openUrl"));
+
+                    QList<QVariant> dbusargs;
+                    dbusargs.append(QUrl::fromLocalFile(fileName).toString());
+                    dbusargs.append(enc);
+                    dbusargs.append(true);
+                    m.setArguments(dbusargs);
+
+                    QDBusConnection::sessionBus().call(m);
+                }
+            } else if (parser.isSet(readStdInOption)) {
                 QTextStream input(stdin, QIODevice::ReadOnly);
 
                 // set chosen codec
@@ -482,7 +635,7 @@ int main(int argc, char **argv)
                 nav = true;
             }
 
-            if (nav) {
+            if (nav && !opened) {
                 QDBusMessage m = QDBusMessage::createMethodCall(serviceName, QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("setCursor"));
 
                 QList<QVariant> args;
@@ -494,8 +647,10 @@ int main(int argc, char **argv)
             }
 
             // activate the used instance
-            QDBusMessage activateMsg = QDBusMessage::createMethodCall(serviceName, QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("activate"));
-            QDBusConnection::sessionBus().call(activateMsg);
+            if (!opened) {
+                QDBusMessage activateMsg = QDBusMessage::createMethodCall(serviceName, QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("activate"));
+                QDBusConnection::sessionBus().call(activateMsg);
+            }
 
             // connect dbus signal
             if (needToBlock) {
@@ -548,27 +703,13 @@ int main(int argc, char **argv)
 
             /**
              * construct one big message with all urls to open
-             * later we will add additional data to this
              */
-            QVariantMap message;
-            QVariantList messageUrls;
-            for (const QString &url : urls) {
-                /**
-                 * get url info and pack them into the message as extra element in urls list
-                 */
-                UrlInfo info(url);
-                QVariantMap urlMessagePart;
-                urlMessagePart[QLatin1String("url")] = info.url;
-                urlMessagePart[QLatin1String("line")] = info.cursor.line();
-                urlMessagePart[QLatin1String("column")] = info.cursor.column();
-                messageUrls.append(urlMessagePart);
-            }
-            message[QLatin1String("urls")] = messageUrls;
+            const QJsonObject message = remoteMessage(parser, urls, useEncodingOption, tempfileOption, gotoLineOption, gotoColumnOption, asyncOption, needToBlock);
 
             /**
              * try to send message, return success
              */
-            return !app.sendMessage(QString::fromUtf8(QJsonDocument::fromVariant(QVariant(message)).toJson()));
+            return !app.sendMessage(QString::fromUtf8(QJsonDocument(message).toJson(QJsonDocument::Compact)));
         }
     }
 #endif // USE_QT_SINGLE_APP
@@ -620,8 +761,29 @@ int main(int argc, char **argv)
 
 #endif
 
+    /**
+     * the benchmark is done once the event loop has nothing left to do
+     */
+    bool idle = false;
+    if (benchmarkStartup) {
+        QObject::connect(QAbstractEventDispatcher::instance(), &QAbstractEventDispatcher::aboutToBlock, &kateApp, [&idle]() {
+            if (!idle) {
+                idle = true;
+                KateTrace::self().mark(QStringLiteral("idle"));
+                QCoreApplication::quit();
+            }
+        });
+    }
+
     /**
      * start main event loop for our application
      */
-    return app.exec();
+    const int result = app.exec();
+
+    if (benchmarkStartup) {
+        KateTrace::self().write();
+        std::cout << KateTrace::self().summary().toStdString() << std::flush;
+    }
+
+    return result;
 }
@@ -42,6 +42,17 @@ KateSession::KateSession(const QString &file, const QString &name, const bool an
     m_documents = config()->group(opGroupName).readEntry(keyCount, 0);
 }
 
+KateSession::KateSession(const QString &file, const QString &name, const QDateTime &timestamp, unsigned int documents)
+    : m_name(name)
+    , m_file(file)
+    , m_anonymous(false)
+    , m_documents(documents)
+    , m_config(nullptr)
+    , m_timestamp(timestamp)
+{
+    Q_ASSERT(!m_file.isEmpty());
+}
+
 KateSession::~KateSession()
 {
     delete m_config;
@@ -58,6 +69,17 @@ void KateSession::setDocuments(const unsigned int number)
     m_documents = number;
 }
 
+void KateSession::update(const QDateTime &timestamp, unsigned int documents)
+{
+    m_timestamp = timestamp;
+    m_documents = documents;
+}
+
+unsigned int KateSession::readDocuments(const QString &file)
+{
+    return KConfig(file, KConfig::SimpleConfig).group(opGroupName).readEntry(keyCount, 0);
+}
+
 void KateSession::setFile(const QString &filename)
 {
     if (m_config) {
@@ -89,6 +111,11 @@ KateSession::Ptr KateSession::create(const QString &file, const QString &name)
     return Ptr(new KateSession(file, name, false));
 }
 
+KateSession::Ptr KateSession::create(const QString &file, const QString &name, const QDateTime &timestamp, unsigned int documents)
+{
+    return Ptr(new KateSession(file, name, timestamp, documents));
+}
+
 KateSession::Ptr KateSession::createFrom(const KateSession::Ptr &session, const QString &file, const QString &name)
 {
     return Ptr(new KateSession(file, name, false, session->config()));
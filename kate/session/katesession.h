@@ -86,6 +86,11 @@ public:
      */
 public:
     static KateSession::Ptr create(const QString &file, const QString &name);
+
+    /**
+     * Create a session from cached meta data, the file is only read once the config is needed.
+     */
+    static KateSession::Ptr create(const QString &file, const QString &name, const QDateTime &timestamp, unsigned int documents);
     static KateSession::Ptr createFrom(const KateSession::Ptr &session, const QString &file, const QString &name);
     static KateSession::Ptr createAnonymous(const QString &file);
     static KateSession::Ptr createAnonymousFrom(const KateSession::Ptr &session, const QString &file);
@@ -106,6 +111,16 @@ private:
      */
     void setFile(const QString &filename);
 
+    /**
+     * the session file was written, e.g. by another instance
+     */
+    void update(const QDateTime &timestamp, unsigned int documents);
+
+    /**
+     * read the count of documents of the session @p file
+     */
+    static unsigned int readDocuments(const QString &file);
+
     /**
      * create a session from given @file
      * @param file configuration file
@@ -115,6 +130,8 @@ private:
      */
     KateSession(const QString &file, const QString &name, const bool anonymous, const KConfig *config = nullptr);
 
+    KateSession(const QString &file, const QString &name, const QDateTime &timestamp, unsigned int documents);
+
 private:
     QString m_name;
     QString m_file;
@@ -11,7 +11,9 @@
 
 #include "kateapp.h"
 #include "katepluginmanager.h"
+#include "katedebug.h"
 #include "katerunninginstanceinfo.h"
+#include "katetrace.h"
 
 #include <KConfigGroup>
 #include <KDesktopFile>
@@ -25,15 +27,41 @@
 
 #include <QApplication>
 #include <QCryptographicHash>
+#include <QDataStream>
 #include <QDir>
+#include <QFileInfo>
 #include <QInputDialog>
+#include <QSaveFile>
 #include <QScopedPointer>
+#include <QSet>
 #include <QUrl>
 
+#include <algorithm>
+
 #ifndef Q_OS_WIN
 #include <unistd.h>
 #endif
 
+namespace
+{
+const QLatin1String SessionSuffix(".katesession");
+
+const quint32 CatalogMagic = 0x31534b4b; // "KKS1"
+const quint32 CatalogVersion = 1;
+const int CatalogWriteDelay = 1000;
+const int RescanDelay = 500;
+
+// most recent sessions offered in the jump list
+const int JumpListSize = 10;
+
+QString sessionNameForFile(const QString &fileName)
+{
+    QString name = fileName;
+    name.chop(SessionSuffix.size());
+    return QUrl::fromPercentEncoding(name.toLatin1());
+}
+}
+
 // BEGIN KateSessionManager
 
 KateSessionManager::KateSessionManager(QObject *parent, const QString &sessionsDir)
@@ -48,54 +76,204 @@ KateSessionManager::KateSessionManager(QObject *parent, const QString &sessionsD
     // create dir if needed
     QDir().mkpath(m_sessionsDir);
 
+    m_catalogTimer.setSingleShot(true);
+    m_catalogTimer.setInterval(CatalogWriteDelay);
+    connect(&m_catalogTimer, &QTimer::timeout, this, &KateSessionManager::writeCatalog);
+
+    m_rescanTimer.setSingleShot(true);
+    m_rescanTimer.setInterval(RescanDelay);
+    connect(&m_rescanTimer, &QTimer::timeout, this, [this]() {
+        if (!m_lastFileEvent.isValid() || m_lastFileEvent.hasExpired(2 * RescanDelay)) {
+            updateSessionList();
+        }
+    });
+
+    // watch the single files, so a change only touches its own session
     m_dirWatch = new KDirWatch(this);
-    m_dirWatch->addDir(m_sessionsDir);
-    connect(m_dirWatch, &KDirWatch::dirty, this, &KateSessionManager::updateSessionList);
+    m_dirWatch->addDir(m_sessionsDir, KDirWatch::WatchFiles);
+    connect(m_dirWatch, &KDirWatch::created, this, &KateSessionManager::sessionFileChanged);
+    connect(m_dirWatch, &KDirWatch::dirty, this, &KateSessionManager::sessionFileChanged);
+    connect(m_dirWatch, &KDirWatch::deleted, this, &KateSessionManager::sessionFileDeleted);
 
+    // the catalog saves opening all unchanged session files
+    readCatalog();
     updateSessionList();
+    m_catalog.clear();
 }
 
 KateSessionManager::~KateSessionManager()
 {
+    if (m_catalogTimer.isActive()) {
+        writeCatalog();
+    }
     delete m_dirWatch;
 }
 
 void KateSessionManager::updateSessionList()
 {
-    QStringList list;
+    const QDir dir(m_sessionsDir, QStringLiteral("*.katesession"), QDir::NoSort, QDir::Files);
+    const QFileInfoList files = dir.entryInfoList();
 
-    // Let's get a list of all session we have atm
-    QDir dir(m_sessionsDir, QStringLiteral("*.katesession"), QDir::Time);
+    bool changed = false;
+    QSet<QString> names;
 
-    for (unsigned int i = 0; i < dir.count(); ++i) {
-        QString name = dir[i];
-        name.chop(12); // .katesession
-        list << QUrl::fromPercentEncoding(name.toLatin1());
+    // Add new sessions to our list, update changed ones
+    for (const QFileInfo &info : files) {
+        names.insert(sessionNameForFile(info.fileName()));
+        changed |= updateSession(info);
     }
 
-    // write jump list actions to disk in the kate.desktop file
-    updateJumpListActions(list);
+    // Remove gone sessions from our list
+    for (auto it = m_sessions.begin(); it != m_sessions.end();) {
+        if (!names.contains(it.key()) && it.value() != activeSession()) {
+            it = m_sessions.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
 
-    bool changed = false;
+    if (changed || !m_jumpListUpToDate) {
+        sessionListUpdated();
+    }
+}
 
-    // Add new sessions to our list
-    for (const QString &session : qAsConst(list)) {
-        if (!m_sessions.contains(session)) {
-            const QString file = sessionFileForName(session);
-            m_sessions.insert(session, KateSession::create(file, session));
-            changed = true;
+bool KateSessionManager::updateSession(const QFileInfo &info)
+{
+    const QString name = sessionNameForFile(info.fileName());
+    const QDateTime timestamp = info.lastModified();
+
+    auto it = m_sessions.find(name);
+    if (it == m_sessions.end()) {
+        const auto cached = m_catalog.constFind(info.fileName());
+        if (cached != m_catalog.constEnd() && cached->timestamp == timestamp) {
+            m_sessions.insert(name, KateSession::create(sessionFileForName(name), name, timestamp, cached->documents));
+        } else {
+            m_sessions.insert(name, KateSession::create(sessionFileForName(name), name));
         }
+        return true;
     }
-    // Remove gone sessions from our list
-    for (const QString &session : m_sessions.keys()) {
-        if ((list.indexOf(session) < 0) && (m_sessions.value(session) != activeSession())) {
-            m_sessions.remove(session);
-            changed = true;
+
+    if ((*it)->timestamp() == timestamp) {
+        return false;
+    }
+
+    (*it)->update(timestamp, KateSession::readDocuments(info.filePath()));
+    return true;
+}
+
+void KateSessionManager::sessionFileChanged(const QString &path)
+{
+    if (!path.endsWith(SessionSuffix)) {
+        if (QDir(path) == QDir(m_sessionsDir)) {
+            sessionsDirChanged();
         }
+        return;
+    }
+
+    m_lastFileEvent.start();
+
+    const QFileInfo info(path);
+    if (!info.exists()) {
+        sessionFileDeleted(path);
+        return;
     }
 
-    if (changed) {
-        emit sessionListChanged();
+    if (updateSession(info)) {
+        sessionListUpdated();
+    }
+}
+
+void KateSessionManager::sessionFileDeleted(const QString &path)
+{
+    if (!path.endsWith(SessionSuffix)) {
+        return;
+    }
+
+    m_lastFileEvent.start();
+
+    auto it = m_sessions.find(sessionNameForFile(QFileInfo(path).fileName()));
+    if (it != m_sessions.end() && it.value() != activeSession()) {
+        m_sessions.erase(it);
+        sessionListUpdated();
+    }
+}
+
+void KateSessionManager::sessionsDirChanged()
+{
+    if (!m_rescanTimer.isActive()) {
+        m_rescanTimer.start();
+    }
+}
+
+void KateSessionManager::sessionListUpdated()
+{
+    updateJumpList();
+
+    if (!m_catalogTimer.isActive()) {
+        m_catalogTimer.start();
+    }
+
+    emit sessionListChanged();
+}
+
+void KateSessionManager::readCatalog()
+{
+    QFile file(m_sessionsDir + QStringLiteral("/.catalog"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> count;
+    if (magic != CatalogMagic || version != CatalogVersion) {
+        return;
+    }
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString fileName;
+        qint64 timestamp = 0;
+        quint32 documents = 0;
+        stream >> fileName >> timestamp >> documents;
+
+        CatalogEntry &entry = m_catalog[fileName];
+        entry.timestamp = QDateTime::fromMSecsSinceEpoch(timestamp, Qt::UTC);
+        entry.documents = documents;
+    }
+
+    // a damaged catalog is of no use
+    if (stream.status() != QDataStream::Ok) {
+        m_catalog.clear();
+    }
+}
+
+void KateSessionManager::writeCatalog()
+{
+    m_catalogTimer.stop();
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+
+    quint32 count = 0;
+    for (const KateSession::Ptr &session : qAsConst(m_sessions)) {
+        if (session->timestamp().isValid()) {
+            ++count;
+        }
+    }
+
+    stream << CatalogMagic << CatalogVersion << count;
+    for (const KateSession::Ptr &session : qAsConst(m_sessions)) {
+        if (session->timestamp().isValid()) {
+            stream << QFileInfo(session->file()).fileName() << session->timestamp().toMSecsSinceEpoch() << quint32(session->documents());
+        }
+    }
+
+    QSaveFile file(m_sessionsDir + QStringLiteral("/.catalog"));
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qCWarning(LOG_KATE) << "Unable to write session catalog" << file.fileName() << file.errorString();
     }
 }
 
@@ -105,6 +283,8 @@ bool KateSessionManager::activateSession(KateSession::Ptr session, const bool cl
         return true;
     }
 
+    KateTraceScope trace("phase", QStringLiteral("KateSessionManager::activateSession"), session->name());
+
     if (!session->isAnonymous()) {
         // check if the requested session is already open in another instance
         KateRunningInstanceMap instances;
@@ -566,6 +746,29 @@ KateSessionList KateSessionManager::sessionList()
     return m_sessions.values();
 }
 
+void KateSessionManager::updateJumpList()
+{
+    KateSessionList sessions = m_sessions.values();
+    const int count = std::min(sessions.size(), JumpListSize);
+    std::partial_sort(sessions.begin(), sessions.begin() + count, sessions.end(), KateSession::compareByTimeDesc);
+
+    QStringList names;
+    names.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        names << sessions.at(i)->name();
+    }
+    names.sort();
+
+    // the desktop file is only looked at if the most recent sessions are others
+    if (m_jumpListUpToDate && names == m_jumpListSessions) {
+        return;
+    }
+
+    m_jumpListSessions = names;
+    m_jumpListUpToDate = true;
+    updateJumpListActions(names);
+}
+
 void KateSessionManager::updateJumpListActions(const QStringList &sessionList)
 {
     KService::Ptr service = KService::serviceByStorageId(qApp->desktopFileName());
@@ -581,9 +784,9 @@ void KateSessionManager::updateJumpListActions(const QStringList &sessionList)
     newActions.erase(std::remove_if(newActions.begin(), newActions.end(), [](const QString &action) { return action.startsWith(QLatin1String("Session ")); }), newActions.end());
 
     // Limit the number of list entries we like to offer
-    const int maxEntryCount = std::min(sessionList.count(), 10);
+    const int maxEntryCount = std::min(sessionList.count(), JumpListSize);
 
-    // sessionList is ordered by time, but we like it alphabetical to avoid even more a needed update
+    // we like it alphabetical to avoid even more a needed update
     QStringList sessionSubList = sessionList.mid(0, maxEntryCount);
     sessionSubList.sort();
 
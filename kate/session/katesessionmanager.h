@@ -10,8 +10,13 @@
 
 #include "katesession.h"
 
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QObject>
+#include <QTimer>
+
+class QFileInfo;
 
 typedef QList<KateSession::Ptr> KateSessionList;
 
@@ -167,9 +172,30 @@ public:
 private Q_SLOTS:
     /**
      * trigger update of session list
+     * only the sessions with a changed file are read again
      */
     void updateSessionList();
 
+    /**
+     * a single session file was created or written
+     */
+    void sessionFileChanged(const QString &path);
+
+    /**
+     * a single session file was deleted
+     */
+    void sessionFileDeleted(const QString &path);
+
+    /**
+     * the sessions dir changed without telling which file
+     */
+    void sessionsDirChanged();
+
+    /**
+     * write name, time and document count of all sessions to the catalog file
+     */
+    void writeCatalog();
+
 private:
     /**
      * Ask the user for a new session name, when needed.
@@ -212,6 +238,27 @@ private:
      */
     void loadSession(const KateSession::Ptr &session) const;
 
+    /**
+     * add the session of the file @p info or update its time and document count
+     * @return true if the session list changed
+     */
+    bool updateSession(const QFileInfo &info);
+
+    /**
+     * emit sessionListChanged() and update what depends on the list
+     */
+    void sessionListUpdated();
+
+    /**
+     * read the catalog written by writeCatalog()
+     */
+    void readCatalog();
+
+    /**
+     * update the jump list actions if the most recent sessions changed
+     */
+    void updateJumpList();
+
     /**
      * Writes sessions as jump list actions to the kate.desktop file
      */
@@ -234,6 +281,29 @@ private:
     KateSession::Ptr m_activeSession;
 
     class KDirWatch *m_dirWatch;
+
+    /**
+     * time and document count per session file name as read from the catalog,
+     * only needed until the first scan of the sessions dir is done
+     */
+    struct CatalogEntry {
+        QDateTime timestamp;
+        unsigned int documents = 0;
+    };
+    QHash<QString, CatalogEntry> m_catalog;
+    QTimer m_catalogTimer;
+
+    /**
+     * a change of the dir is only scanned for if no file event told about it
+     */
+    QTimer m_rescanTimer;
+    QElapsedTimer m_lastFileEvent;
+
+    /**
+     * sessions currently in the jump list, sorted by name
+     */
+    QStringList m_jumpListSessions;
+    bool m_jumpListUpToDate = false;
 };
 
 #endif